@@ -0,0 +1,62 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// Per thread, so the recording threads don't need any synchronization and don't count each other
+	thread_local uint64_t gThreadAllocationCount = 0;
+}
+
+// The default nothrow versions call these ones, aligned allocations are not counted
+void* operator new(std::size_t size)
+{
+	gThreadAllocationCount++;
+	void* memory = std::malloc(size > 0 ? size : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+AllocationCounter::AllocationCounter()
+	: mFirstAllocation(gThreadAllocationCount)
+{
+}
+
+uint64_t AllocationCounter::getAllocationCount() const
+{
+	return gThreadAllocationCount - mFirstAllocation;
+}
+
+uint64_t AllocationCounter::getThreadAllocationCount()
+{
+	return gThreadAllocationCount;
+}
\ No newline at end of file
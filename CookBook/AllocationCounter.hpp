@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the heap allocations (global operator new) made by the current thread since its construction
+// The samples put one around their bind, draw and submission calls, which must not allocate
+class AllocationCounter
+{
+	public:
+		AllocationCounter();
+
+		uint64_t getAllocationCount() const;
+
+		// Since the start of the current thread
+		static uint64_t getThreadAllocationCount();
+
+	private:
+		uint64_t mFirstAllocation;
+};
\ No newline at end of file
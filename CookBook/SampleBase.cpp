@@ -3,6 +3,8 @@
 #include "../VulkanWrapper/VulkanPhysicalDevice.hpp"
 #include "../VulkanWrapper/VulkanQueue.hpp"
 
+#include <algorithm>
+
 MouseStateParameters::MouseStateParameters() 
 {
 	buttons[0].isPressed = false;
@@ -53,6 +55,11 @@ void TimerStateParameters::update()
 
 SampleBase::SampleBase()
 	: mReady(false)
+	, mFramesInFlight(DefaultFramesInFlight)
+	, mFramePacingStats()
+	, mLastFrameBegin()
+	, mHotPathAllocations(0)
+	, mFrameIndex(0)
 {
 }
 
@@ -125,6 +132,139 @@ void SampleBase::wait()
 	VulkanDevice::get().waitForAllSubmittedCommands();
 }
 
+void SampleBase::printPipelineCacheStats()
+{
+	if (mPipelineCache != nullptr)
+	{
+		printf("Pipeline cache %s : %u pipelines created in %.3f ms\n", mPipelineCache->isWarm() ? "warm" : "cold", mPipelineCache->getCreatedPipelineCount(), mPipelineCache->getPipelineCreationTime());
+	}
+	VulkanDevice::get().getShaderModuleCache().printStats();
+}
+
+void SampleBase::printMemoryAllocatorBenchmark(uint32_t resourceCount)
+{
+	VulkanDevice& device = VulkanDevice::get();
+	VulkanMemoryAllocator& memoryAllocator = device.getMemoryAllocator();
+
+	resourceCount = std::min(resourceCount, device.getPhysicalDevice().getProperties().limits.maxMemoryAllocationCount / 2);
+
+	// Only the allocation and the binding of the memory are measured, not the creation of the buffers
+	auto createBuffers = [&device, resourceCount](std::vector<VulkanBufferPtr>& buffers)
+	{
+		for (uint32_t i = 0; i < resourceCount; i++)
+		{
+			// From 4 KB to 256 KB, like the vertex, index and uniform buffers of the samples
+			VulkanBufferPtr buffer = device.createBuffer(4096u << (i % 7), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+			if (buffer == nullptr)
+			{
+				return false;
+			}
+			buffer->getMemoryRequirements();
+			buffers.push_back(std::move(buffer));
+		}
+		return true;
+	};
+
+	std::vector<VulkanBufferPtr> buffers;
+	if (!createBuffers(buffers))
+	{
+		printf("Memory benchmark : could not create the buffers\n");
+		return;
+	}
+	const VulkanU64 deviceAllocationsBefore = memoryAllocator.getStats().totalDeviceAllocations;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (VulkanBufferPtr& buffer : buffers)
+	{
+		if (buffer->allocateMemoryBlock(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == nullptr)
+		{
+			printf("Memory benchmark : could not sub-allocate the memory of a buffer\n");
+			return;
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	const float allocatorTime = std::chrono::duration<float, std::milli>(end - begin).count();
+	const VulkanU64 allocatorDeviceAllocations = memoryAllocator.getStats().totalDeviceAllocations - deviceAllocationsBefore;
+	begin = std::chrono::high_resolution_clock::now();
+	buffers.clear();
+	end = std::chrono::high_resolution_clock::now();
+	const float allocatorFreeTime = std::chrono::duration<float, std::milli>(end - begin).count();
+	memoryAllocator.releaseEmptyPages();
+
+	std::vector<VulkanMemoryBlockPtr> memoryBlocks;
+	memoryBlocks.reserve(resourceCount);
+	if (!createBuffers(buffers))
+	{
+		printf("Memory benchmark : could not create the buffers\n");
+		return;
+	}
+	begin = std::chrono::high_resolution_clock::now();
+	for (VulkanBufferPtr& buffer : buffers)
+	{
+		VulkanMemoryBlockPtr memoryBlock = device.createMemoryBlock(buffer->getMemoryRequirements(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (memoryBlock == nullptr || !memoryBlock->bind(buffer.get(), 0))
+		{
+			printf("Memory benchmark : could not allocate the memory of a buffer\n");
+			return;
+		}
+		memoryBlocks.push_back(std::move(memoryBlock));
+	}
+	end = std::chrono::high_resolution_clock::now();
+	const float dedicatedTime = std::chrono::duration<float, std::milli>(end - begin).count();
+	begin = std::chrono::high_resolution_clock::now();
+	buffers.clear();
+	memoryBlocks.clear();
+	end = std::chrono::high_resolution_clock::now();
+	const float dedicatedFreeTime = std::chrono::duration<float, std::milli>(end - begin).count();
+
+	printf("Memory benchmark : %u buffers, allocator : %.3f ms (%.3f ms to free), %llu device allocations\n", resourceCount, allocatorTime, allocatorFreeTime, static_cast<unsigned long long>(allocatorDeviceAllocations));
+	printf("Memory benchmark : %u buffers, vkAllocateMemory per buffer : %.3f ms (%.3f ms to free), %u device allocations\n", resourceCount, dedicatedTime, dedicatedFreeTime, resourceCount);
+}
+
+bool SampleBase::setFramesInFlight(uint32_t framesInFlight)
+{
+	if (mReady)
+	{
+		printf("The frames in flight must be set before the initialization of the sample\n");
+		return false;
+	}
+	if (framesInFlight == 0 || framesInFlight > MaxFramesInFlight)
+	{
+		printf("Invalid number of frames in flight : %u (1 to %u)\n", framesInFlight, MaxFramesInFlight);
+		return false;
+	}
+	mFramesInFlight = framesInFlight;
+	return true;
+}
+
+uint32_t SampleBase::getFramesInFlight() const
+{
+	return mFramesInFlight;
+}
+
+const FramePacingStats& SampleBase::getFramePacingStats() const
+{
+	return mFramePacingStats;
+}
+
+void SampleBase::printFramePacingStats()
+{
+	const uint32_t frames = mFramePacingStats.frames;
+	if (frames > 0)
+	{
+		const float averageWaitTime = mFramePacingStats.totalFenceWaitTime / frames;
+		const float averageFrameTime = (frames > 1) ? mFramePacingStats.totalFrameTime / (frames - 1) : 0.0f;
+		printf("Frames : %u frames in flight, %u frames, %.3f ms per frame\n", mFramesInFlight, frames, averageFrameTime);
+		printf("Frames : %.3f ms average fence wait (%.3f ms max), %.1f%% of the frame time\n", averageWaitTime, mFramePacingStats.maxFenceWaitTime, (averageFrameTime > 0.0f) ? 100.0f * averageWaitTime / averageFrameTime : 0.0f);
+		printf("Frames : %llu heap allocations in the recording and submission of %u frames, after the first %u frames\n", static_cast<unsigned long long>(mFramePacingStats.hotPathAllocations), mFramePacingStats.allocatingFrames, mFramesInFlight);
+	}
+	#if (defined VULKAN_OPTION_PROFILE)
+	if (mGpuProfiler != nullptr)
+	{
+		mGpuProfiler->printResults();
+	}
+	#endif
+}
+
 void SampleBase::onMouseEvent()
 {
 }
@@ -185,8 +325,24 @@ bool SampleBase::initializeVulkan(VulkanWindowParameters windowParameters, VkPhy
 		return false;
 	}
 
-	const uint32_t framesCount = 3; // TODO : Unhardcode
-	for (uint32_t i = 0; i < framesCount; i++)
+	// Shared by all the samples, each one adds its pipelines to the file
+	mPipelineCache = VulkanDevice::get().createPipelineCacheFromFile("PipelineCache.bin", true);
+	if (mPipelineCache == nullptr)
+	{
+		return false;
+	}
+
+	// TODO : Use a dedicated transfer queue when the device has one
+	mUploadManager = VulkanUploadManager::createUploadManager(VulkanDevice::get(), mGraphicsQueue);
+	if (mUploadManager == nullptr)
+	{
+		return false;
+	}
+
+	mFrameIndex = 0;
+	mFramePacingStats = {};
+	mHotPathAllocations = 0;
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
 	{
 		VulkanCommandBufferPtr commandBuffer = mCommandPool->allocatePrimaryCommandBuffer();
 		if (commandBuffer == nullptr || !commandBuffer->isInitialized())
@@ -222,6 +378,14 @@ bool SampleBase::initializeVulkan(VulkanWindowParameters windowParameters, VkPhy
 		);
 	}
 
+	#if (defined VULKAN_OPTION_PROFILE)
+	mGpuProfiler = VulkanGpuProfiler::createGpuProfiler(VulkanDevice::get(), mGraphicsQueue->getFamilyIndex(), mFramesInFlight);
+	for (FrameResources& frameResources : mFramesResources)
+	{
+		frameResources.mCommandBuffer->setProfiler(mGpuProfiler.get());
+	}
+	#endif
+
 	mSwapchain = VulkanDevice::get().createSwapchain(*(mSurface.get()), mFramesResources);
 	if (mSwapchain == nullptr)
 	{
@@ -232,3 +396,61 @@ bool SampleBase::initializeVulkan(VulkanWindowParameters windowParameters, VkPhy
 
 	return true;
 }
+
+bool SampleBase::beginFrame()
+{
+	FrameResources& currentFrame = getCurrentFrame();
+
+	const auto waitBegin = std::chrono::high_resolution_clock::now();
+
+	// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
+	if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+	{
+		return false;
+	}
+
+	const auto waitEnd = std::chrono::high_resolution_clock::now();
+	const float waitTime = std::chrono::duration<float, std::milli>(waitEnd - waitBegin).count();
+	mFramePacingStats.totalFenceWaitTime += waitTime;
+	mFramePacingStats.maxFenceWaitTime = std::max(mFramePacingStats.maxFenceWaitTime, waitTime);
+	if (mFramePacingStats.frames > 0)
+	{
+		mFramePacingStats.totalFrameTime += std::chrono::duration<float, std::milli>(waitBegin - mLastFrameBegin).count();
+	}
+	mFramePacingStats.frames++;
+	mLastFrameBegin = waitBegin;
+
+	return currentFrame.mDrawingFinishedFence->reset();
+}
+
+FrameResources& SampleBase::getCurrentFrame()
+{
+	return mFramesResources[mFrameIndex];
+}
+
+void SampleBase::endFrame()
+{
+	// The first frames in flight create the transient pools and fill the caches
+	const uint64_t hotPathAllocations = mHotPathAllocations.exchange(0);
+	if (mFramePacingStats.frames > mFramesInFlight && hotPathAllocations > 0)
+	{
+		mFramePacingStats.hotPathAllocations += hotPathAllocations;
+		mFramePacingStats.allocatingFrames++;
+	}
+	mFrameIndex = (mFrameIndex + 1) % static_cast<uint32_t>(mFramesResources.size());
+}
+
+void SampleBase::beginGpuProfile(VulkanCommandBuffer& commandBuffer)
+{
+	#if (defined VULKAN_OPTION_PROFILE)
+	if (mGpuProfiler != nullptr)
+	{
+		mGpuProfiler->beginFrame(mFrameIndex, commandBuffer);
+	}
+	#endif
+}
+
+void SampleBase::addHotPathAllocations(uint64_t allocationCount)
+{
+	mHotPathAllocations += allocationCount;
+}
\ No newline at end of file
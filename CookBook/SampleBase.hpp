@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <vector>
 
@@ -54,9 +55,23 @@ class TimerStateParameters
 		std::chrono::duration<float> mDeltaTime;
 };
 
+// CPU time of the frames, to compare the time spent waiting for the GPU with the time spent preparing the frames
+struct FramePacingStats
+{
+	uint32_t frames;
+	float totalFenceWaitTime; // In ms
+	float maxFenceWaitTime; // In ms
+	float totalFrameTime; // In ms, between two beginFrame()
+	uint64_t hotPathAllocations; // Counted with addHotPathAllocations(), without the first getFramesInFlight() frames which create the pools
+	uint32_t allocatingFrames; // Frames with hot path allocations, without the first getFramesInFlight() frames
+};
+
 class SampleBase
 {
 	public:
+		static const uint32_t DefaultFramesInFlight = 3;
+		static const uint32_t MaxFramesInFlight = 8;
+
 		SampleBase();
 		virtual ~SampleBase();
 
@@ -72,13 +87,46 @@ class SampleBase
 		virtual bool isReady() final;
 		virtual void wait() final;
 
+		// Cold (no valid cache file) or warm pipeline cache, and the time spent creating the pipelines of the sample
+		virtual void printPipelineCacheStats() final;
+
+		// Allocates the memory of resourceCount new buffers with the VulkanMemoryAllocator of the device, then with one vkAllocateMemory per buffer
+		// Must be called after initialize(), the count is limited to half of maxMemoryAllocationCount
+		virtual void printMemoryAllocatorBenchmark(uint32_t resourceCount) final;
+
+		// More frames in flight let the CPU prepare frame N+1 while the GPU still renders frame N, at the cost of latency
+		// Must be called before initialize()
+		virtual bool setFramesInFlight(uint32_t framesInFlight) final;
+		virtual uint32_t getFramesInFlight() const final;
+		virtual const FramePacingStats& getFramePacingStats() const final;
+		virtual void printFramePacingStats() final;
+
 	protected:
 		virtual void onMouseEvent();
 
 		virtual bool initializeVulkan(VulkanWindowParameters windowParameters, VkPhysicalDeviceFeatures* desiredDeviceFeatures = nullptr) final;
 
+		// Waits until the GPU is done with the resources of the current frame (submitted getFramesInFlight() frames ago) and resets its fence
+		// The per-frame resources (command buffer, staging buffer slice, transient descriptor sets, ...) indexed by mFrameIndex can be reused after it
+		virtual bool beginFrame() final;
+		virtual FrameResources& getCurrentFrame() final;
+		// After the submission of the current frame, moves to the resources of the next one
+		virtual void endFrame() final;
+
+		// Right after beginRecording() of the frame command buffer, reads the GPU times of the frame that used it before
+		// The passes are measured with VULKAN_PROFILE_GPU_SCOPE, nothing is done without VULKAN_OPTION_PROFILE
+		virtual void beginGpuProfile(VulkanCommandBuffer& commandBuffer) final;
+
+		// Heap allocations counted by an AllocationCounter from beginRecording() to endRecording() and around the submission, added to the frame stats by endFrame()
+		// They should stay at 0 once each frame in flight was drawn once, can be called from the recording threads
+		virtual void addHotPathAllocations(uint64_t allocationCount) final;
+
 	private:
 		bool mReady;
+		uint32_t mFramesInFlight;
+		FramePacingStats mFramePacingStats;
+		std::chrono::time_point<std::chrono::high_resolution_clock> mLastFrameBegin;
+		std::atomic<uint64_t> mHotPathAllocations; // Of the current frame
 
 	protected:
 		MouseStateParameters mMouseState;
@@ -90,5 +138,11 @@ class SampleBase
 		VulkanQueue* mGraphicsQueue;
 		VulkanQueue* mComputeQueue;
 		VulkanQueue* mPresentQueue;
+		VulkanUploadManagerPtr mUploadManager;
+		VulkanPipelineCachePtr mPipelineCache; // Loaded from and saved to PipelineCache.bin
 		std::vector<FrameResources> mFramesResources;
+		uint32_t mFrameIndex; // Of the current frame in mFramesResources
+		#if (defined VULKAN_OPTION_PROFILE)
+		VulkanGpuProfilerPtr mGpuProfiler; // nullptr when the graphics queue doesn't support timestamps
+		#endif
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../CookBook/SampleBase.hpp"
+#include "../../CookBook/AllocationCounter.hpp"
 
 #include "../../Math/Matrix4.hpp"
 
@@ -8,6 +9,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,10 +18,11 @@ class VertexDiffuseLightning : public SampleBase
 	public:
 		nu::Mesh mMesh;
 		nu::VertexBuffer::Ptr mVertexBuffer;
+		nu::IndexBuffer::Ptr mIndexBuffer;
 
-		VulkanDescriptorSetLayoutPtr mDescriptorSetLayout;
-		VulkanDescriptorPoolPtr mDescriptorPool;
-		std::vector<VulkanDescriptorSetPtr> mDescriptorSets;
+		std::vector<VulkanDescriptorSetLayoutPtr> mDescriptorSetLayouts;
+		VulkanDescriptorAllocatorPtr mDescriptorAllocator;
+		VulkanDescriptorUpdateTemplatePtr mDescriptorUpdateTemplate;
 
 		VulkanRenderPassPtr mRenderPass;
 		VulkanPipelineLayoutPtr mPipelineLayout;
@@ -33,8 +36,6 @@ class VertexDiffuseLightning : public SampleBase
 		nu::UniformBuffer::Ptr mUniformBuffer;
 		nu::StagingBuffer::Ptr mStagingBuffer;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			if (!initializeVulkan(windowParameters, nullptr)) 
@@ -43,12 +44,18 @@ class VertexDiffuseLightning : public SampleBase
 			}
 
 			// Vertex data
-			if (!mMesh.loadFromFile("../../Data/Models/knot.obj", true, false, false, true))
+			if (!mMesh.loadFromFile("../../Data/Models/knot.obj", true, false, false, true, nullptr, true))
 			{
 				return false;
 			}
+			mMesh.optimize(true, true);
 			mVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mMesh.size());
-			if (!mVertexBuffer || !mVertexBuffer->updateAndWait(mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mVertexBuffer || !mVertexBuffer->update(*mUploadManager, mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mMesh.indices.size(), mMesh.getIndexType());
+			if (!mIndexBuffer || !mIndexBuffer->update(*mUploadManager, (uint32_t)mMesh.indices.size(), &mMesh.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -59,7 +66,7 @@ class VertexDiffuseLightning : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -70,41 +77,42 @@ class VertexDiffuseLightning : public SampleBase
 				return false;
 			}
 
-			// Descriptor set with uniform buffer
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
-				0,                                          // uint32_t             binding
-				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType     descriptorType
-				1,                                          // uint32_t             descriptorCount
-				VK_SHADER_STAGE_VERTEX_BIT,                 // VkShaderStageFlags   stageFlags
-				nullptr                                     // const VkSampler    * pImmutableSamplers
-			};
-			mDescriptorSetLayout = VulkanDevice::get().createDescriptorSetLayout({ descriptorSetLayoutBinding });
-			if (mDescriptorSetLayout == nullptr || !mDescriptorSetLayout->isInitialized())
+			// Shaders
+			VulkanShaderModuleSharedPtr vertexShaderModule = VulkanDevice::get().getShaderModuleCache().loadShaderModule("../../Examples/1 - Vertex Diffuse Lightning/shader.vert.spv");
+			if (vertexShaderModule == nullptr)
 			{
 				return false;
 			}
 
-			VkDescriptorPoolSize descriptorPoolSize = {
-				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType     type
-				1                                           // uint32_t             descriptorCount
-			};
-			mDescriptorPool = VulkanDevice::get().createDescriptorPool(false, 1, { descriptorPoolSize });
-			if (mDescriptorPool == nullptr || !mDescriptorPool->isInitialized())
+			VulkanShaderModuleSharedPtr fragmentShaderModule = VulkanDevice::get().getShaderModuleCache().loadShaderModule("../../Examples/1 - Vertex Diffuse Lightning/shader.frag.spv");
+			if (fragmentShaderModule == nullptr)
 			{
 				return false;
 			}
 
-			// TODO : Allocate more than one at once
-			mDescriptorSets.resize(1);
-			mDescriptorSets[0] = mDescriptorPool->allocateDescriptorSet(mDescriptorSetLayout.get());
-			if (mDescriptorSets[0] == nullptr || !mDescriptorSets[0]->isInitialized())
+			// Descriptor set with uniform buffer, the layouts come from the shaders
+			VulkanShaderReflection reflection = vertexShaderModule->getReflection();
+			if (!reflection.merge(fragmentShaderModule->getReflection()))
+			{
+				return false;
+			}
+			if (!reflection.createDescriptorSetLayouts(VulkanDevice::get(), mDescriptorSetLayouts))
 			{
 				return false;
 			}
 
-			// Update descriptor
-			// TODO : Update more than one at once
-			mUniformBuffer->updateDescriptor(mDescriptorSets[0].get(), 0, 0);
+			// The descriptor set is allocated each frame, its pool is reset when the frame comes back
+			mDescriptorAllocator = VulkanDescriptorAllocator::createDescriptorAllocator(VulkanDevice::get(), getFramesInFlight());
+			if (mDescriptorAllocator == nullptr)
+			{
+				return false;
+			}
+			// And written each frame, the template writes it without building the write structures again
+			mDescriptorUpdateTemplate = VulkanDescriptorUpdateTemplate::createDescriptorUpdateTemplate(*mDescriptorSetLayouts[0]);
+			if (mDescriptorUpdateTemplate == nullptr)
+			{
+				return false;
+			}
 
 			// Render pass
 			mRenderPass = VulkanDevice::get().initRenderPass();
@@ -144,33 +152,21 @@ class VertexDiffuseLightning : public SampleBase
 
 			// Graphics pipeline
 
-			mPipelineLayout = VulkanDevice::get().createPipelineLayout({ mDescriptorSetLayout->getHandle() }, {});
+			mPipelineLayout = reflection.createPipelineLayout(VulkanDevice::get(), mDescriptorSetLayouts);
 			if (mPipelineLayout == nullptr || !mPipelineLayout->isInitialized())
 			{
 				return false;
 			}
 
-			VulkanShaderModulePtr vertexShaderModule = VulkanDevice::get().initShaderModule();
-			if (vertexShaderModule == nullptr || !vertexShaderModule->loadFromFile("../../Examples/1 - Vertex Diffuse Lightning/shader.vert.spv", VulkanShaderModule::Vertex))
-			{
-				return false;
-			}
-
-			VulkanShaderModulePtr fragmentShaderModule = VulkanDevice::get().initShaderModule();
-			if (fragmentShaderModule == nullptr || !fragmentShaderModule->loadFromFile("../../Examples/1 - Vertex Diffuse Lightning/shader.frag.spv", VulkanShaderModule::Fragment))
-			{
-				return false;
-			}
-
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
+			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::MeshPipeline].get();
 
 			modelPipeline->setSubpass(0);
 
-			modelPipeline->addShaderModule(vertexShaderModule.get());
-			modelPipeline->addShaderModule(fragmentShaderModule.get());
+			modelPipeline->addShaderModule(vertexShaderModule);
+			modelPipeline->addShaderModule(fragmentShaderModule);
 
 			modelPipeline->addVertexBinding(0, 6 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX);
 			modelPipeline->addVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
@@ -198,6 +194,13 @@ class VertexDiffuseLightning : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
@@ -205,6 +208,9 @@ class VertexDiffuseLightning : public SampleBase
 		{
 			auto prepareFrame = [&](VulkanCommandBuffer* commandBuffer, uint32_t swapchainImageIndex, VulkanFramebuffer* framebuffer) 
 			{
+				// Nothing should be allocated from the beginning to the end of the recording
+				AllocationCounter allocationCounter;
+
 				if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
 				{
 					return false;
@@ -212,7 +218,7 @@ class VertexDiffuseLightning : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -230,8 +236,18 @@ class VertexDiffuseLightning : public SampleBase
 					commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, { imageTransitionBeforeDrawing } );
 				}
 
+				VkDescriptorSet descriptorSet = mDescriptorAllocator->allocateTransientDescriptorSet(mDescriptorSetLayouts[0].get());
+				if (descriptorSet == VK_NULL_HANDLE)
+				{
+					return false;
+				}
+				VulkanDescriptorData descriptorData;
+				descriptorData.buffer = mUniformBuffer->getDescriptorInfo();
+				mDescriptorUpdateTemplate->update(descriptorSet, &descriptorData);
+
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -259,14 +275,15 @@ class VertexDiffuseLightning : public SampleBase
 				commandBuffer->setScissorStateDynamically(0, { scissor });
 
 				mVertexBuffer->bindTo(commandBuffer, 0, 0 );
+				mIndexBuffer->bindTo(commandBuffer, 0);
 
-				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
+				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { descriptorSet }, {});
 
 				commandBuffer->bindPipeline(mPipelines[PipelineNames::MeshPipeline].get());
 
 				for (size_t i = 0; i < mMesh.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mMesh.parts[i].vertexCount, 1, mMesh.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mMesh.parts[i].indexCount, 1, mMesh.parts[i].indexOffset, 0, 0);
 				}
 
 				commandBuffer->endRenderPass();
@@ -286,18 +303,20 @@ class VertexDiffuseLightning : public SampleBase
 					commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, { imageTransitionBeforePresent } );
 				}
 
-				return commandBuffer->endRecording();
+				const bool recorded = commandBuffer->endRecording();
+				addHotPathAllocations(allocationCounter.getAllocationCount());
+				return recorded;
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
+			mStagingBuffer->beginFrame(mFrameIndex);
+
+			if (!mDescriptorAllocator->beginFrame(mFrameIndex))
 			{
 				return false;
 			}
@@ -331,6 +350,8 @@ class VertexDiffuseLightning : public SampleBase
 				currentFrame.mImageAcquiredSemaphore->getHandle(),  // VkSemaphore            Semaphore
 				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT       // VkPipelineStageFlags   WaitingStage
 			});
+
+			AllocationCounter allocationCounter;
 			if (!mGraphicsQueue->submitCommandBuffers({ currentFrame.mCommandBuffer.get() }, waitSemaphoreInfos, { currentFrame.mReadyToPresentSemaphore->getHandle() }, currentFrame.mDrawingFinishedFence.get()))
 			{
 				return false;
@@ -344,8 +365,9 @@ class VertexDiffuseLightning : public SampleBase
 			{
 				return false;
 			}
+			addHotPathAllocations(allocationCounter.getAllocationCount());
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -376,11 +398,11 @@ class VertexDiffuseLightning : public SampleBase
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -8,6 +8,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,10 +17,12 @@ class Postprocessing : public SampleBase
 	public:
 		nu::Mesh mSkybox;
 		nu::VertexBuffer::Ptr mSkyboxVertexBuffer;
+		nu::IndexBuffer::Ptr mSkyboxIndexBuffer;
 		VulkanImageHelperPtr mSkyboxCubemap;
 
 		nu::Mesh mModel;
 		nu::VertexBuffer::Ptr mModelVertexBuffer;
+		nu::IndexBuffer::Ptr mModelIndexBuffer;
 
 		nu::VertexBuffer::Ptr mPostprocessVertexBuffer;
 		VulkanImageHelperPtr mSceneImage;
@@ -48,8 +51,6 @@ class Postprocessing : public SampleBase
 			Count
 		};
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			if (!initializeVulkan(windowParameters, nullptr)) 
@@ -64,23 +65,34 @@ class Postprocessing : public SampleBase
 			}
 
 			// Vertex data - Model
-			if (!mModel.loadFromFile("../../Data/Models/sphere.obj", true, false, false, true))
+			if (!mModel.loadFromFile("../../Data/Models/sphere.obj", true, false, false, true, nullptr, true))
 			{
 				return false;
 			}
+			mModel.optimize(true, true);
 			mModelVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mModel.size());
-			if (!mModelVertexBuffer || !mModelVertexBuffer->updateAndWait(mModel.size(), &mModel.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mModelVertexBuffer || !mModelVertexBuffer->update(*mUploadManager, mModel.size(), &mModel.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mModelIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mModel.indices.size(), mModel.getIndexType());
+			if (!mModelIndexBuffer || !mModelIndexBuffer->update(*mUploadManager, (uint32_t)mModel.indices.size(), &mModel.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
 
 			// Vertex data - Skybox
-			if (!mSkybox.loadFromFile("../../Data/Models/cube.obj", false, false, false, false))
+			if (!mSkybox.loadFromFile("../../Data/Models/cube.obj", false, false, false, false, nullptr, true))
 			{
 				return false;
 			}
 			mSkyboxVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mSkybox.size());
-			if (!mSkyboxVertexBuffer || !mSkyboxVertexBuffer->updateAndWait(mSkybox.size(), &mSkybox.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mSkyboxVertexBuffer || !mSkyboxVertexBuffer->update(*mUploadManager, mSkybox.size(), &mSkybox.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mSkyboxIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mSkybox.indices.size(), mSkybox.getIndexType());
+			if (!mSkyboxIndexBuffer || !mSkyboxIndexBuffer->update(*mUploadManager, (uint32_t)mSkybox.indices.size(), &mSkybox.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -96,7 +108,7 @@ class Postprocessing : public SampleBase
 				1.0f,  1.0f, 0.0f,
 			};
 			mPostprocessVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), (uint32_t)vertices.size() * sizeof(float));
-			if (!mPostprocessVertexBuffer || !mPostprocessVertexBuffer->updateAndWait((uint32_t)vertices.size() * sizeof(float), &vertices[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mPostprocessVertexBuffer || !mPostprocessVertexBuffer->update(*mUploadManager, (uint32_t)vertices.size() * sizeof(float), &vertices[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -107,7 +119,7 @@ class Postprocessing : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -145,10 +157,9 @@ class Postprocessing : public SampleBase
 					static_cast<uint32_t>(i),     // uint32_t               baseArrayLayer
 					1                             // uint32_t               layerCount
 				};
-				mGraphicsQueue->useStagingBufferToUpdateImageAndWait(imageDataSize, &cubemapImageData[0],
-					mSkyboxCubemap->getImage(), imageSubresource, { 0, 0, 0 }, { 1024, 1024, 1 }, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-					0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-					mFramesResources.front().mCommandBuffer.get(), {}, 50000000);
+				mUploadManager->uploadImage(mSkyboxCubemap->getImage(), imageSubresource, { 0, 0, 0 }, { 1024, 1024, 1 }, imageDataSize, &cubemapImageData[0],
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+					VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 			}
 
 			// Scene image (color attachment in 1st subpass, input attachment in 2nd subpass
@@ -353,9 +364,9 @@ class Postprocessing : public SampleBase
 			}
 
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::SkyboxPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
-			mPipelines[PipelineNames::ModelPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
-			mPipelines[PipelineNames::PostprocessPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPostprocessPipelineLayout, *mRenderPass, nullptr);
+			mPipelines[PipelineNames::SkyboxPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
+			mPipelines[PipelineNames::ModelPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
+			mPipelines[PipelineNames::PostprocessPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPostprocessPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* skyboxPipeline = mPipelines[PipelineNames::SkyboxPipeline].get();
 			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::ModelPipeline].get();
@@ -441,7 +452,20 @@ class Postprocessing : public SampleBase
 			postprocessPipeline->addDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
 			postprocessPipeline->addDynamicState(VK_DYNAMIC_STATE_SCISSOR);
 
-			if (!skyboxPipeline->create() || !modelPipeline->create() || !postprocessPipeline->create())
+			// The three pipelines are compiled in parallel
+			VulkanPipelineBatchPtr pipelineBatch = VulkanPipelineBatch::createPipelineBatch(VulkanDevice::get(), PipelineNames::Count);
+			pipelineBatch->addGraphicsPipeline(skyboxPipeline);
+			pipelineBatch->addGraphicsPipeline(modelPipeline);
+			pipelineBatch->addGraphicsPipeline(postprocessPipeline);
+			if (!pipelineBatch->build())
+			{
+				return false;
+			}
+			pipelineBatch->printTimings();
+
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
 			{
 				return false;
 			}
@@ -458,9 +482,11 @@ class Postprocessing : public SampleBase
 					return false;
 				}
 
+				beginGpuProfile(*commandBuffer);
+
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -479,7 +505,8 @@ class Postprocessing : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				// Subpass 0
 
@@ -513,31 +540,46 @@ class Postprocessing : public SampleBase
 				float p[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 				commandBuffer->provideDataToShadersThroughPushConstants(mPipelineLayout->getHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float) * 4, &p[0]);
 
-				// Draw model
-				commandBuffer->bindPipeline(mPipelines[PipelineNames::ModelPipeline].get());
-				mModelVertexBuffer->bindTo(commandBuffer, 0, 0);
-				for (size_t i = 0; i < mModel.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mModel.parts[i].vertexCount, 1, mModel.parts[i].vertexOffset, 0);
-				}
+					VULKAN_PROFILE_GPU_SCOPE(*commandBuffer, "Scene");
 
-				// Draw skybox
-				commandBuffer->bindPipeline(mPipelines[PipelineNames::SkyboxPipeline].get());
-				mSkyboxVertexBuffer->bindTo(commandBuffer, 0, 0);
-				for (size_t i = 0; i < mSkybox.parts.size(); i++)
-				{
-					commandBuffer->drawGeometry(mSkybox.parts[i].vertexCount, 1, mSkybox.parts[i].vertexOffset, 0);
+					// Draw model
+					{
+						VULKAN_PROFILE_GPU_SCOPE(*commandBuffer, "Model");
+						commandBuffer->bindPipeline(mPipelines[PipelineNames::ModelPipeline].get());
+						mModelVertexBuffer->bindTo(commandBuffer, 0, 0);
+						mModelIndexBuffer->bindTo(commandBuffer, 0);
+						for (size_t i = 0; i < mModel.parts.size(); i++) 
+						{
+							commandBuffer->drawIndexedGeometry(mModel.parts[i].indexCount, 1, mModel.parts[i].indexOffset, 0, 0);
+						}
+					}
+
+					// Draw skybox
+					{
+						VULKAN_PROFILE_GPU_SCOPE(*commandBuffer, "Skybox");
+						commandBuffer->bindPipeline(mPipelines[PipelineNames::SkyboxPipeline].get());
+						mSkyboxVertexBuffer->bindTo(commandBuffer, 0, 0);
+						mSkyboxIndexBuffer->bindTo(commandBuffer, 0);
+						for (size_t i = 0; i < mSkybox.parts.size(); i++)
+						{
+							commandBuffer->drawIndexedGeometry(mSkybox.parts[i].indexCount, 1, mSkybox.parts[i].indexOffset, 0, 0);
+						}
+					}
 				}
 
 				// Subpass 1
 				commandBuffer->progressToTheNextSubpass(VK_SUBPASS_CONTENTS_INLINE);
 
-				commandBuffer->bindPipeline(mPipelines[PipelineNames::PostprocessPipeline].get());
-				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPostprocessPipelineLayout->getHandle(), 0, { mPostprocessDescriptorSets[0].get() }, {});
-				mPostprocessVertexBuffer->bindTo(commandBuffer, 0, 0);
-				float time = mTimerState.getTime();
-				commandBuffer->provideDataToShadersThroughPushConstants(mPostprocessPipelineLayout->getHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &time);
-				commandBuffer->drawGeometry(6, 1, 0, 0);
+				{
+					VULKAN_PROFILE_GPU_SCOPE(*commandBuffer, "Postprocess");
+					commandBuffer->bindPipeline(mPipelines[PipelineNames::PostprocessPipeline].get());
+					commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPostprocessPipelineLayout->getHandle(), 0, { mPostprocessDescriptorSets[0].get() }, {});
+					mPostprocessVertexBuffer->bindTo(commandBuffer, 0, 0);
+					float time = mTimerState.getTime();
+					commandBuffer->provideDataToShadersThroughPushConstants(mPostprocessPipelineLayout->getHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &time);
+					commandBuffer->drawGeometry(6, 1, 0, 0);
+				}
 
 				commandBuffer->endRenderPass();
 
@@ -559,18 +601,13 @@ class Postprocessing : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -611,7 +648,7 @@ class Postprocessing : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -640,14 +677,14 @@ class Postprocessing : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
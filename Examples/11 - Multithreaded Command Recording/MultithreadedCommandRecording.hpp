@@ -0,0 +1,512 @@
+#pragma once
+
+#include "../../CookBook/SampleBase.hpp"
+#include "../../CookBook/AllocationCounter.hpp"
+
+#include "../../Math/Matrix4.hpp"
+
+#include "../../Mesh.hpp"
+#include "../../Window.hpp"
+
+#include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
+#include "../../StagingBuffer.hpp"
+#include "../../UniformBuffer.hpp"
+
+class MultithreadedCommandRecording : public SampleBase
+{
+	public:
+		nu::Mesh mMesh;
+		nu::VertexBuffer::Ptr mVertexBuffer;
+		nu::IndexBuffer::Ptr mIndexBuffer;
+
+		VulkanDescriptorSetLayoutPtr mDescriptorSetLayout;
+		VulkanDescriptorPoolPtr mDescriptorPool;
+		std::vector<VulkanDescriptorSetPtr> mDescriptorSets;
+
+		VulkanRenderPassPtr mRenderPass;
+		VulkanPipelineLayoutPtr mPipelineLayout;
+		std::vector<VulkanGraphicsPipelinePtr> mPipelines;
+		enum PipelineNames
+		{
+			MeshPipeline = 0,
+			Count
+		};
+
+		nu::UniformBuffer::Ptr mUniformBuffer;
+		nu::StagingBuffer::Ptr mStagingBuffer;
+
+		// The mesh is drawn once per tile of the grid, each draw having its own viewport
+		static const uint32_t GridSize = 100;
+		static const uint32_t MaxThreadCount = 8;
+		static const uint32_t FramesPerMeasure = 200;
+
+		VulkanParallelRecorderPtr mParallelRecorder;
+
+		// Benchmark : the recording time is averaged over FramesPerMeasure frames for 1, 2, 4 and 8 threads
+		std::vector<uint32_t> mThreadCounts = { 1, 2, 4, 8 };
+		std::vector<float> mAverageRecordingTimes = { 0.0f, 0.0f, 0.0f, 0.0f };
+		uint32_t mMeasureIndex = 0;
+		uint32_t mMeasureFrame = 0;
+		float mMeasureTime = 0.0f;
+
+		virtual bool initialize(VulkanWindowParameters windowParameters) override 
+		{
+			if (!initializeVulkan(windowParameters, nullptr)) 
+			{
+				return false;
+			}
+
+			mParallelRecorder = VulkanParallelRecorder::createParallelRecorder(VulkanDevice::get(), mGraphicsQueue->getFamilyIndex(), getFramesInFlight(), MaxThreadCount);
+			if (mParallelRecorder == nullptr)
+			{
+				return false;
+			}
+			mParallelRecorder->setActiveThreadCount(mThreadCounts[mMeasureIndex]);
+			mParallelRecorder->setStateTracking(true);
+
+			// Vertex data
+			if (!mMesh.loadFromFile("../../Data/Models/knot.obj", true, false, false, true, nullptr, true))
+			{
+				return false;
+			}
+			mMesh.optimize(true, true);
+			mVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mMesh.size());
+			if (!mVertexBuffer || !mVertexBuffer->update(*mUploadManager, mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mMesh.indices.size(), mMesh.getIndexType());
+			if (!mIndexBuffer || !mIndexBuffer->update(*mUploadManager, (uint32_t)mMesh.indices.size(), &mMesh.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+
+			// Uniform buffer
+			mUniformBuffer = nu::UniformBuffer::createUniformBuffer(VulkanDevice::get(), 2 * 16 * sizeof(float));
+			if (mUniformBuffer == nullptr)
+			{
+				return false;
+			}
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
+			if (mStagingBuffer == nullptr)
+			{
+				return false;
+			}
+
+			if (!updateStagingBuffer(true)) 
+			{
+				return false;
+			}
+
+			// Descriptor set with uniform buffer
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
+				0,                                          // uint32_t             binding
+				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType     descriptorType
+				1,                                          // uint32_t             descriptorCount
+				VK_SHADER_STAGE_VERTEX_BIT,                 // VkShaderStageFlags   stageFlags
+				nullptr                                     // const VkSampler    * pImmutableSamplers
+			};
+			mDescriptorSetLayout = VulkanDevice::get().createDescriptorSetLayout({ descriptorSetLayoutBinding });
+			if (mDescriptorSetLayout == nullptr || !mDescriptorSetLayout->isInitialized())
+			{
+				return false;
+			}
+
+			VkDescriptorPoolSize descriptorPoolSize = {
+				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType     type
+				1                                           // uint32_t             descriptorCount
+			};
+			mDescriptorPool = VulkanDevice::get().createDescriptorPool(false, 1, { descriptorPoolSize });
+			if (mDescriptorPool == nullptr || !mDescriptorPool->isInitialized())
+			{
+				return false;
+			}
+
+			// TODO : Allocate more than one at once
+			mDescriptorSets.resize(1);
+			mDescriptorSets[0] = mDescriptorPool->allocateDescriptorSet(mDescriptorSetLayout.get());
+			if (mDescriptorSets[0] == nullptr || !mDescriptorSets[0]->isInitialized())
+			{
+				return false;
+			}
+
+			// Update descriptor
+			// TODO : Update more than one at once
+			mUniformBuffer->updateDescriptor(mDescriptorSets[0].get(), 0, 0);
+
+			// Render pass
+			mRenderPass = VulkanDevice::get().initRenderPass();
+			mRenderPass->addAttachment(mSwapchain->getFormat());
+			mRenderPass->setAttachmentLoadOp(VK_ATTACHMENT_LOAD_OP_CLEAR);
+			mRenderPass->setAttachmentStoreOp(VK_ATTACHMENT_STORE_OP_STORE);
+			mRenderPass->setAttachmentFinalLayout(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+			mRenderPass->addAttachment(mSwapchain->getDepthFormat());
+			mRenderPass->setAttachmentLoadOp(VK_ATTACHMENT_LOAD_OP_CLEAR);
+			mRenderPass->setAttachmentFinalLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+			mRenderPass->addSubpass(VK_PIPELINE_BIND_POINT_GRAPHICS);
+			mRenderPass->addColorAttachmentToSubpass(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+			mRenderPass->addDepthStencilAttachmentToSubpass(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+			mRenderPass->addDependency(
+				VK_SUBPASS_EXTERNAL,                            // uint32_t                   srcSubpass
+				0,                                              // uint32_t                   dstSubpass
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,              // VkPipelineStageFlags       srcStageMask
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags       dstStageMask
+				VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags              srcAccessMask
+				VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags              dstAccessMask
+				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
+			);
+			mRenderPass->addDependency(
+				0,                                              // uint32_t                   srcSubpass
+				VK_SUBPASS_EXTERNAL,                            // uint32_t                   dstSubpass
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags       srcStageMask
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,              // VkPipelineStageFlags       dstStageMask
+				VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags              srcAccessMask
+				VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags              dstAccessMask
+				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
+			);
+
+			if (!mRenderPass->create())
+			{
+				return false;
+			}
+
+			// Graphics pipeline
+
+			mPipelineLayout = VulkanDevice::get().createPipelineLayout({ mDescriptorSetLayout->getHandle() }, {});
+			if (mPipelineLayout == nullptr || !mPipelineLayout->isInitialized())
+			{
+				return false;
+			}
+
+			VulkanShaderModuleSharedPtr vertexShaderModule = VulkanDevice::get().getShaderModuleCache().loadShaderModule("../../Examples/1 - Vertex Diffuse Lightning/shader.vert.spv");
+			if (vertexShaderModule == nullptr)
+			{
+				return false;
+			}
+
+			VulkanShaderModuleSharedPtr fragmentShaderModule = VulkanDevice::get().getShaderModuleCache().loadShaderModule("../../Examples/1 - Vertex Diffuse Lightning/shader.frag.spv");
+			if (fragmentShaderModule == nullptr)
+			{
+				return false;
+			}
+
+			mPipelines.resize(PipelineNames::Count);
+			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
+
+			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::MeshPipeline].get();
+
+			modelPipeline->setSubpass(0);
+
+			modelPipeline->addShaderModule(vertexShaderModule);
+			modelPipeline->addShaderModule(fragmentShaderModule);
+
+			modelPipeline->addVertexBinding(0, 6 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX);
+			modelPipeline->addVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
+			modelPipeline->addVertexAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float));
+
+			//modelPipeline->setInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, false);
+
+			modelPipeline->setViewport(0.0f, 0.0f, 500.0f, 500.0f, 0.0f, 1.0f);
+			modelPipeline->setScissor(0, 0, 500, 500);
+
+			//modelPipeline->setRasterizationState(false, false, VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, false, 0.0f, 0.0f, 0.0f, 1.0f);
+
+			//modelPipeline->setMultisampleState(VK_SAMPLE_COUNT_1_BIT, false, 0.0f, nullptr, false, false);
+
+			//modelPipeline->setDepthStencilState(true, true, VK_COMPARE_OP_LESS_OR_EQUAL, false, false, {}, {}, 0.0f, 1.0f);
+
+			//modelPipeline->addBlend(false);
+			//modelPipeline->setBlendState(false, VK_LOGIC_OP_COPY, 1.0f, 1.0f, 1.0f, 1.0f);
+
+			modelPipeline->addDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
+			modelPipeline->addDynamicState(VK_DYNAMIC_STATE_SCISSOR);
+
+			if (!modelPipeline->create())
+			{
+				return false;
+			}
+
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		virtual bool draw() override 
+		{
+			auto prepareFrame = [&](VulkanCommandBuffer* commandBuffer, uint32_t swapchainImageIndex, VulkanFramebuffer* framebuffer) 
+			{
+				// Nothing should be allocated from the beginning to the end of the recording
+				AllocationCounter allocationCounter;
+
+				if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
+				{
+					return false;
+				}
+
+				if (mStagingBuffer->needToSend())
+				{
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
+				}
+
+				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
+				{
+					VulkanImageTransition imageTransitionBeforeDrawing = {
+						mSwapchain->getImageHandle(swapchainImageIndex), // VkImage             image
+						VK_ACCESS_MEMORY_READ_BIT,                // VkAccessFlags        currentAccess
+						VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,     // VkAccessFlags        newAccess
+						VK_IMAGE_LAYOUT_UNDEFINED,                // VkImageLayout        currentLayout
+						VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, // VkImageLayout        newLayout
+						mPresentQueue->getFamilyIndex(),          // uint32_t             currentQueueFamily
+						mGraphicsQueue->getFamilyIndex(),         // uint32_t             newQueueFamily
+						VK_IMAGE_ASPECT_COLOR_BIT                 // VkImageAspectFlags   aspect
+					};
+					commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, { imageTransitionBeforeDrawing } );
+				}
+
+				// Drawing
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+				VkCommandBufferInheritanceInfo inheritanceInfo = {
+					VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,  // VkStructureType                  sType
+					nullptr,                                            // const void                     * pNext
+					mRenderPass->getHandle(),                           // VkRenderPass                     renderPass
+					0,                                                  // uint32_t                         subpass
+					framebuffer->getHandle(),                           // VkFramebuffer                    framebuffer
+					VK_FALSE,                                           // VkBool32                         occlusionQueryEnable
+					0,                                                  // VkQueryControlFlags              queryFlags
+					0                                                   // VkQueryPipelineStatisticFlags    pipelineStatistics
+				};
+
+				const float tileWidth = static_cast<float>(mSwapchain->getSize().width) / GridSize;
+				const float tileHeight = static_cast<float>(mSwapchain->getSize().height) / GridSize;
+
+				auto recordTiles = [&](VulkanCommandBuffer* secondaryCommandBuffer, uint32_t firstTile, uint32_t tileCount, uint32_t threadIndex)
+				{
+					// Counted on each worker thread, the calling thread (index 0) is already counted for the whole recording
+					AllocationCounter tileAllocationCounter;
+
+					for (uint32_t tile = firstTile; tile < firstTile + tileCount; tile++)
+					{
+						// Each tile binds everything it needs, the state tracking drops the redundant calls
+						mVertexBuffer->bindTo(secondaryCommandBuffer, 0, 0);
+						mIndexBuffer->bindTo(secondaryCommandBuffer, 0);
+						secondaryCommandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
+						secondaryCommandBuffer->bindPipeline(mPipelines[PipelineNames::MeshPipeline].get());
+
+						const uint32_t x = tile % GridSize;
+						const uint32_t y = tile / GridSize;
+
+						VkViewport viewport = {
+							x * tileWidth,                              // float    x
+							y * tileHeight,                             // float    y
+							tileWidth,                                  // float    width
+							tileHeight,                                 // float    height
+							0.0f,                                       // float    minDepth
+							1.0f,                                       // float    maxDepth
+						};
+						secondaryCommandBuffer->setViewportStateDynamically(0, { viewport });
+
+						VkRect2D scissor = {
+							{                                           // VkOffset2D     offset
+								static_cast<int32_t>(x * tileWidth),        // int32_t        x
+								static_cast<int32_t>(y * tileHeight)        // int32_t        y
+							},
+							{                                           // VkExtent2D     extent
+								static_cast<uint32_t>(tileWidth) + 1,       // uint32_t       width
+								static_cast<uint32_t>(tileHeight) + 1       // uint32_t       height
+							}
+						};
+						secondaryCommandBuffer->setScissorStateDynamically(0, { scissor });
+
+						for (size_t i = 0; i < mMesh.parts.size(); i++) 
+						{
+							secondaryCommandBuffer->drawIndexedGeometry(mMesh.parts[i].indexCount, 1, mMesh.parts[i].indexOffset, 0, 0);
+						}
+					}
+
+					if (threadIndex > 0)
+					{
+						addHotPathAllocations(tileAllocationCounter.getAllocationCount());
+					}
+				};
+
+				// Given by reference, a std::function could allocate to store a copy of the lambda and its captures
+				if (!mParallelRecorder->record(mFrameIndex, commandBuffer, inheritanceInfo, GridSize * GridSize, std::cref(recordTiles)))
+				{
+					return false;
+				}
+
+				commandBuffer->endRenderPass();
+
+				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex())
+				{
+					VulkanImageTransition imageTransitionBeforePresent = {
+						mSwapchain->getImageHandle(swapchainImageIndex),  // VkImage            image
+						VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,     // VkAccessFlags        currentAccess
+						VK_ACCESS_MEMORY_READ_BIT,                // VkAccessFlags        newAccess
+						VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,          // VkImageLayout        currentLayout
+						VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,          // VkImageLayout        newLayout
+						mGraphicsQueue->getFamilyIndex(),         // uint32_t             currentQueueFamily
+						mPresentQueue->getFamilyIndex(),          // uint32_t             newQueueFamily
+						VK_IMAGE_ASPECT_COLOR_BIT                 // VkImageAspectFlags   aspect
+					};
+					commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, { imageTransitionBeforePresent } );
+				}
+
+				const bool recorded = commandBuffer->endRecording();
+				addHotPathAllocations(allocationCounter.getAllocationCount());
+				return recorded;
+			};
+
+			if (!beginFrame())
+			{
+				return false;
+			}
+			FrameResources& currentFrame = getCurrentFrame();
+
+			mStagingBuffer->beginFrame(mFrameIndex);
+
+			uint32_t imageIndex;
+			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
+			{
+				return false;
+			}
+
+			std::vector<VkImageView> attachments = { mSwapchain->getImageViewHandle(imageIndex) };
+			if (currentFrame.mDepthAttachment != nullptr)
+			{
+				attachments.push_back(currentFrame.mDepthAttachment->getHandle());
+			}
+
+			// TODO : Only create once
+			currentFrame.mFramebuffer = mRenderPass->createFramebuffer(attachments, mSwapchain->getSize().width, mSwapchain->getSize().height, 1);
+			if (currentFrame.mFramebuffer == nullptr || !currentFrame.mFramebuffer->isInitialized())
+			{
+				return false;
+			}
+
+			if (!prepareFrame(currentFrame.mCommandBuffer.get(), imageIndex, currentFrame.mFramebuffer.get()))
+			{
+				return false;
+			}
+
+			std::vector<WaitSemaphoreInfo> waitSemaphoreInfos = {};
+			waitSemaphoreInfos.push_back({
+				currentFrame.mImageAcquiredSemaphore->getHandle(),  // VkSemaphore            Semaphore
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT       // VkPipelineStageFlags   WaitingStage
+			});
+
+			AllocationCounter allocationCounter;
+			if (!mGraphicsQueue->submitCommandBuffers({ currentFrame.mCommandBuffer.get() }, waitSemaphoreInfos, { currentFrame.mReadyToPresentSemaphore->getHandle() }, currentFrame.mDrawingFinishedFence.get()))
+			{
+				return false;
+			}
+
+			PresentInfo presentInfo = {
+				mSwapchain->getHandle(), // VkSwapchainKHR         Swapchain
+				imageIndex               // uint32_t               ImageIndex
+			};
+			if (!mPresentQueue->presentImage({ currentFrame.mReadyToPresentSemaphore->getHandle() }, { presentInfo }))
+			{
+				return false;
+			}
+			addHotPathAllocations(allocationCounter.getAllocationCount());
+
+			updateBenchmark();
+
+			endFrame();
+			return true;
+		}
+
+		void updateBenchmark()
+		{
+			mMeasureTime += mParallelRecorder->getLastRecordingTime();
+			mMeasureFrame++;
+			if (mMeasureFrame < FramesPerMeasure)
+			{
+				return;
+			}
+
+			mAverageRecordingTimes[mMeasureIndex] = mMeasureTime / FramesPerMeasure;
+			printf("%u draws recorded with %u thread(s) : %.3f ms\n", GridSize * GridSize, mThreadCounts[mMeasureIndex], mAverageRecordingTimes[mMeasureIndex]);
+
+			const VulkanCommandBufferStats stats = mParallelRecorder->getLastRecordingStats();
+			printf("State calls : %u issued, %u skipped\n", stats.issuedCalls, stats.skippedCalls);
+
+			mMeasureIndex = (mMeasureIndex + 1) % static_cast<uint32_t>(mThreadCounts.size());
+			mMeasureFrame = 0;
+			mMeasureTime = 0.0f;
+			if (mMeasureIndex == 0)
+			{
+				for (size_t i = 1; i < mThreadCounts.size(); i++)
+				{
+					printf("Speedup with %u threads : x%.2f\n", mThreadCounts[i], mAverageRecordingTimes[0] / mAverageRecordingTimes[i]);
+				}
+			}
+
+			mParallelRecorder->setActiveThreadCount(mThreadCounts[mMeasureIndex]);
+		}
+
+		void onMouseEvent()
+		{
+			updateStagingBuffer(false);
+		}
+
+		bool updateStagingBuffer(bool force)
+		{
+			static float horizontalAngle = 0.0f;
+			static float verticalAngle = 0.0f;
+
+			if (mMouseState.buttons[0].isPressed || force) 
+			{
+				horizontalAngle += 0.5f * mMouseState.position.delta.x;
+				verticalAngle = nu::clamp(verticalAngle - 0.5f * mMouseState.position.delta.y, -90.0f, 90.0f);
+
+				nu::Matrix4f mr1 = nu::Quaternionf(verticalAngle, { -1.0f, 0.0f, 0.0f }).toMatrix4();
+				nu::Matrix4f mr2 = nu::Quaternionf(horizontalAngle, { 0.0f, 1.0f, 0.0f }).toMatrix4();
+				nu::Matrix4f rotation = mr1 * mr2;
+				nu::Matrix4f translation = nu::Matrix4f::translation({ 0.0f, 0.0f, -4.0f });
+				nu::Matrix4f modelMatrix = translation * rotation;
+
+				nu::Matrix4f viewMatrix = nu::Matrix4f::lookAt(nu::Vector3f::zero, { 0.0f, 0.0f, -4.0f }, nu::Vector3f::up);
+
+				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
+
+				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
+
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
+				{
+					return false;
+				}
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		virtual bool resize() override
+		{
+			if (!mSwapchain->recreate(mFramesResources))
+			{
+				return false;
+			}
+
+			if (isReady()) 
+			{
+				if (!updateStagingBuffer(true)) 
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+};
\ No newline at end of file
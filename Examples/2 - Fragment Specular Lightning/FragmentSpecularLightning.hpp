@@ -8,6 +8,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,10 +17,11 @@ class FragmentSpecularLightning : public SampleBase
 	public:
 		nu::Mesh mMesh;
 		nu::VertexBuffer::Ptr mVertexBuffer;
+		nu::IndexBuffer::Ptr mIndexBuffer;
 
 		VulkanDescriptorSetLayoutPtr mDescriptorSetLayout;
-		VulkanDescriptorPoolPtr mDescriptorPool;
-		std::vector<VulkanDescriptorSetPtr> mDescriptorSets;
+		VulkanDescriptorUpdateTemplatePtr mDescriptorUpdateTemplate;
+		VulkanDescriptorSetCachePtr mDescriptorSetCache;
 
 		VulkanRenderPassPtr mRenderPass;
 		VulkanPipelineLayoutPtr mPipelineLayout;
@@ -33,8 +35,6 @@ class FragmentSpecularLightning : public SampleBase
 		nu::UniformBuffer::Ptr mUniformBuffer;
 		nu::StagingBuffer::Ptr mStagingBuffer;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			if (!initializeVulkan(windowParameters, nullptr)) 
@@ -43,12 +43,18 @@ class FragmentSpecularLightning : public SampleBase
 			}
 
 			// Vertex data
-			if (!mMesh.loadFromFile("../../Data/Models/knot.obj", true, false, false, true))
+			if (!mMesh.loadFromFile("../../Data/Models/knot.obj", true, false, false, true, nullptr, true))
 			{
 				return false;
 			}
+			mMesh.optimize(true, true);
 			mVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mMesh.size());
-			if (!mVertexBuffer || !mVertexBuffer->updateAndWait(mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mVertexBuffer || !mVertexBuffer->update(*mUploadManager, mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mMesh.indices.size(), mMesh.getIndexType());
+			if (!mIndexBuffer || !mIndexBuffer->update(*mUploadManager, (uint32_t)mMesh.indices.size(), &mMesh.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -59,7 +65,7 @@ class FragmentSpecularLightning : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -84,26 +90,18 @@ class FragmentSpecularLightning : public SampleBase
 				return false;
 			}
 
-			VkDescriptorPoolSize descriptorPoolSize = {
-				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType     type
-				1                                           // uint32_t             descriptorCount
-			};
-			mDescriptorPool = VulkanDevice::get().createDescriptorPool(false, 1, { descriptorPoolSize });
-			if (mDescriptorPool == nullptr || !mDescriptorPool->isInitialized())
+			// The set is requested each frame, it is only written the first time
+			mDescriptorUpdateTemplate = VulkanDescriptorUpdateTemplate::createDescriptorUpdateTemplate(*mDescriptorSetLayout);
+			if (mDescriptorUpdateTemplate == nullptr)
 			{
 				return false;
 			}
-
-			// TODO : Allocate more than one at once
-			mDescriptorSets.resize(1);
-			mDescriptorSets[0] = mDescriptorPool->allocateDescriptorSet(mDescriptorSetLayout.get());
-			if (mDescriptorSets[0] == nullptr || !mDescriptorSets[0]->isInitialized())
+			mDescriptorSetCache = VulkanDescriptorSetCache::createDescriptorSetCache(VulkanDevice::get());
+			if (mDescriptorSetCache == nullptr)
 			{
 				return false;
 			}
 
-			mUniformBuffer->updateDescriptor(mDescriptorSets[0].get(), 0, 0);
-
 			// Render pass
 			mRenderPass = VulkanDevice::get().initRenderPass();
 			mRenderPass->addAttachment(mSwapchain->getFormat());
@@ -170,7 +168,7 @@ class FragmentSpecularLightning : public SampleBase
 			}
 
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
+			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::MeshPipeline].get();
 
@@ -205,6 +203,13 @@ class FragmentSpecularLightning : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
@@ -219,7 +224,7 @@ class FragmentSpecularLightning : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -238,7 +243,8 @@ class FragmentSpecularLightning : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -266,8 +272,17 @@ class FragmentSpecularLightning : public SampleBase
 				commandBuffer->setScissorStateDynamically(0, { scissor });
 
 				mVertexBuffer->bindTo(commandBuffer, 0, 0);
+				mIndexBuffer->bindTo(commandBuffer, 0);
+
+				VulkanDescriptorData descriptorData;
+				descriptorData.buffer = mUniformBuffer->getDescriptorInfo();
+				VkDescriptorSet descriptorSet = mDescriptorSetCache->getDescriptorSet(*mDescriptorUpdateTemplate, &descriptorData);
+				if (descriptorSet == VK_NULL_HANDLE)
+				{
+					return false;
+				}
 
-				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
+				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { descriptorSet }, {});
 
 				commandBuffer->bindPipeline(mPipelines[PipelineNames::MeshPipeline].get());
 
@@ -276,7 +291,7 @@ class FragmentSpecularLightning : public SampleBase
 
 				for (size_t i = 0; i < mMesh.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mMesh.parts[i].vertexCount, 1, mMesh.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mMesh.parts[i].indexCount, 1, mMesh.parts[i].indexOffset, 0, 0);
 				}
 
 				commandBuffer->endRenderPass();
@@ -299,18 +314,13 @@ class FragmentSpecularLightning : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -355,7 +365,7 @@ class FragmentSpecularLightning : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -384,14 +394,14 @@ class FragmentSpecularLightning : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -8,6 +8,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,6 +17,7 @@ class NormalMappedGeometry : public SampleBase
 	public:
 		nu::Mesh mMesh;
 		nu::VertexBuffer::Ptr mVertexBuffer;
+		nu::IndexBuffer::Ptr mIndexBuffer;
 
 		VulkanImageHelperPtr mTexture;
 
@@ -35,8 +37,6 @@ class NormalMappedGeometry : public SampleBase
 		nu::UniformBuffer::Ptr mUniformBuffer;
 		nu::StagingBuffer::Ptr mStagingBuffer;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			if (!initializeVulkan(windowParameters, nullptr)) 
@@ -66,22 +66,27 @@ class NormalMappedGeometry : public SampleBase
 				0,                            // uint32_t               baseArrayLayer
 				1                             // uint32_t               layerCount
 			};
-			if (!mGraphicsQueue->useStagingBufferToUpdateImageAndWait(static_cast<VkDeviceSize>(imageData.size()), &imageData[0], mTexture->getImage(), 
-				imageSubresourceLayer, { 0, 0, 0 }, { (uint32_t)width, (uint32_t)height, 1 }, VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, mFramesResources.front().mCommandBuffer.get(), {}, 50000000))
+			if (!mUploadManager->uploadImage(mTexture->getImage(), imageSubresourceLayer, { 0, 0, 0 }, { (uint32_t)width, (uint32_t)height, 1 }, static_cast<VkDeviceSize>(imageData.size()), &imageData[0],
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT))
 			{
 				return false;
 			}
 
 			// Vertex data
 			uint32_t vertexStride = 0;
-			if (!mMesh.loadFromFile("../../Data/Models/ice.obj", true, true, true, true, &vertexStride))
+			if (!mMesh.loadFromFile("../../Data/Models/ice.obj", true, true, true, true, &vertexStride, true))
 			{
 				return false;
 			}
+			mMesh.optimize(true, true);
 			mVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mMesh.size());
-			if (!mVertexBuffer || !mVertexBuffer->updateAndWait(mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mVertexBuffer || !mVertexBuffer->update(*mUploadManager, mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mMesh.indices.size(), mMesh.getIndexType());
+			if (!mIndexBuffer || !mIndexBuffer->update(*mUploadManager, (uint32_t)mMesh.indices.size(), &mMesh.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -92,7 +97,7 @@ class NormalMappedGeometry : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -234,7 +239,7 @@ class NormalMappedGeometry : public SampleBase
 			}
 
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
+			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::MeshPipeline].get();
 
@@ -272,6 +277,13 @@ class NormalMappedGeometry : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
@@ -286,7 +298,7 @@ class NormalMappedGeometry : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -305,7 +317,8 @@ class NormalMappedGeometry : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -333,6 +346,7 @@ class NormalMappedGeometry : public SampleBase
 				commandBuffer->setScissorStateDynamically(0, { scissor });
 
 				mVertexBuffer->bindTo(commandBuffer, 0, 0);
+				mIndexBuffer->bindTo(commandBuffer, 0);
 
 				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
 
@@ -343,7 +357,7 @@ class NormalMappedGeometry : public SampleBase
 
 				for (size_t i = 0; i < mMesh.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mMesh.parts[i].vertexCount, 1, mMesh.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mMesh.parts[i].indexCount, 1, mMesh.parts[i].indexOffset, 0, 0);
 				}
 
 				commandBuffer->endRenderPass();
@@ -366,18 +380,13 @@ class NormalMappedGeometry : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -422,7 +431,7 @@ class NormalMappedGeometry : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -451,14 +460,14 @@ class NormalMappedGeometry : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
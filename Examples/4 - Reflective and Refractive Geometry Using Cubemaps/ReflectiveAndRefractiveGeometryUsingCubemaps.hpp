@@ -8,6 +8,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,9 +17,11 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 	public:
 		nu::Mesh mSkybox;
 		nu::VertexBuffer::Ptr mSkyboxVertexBuffer;
+		nu::IndexBuffer::Ptr mSkyboxIndexBuffer;
 
 		nu::Mesh mMesh;
 		nu::VertexBuffer::Ptr mMeshVertexBuffer;
+		nu::IndexBuffer::Ptr mMeshIndexBuffer;
 
 		VulkanImageHelperPtr mSkyboxTexture;
 
@@ -39,8 +42,6 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 		nu::UniformBuffer::Ptr mUniformBuffer;
 		nu::StagingBuffer::Ptr mStagingBuffer;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			if (!initializeVulkan(windowParameters, nullptr)) 
@@ -51,23 +52,34 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 			// TODO : Camera
 
 			// Vertex data - mesh
-			if (!mMesh.loadFromFile("../../Data/Models/teapot.obj", true, false, false, true))
+			if (!mMesh.loadFromFile("../../Data/Models/teapot.obj", true, false, false, true, nullptr, true))
 			{
 				return false;
 			}
+			mMesh.optimize(true, true);
 			mMeshVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mMesh.size());
-			if (!mMeshVertexBuffer || !mMeshVertexBuffer->updateAndWait(mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mMeshVertexBuffer || !mMeshVertexBuffer->update(*mUploadManager, mMesh.size(), &mMesh.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mMeshIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mMesh.indices.size(), mMesh.getIndexType());
+			if (!mMeshIndexBuffer || !mMeshIndexBuffer->update(*mUploadManager, (uint32_t)mMesh.indices.size(), &mMesh.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
 
 			// Vertex data - skybox
-			if (!mSkybox.loadFromFile("../../Data/Models/cube.obj", false, false, false, false))
+			if (!mSkybox.loadFromFile("../../Data/Models/cube.obj", false, false, false, false, nullptr, true))
 			{
 				return false;
 			}
 			mSkyboxVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mSkybox.size());
-			if (!mSkyboxVertexBuffer || !mSkyboxVertexBuffer->updateAndWait(mSkybox.size(), &mSkybox.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mSkyboxVertexBuffer || !mSkyboxVertexBuffer->update(*mUploadManager, mSkybox.size(), &mSkybox.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mSkyboxIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mSkybox.indices.size(), mSkybox.getIndexType());
+			if (!mSkyboxIndexBuffer || !mSkyboxIndexBuffer->update(*mUploadManager, (uint32_t)mSkybox.indices.size(), &mSkybox.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -78,7 +90,7 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -116,10 +128,9 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 					static_cast<uint32_t>(i),     // uint32_t               baseArrayLayer
 					1                             // uint32_t               layerCount
 				};
-				mGraphicsQueue->useStagingBufferToUpdateImageAndWait(imageDataSize, &cubemapImageData[0],
-					mSkyboxTexture->getImage(), imageSubresource, { 0, 0, 0 }, { 1024, 1024, 1 }, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-					0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-					mFramesResources.front().mCommandBuffer.get(), {}, 50000000);
+				mUploadManager->uploadImage(mSkyboxTexture->getImage(), imageSubresource, { 0, 0, 0 }, { 1024, 1024, 1 }, imageDataSize, &cubemapImageData[0],
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+					VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 			}
 
 			// Descriptor sets with uniform buffer
@@ -247,8 +258,8 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 			}
 
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
-			mPipelines[PipelineNames::SkyboxPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
+			mPipelines[PipelineNames::MeshPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
+			mPipelines[PipelineNames::SkyboxPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* modelPipeline = mPipelines[PipelineNames::MeshPipeline].get();
 			VulkanGraphicsPipeline* skyboxPipeline = mPipelines[PipelineNames::SkyboxPipeline].get();
@@ -325,6 +336,13 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
@@ -339,7 +357,7 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -358,7 +376,8 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -391,20 +410,22 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 
 				commandBuffer->bindPipeline(mPipelines[PipelineNames::MeshPipeline].get());
 				mMeshVertexBuffer->bindTo(commandBuffer, 0, 0);
+				mMeshIndexBuffer->bindTo(commandBuffer, 0);
 				std::array<float, 4> position = { 0.0f, 0.0f, -4.0f, 0.0f };
 				commandBuffer->provideDataToShadersThroughPushConstants(mPipelineLayout->getHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float) * 4, &position[0]); // TODO : Camera position
 				for (size_t i = 0; i < mMesh.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mMesh.parts[i].vertexCount, 1, mMesh.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mMesh.parts[i].indexCount, 1, mMesh.parts[i].indexOffset, 0, 0);
 				}
 
 				// Draw skybox
 
 				commandBuffer->bindPipeline(mPipelines[PipelineNames::SkyboxPipeline].get());
 				mSkyboxVertexBuffer->bindTo(commandBuffer, 0, 0); // TODO : What is the utility of each args here ?
+				mSkyboxIndexBuffer->bindTo(commandBuffer, 0);
 				for (size_t i = 0; i < mSkybox.parts.size(); i++)
 				{
-					commandBuffer->drawGeometry(mSkybox.parts[i].vertexCount, 1, mSkybox.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mSkybox.parts[i].indexCount, 1, mSkybox.parts[i].indexOffset, 0, 0);
 				}
 
 				commandBuffer->endRenderPass();
@@ -427,18 +448,13 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -483,7 +499,7 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -512,14 +528,14 @@ class ReflectiveAndRefractiveGeometryUsingCubemaps : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -23,8 +23,14 @@ class AddingShadows : public SampleBase
 		std::array<nu::Mesh, 2> mScene;
 		nu::VertexBuffer::Ptr mVertexBuffer;
 
-		VulkanImageHelperPtr mShadowMap;
-		VulkanFramebufferPtr mShadowMapFramebuffer;
+		// Shadow map, scene depth and swapchain image are resources of the render graph
+		VulkanRenderGraphPtr mRenderGraph;
+		VulkanU32 mShadowMap;
+		VulkanU32 mSceneDepth;
+		VulkanU32 mBackbuffer;
+		VulkanU32 mShadowPass;
+		VulkanU32 mScenePass;
+		VulkanSamplerPtr mShadowMapSampler;
 
 		VulkanDescriptorSetLayoutPtr mDescriptorSetLayout;
 		VulkanDescriptorPoolPtr mDescriptorPool;
@@ -32,9 +38,6 @@ class AddingShadows : public SampleBase
 
 		VulkanPipelineLayoutPtr mPipelineLayout;
 
-		VulkanRenderPassPtr mShadowRenderPass;
-		VulkanRenderPassPtr mSceneRenderPass;
-
 		std::vector<VulkanGraphicsPipelinePtr> mPipelines;
 		enum PipelineNames
 		{
@@ -46,8 +49,6 @@ class AddingShadows : public SampleBase
 		nu::UniformBuffer::Ptr mUniformBuffer;
 		nu::StagingBuffer::Ptr mStagingBuffer;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override
 		{
 			if (!initializeVulkan(windowParameters, nullptr))
@@ -67,7 +68,7 @@ class AddingShadows : public SampleBase
 			std::vector<float> vertexData(mScene[0].data);
 			vertexData.insert(vertexData.end(), mScene[1].data.begin(), mScene[1].data.end());
 			mVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), (uint32_t)sizeof(vertexData[0]) * (uint32_t)vertexData.size());
-			if (!mVertexBuffer || !mVertexBuffer->updateAndWait((uint32_t)sizeof(vertexData[0]) * (uint32_t)vertexData.size(), &vertexData[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mVertexBuffer || !mVertexBuffer->update(*mUploadManager, (uint32_t)sizeof(vertexData[0]) * (uint32_t)vertexData.size(), &vertexData[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -78,7 +79,7 @@ class AddingShadows : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -88,18 +89,42 @@ class AddingShadows : public SampleBase
 				return false;
 			}
 
-			// Image in which shadow map will be stored
-			mShadowMap = VulkanImageHelper::createCombinedImageSampler(VulkanDevice::get(), VK_IMAGE_TYPE_2D, mSwapchain->getDepthFormat(), { 512, 512, 1 }, 1, 1,
-				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT, VK_FILTER_LINEAR,
-				VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-				VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0.0f, 0.0f, 1.0f, false, 1.0f, false, VK_COMPARE_OP_ALWAYS, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
-				false);
-			if (mShadowMap == nullptr || !mShadowMap->hasSampler() || mShadowMap->getImage() == nullptr || mShadowMap->getMemoryBlock() == nullptr || mShadowMap->getImageView() == nullptr)
+			// Render graph : the shadow map is only sampled by the scene pass, so the graph handles its layouts and barriers
+			mRenderGraph = VulkanRenderGraph::createRenderGraph();
+			mShadowMap = mRenderGraph->createImage("ShadowMap", mSwapchain->getDepthFormat(), { 512, 512 }, VK_IMAGE_ASPECT_DEPTH_BIT);
+			mSceneDepth = mRenderGraph->createImage("SceneDepth", mSwapchain->getDepthFormat(), mSwapchain->getSize(), VK_IMAGE_ASPECT_DEPTH_BIT);
+			mBackbuffer = mRenderGraph->importImage("Backbuffer", mSwapchain->getFormat(), mSwapchain->getSize(), VK_IMAGE_ASPECT_COLOR_BIT,
+				0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+			mShadowPass = mRenderGraph->addGraphicsPass("Shadow", [this](VulkanCommandBuffer* commandBuffer)
+			{
+				mVertexBuffer->bindTo(commandBuffer, 0, 0);
+				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
+				commandBuffer->bindPipeline(mPipelines[PipelineNames::ShadowPipeline].get());
+				commandBuffer->drawGeometry(mScene[0].parts[0].vertexCount + mScene[1].parts[0].vertexCount, 1, 0, 0);
+			});
+			mRenderGraph->addDepthStencilAttachment(mShadowPass, mShadowMap, true, { 1.0f, 0 });
+
+			mScenePass = mRenderGraph->addGraphicsPass("Scene", [this](VulkanCommandBuffer* commandBuffer)
+			{
+				drawScene(commandBuffer);
+			});
+			mRenderGraph->addColorAttachment(mScenePass, mBackbuffer, true, { 0.1f, 0.2f, 0.3f, 1.0f });
+			mRenderGraph->addDepthStencilAttachment(mScenePass, mSceneDepth, true, { 1.0f, 0 });
+			mRenderGraph->addSampledImage(mScenePass, mShadowMap, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+			if (!mRenderGraph->compile() || !mRenderGraph->realize(VulkanDevice::get()))
 			{
 				return false;
 			}
 
-			// TODO : Is the shadow map sent to queue ? (Should it be ?)
+			mShadowMapSampler = VulkanDevice::get().createSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+				VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0.0f, 0.0f, 1.0f, false, 1.0f, false, VK_COMPARE_OP_ALWAYS,
+				VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, false);
+			if (mShadowMapSampler == nullptr)
+			{
+				return false;
+			}
 
 			// Descriptor set with uniform buffer
 			std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings = {
@@ -151,120 +176,7 @@ class AddingShadows : public SampleBase
 			// TODO : Update more than one at once
 			mUniformBuffer->updateDescriptor(mDescriptorSets[0].get(), 0, 0);
 
-			VulkanImageDescriptorInfo imageDescriptorUpdate = {
-				mDescriptorSets[0]->getHandle(),                  // VkDescriptorSet                      TargetDescriptorSet
-				1,                                                // uint32_t                             TargetDescriptorBinding
-				0,                                                // uint32_t                             TargetArrayElement
-				VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,        // VkDescriptorType                     TargetDescriptorType
-				{                                                 // std::vector<VkDescriptorImageInfo>   ImageInfos
-					{
-						mShadowMap->getSampler()->getHandle(),          // VkSampler                            sampler
-						mShadowMap->getImageView()->getHandle(),        // VkImageView                          imageView
-						VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL // VkImageLayout                        imageLayout
-					}
-				}
-			};
-
-			VulkanDevice::get().updateDescriptorSets({ imageDescriptorUpdate }, {  }, {}, {});
-
-			// Shadow map render pass - for rendering into depth attachment
-
-			mShadowRenderPass = VulkanDevice::get().initRenderPass();
-
-			mShadowRenderPass->addAttachment({
-				0,                                                // VkAttachmentDescriptionFlags     flags
-				mSwapchain->getDepthFormat(),                     // VkFormat                         format
-				VK_SAMPLE_COUNT_1_BIT,                            // VkSampleCountFlagBits            samples
-				VK_ATTACHMENT_LOAD_OP_CLEAR,                      // VkAttachmentLoadOp               loadOp
-				VK_ATTACHMENT_STORE_OP_STORE,                     // VkAttachmentStoreOp              storeOp
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE,                  // VkAttachmentLoadOp               stencilLoadOp
-				VK_ATTACHMENT_STORE_OP_DONT_CARE,                 // VkAttachmentStoreOp              stencilStoreOp
-				VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                    initialLayout
-				VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL   // VkImageLayout                    finalLayout
-			});
-
-			mShadowRenderPass->addSubpass(VK_PIPELINE_BIND_POINT_GRAPHICS);
-			mShadowRenderPass->addDepthStencilAttachmentToSubpass(0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-
-			mShadowRenderPass->addDependency({
-				VK_SUBPASS_EXTERNAL,                            // uint32_t                   srcSubpass
-				0,                                              // uint32_t                   dstSubpass
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,          // VkPipelineStageFlags       srcStageMask
-				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,     // VkPipelineStageFlags       dstStageMask
-				VK_ACCESS_SHADER_READ_BIT,                      // VkAccessFlags              srcAccessMask
-				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,   // VkAccessFlags              dstAccessMask
-				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
-			});
-			mShadowRenderPass->addDependency({
-				0,                                              // uint32_t                   srcSubpass
-				VK_SUBPASS_EXTERNAL,                            // uint32_t                   dstSubpass
-				VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,      // VkPipelineStageFlags       srcStageMask
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,          // VkPipelineStageFlags       dstStageMask
-				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,   // VkAccessFlags              srcAccessMask
-				VK_ACCESS_SHADER_READ_BIT,                      // VkAccessFlags              dstAccessMask
-				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
-				});
-
-			if (!mShadowRenderPass->create())
-			{
-				return false;
-			}
-
-			mShadowMapFramebuffer = mShadowRenderPass->createFramebuffer({ mShadowMap->getImageView()->getHandle() }, 512, 512, 1);
-			if (mShadowMapFramebuffer == nullptr || !mShadowMapFramebuffer->isInitialized())
-			{
-				return false;
-			}
-
-			// Render pass
-			mSceneRenderPass = VulkanDevice::get().initRenderPass();
-			mSceneRenderPass->addAttachment({
-				0,                                                // VkAttachmentDescriptionFlags     flags
-				mSwapchain->getFormat(),                          // VkFormat                         format
-				VK_SAMPLE_COUNT_1_BIT,                            // VkSampleCountFlagBits            samples
-				VK_ATTACHMENT_LOAD_OP_CLEAR,                      // VkAttachmentLoadOp               loadOp
-				VK_ATTACHMENT_STORE_OP_STORE,                     // VkAttachmentStoreOp              storeOp
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE,                  // VkAttachmentLoadOp               stencilLoadOp
-				VK_ATTACHMENT_STORE_OP_DONT_CARE,                 // VkAttachmentStoreOp              stencilStoreOp
-				VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                    initialLayout
-				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR                   // VkImageLayout                    finalLayout
-				});
-			mSceneRenderPass->addAttachment({
-				0,                                                // VkAttachmentDescriptionFlags     flags
-				mSwapchain->getDepthFormat(),                     // VkFormat                         format
-				VK_SAMPLE_COUNT_1_BIT,                            // VkSampleCountFlagBits            samples
-				VK_ATTACHMENT_LOAD_OP_CLEAR,                      // VkAttachmentLoadOp               loadOp
-				VK_ATTACHMENT_STORE_OP_DONT_CARE,                 // VkAttachmentStoreOp              storeOp
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE,                  // VkAttachmentLoadOp               stencilLoadOp
-				VK_ATTACHMENT_STORE_OP_DONT_CARE,                 // VkAttachmentStoreOp              stencilStoreOp
-				VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                    initialLayout
-				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL  // VkImageLayout                    finalLayout
-				});
-			mSceneRenderPass->addSubpass(VK_PIPELINE_BIND_POINT_GRAPHICS);
-			mSceneRenderPass->addColorAttachmentToSubpass(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-			mSceneRenderPass->addDepthStencilAttachmentToSubpass(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-			mSceneRenderPass->addDependency({
-				VK_SUBPASS_EXTERNAL,                            // uint32_t                   srcSubpass
-				0,                                              // uint32_t                   dstSubpass
-				VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,      // VkPipelineStageFlags       srcStageMask
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,          // VkPipelineStageFlags       dstStageMask
-				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,   // VkAccessFlags              srcAccessMask
-				VK_ACCESS_SHADER_READ_BIT,                      // VkAccessFlags              dstAccessMask
-				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
-			});
-			mSceneRenderPass->addDependency({
-				0,                                              // uint32_t                   srcSubpass
-				VK_SUBPASS_EXTERNAL,                            // uint32_t                   dstSubpass
-				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags       srcStageMask
-				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,              // VkPipelineStageFlags       dstStageMask
-				VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags              srcAccessMask
-				VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags              dstAccessMask
-				VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags          dependencyFlags
-			});
-			if (!mSceneRenderPass->create())
-			{
-				return false;
-			}
+			updateShadowMapDescriptor();
 
 			// Graphics pipeline
 			mPipelineLayout = VulkanDevice::get().createPipelineLayout({ mDescriptorSetLayout->getHandle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 4 } });
@@ -274,8 +186,8 @@ class AddingShadows : public SampleBase
 			}
 
 			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::ScenePipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mSceneRenderPass, nullptr);
-			mPipelines[PipelineNames::ShadowPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mShadowRenderPass, nullptr);
+			mPipelines[PipelineNames::ScenePipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderGraph->getRenderPass(mScenePass), mPipelineCache.get());
+			mPipelines[PipelineNames::ShadowPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderGraph->getRenderPass(mShadowPass), mPipelineCache.get());
 
 			VulkanGraphicsPipeline* scenePipeline = mPipelines[PipelineNames::ScenePipeline].get();
 
@@ -370,12 +282,19 @@ class AddingShadows : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
 		virtual bool draw() override
 		{
-			auto prepareFrame = [&](VulkanCommandBuffer* commandBuffer, uint32_t swapchainImageIndex, VulkanFramebuffer* framebuffer)
+			auto prepareFrame = [&](VulkanCommandBuffer* commandBuffer, uint32_t swapchainImageIndex)
 			{
 				if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
 				{
@@ -384,17 +303,9 @@ class AddingShadows : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
-				// Shadow map generation
-				commandBuffer->beginRenderPass(mShadowRenderPass->getHandle(), mShadowMapFramebuffer->getHandle(), { { 0, 0, },{ 512, 512 } }, { { 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
-				mVertexBuffer->bindTo(commandBuffer, 0, 0);
-				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
-				commandBuffer->bindPipeline(mPipelines[PipelineNames::ShadowPipeline].get());
-				commandBuffer->drawGeometry(mScene[0].parts[0].vertexCount + mScene[1].parts[0].vertexCount, 1, 0, 0);
-				commandBuffer->endRenderPass();
-
 				// Image transition before drawing
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex())
 				{
@@ -411,42 +322,11 @@ class AddingShadows : public SampleBase
 					commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, { imageTransitionBeforeDrawing });
 				}
 
-				// Drawing
-				commandBuffer->beginRenderPass(mSceneRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
-				commandBuffer->bindPipeline(mPipelines[PipelineNames::ScenePipeline].get());
-
-				uint32_t width = mSwapchain->getSize().width;
-				uint32_t height = mSwapchain->getSize().height;
-
-				VkViewport viewport = {
-					0.0f,                                       // float    x
-					0.0f,                                       // float    y
-					static_cast<float>(width),                  // float    width
-					static_cast<float>(height),                 // float    height
-					0.0f,                                       // float    minDepth
-					1.0f,                                       // float    maxDepth
-				};
-				commandBuffer->setViewportStateDynamically(0, { viewport });
-
-				VkRect2D scissor = {
-					{                                           // VkOffset2D     offset
-						0,                                            // int32_t        x
-						0                                             // int32_t        y
-					},
-					{                                           // VkExtent2D     extent
-						width,                                      // uint32_t       width
-						height                                      // uint32_t       height
-					}
-				};
-				commandBuffer->setScissorStateDynamically(0, { scissor });
-
-				static float lightPosition[4] = { 3.0f, 3.0f, 3.0f, 1.0f };
-
-				commandBuffer->provideDataToShadersThroughPushConstants(mPipelineLayout->getHandle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 4, &lightPosition[0]);
-
-				commandBuffer->drawGeometry(mScene[0].parts[0].vertexCount + mScene[1].parts[0].vertexCount, 1, 0, 0);
-
-				commandBuffer->endRenderPass();
+				// Shadow map and scene
+				if (!mRenderGraph->execute(commandBuffer))
+				{
+					return false;
+				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex())
 				{
@@ -466,18 +346,13 @@ class AddingShadows : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -485,20 +360,9 @@ class AddingShadows : public SampleBase
 				return false;
 			}
 
-			std::vector<VkImageView> attachments = { mSwapchain->getImageViewHandle(imageIndex) };
-			if (currentFrame.mDepthAttachment != nullptr)
-			{
-				attachments.push_back(currentFrame.mDepthAttachment->getHandle());
-			}
+			mRenderGraph->setImportedImage(mBackbuffer, mSwapchain->getImage(imageIndex), mSwapchain->getImageViewHandle(imageIndex));
 
-			// TODO : Only create once
-			currentFrame.mFramebuffer = mSceneRenderPass->createFramebuffer(attachments, mSwapchain->getSize().width, mSwapchain->getSize().height, 1);
-			if (currentFrame.mFramebuffer == nullptr || !currentFrame.mFramebuffer->isInitialized())
-			{
-				return false;
-			}
-
-			if (!prepareFrame(currentFrame.mCommandBuffer.get(), imageIndex, currentFrame.mFramebuffer.get()))
+			if (!prepareFrame(currentFrame.mCommandBuffer.get(), imageIndex))
 			{
 				return false;
 			}
@@ -522,10 +386,66 @@ class AddingShadows : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
+		void drawScene(VulkanCommandBuffer* commandBuffer)
+		{
+			commandBuffer->bindPipeline(mPipelines[PipelineNames::ScenePipeline].get());
+
+			uint32_t width = mSwapchain->getSize().width;
+			uint32_t height = mSwapchain->getSize().height;
+
+			VkViewport viewport = {
+				0.0f,                                       // float    x
+				0.0f,                                       // float    y
+				static_cast<float>(width),                  // float    width
+				static_cast<float>(height),                 // float    height
+				0.0f,                                       // float    minDepth
+				1.0f,                                       // float    maxDepth
+			};
+			commandBuffer->setViewportStateDynamically(0, { viewport });
+
+			VkRect2D scissor = {
+				{                                           // VkOffset2D     offset
+					0,                                            // int32_t        x
+					0                                             // int32_t        y
+				},
+				{                                           // VkExtent2D     extent
+					width,                                      // uint32_t       width
+					height                                      // uint32_t       height
+				}
+			};
+			commandBuffer->setScissorStateDynamically(0, { scissor });
+
+			static float lightPosition[4] = { 3.0f, 3.0f, 3.0f, 1.0f };
+
+			commandBuffer->provideDataToShadersThroughPushConstants(mPipelineLayout->getHandle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 4, &lightPosition[0]);
+
+			commandBuffer->drawGeometry(mScene[0].parts[0].vertexCount + mScene[1].parts[0].vertexCount, 1, 0, 0);
+		}
+
+		void updateShadowMapDescriptor()
+		{
+			// The shadow map view changes each time the render graph is realized
+			VulkanImageDescriptorInfo imageDescriptorUpdate = {
+				mDescriptorSets[0]->getHandle(),                  // VkDescriptorSet                      TargetDescriptorSet
+				1,                                                // uint32_t                             TargetDescriptorBinding
+				0,                                                // uint32_t                             TargetArrayElement
+				VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,        // VkDescriptorType                     TargetDescriptorType
+				{                                                 // std::vector<VkDescriptorImageInfo>   ImageInfos
+					{
+						mShadowMapSampler->getHandle(),                 // VkSampler                            sampler
+						mRenderGraph->getImageView(mShadowMap),         // VkImageView                          imageView
+						VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // VkImageLayout                        imageLayout
+					}
+				}
+			};
+
+			VulkanDevice::get().updateDescriptorSets({ imageDescriptorUpdate }, {  }, {}, {});
+		}
+
 		void onMouseEvent()
 		{
 			updateStagingBuffer(false);
@@ -551,14 +471,14 @@ class AddingShadows : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -575,6 +495,14 @@ class AddingShadows : public SampleBase
 
 			if (isReady())
 			{
+				mRenderGraph->setImageSize(mSceneDepth, mSwapchain->getSize());
+				mRenderGraph->setImageSize(mBackbuffer, mSwapchain->getSize());
+				if (!mRenderGraph->realize(VulkanDevice::get()))
+				{
+					return false;
+				}
+				updateShadowMapDescriptor();
+
 				if (!updateStagingBuffer(true))
 				{
 					return false;
@@ -44,8 +44,6 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 		VulkanPipelineLayoutPtr mComputePipelineLayout;
 		VulkanComputePipelinePtr mComputePipeline;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			VkPhysicalDeviceFeatures deviceFeatures = {};
@@ -99,7 +97,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				}
 
 				mParticlesVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), (uint32_t)sizeof(particles[0]) * (uint32_t)particles.size());
-				if (!mParticlesVertexBuffer || !mParticlesVertexBuffer->updateAndWait((uint32_t)sizeof(particles[0]) * (uint32_t)particles.size(), &particles[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+				if (!mParticlesVertexBuffer || !mParticlesVertexBuffer->update(*mUploadManager, (uint32_t)sizeof(particles[0]) * (uint32_t)particles.size(), &particles[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 				{
 					return false;
 				}
@@ -113,7 +111,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -264,7 +262,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				return false;
 			}
 
-			mComputePipeline = VulkanDevice::get().createComputePipeline(computeShaderModule.get(), mComputePipelineLayout.get(), nullptr, VK_NULL_HANDLE);
+			mComputePipeline = VulkanDevice::get().createComputePipeline(computeShaderModule.get(), mComputePipelineLayout.get(), mPipelineCache.get(), VK_NULL_HANDLE);
 			if (mComputePipeline == nullptr || !mComputePipeline->isInitialized())
 			{
 				return false;
@@ -291,7 +289,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 			}
 
 			mGraphicsPipelines.resize(GraphicsPipelineNames::Count);
-			mGraphicsPipelines[GraphicsPipelineNames::ParticlesPipeline] = VulkanDevice::get().initGraphicsPipeline(*mGraphicsPipelineLayout, *mRenderPass, nullptr);
+			mGraphicsPipelines[GraphicsPipelineNames::ParticlesPipeline] = VulkanDevice::get().initGraphicsPipeline(*mGraphicsPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			VulkanGraphicsPipeline* particlesPipeline = mGraphicsPipelines[GraphicsPipelineNames::ParticlesPipeline].get();
 
@@ -360,6 +358,13 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				return false;
 			}
 
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
+			{
+				return false;
+			}
+
 			return true;
 		}
 
@@ -405,7 +410,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -424,7 +429,8 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -476,18 +482,13 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -532,7 +533,7 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -561,14 +562,14 @@ class DrawingParticlesUsingComputeAndGraphicsPipelines : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -8,6 +8,7 @@
 #include "../../Window.hpp"
 
 #include "../../VertexBuffer.hpp"
+#include "../../IndexBuffer.hpp"
 #include "../../StagingBuffer.hpp"
 #include "../../UniformBuffer.hpp"
 
@@ -16,6 +17,7 @@ class RenderingTesselatedTerrain : public SampleBase
 	public:
 		nu::Mesh mModel;
 		nu::VertexBuffer::Ptr mModelVertexBuffer;
+		nu::IndexBuffer::Ptr mModelIndexBuffer;
 
 		VulkanImageHelperPtr mHeightMap;
 
@@ -28,7 +30,8 @@ class RenderingTesselatedTerrain : public SampleBase
 
 		VulkanRenderPassPtr mRenderPass;
 		VulkanPipelineLayoutPtr mPipelineLayout; 
-		std::vector<VulkanGraphicsPipelinePtr> mPipelines;
+		VulkanPipelineStateCachePtr mPipelineStateCache; // Owns the pipelines, the line pipeline derives from the solid one
+		std::vector<VulkanGraphicsPipeline*> mPipelines;
 		enum PipelineNames
 		{
 			SolidTerrainPipeline = 0,
@@ -37,8 +40,6 @@ class RenderingTesselatedTerrain : public SampleBase
 		};
 		uint32_t mCurrentPipeline;
 
-		uint32_t mFrameIndex = 0;
-
 		virtual bool initialize(VulkanWindowParameters windowParameters) override 
 		{
 			mCurrentPipeline = 0;
@@ -54,12 +55,17 @@ class RenderingTesselatedTerrain : public SampleBase
 			}
 
 			// Vertex data
-			if (!mModel.loadFromFile("../../Data/Models/plane.obj", false, true, false, false))
+			if (!mModel.loadFromFile("../../Data/Models/plane.obj", false, true, false, false, nullptr, true))
 			{
 				return false;
 			}
 			mModelVertexBuffer = nu::VertexBuffer::createVertexBuffer(VulkanDevice::get(), mModel.size());
-			if (!mModelVertexBuffer || !mModelVertexBuffer->updateAndWait(mModel.size(), &mModel.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, mFramesResources.front().mCommandBuffer.get(), mGraphicsQueue, {}, 50000000))
+			if (!mModelVertexBuffer || !mModelVertexBuffer->update(*mUploadManager, mModel.size(), &mModel.data[0], 0, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
+			{
+				return false;
+			}
+			mModelIndexBuffer = nu::IndexBuffer::createIndexBuffer(VulkanDevice::get(), (uint32_t)mModel.indices.size(), mModel.getIndexType());
+			if (!mModelIndexBuffer || !mModelIndexBuffer->update(*mUploadManager, (uint32_t)mModel.indices.size(), &mModel.indices[0], 0, 0, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT))
 			{
 				return false;
 			}
@@ -70,7 +76,7 @@ class RenderingTesselatedTerrain : public SampleBase
 			{
 				return false;
 			}
-			mStagingBuffer = mUniformBuffer->createStagingBuffer();
+			mStagingBuffer = nu::StagingBuffer::createStagingBuffer(VulkanDevice::get(), 4 * 1024, getFramesInFlight());
 			if (mStagingBuffer == nullptr)
 			{
 				return false;
@@ -104,10 +110,9 @@ class RenderingTesselatedTerrain : public SampleBase
 				0,                            // uint32_t               baseArrayLayer
 				1                             // uint32_t               layerCount
 			};
-			if (!mGraphicsQueue->useStagingBufferToUpdateImageAndWait(imageData.size(), &imageData[0], mHeightMap->getImage(),
-				imageSubresourceLayer, { 0, 0, 0 }, { (uint32_t)width, (uint32_t)height, 1 }, VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, mFramesResources.front().mCommandBuffer.get(), {}, 50000000))
+			if (!mUploadManager->uploadImage(mHeightMap->getImage(), imageSubresourceLayer, { 0, 0, 0 }, { (uint32_t)width, (uint32_t)height, 1 }, imageData.size(), &imageData[0],
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT))
 			{
 				return false;
 			}
@@ -229,12 +234,10 @@ class RenderingTesselatedTerrain : public SampleBase
 				return false;
 			}
 
-			mPipelines.resize(PipelineNames::Count);
-			mPipelines[PipelineNames::SolidTerrainPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
-			mPipelines[PipelineNames::LineTerrainPipeline] = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, nullptr);
+			mPipelineStateCache = VulkanPipelineStateCache::createPipelineStateCache();
 
-			VulkanGraphicsPipeline* solidTerrainPipeline = mPipelines[PipelineNames::SolidTerrainPipeline].get();
-			VulkanGraphicsPipeline* lineTerrainPipeline = mPipelines[PipelineNames::LineTerrainPipeline].get();
+			VulkanGraphicsPipelinePtr solidTerrainPipeline = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
+			VulkanGraphicsPipelinePtr lineTerrainPipeline = VulkanDevice::get().initGraphicsPipeline(*mPipelineLayout, *mRenderPass, mPipelineCache.get());
 
 			solidTerrainPipeline->setSubpass(0);
 			lineTerrainPipeline->setSubpass(0);
@@ -310,7 +313,18 @@ class RenderingTesselatedTerrain : public SampleBase
 			lineTerrainPipeline->addDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
 			lineTerrainPipeline->addDynamicState(VK_DYNAMIC_STATE_SCISSOR);
 
-			if (!solidTerrainPipeline->create() || !lineTerrainPipeline->create())
+			mPipelines.resize(PipelineNames::Count);
+			mPipelines[PipelineNames::SolidTerrainPipeline] = mPipelineStateCache->getPipeline(std::move(solidTerrainPipeline));
+			mPipelines[PipelineNames::LineTerrainPipeline] = mPipelineStateCache->getPipeline(std::move(lineTerrainPipeline));
+			if (mPipelines[PipelineNames::SolidTerrainPipeline] == nullptr || mPipelines[PipelineNames::LineTerrainPipeline] == nullptr)
+			{
+				return false;
+			}
+			mPipelineStateCache->printStats();
+
+			// Send all the uploads at once
+			VulkanUploadTicket uploadTicket;
+			if (!mUploadManager->submit(uploadTicket) || !mUploadManager->wait(uploadTicket, 1000000000))
 			{
 				return false;
 			}
@@ -329,7 +343,7 @@ class RenderingTesselatedTerrain : public SampleBase
 
 				if (mStagingBuffer->needToSend())
 				{
-					mStagingBuffer->send(commandBuffer);
+					mStagingBuffer->send(commandBuffer, mFrameIndex);
 				}
 
 				if (mPresentQueue->getFamilyIndex() != mGraphicsQueue->getFamilyIndex()) 
@@ -348,7 +362,8 @@ class RenderingTesselatedTerrain : public SampleBase
 				}
 
 				// Drawing
-				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { { 0.1f, 0.2f, 0.3f, 1.0f },{ 1.0f, 0 } }, VK_SUBPASS_CONTENTS_INLINE);
+				const VkClearValue clearValues[] = { { 0.1f, 0.2f, 0.3f, 1.0f }, { 1.0f, 0 } };
+				commandBuffer->beginRenderPass(mRenderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, mSwapchain->getSize() }, { clearValues, 2 }, VK_SUBPASS_CONTENTS_INLINE);
 
 				uint32_t width = mSwapchain->getSize().width;
 				uint32_t height = mSwapchain->getSize().height;
@@ -376,12 +391,13 @@ class RenderingTesselatedTerrain : public SampleBase
 				commandBuffer->setScissorStateDynamically(0, { scissor });
 
 				mModelVertexBuffer->bindTo(commandBuffer, 0, 0);
+				mModelIndexBuffer->bindTo(commandBuffer, 0);
 				commandBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->getHandle(), 0, { mDescriptorSets[0].get() }, {});
-				commandBuffer->bindPipeline(mPipelines[mCurrentPipeline].get());
+				commandBuffer->bindPipeline(mPipelines[mCurrentPipeline]);
 
 				for (size_t i = 0; i < mModel.parts.size(); i++) 
 				{
-					commandBuffer->drawGeometry(mModel.parts[i].vertexCount, 1, mModel.parts[i].vertexOffset, 0);
+					commandBuffer->drawIndexedGeometry(mModel.parts[i].indexCount, 1, mModel.parts[i].indexOffset, 0, 0);
 				}
 
 				commandBuffer->endRenderPass();
@@ -404,18 +420,13 @@ class RenderingTesselatedTerrain : public SampleBase
 				return commandBuffer->endRecording();
 			};
 
-			FrameResources& currentFrame = mFramesResources[mFrameIndex];
-
-			// TODO : Fence warning might come from here : "vkWaitForFences called for fence 0x... which has not been submitted on a Queue or during acquire next image."
-			if (!currentFrame.mDrawingFinishedFence->wait(2000000000))
+			if (!beginFrame())
 			{
 				return false;
 			}
+			FrameResources& currentFrame = getCurrentFrame();
 
-			if (!currentFrame.mDrawingFinishedFence->reset())
-			{
-				return false;
-			}
+			mStagingBuffer->beginFrame(mFrameIndex);
 
 			uint32_t imageIndex;
 			if (!mSwapchain->acquireImageIndex(2000000000, currentFrame.mImageAcquiredSemaphore->getHandle(), VK_NULL_HANDLE, imageIndex))
@@ -460,7 +471,7 @@ class RenderingTesselatedTerrain : public SampleBase
 				return false;
 			}
 
-			mFrameIndex = (mFrameIndex + 1) % mFramesResources.size();
+			endFrame();
 			return true;
 		}
 
@@ -494,14 +505,14 @@ class RenderingTesselatedTerrain : public SampleBase
 
 				nu::Matrix4f modelViewMatrix = viewMatrix * modelMatrix;
 
-				if (!mStagingBuffer->mapWriteUnmap(0, sizeof(float) * 16, &modelViewMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, 0, sizeof(float) * 16, &modelViewMatrix[0]))
 				{
 					return false;
 				}
 
 				nu::Matrix4f perspectiveMatrix = nu::Matrix4f::perspective(50.0f, static_cast<float>(mSwapchain->getSize().width) / static_cast<float>(mSwapchain->getSize().height), 0.5f, 10.0f);
 
-				if (!mStagingBuffer->mapWriteUnmap(sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0], true, nullptr))
+				if (!mUniformBuffer->update(*mStagingBuffer, sizeof(float) * 16, sizeof(float) * 16, &perspectiveMatrix[0]))
 				{
 					return false;
 				}
@@ -8,19 +8,192 @@
 #include "8 - Drawing Particles Using Compute And Graphics Pipelines\DrawingParticlesUsingComputeAndGraphicsPipelines.hpp"
 #include "9 - Rendering Tesselated Terrain\RenderingTesselatedTerrain.hpp"
 #include "10 - Postprocessing\Postprocessing.hpp"
+#include "11 - Multithreaded Command Recording\MultithreadedCommandRecording.hpp"
 
-int main() 
+#include <cstdlib>
+#include <cstring>
+
+void printUsage()
+{
+	printf("Usage : Examples [options]\n");
+	printf("  -benchmarkMemory  Compare the memory allocator with one vkAllocateMemory per buffer after the initialization of the first sample\n");
+	printf("  -framesInFlight N Frames prepared by the CPU while the GPU renders the previous ones, %u by default (1 to %u)\n", SampleBase::DefaultFramesInFlight, SampleBase::MaxFramesInFlight);
+	printf("  -comparePacing    Draw the first sample for a few seconds with 1, 2 and 3 frames in flight and compare the fence waits, then exit\n");
+	printf("  -checkAllocations Draw the samples counting their heap allocations for a few seconds, then exit with 1 if a frame allocated\n");
+}
+
+// Same frames for each number of frames in flight, so only the waits on the fences change
+void compareFramePacing(uint32_t frameCount)
+{
+	for (uint32_t framesInFlight = 1; framesInFlight <= 3; framesInFlight++)
+	{
+		printf("1 - Vertex Diffuse Lightning, %u frames in flight\n", framesInFlight);
+
+		nu::Window window("1 - Vertex Diffuse Lightning", 0, 0, 1280, 920);
+
+		VertexDiffuseLightning sample;
+		if (!sample.setFramesInFlight(framesInFlight) || !sample.initialize(window.getParameters()))
+		{
+			printf("Could not initialize the sample\n");
+			return;
+		}
+
+		// The frames which are not drawn don't wait on a fence, they are reported apart so the averages only cover the drawn ones
+		uint32_t skippedFrames = 0;
+		for (uint32_t frame = 0; frame < frameCount && window.isOpen(); frame++)
+		{
+			nu::Event event;
+			while (window.pollEvent(event))
+			{
+				if (event.type == nu::EventType::Close)
+				{
+					window.close();
+				}
+			}
+
+			if (!sample.isReady())
+			{
+				skippedFrames++;
+				continue;
+			}
+			sample.updateTime();
+			if (!sample.draw())
+			{
+				skippedFrames++;
+			}
+		}
+
+		sample.wait();
+		sample.printFramePacingStats();
+		if (skippedFrames > 0)
+		{
+			printf("Frames : %u of %u frames not drawn, the sample was not ready or the frame failed\n", skippedFrames, frameCount);
+		}
+		printf("\n");
+	}
+}
+
+// Returns false when a frame allocated once each frame in flight was drawn, or when the sample could not be drawn
+template <typename T>
+bool checkHotPathAllocations(const char* name, uint32_t framesInFlight, uint32_t frameCount)
+{
+	printf("%s, %u frames in flight\n", name, framesInFlight);
+
+	nu::Window window(name, 0, 0, 1280, 920);
+
+	T sample;
+	if (!sample.setFramesInFlight(framesInFlight) || !sample.initialize(window.getParameters()))
+	{
+		printf("Could not initialize the sample\n");
+		return false;
+	}
+
+	uint32_t drawnFrames = 0;
+	for (uint32_t frame = 0; frame < frameCount && window.isOpen(); frame++)
+	{
+		nu::Event event;
+		while (window.pollEvent(event))
+		{
+			if (event.type == nu::EventType::Close)
+			{
+				window.close();
+			}
+		}
+
+		if (sample.isReady())
+		{
+			sample.updateTime();
+			drawnFrames += sample.draw() ? 1 : 0;
+		}
+	}
+
+	sample.wait();
+	sample.printFramePacingStats();
+
+	const FramePacingStats& stats = sample.getFramePacingStats();
+	if (drawnFrames <= framesInFlight)
+	{
+		printf("Allocations : FAILED, only %u of %u frames drawn\n\n", drawnFrames, frameCount);
+		return false;
+	}
+	if (stats.allocatingFrames > 0)
+	{
+		printf("Allocations : FAILED, %u frames allocated\n\n", stats.allocatingFrames);
+		return false;
+	}
+	printf("Allocations : OK, no allocation in %u frames\n\n", drawnFrames - framesInFlight);
+	return true;
+}
+
+int main(int argc, char** argv) 
 {
+	bool benchmarkMemory = false;
+	bool comparePacing = false;
+	bool checkAllocations = false;
+	uint32_t framesInFlight = SampleBase::DefaultFramesInFlight;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-benchmarkMemory") == 0)
+		{
+			benchmarkMemory = true;
+		}
+		else if (strcmp(argv[i], "-framesInFlight") == 0 && i + 1 < argc)
+		{
+			framesInFlight = static_cast<uint32_t>(atoi(argv[++i]));
+			if (framesInFlight == 0 || framesInFlight > SampleBase::MaxFramesInFlight)
+			{
+				printf("Invalid number of frames in flight : %s\n", argv[i]);
+				printUsage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-comparePacing") == 0)
+		{
+			comparePacing = true;
+		}
+		else if (strcmp(argv[i], "-checkAllocations") == 0)
+		{
+			checkAllocations = true;
+		}
+		else
+		{
+			printf("Unknown option '%s'\n", argv[i]);
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (comparePacing)
+	{
+		compareFramePacing(500);
+		system("pause");
+		return 0;
+	}
+
+	// Only the samples which count their allocations, no pause so it can be run by a script
+	if (checkAllocations)
+	{
+		bool allocationFree = checkHotPathAllocations<VertexDiffuseLightning>("1 - Vertex Diffuse Lightning", framesInFlight, 300);
+		allocationFree &= checkHotPathAllocations<MultithreadedCommandRecording>("11 - Multithreaded Command Recording", framesInFlight, 300);
+		return allocationFree ? 0 : 1;
+	}
+
 	printf("1 - Vertex Diffuse Lightning\n");
 	{
 		nu::Window window("1 - Vertex Diffuse Lightning", 0, 0, 1280, 920);
 
 		VertexDiffuseLightning sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
+		if (benchmarkMemory && sample.isReady())
+		{
+			sample.printMemoryAllocatorBenchmark(1000);
+		}
 
 		while (window.isOpen())
 		{
@@ -58,6 +231,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -73,11 +247,13 @@ int main()
 		nu::Window window("2 - Fragment Specular Lightning", 0, 0, 1280, 920);
 
 		FragmentSpecularLightning sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -115,6 +291,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -130,11 +307,13 @@ int main()
 		nu::Window window("3 - Normal Mapped Geometry", 0, 0, 1280, 920);
 
 		NormalMappedGeometry sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -172,6 +351,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -187,11 +367,13 @@ int main()
 		nu::Window window("4 - Reflective and Refractive Geometry Using Cubemaps", 0, 0, 1280, 920);
 
 		ReflectiveAndRefractiveGeometryUsingCubemaps sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -229,6 +411,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -245,11 +428,13 @@ int main()
 		nu::Window window("5 - Adding Shadows", 0, 0, 1280, 920);
 
 		AddingShadows sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -287,6 +472,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 	*/
@@ -303,11 +489,13 @@ int main()
 		nu::Window window("6 - Drawing Skybox", 0, 0, 1280, 920);
 
 		DrawingSkybox sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -345,6 +533,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -360,11 +549,13 @@ int main()
 		nu::Window window("7 - Drawing Billboards Using Geometry Shaders", 0, 0, 1280, 920);
 
 		DrawingBillboardsUsingGeometryShaders sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -402,6 +593,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -418,11 +610,13 @@ int main()
 		nu::Window window("8 - Drawing Particles Using Compute And Graphics Pipelines", 0, 0, 1280, 920);
 
 		DrawingParticlesUsingComputeAndGraphicsPipelines sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -460,6 +654,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 	*/
@@ -476,11 +671,13 @@ int main()
 		nu::Window window("9 - Rendering Tesselated Terrain", 0, 0, 1280, 920);
 
 		RenderingTesselatedTerrain sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -518,6 +715,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -533,11 +731,73 @@ int main()
 		nu::Window window("10 - Postprocessing", 0, 0, 1280, 920);
 
 		Postprocessing sample;
+		sample.setFramesInFlight(framesInFlight);
+		if (!sample.initialize(window.getParameters()))
+		{
+			printf("Could not initialize the sample\n");
+			window.close();
+		}
+		sample.printPipelineCacheStats();
+
+		while (window.isOpen())
+		{
+			nu::Event event;
+			while (window.pollEvent(event))
+			{
+				if (event.type == nu::EventType::Close)
+				{
+					window.close();
+				}
+				if (event.type == nu::EventType::MouseMove)
+				{
+					if (sample.isReady())
+					{
+						sample.mouseMove(static_cast<int>(event.param1), static_cast<int>(event.param2));
+						sample.onMouseEvent();
+					}
+				}
+				if (event.type == nu::EventType::MouseClick)
+				{
+					if (sample.isReady())
+					{
+						sample.mouseClick(static_cast<size_t>(event.param1), event.param2 > 0);
+						sample.onMouseEvent();
+					}
+				}
+			}
+
+			if (sample.isReady())
+			{
+				sample.updateTime();
+				sample.draw();
+				sample.mouseReset();
+			}
+		}
+
+		sample.wait();
+		sample.printFramePacingStats();
+	}
+	printf("\n\n");
+
+	#if defined VULKAN_OPTION_OBJECTTRACKER
+		if (VulkanObjectTracker::hasLeaks())
+		{
+			printf("\n\n%d leaks found\n\n\n", VulkanObjectTracker::getLeaksCount());
+		}
+	#endif
+
+	printf("11 - Multithreaded Command Recording\n");
+	{
+		nu::Window window("11 - Multithreaded Command Recording", 0, 0, 1280, 920);
+
+		MultithreadedCommandRecording sample;
+		sample.setFramesInFlight(framesInFlight);
 		if (!sample.initialize(window.getParameters()))
 		{
 			printf("Could not initialize the sample\n");
 			window.close();
 		}
+		sample.printPipelineCacheStats();
 
 		while (window.isOpen())
 		{
@@ -575,6 +835,7 @@ int main()
 		}
 
 		sample.wait();
+		sample.printFramePacingStats();
 	}
 	printf("\n\n");
 
@@ -1,19 +1,96 @@
 #include "IndexBuffer.hpp"
 
+#include <vector>
+
 namespace nu
 {
 
-IndexBuffer::Ptr IndexBuffer::createIndexBuffer(VulkanDevice& device)
+IndexBuffer::Ptr IndexBuffer::createIndexBuffer(VulkanDevice& device, uint32_t indexCount, VkIndexType indexType)
 {
-	return nullptr;
+	IndexBuffer::Ptr indexBuffer = IndexBuffer::Ptr(new IndexBuffer());
+	if (indexBuffer != nullptr)
+	{
+		if (!indexBuffer->init(device, indexCount, indexType))
+		{
+			indexBuffer.reset();
+		}
+	}
+	return indexBuffer;
 }
 
 IndexBuffer::~IndexBuffer()
 {
 }
 
+bool IndexBuffer::update(VulkanUploadManager& uploadManager, uint32_t indexCount, const uint32_t* indices, uint32_t firstIndex, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages)
+{
+	if (mIndexType == VK_INDEX_TYPE_UINT32)
+	{
+		return updateRaw(uploadManager, indexCount, indices, firstIndex, currentAccess, newAccess, generatingStages, consumingStages);
+	}
+
+	std::vector<uint16_t> shortIndices(indexCount);
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] > 0xFFFF)
+		{
+			// TODO : Use Numea Log System
+			printf("Index %u can't be stored in 16 bits\n", indices[i]);
+			return false;
+		}
+		shortIndices[i] = (uint16_t)indices[i];
+	}
+	return updateRaw(uploadManager, indexCount, shortIndices.data(), firstIndex, currentAccess, newAccess, generatingStages, consumingStages);
+}
+
+bool IndexBuffer::updateRaw(VulkanUploadManager& uploadManager, uint32_t indexCount, const void* indices, uint32_t firstIndex, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages)
+{
+	if (firstIndex + indexCount > mIndexCount)
+	{
+		// TODO : Use Numea Log System
+		printf("Too many indices for the index buffer\n");
+		return false;
+	}
+	return uploadManager.uploadBuffer(mBuffer.get(), firstIndex * getIndexSize(), indexCount * getIndexSize(), indices, currentAccess, newAccess, generatingStages, consumingStages);
+}
+
+void IndexBuffer::bindTo(VulkanCommandBuffer* commandBuffer, uint32_t memoryOffset)
+{
+	commandBuffer->bindIndexBuffer(mBuffer.get(), memoryOffset, mIndexType);
+}
+
+uint32_t IndexBuffer::getIndexCount() const
+{
+	return mIndexCount;
+}
+
+VkIndexType IndexBuffer::getIndexType() const
+{
+	return mIndexType;
+}
+
+uint32_t IndexBuffer::getIndexSize() const
+{
+	return (mIndexType == VK_INDEX_TYPE_UINT16) ? (uint32_t)sizeof(uint16_t) : (uint32_t)sizeof(uint32_t);
+}
+
 IndexBuffer::IndexBuffer()
+	: mBuffer(nullptr)
+	, mIndexCount(0)
+	, mIndexType(VK_INDEX_TYPE_UINT32)
+{
+}
+
+bool IndexBuffer::init(VulkanDevice& device, uint32_t indexCount, VkIndexType indexType)
 {
+	mIndexCount = indexCount;
+	mIndexType = indexType;
+	mBuffer = device.createBuffer(indexCount * getIndexSize(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	if (!mBuffer || !mBuffer->allocateMemoryBlock(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+	{
+		return false;
+	}
+	return true;
 }
 
 } // namespace nu
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include "VulkanWrapper/VulkanDevice.hpp"
 #include "VulkanWrapper/VulkanBuffer.hpp"
+#include "VulkanWrapper/VulkanCommandBuffer.hpp"
+#include "VulkanWrapper/VulkanUploadManager.hpp"
+
+#include <memory>
 
 namespace nu
 {
@@ -11,13 +15,29 @@ class IndexBuffer
 	public:
 		typedef std::unique_ptr<IndexBuffer> Ptr;
 
-		static IndexBuffer::Ptr createIndexBuffer(VulkanDevice& device);
+		static IndexBuffer::Ptr createIndexBuffer(VulkanDevice& device, uint32_t indexCount, VkIndexType indexType);
 		~IndexBuffer();
 
+		// The indices are converted to the index type of the buffer, then copied in the staging memory right away
+		bool update(VulkanUploadManager& uploadManager, uint32_t indexCount, const uint32_t* indices, uint32_t firstIndex, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages);
+
+		// The indices are already in the index type of the buffer (like the ones of a MeshFile), they are copied as they are
+		bool updateRaw(VulkanUploadManager& uploadManager, uint32_t indexCount, const void* indices, uint32_t firstIndex, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages);
+
+		void bindTo(VulkanCommandBuffer* commandBuffer, uint32_t memoryOffset);
+
+		uint32_t getIndexCount() const;
+		VkIndexType getIndexType() const;
+		uint32_t getIndexSize() const;
+
 	private:
 		IndexBuffer();
 
+		bool init(VulkanDevice& device, uint32_t indexCount, VkIndexType indexType);
+
 		VulkanBufferPtr mBuffer;
+		uint32_t mIndexCount;
+		VkIndexType mIndexType;
 };
 
 } // namespace nu
\ No newline at end of file
@@ -1,19 +1,149 @@
 #include "Mesh.hpp"
 
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "ThirdParty/tiny_obj_loader.h"
 
-#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+#if (defined _M_X64) || (defined _M_AMD64) || (defined _M_IX86_FP && _M_IX86_FP >= 2) || (defined __SSE2__)
+	#define NU_MESH_SSE 1
+	#include <emmintrin.h>
+#else
+	#define NU_MESH_SSE 0
+#endif
 
 namespace nu 
 {
 
+namespace
+{
+
+// Vertices or indices written by one loading job
+const uint32_t ElementsPerJob = 16384;
+
+// Runs function(job, threadIndex) for all the jobs, each thread takes the next job until there is none left
+// Only used at loading, the threads don't need to outlive the call
+void parallelFor(uint32_t jobCount, uint32_t threadCount, const std::function<void(uint32_t job, uint32_t threadIndex)>& function)
+{
+	const uint32_t workerCount = std::min(threadCount, jobCount);
+	std::atomic<uint32_t> nextJob(0);
+	auto work = [&](uint32_t threadIndex)
+	{
+		uint32_t job;
+		while ((job = nextJob.fetch_add(1)) < jobCount)
+		{
+			function(job, threadIndex);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(workerCount);
+	for (uint32_t i = 1; i < workerCount; i++)
+	{
+		workers.emplace_back(work, i);
+	}
+	work(0);
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+struct IndexTriple
+{
+	int vertex;
+	int normal;
+	int texcoord;
+
+	bool operator==(const IndexTriple& other) const
+	{
+		return vertex == other.vertex && normal == other.normal && texcoord == other.texcoord;
+	}
+};
+
+struct IndexTripleHash
+{
+	size_t operator()(const IndexTriple& triple) const
+	{
+		uint64_t hash = (uint32_t)triple.vertex;
+		hash = hash * 0x100000001B3ull + (uint32_t)triple.normal;
+		hash = hash * 0x100000001B3ull + (uint32_t)triple.texcoord;
+		return (size_t)(hash ^ (hash >> 32));
+	}
+};
+
+typedef void (*AssembleFunction)(const tinyobj::attrib_t& attribs, const tinyobj::index_t* sources, uint32_t count, uint32_t stride, float* output, Vector3f& minimum, Vector3f& maximum);
+
+// Writes count interleaved vertices, the layout is a template parameter so the loop doesn't test it
+template <bool LoadNormals, bool LoadTexcoords>
+void assembleVertices(const tinyobj::attrib_t& attribs, const tinyobj::index_t* sources, uint32_t count, uint32_t stride, float* output, Vector3f& minimum, Vector3f& maximum)
+{
+	const uint32_t texcoordOffset = LoadNormals ? 6 : 3;
+	for (uint32_t i = 0; i < count; i++, output += stride)
+	{
+		const tinyobj::index_t& index = sources[i];
+
+		const float* position = &attribs.vertices[3 * index.vertex_index];
+		output[0] = position[0];
+		output[1] = position[1];
+		output[2] = position[2];
+		minimum = Vector3f::minimum(minimum, Vector3f(position));
+		maximum = Vector3f::maximum(maximum, Vector3f(position));
+
+		if (LoadNormals)
+		{
+			const float* normal = &attribs.normals[3 * index.normal_index];
+			output[3] = normal[0];
+			output[4] = normal[1];
+			output[5] = normal[2];
+		}
+
+		if (LoadTexcoords)
+		{
+			const float* texcoord = &attribs.texcoords[2 * index.texcoord_index];
+			output[texcoordOffset + 0] = texcoord[0];
+			output[texcoordOffset + 1] = texcoord[1];
+		}
+	}
+}
+
+} // namespace
+
 uint32_t Mesh::size() const
 {
 	return (uint32_t)sizeof(float) * (uint32_t)data.size();
 }
 
-bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, uint32_t* vertexStride)
+uint32_t Mesh::indicesSize() const
+{
+	return (getIndexType() == VK_INDEX_TYPE_UINT16 ? (uint32_t)sizeof(uint16_t) : (uint32_t)sizeof(uint32_t)) * (uint32_t)indices.size();
+}
+
+bool Mesh::isIndexed() const
+{
+	return indices.size() > 0;
+}
+
+uint32_t Mesh::getVertexCount() const
+{
+	return (stride > 0) ? (uint32_t)data.size() / stride : 0;
+}
+
+VkIndexType Mesh::getIndexType() const
+{
+	return (getVertexCount() <= 65536) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, uint32_t* vertexStride, bool indexed)
 {
 	// Load model
 	tinyobj::attrib_t attribs;
@@ -40,7 +170,244 @@ bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoor
 		generateTangents = false;
 	}
 
-	// Load model data and unify (normalize) its size and position
+	if (loadNormals && attribs.normals.size() == 0)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not load normal vectors data in the '%s' file\n", filename);
+		return false;
+	}
+	if (loadTexcoords && attribs.texcoords.size() == 0)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not load texture coordinates data in the '%s' file\n", filename);
+		return false;
+	}
+
+	stride = 3 + (loadNormals ? 3 : 0) + (loadTexcoords ? 2 : 0) + (generateTangents ? 6 : 0);
+	attributes = Positions | (loadNormals ? Normals : 0) | (loadTexcoords ? Texcoords : 0) | (generateTangents ? Tangents : 0);
+	if (vertexStride) 
+	{
+		*vertexStride = stride * sizeof(float);
+	}
+
+	const uint32_t threadCount = (loadingThreadCount > 0) ? loadingThreadCount : std::max(1u, (uint32_t)std::thread::hardware_concurrency());
+
+	data.clear();
+	indices.clear();
+	parts.clear();
+
+	// In indexed mode, the unique vertices of each shape (by their position/normal/texcoord indices in the file) and the indices of the shape in them
+	// The deduplication stays sequential inside a shape to keep the order of the vertices, but the shapes are independent
+	const uint32_t shapeCount = (uint32_t)shapes.size();
+	std::vector<std::vector<tinyobj::index_t>> shapeVertices(indexed ? shapeCount : 0);
+	std::vector<std::vector<uint32_t>> shapeIndices(indexed ? shapeCount : 0);
+	if (indexed)
+	{
+		parallelFor(shapeCount, threadCount, [&](uint32_t shape, uint32_t)
+		{
+			// Only the loaded attributes are part of the key, so vertices only differing by an unused attribute are merged
+			const std::vector<tinyobj::index_t>& sourceIndices = shapes[shape].mesh.indices;
+			std::unordered_map<IndexTriple, uint32_t, IndexTripleHash> uniqueVertices;
+			uniqueVertices.reserve(sourceIndices.size());
+			std::vector<tinyobj::index_t>& vertices = shapeVertices[shape];
+			std::vector<uint32_t>& localIndices = shapeIndices[shape];
+			localIndices.resize(sourceIndices.size());
+			for (size_t i = 0; i < sourceIndices.size(); i++)
+			{
+				const tinyobj::index_t& index = sourceIndices[i];
+				const IndexTriple triple = { index.vertex_index, loadNormals ? index.normal_index : 0, loadTexcoords ? index.texcoord_index : 0 };
+				auto result = uniqueVertices.emplace(triple, (uint32_t)vertices.size());
+				if (result.second)
+				{
+					vertices.push_back(index);
+				}
+				localIndices[i] = result.first->second;
+			}
+		});
+	}
+
+	// The ranges of the shapes are known now, so the output is sized once and each job writes its own part of it
+	std::vector<uint32_t> shapeVertexOffsets(shapeCount);
+	std::vector<uint32_t> shapeIndexOffsets(shapeCount);
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	for (uint32_t shape = 0; shape < shapeCount; shape++)
+	{
+		const uint32_t shapeVertexCount = (uint32_t)(indexed ? shapeVertices[shape].size() : shapes[shape].mesh.indices.size());
+		const uint32_t shapeIndexCount = indexed ? (uint32_t)shapeIndices[shape].size() : 0;
+		shapeVertexOffsets[shape] = vertexCount;
+		shapeIndexOffsets[shape] = indexCount;
+		if (shapeVertexCount > 0) 
+		{
+			parts.push_back({ vertexCount, shapeVertexCount, indexCount, shapeIndexCount });
+		}
+		vertexCount += shapeVertexCount;
+		indexCount += shapeIndexCount;
+	}
+	data.resize((size_t)vertexCount * stride); // The tangent space vectors stay at 0 until they are generated
+	indices.resize(indexCount);
+
+	// Vertices and indices are written by chunks, so a single big shape is split between the threads too
+	struct Job
+	{
+		uint32_t shape;
+		uint32_t first;
+		uint32_t count;
+		bool vertices; // Or indices
+	};
+	std::vector<Job> jobs;
+	for (uint32_t shape = 0; shape < shapeCount; shape++)
+	{
+		const uint32_t shapeVertexCount = (uint32_t)(indexed ? shapeVertices[shape].size() : shapes[shape].mesh.indices.size());
+		for (uint32_t first = 0; first < shapeVertexCount; first += ElementsPerJob)
+		{
+			jobs.push_back({ shape, first, std::min(ElementsPerJob, shapeVertexCount - first), true });
+		}
+		const uint32_t shapeIndexCount = indexed ? (uint32_t)shapeIndices[shape].size() : 0;
+		for (uint32_t first = 0; first < shapeIndexCount; first += ElementsPerJob)
+		{
+			jobs.push_back({ shape, first, std::min(ElementsPerJob, shapeIndexCount - first), false });
+		}
+	}
+
+	// The layout is resolved once, not for each vertex
+	AssembleFunction assemble = nullptr;
+	if (loadNormals)
+	{
+		assemble = loadTexcoords ? &assembleVertices<true, true> : &assembleVertices<true, false>;
+	}
+	else
+	{
+		assemble = loadTexcoords ? &assembleVertices<false, true> : &assembleVertices<false, false>;
+	}
+
+	// Bounds of the vertices written by each thread, reduced once all the jobs are done
+	std::vector<Vector3f> threadMinimums(threadCount, Vector3f(std::numeric_limits<float>::max()));
+	std::vector<Vector3f> threadMaximums(threadCount, Vector3f(std::numeric_limits<float>::lowest()));
+
+	parallelFor((uint32_t)jobs.size(), threadCount, [&](uint32_t jobIndex, uint32_t threadIndex)
+	{
+		const Job& job = jobs[jobIndex];
+		if (job.vertices)
+		{
+			const tinyobj::index_t* sources = indexed ? shapeVertices[job.shape].data() : shapes[job.shape].mesh.indices.data();
+			float* output = &data[((size_t)shapeVertexOffsets[job.shape] + job.first) * stride];
+			assemble(attribs, sources + job.first, job.count, stride, output, threadMinimums[threadIndex], threadMaximums[threadIndex]);
+		}
+		else
+		{
+			const uint32_t* localIndices = shapeIndices[job.shape].data() + job.first;
+			uint32_t* output = &indices[shapeIndexOffsets[job.shape] + job.first];
+			const uint32_t vertexOffset = shapeVertexOffsets[job.shape];
+			for (uint32_t i = 0; i < job.count; i++)
+			{
+				output[i] = localIndices[i] + vertexOffset;
+			}
+		}
+	});
+
+	if (vertexCount > 0)
+	{
+		boundsMin = threadMinimums[0];
+		boundsMax = threadMaximums[0];
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			boundsMin = Vector3f::minimum(boundsMin, threadMinimums[i]);
+			boundsMax = Vector3f::maximum(boundsMax, threadMaximums[i]);
+		}
+	}
+	else
+	{
+		boundsMin = Vector3f(0.0f);
+		boundsMax = Vector3f(0.0f);
+	}
+
+	if (generateTangents) 
+	{
+		generateTangentSpaceVectors();
+	}
+
+	// Unify (normalize) its size and position
+	if (unify && vertexCount > 0) 
+	{
+		const float minX = boundsMin[0];
+		const float maxX = boundsMax[0];
+		const float minY = boundsMin[1];
+		const float maxY = boundsMax[1];
+		const float minZ = boundsMin[2];
+		const float maxZ = boundsMax[2];
+
+		float offsetX = 0.5f * (minX + maxX);
+		float offsetY = 0.5f * (minY + maxY);
+		float offsetZ = 0.5f * (minZ + maxZ);
+		float scaleX = std::abs(minX - offsetX) > std::abs(maxX - offsetX) ? std::abs(minX - offsetX) : std::abs(maxX - offsetX);
+		float scaleY = std::abs(minY - offsetY) > std::abs(maxY - offsetY) ? std::abs(minY - offsetY) : std::abs(maxY - offsetY);
+		float scaleZ = std::abs(minZ - offsetZ) > std::abs(maxZ - offsetZ) ? std::abs(minZ - offsetZ) : std::abs(maxZ - offsetZ);
+		float scale = scaleX > scaleY ? scaleX : scaleY;
+		scale = scaleZ > scale ? 1.0f / scaleZ : 1.0f / scale;
+
+		const uint32_t chunkCount = (vertexCount + ElementsPerJob - 1) / ElementsPerJob;
+		parallelFor(chunkCount, threadCount, [&](uint32_t chunk, uint32_t)
+		{
+			const size_t first = (size_t)chunk * ElementsPerJob;
+			const size_t last = std::min(first + ElementsPerJob, (size_t)vertexCount);
+			for (size_t i = first * stride; i < last * stride; i += stride) 
+			{
+				data[i + 0] = scale * (data[i + 0] - offsetX);
+				data[i + 1] = scale * (data[i + 1] - offsetY);
+				data[i + 2] = scale * (data[i + 2] - offsetZ);
+			}
+		});
+
+		const Vector3f offset(offsetX, offsetY, offsetZ);
+		boundsMin = (boundsMin - offset) * scale;
+		boundsMax = (boundsMax - offset) * scale;
+	}
+
+	return true;
+}
+
+bool Mesh::loadFromFileReference(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, bool indexed)
+{
+	tinyobj::attrib_t attribs;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string error;
+
+	bool result = tinyobj::LoadObj(&attribs, &shapes, &materials, &error, filename);
+	if (!result) 
+	{
+		// TODO : Use Numea Log System
+		printf("Could not open the '%s' file\n", filename);
+		if (error.size() > 0)
+		{
+			// TODO : Use Numea Log System
+			printf("%s\n", error.c_str());
+		}
+		return false;
+	}
+
+	if (!loadNormals || !loadTexcoords) 
+	{
+		generateTangents = false;
+	}
+
+	if (loadNormals && attribs.normals.size() == 0)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not load normal vectors data in the '%s' file\n", filename);
+		return false;
+	}
+	if (loadTexcoords && attribs.texcoords.size() == 0)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not load texture coordinates data in the '%s' file\n", filename);
+		return false;
+	}
+
+	stride = 3 + (loadNormals ? 3 : 0) + (loadTexcoords ? 2 : 0) + (generateTangents ? 6 : 0);
+	attributes = Positions | (loadNormals ? Normals : 0) | (loadTexcoords ? Texcoords : 0) | (generateTangents ? Tangents : 0);
+
 	float minX = attribs.vertices[0];
 	float maxX = attribs.vertices[0];
 	float minY = attribs.vertices[1];
@@ -49,102 +416,89 @@ bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoor
 	float maxZ = attribs.vertices[2];
 
 	data.clear();
+	indices.clear();
 	parts.clear();
+
+	// The data grows one float at a time
+	auto appendVertex = [&](const tinyobj::index_t& index)
+	{
+		data.emplace_back(attribs.vertices[3 * index.vertex_index + 0]);
+		data.emplace_back(attribs.vertices[3 * index.vertex_index + 1]);
+		data.emplace_back(attribs.vertices[3 * index.vertex_index + 2]);
+
+		if (loadNormals) 
+		{
+			data.emplace_back(attribs.normals[3 * index.normal_index + 0]);
+			data.emplace_back(attribs.normals[3 * index.normal_index + 1]);
+			data.emplace_back(attribs.normals[3 * index.normal_index + 2]);
+		}
+
+		if (loadTexcoords) 
+		{
+			data.emplace_back(attribs.texcoords[2 * index.texcoord_index + 0]);
+			data.emplace_back(attribs.texcoords[2 * index.texcoord_index + 1]);
+		}
+
+		if (generateTangents) 
+		{
+			for (int i = 0; i < 6; ++i) 
+			{
+				data.emplace_back(0.0f);
+			}
+		}
+	};
+
+	std::unordered_map<IndexTriple, uint32_t, IndexTripleHash> uniqueVertices;
 		
 	uint32_t offset = 0;
 	for (auto& shape : shapes)
 	{
 		uint32_t partOffset = offset;
+		uint32_t partIndexOffset = (uint32_t)indices.size();
 
-		for (auto& index : shape.mesh.indices) 
+		if (indexed)
 		{
-			data.emplace_back(attribs.vertices[3 * index.vertex_index + 0]);
-			data.emplace_back(attribs.vertices[3 * index.vertex_index + 1]);
-			data.emplace_back(attribs.vertices[3 * index.vertex_index + 2]);
-			++offset;
-
-			if (loadNormals) 
-			{
-				if (attribs.normals.size() == 0) 
-				{
-					// TODO : Use Numea Log System
-					printf("Could not load normal vectors data in the '%s' file\n", filename);
-					return false;
-				}
-				else 
-				{
-					data.emplace_back(attribs.normals[3 * index.normal_index + 0]);
-					data.emplace_back(attribs.normals[3 * index.normal_index + 1]);
-					data.emplace_back(attribs.normals[3 * index.normal_index + 2]);
-				}
-			}
+			uniqueVertices.clear();
+			uniqueVertices.reserve(shape.mesh.indices.size());
+			indices.reserve(indices.size() + shape.mesh.indices.size());
+		}
 
-			if (loadTexcoords) 
+		for (auto& index : shape.mesh.indices) 
+		{
+			if (indexed)
 			{
-				if (attribs.texcoords.size() == 0) 
-				{
-					// TODO : Use Numea Log System
-					printf("Could not load texture coordinates data in the '%s' file\n", filename);
-					return false;
-				}
-				else 
+				const IndexTriple triple = { index.vertex_index, loadNormals ? index.normal_index : 0, loadTexcoords ? index.texcoord_index : 0 };
+				auto itr = uniqueVertices.find(triple);
+				if (itr != uniqueVertices.end())
 				{
-					data.emplace_back(attribs.texcoords[2 * index.texcoord_index + 0]);
-					data.emplace_back(attribs.texcoords[2 * index.texcoord_index + 1]);
+					indices.emplace_back(itr->second);
+					continue;
 				}
+				uniqueVertices.emplace(triple, offset);
+				indices.emplace_back(offset);
 			}
 
-			if (generateTangents) 
-			{
-				// Insert temporary tangent space vectors data
-				for (int i = 0; i < 6; ++i) 
-				{
-					data.emplace_back(0.0f);
-				}
-			}
+			appendVertex(index);
+			++offset;
 
 			if (unify) 
 			{
-				if (attribs.vertices[3 * index.vertex_index + 0] < minX) 
-				{
-					minX = attribs.vertices[3 * index.vertex_index + 0];
-				}
-				if (attribs.vertices[3 * index.vertex_index + 0] > maxX) 
-				{
-					maxX = attribs.vertices[3 * index.vertex_index + 0];
-				}
-				if (attribs.vertices[3 * index.vertex_index + 1] < minY) 
-				{
-					minY = attribs.vertices[3 * index.vertex_index + 1];
-				}
-				if (attribs.vertices[3 * index.vertex_index + 1] > maxY) 
-				{
-					maxY = attribs.vertices[3 * index.vertex_index + 1];
-				}
-				if (attribs.vertices[3 * index.vertex_index + 2] < minZ) 
-				{
-					minZ = attribs.vertices[3 * index.vertex_index + 2];
-				}
-				if (attribs.vertices[3 * index.vertex_index + 2] > maxZ) 
-				{
-					maxZ = attribs.vertices[3 * index.vertex_index + 2];
-				}
+				minX = std::min(minX, attribs.vertices[3 * index.vertex_index + 0]);
+				maxX = std::max(maxX, attribs.vertices[3 * index.vertex_index + 0]);
+				minY = std::min(minY, attribs.vertices[3 * index.vertex_index + 1]);
+				maxY = std::max(maxY, attribs.vertices[3 * index.vertex_index + 1]);
+				minZ = std::min(minZ, attribs.vertices[3 * index.vertex_index + 2]);
+				maxZ = std::max(maxZ, attribs.vertices[3 * index.vertex_index + 2]);
 			}
 		}
 
 		uint32_t partVertexCount = offset - partOffset;
 		if (partVertexCount > 0) 
 		{
-			parts.push_back({ partOffset, partVertexCount });
+			parts.push_back({ partOffset, partVertexCount, partIndexOffset, (uint32_t)indices.size() - partIndexOffset });
 		}
 	}
 
-	uint32_t stride = 3 + (loadNormals ? 3 : 0) + (loadTexcoords ? 2 : 0) + (generateTangents ? 6 : 0);
-	if (vertexStride) 
-	{
-		*vertexStride = stride * sizeof(float);
-	}
-
 	if (generateTangents) 
 	{
 		generateTangentSpaceVectors();
@@ -155,9 +509,9 @@ bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoor
 		float offsetX = 0.5f * (minX + maxX);
 		float offsetY = 0.5f * (minY + maxY);
 		float offsetZ = 0.5f * (minZ + maxZ);
-		float scaleX = abs(minX - offsetX) > abs(maxX - offsetX) ? abs(minX - offsetX) : abs(maxX - offsetX);
-		float scaleY = abs(minY - offsetY) > abs(maxY - offsetY) ? abs(minY - offsetY) : abs(maxY - offsetY);
-		float scaleZ = abs(minZ - offsetZ) > abs(maxZ - offsetZ) ? abs(minZ - offsetZ) : abs(maxZ - offsetZ);
+		float scaleX = std::abs(minX - offsetX) > std::abs(maxX - offsetX) ? std::abs(minX - offsetX) : std::abs(maxX - offsetX);
+		float scaleY = std::abs(minY - offsetY) > std::abs(maxY - offsetY) ? std::abs(minY - offsetY) : std::abs(maxY - offsetY);
+		float scaleZ = std::abs(minZ - offsetZ) > std::abs(maxZ - offsetZ) ? std::abs(minZ - offsetZ) : std::abs(maxZ - offsetZ);
 		float scale = scaleX > scaleY ? scaleX : scaleY;
 		scale = scaleZ > scale ? 1.0f / scaleZ : 1.0f / scale;
 
@@ -169,31 +523,251 @@ bool Mesh::loadFromFile(const char* filename, bool loadNormals, bool loadTexcoor
 		}
 	}
 
+	boundsMin = Vector3f(0.0f);
+	boundsMax = Vector3f(0.0f);
+	if (data.size() >= stride)
+	{
+		boundsMin = Vector3f(data[0], data[1], data[2]);
+		boundsMax = boundsMin;
+		for (size_t i = stride; i + 2 < data.size(); i += stride)
+		{
+			const Vector3f position(data[i], data[i + 1], data[i + 2]);
+			boundsMin = Vector3f::minimum(boundsMin, position);
+			boundsMax = Vector3f::maximum(boundsMax, position);
+		}
+	}
+
 	return true;
 }
 
+bool Mesh::loadFromBinaryFile(const char* filename, uint32_t* vertexStride)
+{
+	MeshFile file;
+	if (!file.open(filename))
+	{
+		return false;
+	}
+
+	const MeshFileHeader& header = file.getHeader();
+	if (header.vertexStride % sizeof(float) != 0)
+	{
+		// TODO : Use Numea Log System
+		printf("The vertices of the '%s' file are not made of floats\n", filename);
+		return false;
+	}
+
+	stride = header.vertexStride / (uint32_t)sizeof(float);
+	attributes = header.attributes;
+	boundsMin = Vector3f(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	boundsMax = Vector3f(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	if (vertexStride) 
+	{
+		*vertexStride = header.vertexStride;
+	}
+
+	parts.assign(file.getParts(), file.getParts() + file.getPartCount());
+
+	const float* vertices = static_cast<const float*>(file.getVertexData());
+	data.assign(vertices, vertices + file.getVertexDataSize() / sizeof(float));
+
+	if (header.indexType == VK_INDEX_TYPE_UINT16)
+	{
+		const uint16_t* fileIndices = static_cast<const uint16_t*>(file.getIndexData());
+		indices.assign(fileIndices, fileIndices + header.indexCount);
+	}
+	else
+	{
+		const uint32_t* fileIndices = static_cast<const uint32_t*>(file.getIndexData());
+		indices.assign(fileIndices, fileIndices + header.indexCount);
+	}
+
+	return true;
+}
+
+bool Mesh::saveToBinaryFile(const char* filename) const
+{
+	return MeshFile::write(filename, *this);
+}
+
+bool Mesh::optimize(bool sortForOverdraw, bool printStats)
+{
+	if (!isIndexed())
+	{
+		// TODO : Use Numea Log System
+		printf("Only indexed meshes can be optimized\n");
+		return false;
+	}
+
+	MeshCacheStats before = { 0.0f, 0.0f };
+	MeshCacheStats after = { 0.0f, 0.0f };
+	for (auto& part : parts)
+	{
+		// The optimizer works with indices relative to the first vertex of the part
+		uint32_t* partIndices = &indices[part.indexOffset];
+		for (uint32_t i = 0; i < part.indexCount; i++)
+		{
+			partIndices[i] -= part.vertexOffset;
+		}
+
+		const MeshCacheStats partBefore = MeshOptimizer::analyzeVertexCache(partIndices, part.indexCount, part.vertexCount);
+
+		float* partData = &data[part.vertexOffset * stride];
+		MeshOptimizer::optimizeVertexCache(partIndices, part.indexCount, part.vertexCount);
+		if (sortForOverdraw)
+		{
+			MeshOptimizer::optimizeOverdraw(partIndices, part.indexCount, partData, stride, part.vertexCount);
+		}
+		MeshOptimizer::optimizeVertexFetch(partData, stride, part.vertexCount, partIndices, part.indexCount);
+
+		const MeshCacheStats partAfter = MeshOptimizer::analyzeVertexCache(partIndices, part.indexCount, part.vertexCount);
+
+		for (uint32_t i = 0; i < part.indexCount; i++)
+		{
+			partIndices[i] += part.vertexOffset;
+		}
+
+		// Weighted by the triangles for the ACMR and by the vertices for the ATVR
+		before.acmr += partBefore.acmr * part.indexCount / 3;
+		before.atvr += partBefore.atvr * part.vertexCount;
+		after.acmr += partAfter.acmr * part.indexCount / 3;
+		after.atvr += partAfter.atvr * part.vertexCount;
+	}
+
+	if (printStats && indices.size() >= 3)
+	{
+		const float triangleCount = (float)(indices.size() / 3);
+		const float vertexCount = (float)getVertexCount();
+		printf("Mesh : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%u entries FIFO)\n", before.acmr / triangleCount, after.acmr / triangleCount, before.atvr / vertexCount, after.atvr / vertexCount, MeshOptimizer::DefaultAnalyzeCacheSize);
+	}
+
+	return true;
+}
+
+uint32_t Mesh::getAttributeOffset(Attributes attribute) const
+{
+	// The attributes are interleaved in the order of their flags
+	uint32_t offset = 0;
+	if (attribute > Positions && (attributes & Positions) != 0)
+	{
+		offset += 3;
+	}
+	if (attribute > Normals && (attributes & Normals) != 0)
+	{
+		offset += 3;
+	}
+	if (attribute > Texcoords && (attributes & Texcoords) != 0)
+	{
+		offset += 2;
+	}
+	return offset;
+}
+
 void Mesh::generateTangentSpaceVectors()
 {
-	const size_t normalOffset = 3;
-	const size_t texcoordOffset = 6;
-	const size_t tangentOffset = 8;
-	const size_t bitangentOffset = 11;
-	const size_t stride = bitangentOffset + 3;
+	if ((attributes & (Normals | Texcoords | Tangents)) != (Normals | Texcoords | Tangents))
+	{
+		return;
+	}
+
+	const uint32_t normalOffset = getAttributeOffset(Normals);
+	const uint32_t texcoordOffset = getAttributeOffset(Texcoords);
+	const uint32_t tangentOffset = getAttributeOffset(Tangents);
+	const uint32_t bitangentOffset = tangentOffset + 3;
+	const bool indexed = isIndexed();
+
+	// Sums of the face vectors of each vertex of the part : in indexed mode a vertex is shared by several faces, otherwise it is only used by its own face
+	std::vector<float> tangentSums;
+	std::vector<float> bitangentSums;
 
 	for (auto& part : parts) 
 	{
-		for (size_t i = 0; i < data.size(); i += stride * 3) 
+		const uint32_t triangleCount = (indexed ? part.indexCount : part.vertexCount) / 3;
+		const uint32_t* partIndices = indexed ? &indices[part.indexOffset] : nullptr;
+		auto getVertex = [&](uint32_t triangle, uint32_t corner) -> uint32_t
+		{
+			return indexed ? partIndices[3 * triangle + corner] - part.vertexOffset : 3 * triangle + corner;
+		};
+		const float* partData = &data[(size_t)part.vertexOffset * stride];
+		float* partOutput = &data[(size_t)part.vertexOffset * stride];
+
+		tangentSums.assign((size_t)part.vertexCount * 3, 0.0f);
+		bitangentSums.assign((size_t)part.vertexCount * 3, 0.0f);
+		auto accumulate = [&](const uint32_t* vertices, const float* faceTangent, const float* faceBitangent)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				float* tangentSum = &tangentSums[vertices[corner] * 3];
+				float* bitangentSum = &bitangentSums[vertices[corner] * 3];
+				tangentSum[0] += faceTangent[0];
+				tangentSum[1] += faceTangent[1];
+				tangentSum[2] += faceTangent[2];
+				bitangentSum[0] += faceBitangent[0];
+				bitangentSum[1] += faceBitangent[1];
+				bitangentSum[2] += faceBitangent[2];
+			}
+		};
+
+		uint32_t triangle = 0;
+
+#if NU_MESH_SSE
+		// Face vectors of 4 triangles at a time, with the same operations in the same order as the scalar code so the results are identical
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; useSse && triangle + 4 <= triangleCount; triangle += 4)
 		{
-			size_t i1 = i;
-			size_t i2 = i1 + stride;
-			size_t i3 = i2 + stride;
-			const Vector3f v1 = { data[i1], data[i1 + 1], data[i1 + 2] };
-			const Vector3f v2 = { data[i2], data[i2 + 1], data[i2 + 2] };
-			const Vector3f v3 = { data[i3], data[i3 + 1], data[i3 + 2] };
+			uint32_t vertices[4][3];
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				vertices[lane][0] = getVertex(triangle + lane, 0);
+				vertices[lane][1] = getVertex(triangle + lane, 1);
+				vertices[lane][2] = getVertex(triangle + lane, 2);
+			}
+			auto gather = [&](uint32_t corner, uint32_t offset) -> __m128
+			{
+				return _mm_setr_ps(partData[vertices[0][corner] * stride + offset], partData[vertices[1][corner] * stride + offset], partData[vertices[2][corner] * stride + offset], partData[vertices[3][corner] * stride + offset]);
+			};
+
+			const __m128 x1 = _mm_sub_ps(gather(1, 0), gather(0, 0));
+			const __m128 x2 = _mm_sub_ps(gather(2, 0), gather(0, 0));
+			const __m128 y1 = _mm_sub_ps(gather(1, 1), gather(0, 1));
+			const __m128 y2 = _mm_sub_ps(gather(2, 1), gather(0, 1));
+			const __m128 z1 = _mm_sub_ps(gather(1, 2), gather(0, 2));
+			const __m128 z2 = _mm_sub_ps(gather(2, 2), gather(0, 2));
+
+			const __m128 s1 = _mm_sub_ps(gather(1, texcoordOffset), gather(0, texcoordOffset));
+			const __m128 s2 = _mm_sub_ps(gather(2, texcoordOffset), gather(0, texcoordOffset));
+			const __m128 t1 = _mm_sub_ps(gather(1, texcoordOffset + 1), gather(0, texcoordOffset + 1));
+			const __m128 t2 = _mm_sub_ps(gather(2, texcoordOffset + 1), gather(0, texcoordOffset + 1));
+
+			const __m128 r = _mm_div_ps(one, _mm_sub_ps(_mm_mul_ps(s1, t2), _mm_mul_ps(s2, t1)));
+
+			alignas(16) float faceTangents[3][4];
+			alignas(16) float faceBitangents[3][4];
+			_mm_store_ps(faceTangents[0], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(t2, x1), _mm_mul_ps(t1, x2)), r));
+			_mm_store_ps(faceTangents[1], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(t2, y1), _mm_mul_ps(t1, y2)), r));
+			_mm_store_ps(faceTangents[2], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(t2, z1), _mm_mul_ps(t1, z2)), r));
+			_mm_store_ps(faceBitangents[0], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(s1, x2), _mm_mul_ps(s2, x1)), r));
+			_mm_store_ps(faceBitangents[1], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(s1, y2), _mm_mul_ps(s2, y1)), r));
+			_mm_store_ps(faceBitangents[2], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(s1, z2), _mm_mul_ps(s2, z1)), r));
+
+			// In triangle order, so the sums are the same as with the scalar code
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				const float faceTangent[3] = { faceTangents[0][lane], faceTangents[1][lane], faceTangents[2][lane] };
+				const float faceBitangent[3] = { faceBitangents[0][lane], faceBitangents[1][lane], faceBitangents[2][lane] };
+				accumulate(vertices[lane], faceTangent, faceBitangent);
+			}
+		}
+#endif
 
-			const std::array<float, 2> w1 = { data[i1 + texcoordOffset], data[i1 + texcoordOffset + 1] };
-			const std::array<float, 2> w2 = { data[i2 + texcoordOffset], data[i2 + texcoordOffset + 1] };
-			const std::array<float, 2> w3 = { data[i3 + texcoordOffset], data[i3 + texcoordOffset + 1] };
+		for (; triangle < triangleCount; triangle++)
+		{
+			const uint32_t vertices[3] = { getVertex(triangle, 0), getVertex(triangle, 1), getVertex(triangle, 2) };
+			const float* v1 = &partData[vertices[0] * stride];
+			const float* v2 = &partData[vertices[1] * stride];
+			const float* v3 = &partData[vertices[2] * stride];
+			const float* w1 = v1 + texcoordOffset;
+			const float* w2 = v2 + texcoordOffset;
+			const float* w3 = v3 + texcoordOffset;
 
 			float x1 = v2[0] - v1[0];
 			float x2 = v3[0] - v1[0];
@@ -208,12 +782,81 @@ void Mesh::generateTangentSpaceVectors()
 			float t2 = w3[1] - w1[1];
 
 			float r = 1.0f / (s1 * t2 - s2 * t1);
-			const Vector3f faceTangent = { (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r };
-			const Vector3f faceBitangent = { (s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r };
+			const float faceTangent[3] = { (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r };
+			const float faceBitangent[3] = { (s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r };
+			accumulate(vertices, faceTangent, faceBitangent);
+		}
 
-			calculateTangentAndBitangent(&data[i1 + normalOffset], faceTangent, faceBitangent, &data[i1 + tangentOffset], &data[i1 + bitangentOffset]);
-			calculateTangentAndBitangent(&data[i2 + normalOffset], faceTangent, faceBitangent, &data[i2 + tangentOffset], &data[i2 + bitangentOffset]);
-			calculateTangentAndBitangent(&data[i3 + normalOffset], faceTangent, faceBitangent, &data[i3 + tangentOffset], &data[i3 + bitangentOffset]);
+		uint32_t vertex = 0;
+
+#if NU_MESH_SSE
+		// Gram-Schmidt orthogonalization and handedness of 4 vertices at a time
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 minusOne = _mm_set1_ps(-1.0f);
+		for (; useSse && vertex + 4 <= part.vertexCount; vertex += 4)
+		{
+			auto gatherData = [&](uint32_t offset) -> __m128
+			{
+				return _mm_setr_ps(partData[(vertex + 0) * stride + offset], partData[(vertex + 1) * stride + offset], partData[(vertex + 2) * stride + offset], partData[(vertex + 3) * stride + offset]);
+			};
+			auto gatherSums = [&](const std::vector<float>& sums, uint32_t component) -> __m128
+			{
+				return _mm_setr_ps(sums[(vertex + 0) * 3 + component], sums[(vertex + 1) * 3 + component], sums[(vertex + 2) * 3 + component], sums[(vertex + 3) * 3 + component]);
+			};
+
+			const __m128 nx = gatherData(normalOffset);
+			const __m128 ny = gatherData(normalOffset + 1);
+			const __m128 nz = gatherData(normalOffset + 2);
+			const __m128 ftx = gatherSums(tangentSums, 0);
+			const __m128 fty = gatherSums(tangentSums, 1);
+			const __m128 ftz = gatherSums(tangentSums, 2);
+			const __m128 fbx = gatherSums(bitangentSums, 0);
+			const __m128 fby = gatherSums(bitangentSums, 1);
+			const __m128 fbz = gatherSums(bitangentSums, 2);
+
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ftx), _mm_mul_ps(ny, fty)), _mm_mul_ps(nz, ftz));
+			const __m128 ux = _mm_sub_ps(ftx, _mm_mul_ps(nx, d));
+			const __m128 uy = _mm_sub_ps(fty, _mm_mul_ps(ny, d));
+			const __m128 uz = _mm_sub_ps(ftz, _mm_mul_ps(nz, d));
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, ux), _mm_mul_ps(uy, uy)), _mm_mul_ps(uz, uz)));
+			const __m128 factor = _mm_div_ps(one, length);
+			const __m128 tx = _mm_mul_ps(ux, factor);
+			const __m128 ty = _mm_mul_ps(uy, factor);
+			const __m128 tz = _mm_mul_ps(uz, factor);
+
+			const __m128 cx = _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty));
+			const __m128 cy = _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz));
+			const __m128 cz = _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx));
+			const __m128 handednessTest = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, fbx), _mm_mul_ps(cy, fby)), _mm_mul_ps(cz, fbz));
+			const __m128 negative = _mm_cmplt_ps(handednessTest, zero);
+			const __m128 handedness = _mm_or_ps(_mm_and_ps(negative, minusOne), _mm_andnot_ps(negative, one));
+
+			alignas(16) float results[6][4];
+			_mm_store_ps(results[0], tx);
+			_mm_store_ps(results[1], ty);
+			_mm_store_ps(results[2], tz);
+			_mm_store_ps(results[3], _mm_mul_ps(cx, handedness));
+			_mm_store_ps(results[4], _mm_mul_ps(cy, handedness));
+			_mm_store_ps(results[5], _mm_mul_ps(cz, handedness));
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				float* output = &partOutput[(vertex + lane) * stride];
+				output[tangentOffset + 0] = results[0][lane];
+				output[tangentOffset + 1] = results[1][lane];
+				output[tangentOffset + 2] = results[2][lane];
+				output[bitangentOffset + 0] = results[3][lane];
+				output[bitangentOffset + 1] = results[4][lane];
+				output[bitangentOffset + 2] = results[5][lane];
+			}
+		}
+#endif
+
+		for (; vertex < part.vertexCount; vertex++)
+		{
+			float* output = &partOutput[vertex * stride];
+			const Vector3f faceTangent(&tangentSums[vertex * 3]);
+			const Vector3f faceBitangent(&bitangentSums[vertex * 3]);
+			calculateTangentAndBitangent(output + normalOffset, faceTangent, faceBitangent, output + tangentOffset, output + bitangentOffset);
 		}
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Math/Vector3.hpp"
+#include "VulkanWrapper/VulkanFunctions.hpp"
 
 #include <vector>
 
@@ -9,21 +10,64 @@ namespace nu
 
 struct Mesh 
 {
+	// Attributes of the interleaved vertices, in this order
+	enum Attributes
+	{
+		Positions = 0x1,
+		Normals = 0x2,
+		Texcoords = 0x4,
+		Tangents = 0x8 // Tangent then bitangent
+	};
+
 	struct Part 
 	{
 		uint32_t vertexOffset;
 		uint32_t vertexCount;
+		uint32_t indexOffset; // Only for indexed meshes
+		uint32_t indexCount;
 	};
 
 	std::vector<float> data;
+	std::vector<uint32_t> indices; // Empty for non-indexed meshes, the indices already include the vertexOffset of their part
 	std::vector<Part> parts;
+	uint32_t stride = 0; // In floats
+	uint32_t attributes = 0;
+	Vector3f boundsMin;
+	Vector3f boundsMax;
+
+	uint32_t loadingThreadCount = 0; // Threads used by loadFromFile to build the vertices, 0 for all the hardware threads
+	bool useSse = true; // Only where SSE2 is available, false forces the scalar code so both can be compared
 
 	uint32_t size() const;
+	uint32_t indicesSize() const; // In bytes, with the index type of getIndexType()
+
+	bool isIndexed() const;
+	uint32_t getVertexCount() const;
+	VkIndexType getIndexType() const; // 16 bits indices when all the vertices can be addressed with them
+	uint32_t getAttributeOffset(Attributes attribute) const; // In floats from the start of a vertex
+
+	// Only the parsing of the file is sequential, the vertices of the shapes are deduplicated and built on several threads
+	// In indexed mode, the vertices sharing the same position/normal/texcoord indices in the file are only stored once
+	bool loadFromFile(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, uint32_t* vertexStride = nullptr, bool indexed = false);
+
+	// The previous loader, sequential and growing the data one float at a time, kept as the reference of the loading benchmark of the MeshConverter
+	// Gives the same vertices, indices and parts as loadFromFile
+	bool loadFromFileReference(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, bool indexed = false);
+
+	// Binary meshes written by saveToBinaryFile (see MeshFile), the data is copied without any parsing
+	bool loadFromBinaryFile(const char* filename, uint32_t* vertexStride = nullptr);
+	bool saveToBinaryFile(const char* filename) const;
+
+	// Reorders the triangles of each part for the post-transform vertex cache, then its vertices for the fetch locality
+	// With sortForOverdraw, the clusters of triangles facing outside are also moved first in each part
+	// Only for indexed meshes, the same mesh is always optimized the same way
+	bool optimize(bool sortForOverdraw = false, bool printStats = false);
 
-	bool loadFromFile(const char* filename, bool loadNormals, bool loadTexcoords, bool generateTangents, bool unify, uint32_t* vertexStride = nullptr);
+	// Overwrites the tangents and bitangents from the positions, normals and texcoords, the attributes must include all of them
+	// Each part is processed once, the face vectors are accumulated for the vertices shared in indexed mode
+	void generateTangentSpaceVectors();
  
 	private:
-		void generateTangentSpaceVectors();
 		void calculateTangentAndBitangent(const float* normalData, const Vector3f& faceTangent, const Vector3f& faceBitangent, float* tangentData, float* bitangentData);
 };
 
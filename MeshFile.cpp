@@ -0,0 +1,258 @@
+#include "MeshFile.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace nu
+{
+
+static_assert(sizeof(MeshFileHeader) == 80, "The header is written as it is");
+static_assert(sizeof(Mesh::Part) == 4 * sizeof(uint32_t), "The parts are written as they are");
+
+MeshFile::MeshFile()
+	: mFile()
+	, mHeader(nullptr)
+{
+}
+
+MeshFile::~MeshFile()
+{
+	close();
+}
+
+bool MeshFile::open(const char* filename)
+{
+	close();
+
+	if (!mFile.open(filename))
+	{
+		return false;
+	}
+
+	const size_t fileSize = mFile.getSize();
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(mFile.getData());
+	if (fileSize < sizeof(MeshFileHeader) || header->magic != Magic)
+	{
+		// TODO : Use Numea Log System
+		printf("The '%s' file is not a mesh file\n", filename);
+		mFile.close();
+		return false;
+	}
+	if (header->version != Version)
+	{
+		// TODO : Use Numea Log System
+		printf("The '%s' mesh file has the version %u instead of %u, convert it again\n", filename, header->version, Version);
+		mFile.close();
+		return false;
+	}
+
+	// Every section has to be in the file, the parts in the sections and the indices in the vertices, so the mapped data can be used without any other check
+	const uint64_t partsEnd = header->partsOffset + (uint64_t)header->partCount * sizeof(Mesh::Part);
+	const uint64_t verticesEnd = header->verticesOffset + (uint64_t)header->vertexCount * header->vertexStride;
+	const uint64_t indicesEnd = header->indicesOffset + (uint64_t)header->indexCount * getIndexSize(header->indexType);
+	if (getIndexSize(header->indexType) == 0 || partsEnd > fileSize || verticesEnd > fileSize || indicesEnd > fileSize
+		|| header->partsOffset % SectionAlignment != 0 || header->verticesOffset % SectionAlignment != 0 || header->indicesOffset % SectionAlignment != 0)
+	{
+		// TODO : Use Numea Log System
+		printf("The '%s' mesh file is corrupted\n", filename);
+		mFile.close();
+		return false;
+	}
+	if (header->vertexStride == 0 || header->vertexStride != getVertexStride(header->attributes))
+	{
+		// TODO : Use Numea Log System
+		printf("The '%s' mesh file has a vertex stride of %u bytes which doesn't match its attributes\n", filename, header->vertexStride);
+		mFile.close();
+		return false;
+	}
+
+	const Mesh::Part* parts = reinterpret_cast<const Mesh::Part*>(mFile.getData() + header->partsOffset);
+	for (uint32_t i = 0; i < header->partCount; i++)
+	{
+		const Mesh::Part& part = parts[i];
+		if ((uint64_t)part.vertexOffset + part.vertexCount > header->vertexCount || (uint64_t)part.indexOffset + part.indexCount > header->indexCount)
+		{
+			// TODO : Use Numea Log System
+			printf("The part %u of the '%s' mesh file is out of its vertices or indices\n", i, filename);
+			mFile.close();
+			return false;
+		}
+	}
+
+	// The index buffer is used as it is, an index out of the vertices would be read by the GPU
+	const void* indices = mFile.getData() + header->indicesOffset;
+	const bool indicesValid = (header->indexType == VK_INDEX_TYPE_UINT16)
+		? areIndicesValid(static_cast<const uint16_t*>(indices), header->indexCount, header->vertexCount)
+		: areIndicesValid(static_cast<const uint32_t*>(indices), header->indexCount, header->vertexCount);
+	if (!indicesValid)
+	{
+		// TODO : Use Numea Log System
+		printf("The '%s' mesh file has indices out of its %u vertices\n", filename, header->vertexCount);
+		mFile.close();
+		return false;
+	}
+
+	mHeader = header;
+	return true;
+}
+
+bool MeshFile::isOpen() const
+{
+	return mHeader != nullptr;
+}
+
+void MeshFile::close()
+{
+	mFile.close();
+	mHeader = nullptr;
+}
+
+const MeshFileHeader& MeshFile::getHeader() const
+{
+	return *mHeader;
+}
+
+const Mesh::Part* MeshFile::getParts() const
+{
+	return reinterpret_cast<const Mesh::Part*>(mFile.getData() + mHeader->partsOffset);
+}
+
+uint32_t MeshFile::getPartCount() const
+{
+	return mHeader->partCount;
+}
+
+const void* MeshFile::getVertexData() const
+{
+	return mFile.getData() + mHeader->verticesOffset;
+}
+
+uint32_t MeshFile::getVertexDataSize() const
+{
+	return mHeader->vertexCount * mHeader->vertexStride;
+}
+
+const void* MeshFile::getIndexData() const
+{
+	return mFile.getData() + mHeader->indicesOffset;
+}
+
+uint32_t MeshFile::getIndexDataSize() const
+{
+	return mHeader->indexCount * getIndexSize(mHeader->indexType);
+}
+
+bool MeshFile::write(const char* filename, const Mesh& mesh)
+{
+	if (mesh.stride == 0 || mesh.data.empty())
+	{
+		// TODO : Use Numea Log System
+		printf("Could not write an empty mesh in the '%s' file\n", filename);
+		return false;
+	}
+
+	auto align = [](uint64_t offset) -> uint64_t
+	{
+		return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+	};
+
+	// The indices are stored in the type used by the index buffer, so they can be uploaded as they are
+	const VkIndexType indexType = mesh.getIndexType();
+	std::vector<uint16_t> shortIndices;
+	if (indexType == VK_INDEX_TYPE_UINT16)
+	{
+		shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+	}
+
+	MeshFileHeader header = {};
+	header.magic = Magic;
+	header.version = Version;
+	header.attributes = mesh.attributes;
+	header.vertexStride = mesh.stride * (uint32_t)sizeof(float);
+	header.vertexCount = mesh.getVertexCount();
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.indexType = (uint32_t)indexType;
+	header.partCount = (uint32_t)mesh.parts.size();
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		header.boundsMin[i] = mesh.boundsMin[i];
+		header.boundsMax[i] = mesh.boundsMax[i];
+	}
+	header.partsOffset = align(sizeof(MeshFileHeader));
+	header.verticesOffset = align(header.partsOffset + header.partCount * sizeof(Mesh::Part));
+	header.indicesOffset = align(header.verticesOffset + (uint64_t)header.vertexCount * header.vertexStride);
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not open the '%s' file\n", filename);
+		return false;
+	}
+
+	const char padding[SectionAlignment] = {};
+	auto writeSection = [&](uint64_t offset, const void* data, size_t size)
+	{
+		const uint64_t position = (uint64_t)file.tellp();
+		file.write(padding, (std::streamsize)(offset - position));
+		file.write(static_cast<const char*>(data), (std::streamsize)size);
+	};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(header.partsOffset, mesh.parts.data(), mesh.parts.size() * sizeof(Mesh::Part));
+	writeSection(header.verticesOffset, mesh.data.data(), (size_t)header.vertexCount * header.vertexStride);
+	if (indexType == VK_INDEX_TYPE_UINT16)
+	{
+		writeSection(header.indicesOffset, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		writeSection(header.indicesOffset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+	}
+
+	if (!file)
+	{
+		// TODO : Use Numea Log System
+		printf("Could not write the '%s' file\n", filename);
+		return false;
+	}
+	return true;
+}
+
+uint32_t MeshFile::getVertexStride(uint32_t attributes)
+{
+	if ((attributes & ~(uint32_t)(Mesh::Positions | Mesh::Normals | Mesh::Texcoords | Mesh::Tangents)) != 0)
+	{
+		return 0;
+	}
+
+	uint32_t stride = 0;
+	stride += (attributes & Mesh::Positions) != 0 ? 3 : 0;
+	stride += (attributes & Mesh::Normals) != 0 ? 3 : 0;
+	stride += (attributes & Mesh::Texcoords) != 0 ? 2 : 0;
+	stride += (attributes & Mesh::Tangents) != 0 ? 6 : 0;
+	return stride * (uint32_t)sizeof(float);
+}
+
+template <typename T>
+bool MeshFile::areIndicesValid(const T* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	T maxIndex = 0;
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		maxIndex = std::max(maxIndex, indices[i]);
+	}
+	return indexCount == 0 || maxIndex < vertexCount;
+}
+
+uint32_t MeshFile::getIndexSize(uint32_t indexType)
+{
+	switch (indexType)
+	{
+		case VK_INDEX_TYPE_UINT16: return (uint32_t)sizeof(uint16_t);
+		case VK_INDEX_TYPE_UINT32: return (uint32_t)sizeof(uint32_t);
+		default: return 0;
+	}
+}
+
+} // namespace nu
\ No newline at end of file
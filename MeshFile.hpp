@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Mesh.hpp"
+
+#include "VulkanWrapper/VulkanMappedFile.hpp"
+
+// TODO : Compressed vertex attributes (half floats, octahedral normals)
+
+namespace nu
+{
+
+// All the offsets are in bytes from the start of the file, the sections are aligned on SectionAlignment
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t attributes; // Mesh::Attributes
+	uint32_t vertexStride; // In bytes
+	uint32_t vertexCount;
+	uint32_t indexCount; // 0 for non-indexed meshes
+	uint32_t indexType; // VkIndexType
+	uint32_t partCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	uint64_t partsOffset; // partCount Mesh::Part
+	uint64_t verticesOffset; // vertexCount interleaved vertices
+	uint64_t indicesOffset; // indexCount indices of indexType
+};
+
+// Versioned binary container of the final vertex stream of a Mesh : interleaved vertices, indices, parts, bounds and layout
+// The file is mapped in memory, so the vertices and indices can be sent to a staging buffer as they are
+class MeshFile
+{
+	public:
+		static const uint32_t Magic = 0x4853454D; // "MESH"
+		static const uint32_t Version = 1;
+		static const uint32_t SectionAlignment = 16;
+
+		MeshFile();
+		~MeshFile();
+
+		bool open(const char* filename);
+		bool isOpen() const;
+		void close();
+
+		const MeshFileHeader& getHeader() const;
+
+		const Mesh::Part* getParts() const;
+		uint32_t getPartCount() const;
+
+		// Pointers in the mapped file, valid until close
+		const void* getVertexData() const;
+		uint32_t getVertexDataSize() const;
+		const void* getIndexData() const;
+		uint32_t getIndexDataSize() const;
+
+		static bool write(const char* filename, const Mesh& mesh);
+
+	private:
+		// NonCopyable
+		MeshFile(const MeshFile& other) = delete;
+		MeshFile& operator=(const MeshFile& other) = delete;
+
+		static uint32_t getVertexStride(uint32_t attributes); // In bytes, 0 for unknown attributes
+		template <typename T>
+		static bool areIndicesValid(const T* indices, uint32_t indexCount, uint32_t vertexCount);
+		static uint32_t getIndexSize(uint32_t indexType);
+
+		VulkanMappedFile mFile;
+		const MeshFileHeader* mHeader;
+};
+
+} // namespace nu
\ No newline at end of file
@@ -0,0 +1,378 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nu
+{
+
+namespace
+{
+
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.0f;
+const float ValenceBoostPower = 0.5f;
+
+float getVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+{
+	if (remainingTriangles == 0)
+	{
+		// No triangle left to draw with this vertex
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			// The vertices of the last triangle get a fixed score, so the strips are not favoured too much
+			score = LastTriangleScore;
+		}
+		else
+		{
+			const float scaler = 1.0f / (MeshOptimizer::OptimizeCacheSize - 3);
+			score = powf(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+		}
+	}
+
+	// Favours the vertices with few triangles left, so they are not left alone at the end
+	score += ValenceBoostScale * powf((float)remainingTriangles, -ValenceBoostPower);
+	return score;
+}
+
+// FIFO cache simulation, a vertex is in the cache while less than cacheSize misses happened since its own miss
+class FifoCache
+{
+	public:
+		FifoCache(uint32_t vertexCount, uint32_t cacheSize)
+			: mTimestamps(vertexCount, 0)
+			, mTimestamp(cacheSize + 1)
+			, mCacheSize(cacheSize)
+		{
+		}
+
+		// Returns the number of misses of the triangle
+		uint32_t addTriangle(const uint32_t* triangle)
+		{
+			uint32_t misses = 0;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const uint32_t vertex = triangle[i];
+				if (mTimestamp - mTimestamps[vertex] > mCacheSize)
+				{
+					mTimestamps[vertex] = mTimestamp++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		void clear()
+		{
+			mTimestamp += mCacheSize + 1;
+		}
+
+	private:
+		std::vector<uint32_t> mTimestamps;
+		uint32_t mTimestamp;
+		uint32_t mCacheSize;
+};
+
+} // namespace
+
+const uint32_t MeshOptimizer::OptimizeCacheSize; // Given to std::min by reference
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// Triangles using each vertex, the remaining ones are kept at the start of the list of each vertex
+	std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		remainingTriangles[indices[i]]++;
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount, 0);
+	uint32_t adjacencyOffset = 0;
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		adjacencyOffsets[vertex] = adjacencyOffset;
+		adjacencyOffset += remainingTriangles[vertex];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> adjacencyCursors(adjacencyOffsets);
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[adjacencyCursors[indices[i]]++] = i / 3;
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		vertexScores[vertex] = getVertexScore(-1, remainingTriangles[vertex]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	uint32_t bestTriangle = 0;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		const uint32_t* vertices = &indices[triangle * 3];
+		triangleScores[triangle] = vertexScores[vertices[0]] + vertexScores[vertices[1]] + vertexScores[vertices[2]];
+		if (triangleScores[triangle] > triangleScores[bestTriangle])
+		{
+			bestTriangle = triangle;
+		}
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(OptimizeCacheSize + 3);
+	newCache.reserve(OptimizeCacheSize + 3);
+	uint32_t nextCandidate = 0; // The triangles before it are all emitted
+
+	while (output.size() < triangleCount * 3)
+	{
+		const uint32_t triangleVertices[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+		output.insert(output.end(), triangleVertices, triangleVertices + 3);
+		emitted[bestTriangle] = true;
+
+		for (uint32_t vertex : triangleVertices)
+		{
+			uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+			uint32_t* last = triangles + remainingTriangles[vertex] - 1;
+			uint32_t* itr = std::find(triangles, last + 1, bestTriangle);
+			if (itr <= last)
+			{
+				std::swap(*itr, *last);
+				remainingTriangles[vertex]--;
+			}
+		}
+
+		// The vertices of the triangle go at the front of the cache, the ones pushed beyond its size leave it
+		newCache.clear();
+		for (uint32_t vertex : triangleVertices)
+		{
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+		for (uint32_t vertex : cache)
+		{
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+		for (uint32_t i = 0; i < newCache.size(); i++)
+		{
+			const uint32_t vertex = newCache[i];
+			cachePositions[vertex] = (i < OptimizeCacheSize) ? (int32_t)i : -1;
+			vertexScores[vertex] = getVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+		}
+
+		// Only the triangles of the vertices in the cache can be the next best one, the others didn't change
+		bool found = false;
+		float bestScore = 0.0f;
+		for (uint32_t i = 0; i < newCache.size(); i++)
+		{
+			const uint32_t vertex = newCache[i];
+			const uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+			for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+			{
+				const uint32_t triangle = triangles[j];
+				const uint32_t* vertices = &indices[triangle * 3];
+				triangleScores[triangle] = vertexScores[vertices[0]] + vertexScores[vertices[1]] + vertexScores[vertices[2]];
+				if (i < OptimizeCacheSize && (!found || triangleScores[triangle] > bestScore))
+				{
+					bestTriangle = triangle;
+					bestScore = triangleScores[triangle];
+					found = true;
+				}
+			}
+		}
+		newCache.resize(std::min((uint32_t)newCache.size(), OptimizeCacheSize));
+		cache.swap(newCache);
+
+		if (!found)
+		{
+			// Nothing left around the cache, continue with the first triangle not emitted yet
+			while (nextCandidate < triangleCount && emitted[nextCandidate])
+			{
+				nextCandidate++;
+			}
+			bestTriangle = nextCandidate;
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const float* vertexData, uint32_t vertexStride, uint32_t vertexCount, float threshold)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// Each cluster is drawn with a cold cache once sorted, so it ends once its own ACMR is close enough to the one of the whole list
+	const float acmr = analyzeVertexCache(indices, triangleCount * 3, vertexCount).acmr;
+	std::vector<uint32_t> clusterStarts;
+	FifoCache fifoCache(vertexCount, DefaultAnalyzeCacheSize);
+	uint32_t clusterMisses = 0;
+	uint32_t clusterTriangles = 0;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		if (clusterTriangles == 0)
+		{
+			clusterStarts.push_back(triangle);
+			fifoCache.clear();
+		}
+		clusterMisses += fifoCache.addTriangle(&indices[triangle * 3]);
+		clusterTriangles++;
+		if (clusterMisses <= threshold * acmr * clusterTriangles)
+		{
+			clusterMisses = 0;
+			clusterTriangles = 0;
+		}
+	}
+	const uint32_t clusterCount = (uint32_t)clusterStarts.size();
+	if (clusterCount <= 1)
+	{
+		return;
+	}
+	clusterStarts.push_back(triangleCount);
+
+	// Area weighted centroid and normal of each cluster
+	struct Cluster
+	{
+		float centroid[3];
+		float normal[3];
+		float area;
+		float sortKey;
+	};
+	std::vector<Cluster> clusters(clusterCount);
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		Cluster& cluster = clusters[c];
+		cluster = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 0.0f, 0.0f };
+		for (uint32_t triangle = clusterStarts[c]; triangle < clusterStarts[c + 1]; triangle++)
+		{
+			const float* p0 = &vertexData[indices[triangle * 3 + 0] * vertexStride];
+			const float* p1 = &vertexData[indices[triangle * 3 + 1] * vertexStride];
+			const float* p2 = &vertexData[indices[triangle * 3 + 2] * vertexStride];
+			const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			const float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				cluster.centroid[k] += area * (p0[k] + p1[k] + p2[k]) / 3.0f;
+				cluster.normal[k] += normal[k];
+			}
+			cluster.area += area;
+		}
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			meshCentroid[k] += cluster.centroid[k];
+		}
+		meshArea += cluster.area;
+	}
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		meshCentroid[k] = (meshArea > 0.0f) ? meshCentroid[k] / meshArea : 0.0f;
+	}
+
+	// The clusters facing away from the center hide the others, so they are drawn first
+	for (Cluster& cluster : clusters)
+	{
+		const float normalLength = sqrtf(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+		if (cluster.area > 0.0f && normalLength > 0.0f)
+		{
+			float dot = 0.0f;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				dot += (cluster.centroid[k] / cluster.area - meshCentroid[k]) * cluster.normal[k];
+			}
+			cluster.sortKey = dot / normalLength;
+		}
+	}
+	std::vector<uint32_t> order(clusterCount);
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&clusters](uint32_t left, uint32_t right) { return clusters[left].sortKey > clusters[right].sortKey; });
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	for (uint32_t c : order)
+	{
+		output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+	}
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::optimizeVertexFetch(float* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t* indices, uint32_t indexCount)
+{
+	const uint32_t unused = ~0u;
+	std::vector<uint32_t> remap(vertexCount, unused);
+	uint32_t nextVertex = 0;
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		if (remap[indices[i]] == unused)
+		{
+			remap[indices[i]] = nextVertex++;
+		}
+		indices[i] = remap[indices[i]];
+	}
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		if (remap[vertex] == unused)
+		{
+			remap[vertex] = nextVertex++;
+		}
+	}
+
+	std::vector<float> reordered(vertexCount * vertexStride);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		std::copy(vertexData + vertex * vertexStride, vertexData + (vertex + 1) * vertexStride, reordered.begin() + remap[vertex] * vertexStride);
+	}
+	std::copy(reordered.begin(), reordered.end(), vertexData);
+}
+
+MeshCacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	MeshCacheStats stats = { 0.0f, 0.0f };
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	FifoCache fifoCache(vertexCount, cacheSize);
+	uint32_t misses = 0;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		misses += fifoCache.addTriangle(&indices[triangle * 3]);
+	}
+	stats.acmr = (float)misses / triangleCount;
+	stats.atvr = (float)misses / vertexCount;
+	return stats;
+}
+
+} // namespace nu
\ No newline at end of file
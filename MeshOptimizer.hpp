@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// TODO : Meshlets for the mesh shaders
+
+namespace nu
+{
+
+struct MeshCacheStats
+{
+	float acmr; // Average cache miss ratio : vertex shader invocations per triangle, 0.5 at best for big regular meshes, 3 at worst
+	float atvr; // Average transformed vertex ratio : vertex shader invocations per vertex, 1 at best
+};
+
+// CPU only and deterministic passes on an indexed triangle list, so the same mesh is always optimized the same way
+// The indices are relative to the first vertex of the range they use
+class MeshOptimizer
+{
+	public:
+		static const uint32_t DefaultAnalyzeCacheSize = 16; // FIFO, close to the post-transform caches of most GPUs
+		static const uint32_t OptimizeCacheSize = 32; // LRU model of the Forsyth algorithm
+
+		// Reorders the triangles for the post-transform vertex cache (Tom Forsyth's linear-speed vertex cache optimisation)
+		static void optimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+		// Splits the triangles in clusters which stay about as cache efficient as the whole list, then sorts the clusters so the ones facing away from the center are drawn first
+		// Call after optimizeVertexCache, the threshold is the ACMR allowed for the clusters relative to the whole list
+		// The positions are the 3 first floats of each vertex, the stride is in floats
+		static void optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const float* vertexData, uint32_t vertexStride, uint32_t vertexCount, float threshold = 1.05f);
+
+		// Reorders the vertices in the order of their first use, the unused vertices are moved at the end
+		// The stride is in floats, the indices are updated to the new order
+		static void optimizeVertexFetch(float* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t* indices, uint32_t indexCount);
+
+		static MeshCacheStats analyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = DefaultAnalyzeCacheSize);
+};
+
+} // namespace nu
\ No newline at end of file
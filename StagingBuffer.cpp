@@ -1,16 +1,16 @@
 #include "StagingBuffer.hpp"
 
-#include "UniformBuffer.hpp"
+#include <algorithm>
 
 namespace nu
 {
 
-StagingBuffer::Ptr StagingBuffer::createStagingBuffer(VulkanBuffer& dstBuffer)
+StagingBuffer::Ptr StagingBuffer::createStagingBuffer(VulkanDevice& device, VkDeviceSize frameBudget, uint32_t framesCount)
 {
-	StagingBuffer::Ptr stagingBuffer = StagingBuffer::Ptr(new StagingBuffer(dstBuffer));
+	StagingBuffer::Ptr stagingBuffer = StagingBuffer::Ptr(new StagingBuffer(frameBudget, framesCount));
 	if (stagingBuffer != nullptr)
 	{
-		if (!stagingBuffer->init())
+		if (!stagingBuffer->init(device))
 		{
 			stagingBuffer.reset();
 		}
@@ -22,112 +22,229 @@ StagingBuffer::~StagingBuffer()
 {
 }
 
-bool StagingBuffer::map(uint32_t offset, uint32_t size)
+void StagingBuffer::beginFrame(uint32_t frameIndex)
 {
-	assert(mBuffer->isBoundToMemoryBlock());
-	return mBuffer->getMemoryBlock()->map(offset, size);
-}
+	assert(frameIndex < mFrameEnds.size());
 
-bool StagingBuffer::read(void* data)
-{
-	assert(mBuffer->isBoundToMemoryBlock());
-	return mBuffer->getMemoryBlock()->read(data);
+	mTail = std::max(mTail, mFrameEnds[frameIndex]);
 }
 
-bool StagingBuffer::write(const void* data)
-{
-	assert(mBuffer->isBoundToMemoryBlock());
-	return mBuffer->getMemoryBlock()->write(data);
-}
-
-bool StagingBuffer::unmap()
-{
-	assert(mBuffer->isBoundToMemoryBlock());
-	return mBuffer->getMemoryBlock()->unmap();
-}
-
-bool StagingBuffer::mapWriteUnmap(uint32_t offset, uint32_t dataSize, void* data, bool unmap, void** readPointer)
+bool StagingBuffer::write(VulkanBuffer& dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* data, VkAccessFlags dstAccess, VkPipelineStageFlags dstStages)
 {
 	assert(mBuffer->isBoundToMemoryBlock());
+	assert(dstOffset + dataSize <= dstBuffer.getSize());
 
 	VulkanMemoryBlock* memoryBlock = mBuffer->getMemoryBlock();
-	if (!memoryBlock->map(offset, dataSize))
-	{
-		return false;
-	}
-	if (readPointer != nullptr)
+	const VkDeviceSize memoryOffset = mBuffer->getOffsetInMemoryBlock();
+
+	// Pending regions of a destination never overlap, so their order in the copy does not matter
+	// The new data replaces the pending data of the same range
+	const VkDeviceSize dstEnd = dstOffset + dataSize;
+	for (size_t i = 0; i < mPendingCopies.size(); )
 	{
-		if (!memoryBlock->read(&readPointer))
+		PendingCopy& pending = mPendingCopies[i];
+		VkBufferCopy& region = pending.region;
+		const VkDeviceSize regionEnd = region.dstOffset + region.size;
+		if (pending.dstBuffer != &dstBuffer || regionEnd <= dstOffset || dstEnd <= region.dstOffset)
 		{
-			return false;
+			i++;
+			continue;
+		}
+
+		if (region.dstOffset <= dstOffset && dstEnd <= regionEnd)
+		{
+			// Already staged : overwrite the staged data
+			pending.dstAccess |= dstAccess;
+			pending.dstStages |= dstStages;
+			return memoryBlock->writeRange(memoryOffset + region.srcOffset + (dstOffset - region.dstOffset), dataSize, data, false);
+		}
+
+		// Keep only the parts of the pending region outside of the new range
+		PendingCopy right = pending;
+		right.region.srcOffset += dstEnd - region.dstOffset;
+		right.region.dstOffset = dstEnd;
+		right.region.size = (regionEnd > dstEnd) ? regionEnd - dstEnd : 0;
+		region.size = (dstOffset > region.dstOffset) ? dstOffset - region.dstOffset : 0;
+		if (region.size == 0)
+		{
+			mPendingCopies.erase(mPendingCopies.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+		if (right.region.size > 0)
+		{
+			mPendingCopies.insert(mPendingCopies.begin() + i, right);
+			i++;
 		}
 	}
-	if (!memoryBlock->write(data))
+
+	VkDeviceSize srcOffset;
+	if (!allocate(dataSize, srcOffset))
 	{
 		return false;
 	}
-	if (unmap)
+
+	// The flush is done once for all the writes in send()
+	if (!memoryBlock->writeRange(memoryOffset + srcOffset, dataSize, data, false))
 	{
-		memoryBlock->unmap();
+		return false;
 	}
 
-	mNeedToSend = true;
+	mPendingCopies.push_back({
+		&dstBuffer,               // VulkanBuffer*          dstBuffer
+		dstAccess,                // VkAccessFlags          dstAccess
+		dstStages,                // VkPipelineStageFlags   dstStages
+		{
+			srcOffset,                // VkDeviceSize     srcOffset
+			dstOffset,                // VkDeviceSize     dstOffset
+			dataSize                  // VkDeviceSize     size
+		},
+		static_cast<uint32_t>(mPendingCopies.size())  // uint32_t   order
+	});
 
 	return true;
 }
 
-void StagingBuffer::send(VulkanCommandBuffer* commandBuffer)
+void StagingBuffer::send(VulkanCommandBuffer* commandBuffer, uint32_t frameIndex)
 {
-	mNeedToSend = false;
-
-	VulkanBufferTransition preTransferTransition = {
-		&mDstBuffer,                  // Buffer*          buffer
-		VK_ACCESS_UNIFORM_READ_BIT,   // VkAccessFlags    currentAccess
-		VK_ACCESS_TRANSFER_WRITE_BIT, // VkAccessFlags    newAccess
-		VK_QUEUE_FAMILY_IGNORED,      // uint32_t         currentQueueFamily
-		VK_QUEUE_FAMILY_IGNORED       // uint32_t         newQueueFamily
-	};
-	commandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, { preTransferTransition });
-
-	std::vector<VkBufferCopy> regions = {
+	assert(frameIndex < mFrameEnds.size());
+
+	// Everything allocated until now is read by this frame
+	mFrameEnds[frameIndex] = mHead;
+
+	if (mPendingCopies.empty())
+	{
+		return;
+	}
+
+	mBuffer->getMemoryBlock()->flush();
+
+	// Group the regions by destination, ordered by destination offset
+	// The writes order is kept for overlapping regions, std::stable_sort would allocate
+	std::sort(mPendingCopies.begin(), mPendingCopies.end(), [](const PendingCopy& a, const PendingCopy& b)
+	{
+		if (a.dstBuffer != b.dstBuffer)
+		{
+			return a.dstBuffer < b.dstBuffer;
+		}
+		if (a.region.dstOffset != b.region.dstOffset)
 		{
-			0,                        // VkDeviceSize     srcOffset
-			0,                        // VkDeviceSize     dstOffset
-			mBuffer->getSize()        // VkDeviceSize     size
+			return a.region.dstOffset < b.region.dstOffset;
 		}
-	};
-	// TODO : Use srcOffset & dstOffset
-	commandBuffer->copyDataBetweenBuffers(mBuffer.get(), &mDstBuffer, regions);
-
-	VulkanBufferTransition postTransferTransition = {
-		&mDstBuffer,                  // Buffer*          buffer
-		VK_ACCESS_TRANSFER_WRITE_BIT, // VkAccessFlags    currentAccess
-		VK_ACCESS_UNIFORM_READ_BIT,   // VkAccessFlags    newAccess
-		VK_QUEUE_FAMILY_IGNORED,      // uint32_t         currentQueueFamily
-		VK_QUEUE_FAMILY_IGNORED       // uint32_t         newQueueFamily
-	};
-	commandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, { postTransferTransition });
+		return a.order < b.order;
+	});
+
+	// The current state of the destinations is tracked, all the barriers before the copies are sent at once
+	for (size_t i = 0; i < mPendingCopies.size(); i++)
+	{
+		if (i == 0 || mPendingCopies[i - 1].dstBuffer != mPendingCopies[i].dstBuffer)
+		{
+			commandBuffer->transitionBuffer(mPendingCopies[i].dstBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		}
+	}
+
+	// One copy per destination, contiguous regions are merged
+	for (size_t i = 0; i < mPendingCopies.size(); i++)
+	{
+		const PendingCopy& pending = mPendingCopies[i];
+		if (!mRegions.empty() && mRegions.back().srcOffset + mRegions.back().size == pending.region.srcOffset && mRegions.back().dstOffset + mRegions.back().size == pending.region.dstOffset)
+		{
+			mRegions.back().size += pending.region.size;
+		}
+		else
+		{
+			mRegions.push_back(pending.region);
+		}
+
+		if (i + 1 == mPendingCopies.size() || mPendingCopies[i + 1].dstBuffer != pending.dstBuffer)
+		{
+			commandBuffer->copyDataBetweenBuffers(mBuffer.get(), pending.dstBuffer, mRegions);
+			mRegions.clear();
+		}
+	}
+
+	// The barriers after the copies are sent with the next ones, before the render pass that reads the destinations
+	VkAccessFlags dstAccess = 0;
+	VkPipelineStageFlags dstStages = 0;
+	for (size_t i = 0; i < mPendingCopies.size(); i++)
+	{
+		const PendingCopy& pending = mPendingCopies[i];
+		dstAccess |= pending.dstAccess;
+		dstStages |= pending.dstStages;
+		if (i + 1 == mPendingCopies.size() || mPendingCopies[i + 1].dstBuffer != pending.dstBuffer)
+		{
+			commandBuffer->transitionBuffer(pending.dstBuffer, dstAccess, dstStages);
+			dstAccess = 0;
+			dstStages = 0;
+		}
+	}
+
+	mPendingCopies.clear();
 }
 
 bool StagingBuffer::needToSend() const
 {
-	return mNeedToSend;
+	return !mPendingCopies.empty();
+}
+
+VkDeviceSize StagingBuffer::getSize() const
+{
+	return mSize;
+}
+
+VkDeviceSize StagingBuffer::getUsedSize() const
+{
+	return static_cast<VkDeviceSize>(mHead - mTail);
 }
 
-StagingBuffer::StagingBuffer(VulkanBuffer& dstBuffer)
-	: mDstBuffer(dstBuffer)
-	, mBuffer(nullptr)
-	, mNeedToSend(false)
+StagingBuffer::StagingBuffer(VkDeviceSize frameBudget, uint32_t framesCount)
+	: mBuffer(nullptr)
+	, mSize(frameBudget * framesCount)
+	, mHead(0)
+	, mTail(0)
+	, mFrameEnds(framesCount, 0)
+	, mPendingCopies()
+	, mRegions()
 {
 }
 
-bool StagingBuffer::init()
+bool StagingBuffer::init(VulkanDevice& device)
 {
-	mBuffer = mDstBuffer.getDevice().createBuffer(mDstBuffer.getSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	mBuffer = device.createBuffer(mSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
 	if (!mBuffer || !mBuffer->allocateMemoryBlock(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
 	{
 		return false;
 	}
+	if (!mBuffer->getMemoryBlock()->isPersistentlyMapped() && !mBuffer->getMemoryBlock()->mapPersistently())
+	{
+		return false;
+	}
+	return true;
+}
+
+bool StagingBuffer::allocate(VkDeviceSize size, VkDeviceSize& offset)
+{
+	const VulkanU64 alignment = 16;
+
+	VulkanU64 head = (mHead + alignment - 1) / alignment * alignment;
+	VulkanU64 position = head % mSize;
+	if (position + size > mSize)
+	{
+		// Not enough space before the end of the buffer : skip to the beginning
+		head += mSize - position;
+		position = 0;
+	}
+
+	if (head + size - mTail > mSize)
+	{
+		printf("StagingBuffer is full (%u bytes requested, %u bytes used)\n", static_cast<uint32_t>(size), static_cast<uint32_t>(getUsedSize()));
+		return false;
+	}
+
+	mHead = head + size;
+	offset = static_cast<VkDeviceSize>(position);
 	return true;
 }
 
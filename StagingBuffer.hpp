@@ -8,38 +8,63 @@
 
 #include <memory>
 
+// TODO : Images destinations
+// TODO : Grow when the budget is too small instead of failing
+
 namespace nu
 {
 
-class UniformBuffer;
+// One persistently mapped buffer used as a ring by all the frames in flight
+// Writes are bump-allocated, then sent with one copy per destination buffer
+// The memory used by a frame is reused once the fence of this frame slot has been waited
 class StagingBuffer
 {
 	public:
 		typedef std::unique_ptr<StagingBuffer> Ptr;
 
-		static StagingBuffer::Ptr createStagingBuffer(VulkanBuffer& dstBuffer);
+		static StagingBuffer::Ptr createStagingBuffer(VulkanDevice& device, VkDeviceSize frameBudget, uint32_t framesCount);
 
 		~StagingBuffer();
 
-		bool map(uint32_t offset, uint32_t size);
-		bool read(void* data);
-		bool write(const void* data);
-		bool unmap();
+		// Call once the fence of the frame slot has been waited, the memory sent with this slot is released
+		void beginFrame(uint32_t frameIndex);
 
-		bool mapWriteUnmap(uint32_t offset, uint32_t dataSize, void* data, bool unmap = true, void** pointer = nullptr);
+		bool write(VulkanBuffer& dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* data, VkAccessFlags dstAccess = VK_ACCESS_UNIFORM_READ_BIT, VkPipelineStageFlags dstStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
 
-		void send(VulkanCommandBuffer* commandBuffer);
+		void send(VulkanCommandBuffer* commandBuffer, uint32_t frameIndex);
 
 		bool needToSend() const;
 
+		VkDeviceSize getSize() const;
+		VkDeviceSize getUsedSize() const;
+
 	private:
-		StagingBuffer(VulkanBuffer& dstBuffer);
+		StagingBuffer(VkDeviceSize frameBudget, uint32_t framesCount);
+
+		bool init(VulkanDevice& device);
+
+		bool allocate(VkDeviceSize size, VkDeviceSize& offset);
 
-		bool init();
+		struct PendingCopy
+		{
+			VulkanBuffer* dstBuffer;
+			VkAccessFlags dstAccess;
+			VkPipelineStageFlags dstStages;
+			VkBufferCopy region;
+			uint32_t order;
+		};
 
-		VulkanBuffer& mDstBuffer;
 		VulkanBufferPtr mBuffer;
-		bool mNeedToSend;
+		VkDeviceSize mSize;
+
+		// Positions are increasing forever, the position in the buffer is position % mSize
+		VulkanU64 mHead;
+		VulkanU64 mTail;
+		std::vector<VulkanU64> mFrameEnds;
+
+		std::vector<PendingCopy> mPendingCopies;
+
+		std::vector<VkBufferCopy> mRegions; // Scratch storage of send(), keeps its capacity between frames
 };
 
 } // namespace nu
\ No newline at end of file
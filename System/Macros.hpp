@@ -77,7 +77,7 @@ namespace priv
 template <typename T, typename M> M getMemberType(M T::*);
 template <typename T, typename M> T getClassType(M T::*);
 
-template <typename T, typename R, typename R T::*M>
+template <typename T, typename R, R T::*M>
 constexpr std::size_t OffsetOf()
 {
 	return reinterpret_cast<std::size_t>(&((static_cast<T*>(0))->*M));
@@ -1,9 +1,13 @@
 #include "UnitTest.hpp"
 
+#include <cassert>
+
 namespace nu
 {
 
-UnitTest::UnitTest(char* name)
+U32 UnitTest::sFailedCheckCount = 0;
+
+UnitTest::UnitTest(const char* name)
 	: mName(name)
 	, mCurrentTitle(nullptr)
 	, mTests()
@@ -15,7 +19,7 @@ UnitTest::~UnitTest()
 {
 }
 
-void UnitTest::start(char* title)
+void UnitTest::start(const char* title)
 {
 	mTests.emplace_back(title);
 	mCurrentTitle = title;
@@ -30,6 +34,7 @@ void UnitTest::check(bool passed, const char* expr, const char* file, I32 line)
 	else
 	{
 		mTests.back().failed++;
+		sFailedCheckCount++;
 		printf("\n[ERROR][%s] Check failed : %s (%s:%d)\n\n", mCurrentTitle, expr, file, line);
 	}
 }
@@ -47,7 +52,7 @@ void UnitTest::print()
 			printf(" ---> SUCCESS");
 			success++;
 		}
-		else if (mTests[i].passed > 0)
+		else if (mTests[i].failed > 0)
 		{
 			printf(" ---> FAILED");
 			failed++;
@@ -61,25 +66,30 @@ void UnitTest::print()
 	{
 		printf(" ---> SUCCESS");
 	}
-	else if (success > 0)
+	else if (failed > 0)
 	{
 		printf(" ---> FAILED");
 	}
 	printf("\n====================================\n\n");
 }
 
-char* UnitTest::getName()
+const char* UnitTest::getName()
 {
 	return mName;
 }
 
-char* UnitTest::getTitle()
+const char* UnitTest::getTitle()
 {
 	assert(mCurrentTitle != nullptr);
 	return mCurrentTitle;
 }
 
-UnitTest::Test::Test(char* pTitle)
+U32 UnitTest::getFailedCheckCount()
+{
+	return sFailedCheckCount;
+}
+
+UnitTest::Test::Test(const char* pTitle)
 	: title(pTitle)
 	, passed(0)
 	, failed(0)
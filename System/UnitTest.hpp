@@ -21,31 +21,36 @@ namespace nu
 class UnitTest
 {
 	public:
-		UnitTest(char* name);
+		UnitTest(const char* name);
 		~UnitTest();
 
-		void start(char* title);
+		void start(const char* title);
 
 		void check(bool passed, const char* expr, const char* file, I32 line);
 
 		void print();
 
-		char* getName();
-		char* getTitle();
+		const char* getName();
+		const char* getTitle();
+
+		// Failed checks of all the tests run by the program, so the program can return an error code
+		static U32 getFailedCheckCount();
 
 	private:
 		struct Test
 		{
-			Test(char* pTitle);
+			Test(const char* pTitle);
 
-			char* title;
+			const char* title;
 			U32 passed;
 			U32 failed;
 		};
 
-		char* mName;
-		char* mCurrentTitle;
+		const char* mName;
+		const char* mCurrentTitle;
 		std::vector<Test> mTests;
+
+		static U32 sFailedCheckCount;
 };
 
 } // namespace nu
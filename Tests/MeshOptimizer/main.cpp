@@ -0,0 +1,146 @@
+#include "../../MeshOptimizer.hpp"
+#include "../../System/UnitTest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Optimizes a generated grid whose triangles are shuffled, and checks after each pass that every triangle is still there with its winding
+// and that the vertex cache is not used worse than before
+// Returns 0 when every check passes, the failed checks are printed
+
+// Position and original index of the vertex, so the triangles can be compared after the vertices are reordered
+static const uint32_t VertexStride = 4;
+
+struct Triangle
+{
+	uint32_t vertices[3];
+
+	bool operator<(const Triangle& other) const
+	{
+		return std::lexicographical_compare(vertices, vertices + 3, other.vertices, other.vertices + 3);
+	}
+	bool operator==(const Triangle& other) const
+	{
+		return std::equal(vertices, vertices + 3, other.vertices);
+	}
+};
+
+// Rows of quads on a bumpy surface, the unused vertices at the end must stay at the end after optimizeVertexFetch
+void generateGrid(uint32_t size, uint32_t unusedVertexCount, std::vector<float>& vertexData, std::vector<uint32_t>& indices)
+{
+	const uint32_t vertexCount = size * size + unusedVertexCount;
+	vertexData.resize(vertexCount * VertexStride);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const float x = static_cast<float>(vertex % size) / (size - 1) * 2.0f - 1.0f;
+		const float y = static_cast<float>(vertex / size) / (size - 1) * 2.0f - 1.0f;
+		vertexData[vertex * VertexStride + 0] = x;
+		vertexData[vertex * VertexStride + 1] = y;
+		vertexData[vertex * VertexStride + 2] = 0.25f * std::sin(4.0f * x) * std::cos(4.0f * y);
+		vertexData[vertex * VertexStride + 3] = static_cast<float>(vertex);
+	}
+
+	indices.clear();
+	for (uint32_t row = 0; row + 1 < size; row++)
+	{
+		for (uint32_t column = 0; column + 1 < size; column++)
+		{
+			const uint32_t vertex = row * size + column;
+			const uint32_t quad[6] = { vertex, vertex + 1, vertex + size, vertex + 1, vertex + size + 1, vertex + size };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+// Fixed seed, so the test is the same on every run
+void shuffleTriangles(std::vector<uint32_t>& indices)
+{
+	uint32_t seed = 12345;
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	for (uint32_t i = triangleCount - 1; i > 0; i--)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		const uint32_t j = (seed >> 8) % (i + 1);
+		std::swap_ranges(&indices[i * 3], &indices[i * 3 + 3], &indices[j * 3]);
+	}
+}
+
+// Triangles by original vertex index, rotated so the smallest index is first to keep the winding, then sorted
+std::vector<Triangle> getTriangles(const std::vector<float>& vertexData, const std::vector<uint32_t>& indices)
+{
+	std::vector<Triangle> triangles(indices.size() / 3);
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		uint32_t* vertices = triangles[i].vertices;
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			vertices[j] = static_cast<uint32_t>(vertexData[indices[i * 3 + j] * VertexStride + 3]);
+		}
+		std::rotate(vertices, std::min_element(vertices, vertices + 3), vertices + 3);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+void testGrid(nu::UnitTest& unitTest, uint32_t size, uint32_t unusedVertexCount)
+{
+	std::vector<float> vertexData;
+	std::vector<uint32_t> indices;
+	generateGrid(size, unusedVertexCount, vertexData, indices);
+	shuffleTriangles(indices);
+
+	const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / VertexStride);
+	const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+	const std::vector<Triangle> triangles = getTriangles(vertexData, indices);
+
+	const nu::MeshCacheStats shuffledStats = nu::MeshOptimizer::analyzeVertexCache(indices.data(), indexCount, vertexCount);
+
+	nu::MeshOptimizer::optimizeVertexCache(indices.data(), indexCount, vertexCount);
+	CHECK(getTriangles(vertexData, indices) == triangles);
+	const nu::MeshCacheStats cacheStats = nu::MeshOptimizer::analyzeVertexCache(indices.data(), indexCount, vertexCount);
+	CHECK(cacheStats.acmr <= shuffledStats.acmr);
+	CHECK(cacheStats.acmr < 1.0f); // A regular grid is well below one vertex per triangle once optimized
+
+	const float threshold = 1.05f;
+	nu::MeshOptimizer::optimizeOverdraw(indices.data(), indexCount, vertexData.data(), VertexStride, vertexCount, threshold);
+	CHECK(getTriangles(vertexData, indices) == triangles);
+	const nu::MeshCacheStats overdrawStats = nu::MeshOptimizer::analyzeVertexCache(indices.data(), indexCount, vertexCount);
+	CHECK(overdrawStats.acmr <= shuffledStats.acmr);
+
+	// The vertex order doesn't change the cache hits, only the order of the fetches
+	nu::MeshOptimizer::optimizeVertexFetch(vertexData.data(), VertexStride, vertexCount, indices.data(), indexCount);
+	CHECK(getTriangles(vertexData, indices) == triangles);
+	const nu::MeshCacheStats fetchStats = nu::MeshOptimizer::analyzeVertexCache(indices.data(), indexCount, vertexCount);
+	CHECK(fetchStats.acmr == overdrawStats.acmr);
+	uint32_t nextVertex = 0;
+	bool firstUseOrder = true;
+	for (uint32_t index : indices)
+	{
+		firstUseOrder &= index <= nextVertex;
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+	CHECK(firstUseOrder);
+	CHECK(nextVertex == size * size);
+	for (uint32_t vertex = size * size; vertex < vertexCount; vertex++)
+	{
+		CHECK(static_cast<uint32_t>(vertexData[vertex * VertexStride + 3]) >= size * size);
+	}
+
+	printf("MeshOptimizer : %ux%u grid, ACMR %.3f shuffled, %.3f for the vertex cache, %.3f for the overdraw (ATVR %.3f)\n", size, size, shuffledStats.acmr, cacheStats.acmr, overdrawStats.acmr, fetchStats.atvr);
+}
+
+BEGIN_TEST(MeshOptimizer)
+	TEST("16x16 grid");
+	testGrid(unitTest, 16, 0);
+	TEST("64x64 grid with unused vertices");
+	testGrid(unitTest, 64, 5);
+	TEST("181x181 grid with an unused vertex");
+	testGrid(unitTest, 181, 1);
+END_TEST
+
+int main()
+{
+	RUN_TEST(MeshOptimizer);
+	return (nu::UnitTest::getFailedCheckCount() > 0) ? 1 : 0;
+}
\ No newline at end of file
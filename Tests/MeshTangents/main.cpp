@@ -0,0 +1,250 @@
+#include "../../Mesh.hpp"
+#include "../../System/UnitTest.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Generates the tangent space vectors of the same meshes with the SSE and the scalar code, and compares both with the previous implementation
+// The meshes have several parts whose sizes are not multiples of 4, so the scalar code also handles the remainders of the SSE loops
+// Returns 0 when the results match, the failed checks are printed
+
+// The previous implementation, for the layout of the test meshes (positions, normals, texcoords, tangents and bitangents)
+// The non-indexed meshes are walked triangle by triangle, the indexed meshes accumulate the face vectors of the shared vertices
+namespace reference
+{
+
+const size_t NormalOffset = 3;
+const size_t TexcoordOffset = 6;
+const size_t TangentOffset = 8;
+const size_t BitangentOffset = 11;
+const size_t Stride = BitangentOffset + 3;
+
+void calculateTangentAndBitangent(const float* normalData, const nu::Vector3f& faceTangent, const nu::Vector3f& faceBitangent, float* tangentData, float* bitangentData)
+{
+	// Gram-Schmidt orthogonalize
+	const nu::Vector3f normal = { normalData[0], normalData[1], normalData[2] };
+	const nu::Vector3f tangent = (faceTangent - normal * normal.dotProduct(faceTangent)).normalized();
+
+	// Calculate handedness
+	float handedness = (normal.crossProduct(tangent).dotProduct(faceBitangent) < 0.0f) ? -1.0f : 1.0f;
+
+	const nu::Vector3f bitangent = handedness * normal.crossProduct(tangent);
+
+	tangentData[0] = tangent[0];
+	tangentData[1] = tangent[1];
+	tangentData[2] = tangent[2];
+
+	bitangentData[0] = bitangent[0];
+	bitangentData[1] = bitangent[1];
+	bitangentData[2] = bitangent[2];
+}
+
+void calculateFaceVectors(const std::vector<float>& data, size_t i1, size_t i2, size_t i3, nu::Vector3f& faceTangent, nu::Vector3f& faceBitangent)
+{
+	const nu::Vector3f v1 = { data[i1], data[i1 + 1], data[i1 + 2] };
+	const nu::Vector3f v2 = { data[i2], data[i2 + 1], data[i2 + 2] };
+	const nu::Vector3f v3 = { data[i3], data[i3 + 1], data[i3 + 2] };
+
+	const std::array<float, 2> w1 = { data[i1 + TexcoordOffset], data[i1 + TexcoordOffset + 1] };
+	const std::array<float, 2> w2 = { data[i2 + TexcoordOffset], data[i2 + TexcoordOffset + 1] };
+	const std::array<float, 2> w3 = { data[i3 + TexcoordOffset], data[i3 + TexcoordOffset + 1] };
+
+	float x1 = v2[0] - v1[0];
+	float x2 = v3[0] - v1[0];
+	float y1 = v2[1] - v1[1];
+	float y2 = v3[1] - v1[1];
+	float z1 = v2[2] - v1[2];
+	float z2 = v3[2] - v1[2];
+
+	float s1 = w2[0] - w1[0];
+	float s2 = w3[0] - w1[0];
+	float t1 = w2[1] - w1[1];
+	float t2 = w3[1] - w1[1];
+
+	float r = 1.0f / (s1 * t2 - s2 * t1);
+	faceTangent = { (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r };
+	faceBitangent = { (s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r };
+}
+
+void generateTangentSpaceVectors(std::vector<float>& data)
+{
+	for (size_t i = 0; i < data.size(); i += Stride * 3) 
+	{
+		size_t i1 = i;
+		size_t i2 = i1 + Stride;
+		size_t i3 = i2 + Stride;
+		nu::Vector3f faceTangent;
+		nu::Vector3f faceBitangent;
+		calculateFaceVectors(data, i1, i2, i3, faceTangent, faceBitangent);
+
+		calculateTangentAndBitangent(&data[i1 + NormalOffset], faceTangent, faceBitangent, &data[i1 + TangentOffset], &data[i1 + BitangentOffset]);
+		calculateTangentAndBitangent(&data[i2 + NormalOffset], faceTangent, faceBitangent, &data[i2 + TangentOffset], &data[i2 + BitangentOffset]);
+		calculateTangentAndBitangent(&data[i3 + NormalOffset], faceTangent, faceBitangent, &data[i3 + TangentOffset], &data[i3 + BitangentOffset]);
+	}
+}
+
+void generateIndexedTangentSpaceVectors(std::vector<float>& data, const std::vector<uint32_t>& indices)
+{
+	const size_t vertexCount = data.size() / Stride;
+	std::vector<nu::Vector3f> tangents(vertexCount, nu::Vector3f(0.0f));
+	std::vector<nu::Vector3f> bitangents(vertexCount, nu::Vector3f(0.0f));
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) 
+	{
+		const uint32_t vertices[3] = { indices[i], indices[i + 1], indices[i + 2] };
+		nu::Vector3f faceTangent;
+		nu::Vector3f faceBitangent;
+		calculateFaceVectors(data, vertices[0] * Stride, vertices[1] * Stride, vertices[2] * Stride, faceTangent, faceBitangent);
+
+		for (uint32_t vertex : vertices)
+		{
+			tangents[vertex] += faceTangent;
+			bitangents[vertex] += faceBitangent;
+		}
+	}
+
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		size_t i = vertex * Stride;
+		calculateTangentAndBitangent(&data[i + NormalOffset], tangents[vertex], bitangents[vertex], &data[i + TangentOffset], &data[i + BitangentOffset]);
+	}
+}
+
+} // namespace reference
+
+// Bumpy grid with texcoords stretched unevenly, so the face vectors differ between the triangles
+void addGridPart(nu::Mesh& mesh, bool indexed, uint32_t width, uint32_t height)
+{
+	const uint32_t vertexOffset = static_cast<uint32_t>(mesh.data.size() / mesh.stride);
+	auto writeVertex = [&mesh](uint32_t column, uint32_t row)
+	{
+		const float u = static_cast<float>(column) / 7.0f;
+		const float v = static_cast<float>(row) / 5.0f;
+		const float height = 0.3f * std::sin(2.0f * u + 3.0f * v);
+		const float normal[3] = { -0.6f * std::cos(2.0f * u + 3.0f * v), -0.9f * std::cos(2.0f * u + 3.0f * v), 1.0f };
+		const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		const float vertex[14] = { u, v, height, normal[0] / length, normal[1] / length, normal[2] / length, u * u + 0.5f * u, v + 0.25f * u * v, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		mesh.data.insert(mesh.data.end(), vertex, vertex + 14);
+	};
+
+	nu::Mesh::Part part = {};
+	part.vertexOffset = vertexOffset;
+	if (indexed)
+	{
+		for (uint32_t row = 0; row < height; row++)
+		{
+			for (uint32_t column = 0; column < width; column++)
+			{
+				writeVertex(column, row);
+			}
+		}
+		part.vertexCount = width * height;
+		part.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+		for (uint32_t row = 0; row + 1 < height; row++)
+		{
+			for (uint32_t column = 0; column + 1 < width; column++)
+			{
+				const uint32_t vertex = vertexOffset + row * width + column;
+				const uint32_t quad[6] = { vertex, vertex + 1, vertex + width, vertex + 1, vertex + width + 1, vertex + width };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		part.indexCount = static_cast<uint32_t>(mesh.indices.size()) - part.indexOffset;
+	}
+	else
+	{
+		for (uint32_t row = 0; row + 1 < height; row++)
+		{
+			for (uint32_t column = 0; column + 1 < width; column++)
+			{
+				writeVertex(column, row);
+				writeVertex(column + 1, row);
+				writeVertex(column, row + 1);
+				writeVertex(column + 1, row);
+				writeVertex(column + 1, row + 1);
+				writeVertex(column, row + 1);
+			}
+		}
+		part.vertexCount = static_cast<uint32_t>(mesh.data.size() / mesh.stride) - vertexOffset;
+	}
+	mesh.parts.push_back(part);
+}
+
+// Number of vertices whose tangent space vectors are not bit-identical to the reference
+uint32_t countDifferentVertices(const nu::Mesh& mesh, const std::vector<float>& referenceData)
+{
+	uint32_t differentVertices = 0;
+	for (uint32_t vertex = 0; vertex < mesh.getVertexCount(); vertex++)
+	{
+		const size_t offset = vertex * mesh.stride + reference::TangentOffset;
+		differentVertices += (memcmp(&mesh.data[offset], &referenceData[offset], 6 * sizeof(float)) != 0) ? 1 : 0;
+	}
+	return differentVertices;
+}
+
+void testMesh(nu::UnitTest& unitTest, bool indexed)
+{
+	nu::Mesh sseMesh;
+	sseMesh.stride = 14;
+	sseMesh.attributes = nu::Mesh::Positions | nu::Mesh::Normals | nu::Mesh::Texcoords | nu::Mesh::Tangents;
+	const uint32_t partSizes[][2] = { { 9, 7 }, { 2, 2 }, { 31, 17 }, { 4, 3 } };
+	for (const auto& partSize : partSizes)
+	{
+		addGridPart(sseMesh, indexed, partSize[0], partSize[1]);
+	}
+	CHECK(sseMesh.getAttributeOffset(nu::Mesh::Normals) == reference::NormalOffset && sseMesh.getAttributeOffset(nu::Mesh::Tangents) == reference::TangentOffset);
+
+	std::vector<float> referenceData = sseMesh.data;
+	if (indexed)
+	{
+		reference::generateIndexedTangentSpaceVectors(referenceData, sseMesh.indices);
+	}
+	else
+	{
+		reference::generateTangentSpaceVectors(referenceData);
+	}
+
+	nu::Mesh scalarMesh = sseMesh;
+	scalarMesh.useSse = false;
+	sseMesh.generateTangentSpaceVectors();
+	scalarMesh.generateTangentSpaceVectors();
+
+	// Same operations in the same order, so the results are bit-identical and not only close
+	const uint32_t vertexCount = sseMesh.getVertexCount();
+	const uint32_t sseDifferences = countDifferentVertices(sseMesh, referenceData);
+	const uint32_t scalarDifferences = countDifferentVertices(scalarMesh, referenceData);
+	CHECK(vertexCount > 0);
+	CHECK(sseDifferences == 0);
+	CHECK(scalarDifferences == 0);
+
+	const uint32_t normalOffset = sseMesh.getAttributeOffset(nu::Mesh::Normals);
+	const uint32_t tangentOffset = sseMesh.getAttributeOffset(nu::Mesh::Tangents);
+	bool orthonormal = true;
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const float* normal = &sseMesh.data[vertex * sseMesh.stride + normalOffset];
+		const float* tangent = &sseMesh.data[vertex * sseMesh.stride + tangentOffset];
+		const float tangentLength = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+		const float normalDot = normal[0] * tangent[0] + normal[1] * tangent[1] + normal[2] * tangent[2];
+		orthonormal &= std::fabs(tangentLength - 1.0f) < 1e-4f && std::fabs(normalDot) < 1e-4f;
+	}
+	CHECK(orthonormal);
+
+	printf("MeshTangents : %s mesh, %u vertices in %u parts, %u vertices differ from the previous implementation with SSE, %u without\n", indexed ? "indexed" : "non-indexed", vertexCount, static_cast<uint32_t>(sseMesh.parts.size()), sseDifferences, scalarDifferences);
+}
+
+BEGIN_TEST(MeshTangents)
+	TEST("Indexed mesh");
+	testMesh(unitTest, true);
+	TEST("Non-indexed mesh");
+	testMesh(unitTest, false);
+END_TEST
+
+int main()
+{
+	RUN_TEST(MeshTangents);
+	return (nu::UnitTest::getFailedCheckCount() > 0) ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "../../VulkanWrapper/VulkanRenderGraph.hpp"
+#include "../../System/UnitTest.hpp"
+
+#include <cstdio>
+
+// Compiles a small deferred frame on the CPU only and checks the culling, the barriers, the attachment operations and the aliasing
+// Returns 0 when every check passes, the failed checks are printed
+
+bool hasBarrier(const std::vector<VulkanRenderGraphBarrier>& barriers, VulkanU32 resource, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStages, VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+	for (const VulkanRenderGraphBarrier& barrier : barriers)
+	{
+		if (barrier.resource == resource)
+		{
+			return barrier.srcAccess == srcAccess && barrier.dstAccess == dstAccess && barrier.srcStages == srcStages && barrier.oldLayout == oldLayout && barrier.newLayout == newLayout;
+		}
+	}
+	return false;
+}
+
+bool hasAttachment(const std::vector<VulkanRenderGraphAttachment>& attachments, VulkanU32 resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp)
+{
+	for (const VulkanRenderGraphAttachment& attachment : attachments)
+	{
+		if (attachment.resource == resource)
+		{
+			return attachment.loadOp == loadOp && attachment.storeOp == storeOp;
+		}
+	}
+	return false;
+}
+
+void testDeferredFrame(nu::UnitTest& unitTest)
+{
+	const VkExtent2D size = { 1280, 720 };
+	const VkClearColorValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+	const VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+	const VkPipelineStageFlags colorStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	const VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+	VulkanRenderGraphPtr graph = VulkanRenderGraph::createRenderGraph();
+	const VulkanU32 backbuffer = graph->importImage("Backbuffer", VK_FORMAT_B8G8R8A8_UNORM, size, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	const VulkanU32 gbuffer = graph->createImage("GBuffer", VK_FORMAT_R8G8B8A8_UNORM, size, VK_IMAGE_ASPECT_COLOR_BIT);
+	const VulkanU32 depth = graph->createImage("Depth", VK_FORMAT_D32_SFLOAT, size, VK_IMAGE_ASPECT_DEPTH_BIT);
+	const VulkanU32 debug = graph->createImage("Debug", VK_FORMAT_R8G8B8A8_UNORM, size, VK_IMAGE_ASPECT_COLOR_BIT);
+	const VulkanU32 lighting = graph->createImage("Lighting", VK_FORMAT_R16G16B16A16_SFLOAT, size, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	const VulkanU32 gbufferPass = graph->addGraphicsPass("GBuffer", nullptr);
+	graph->addColorAttachment(gbufferPass, gbuffer, true, clearColor);
+	graph->addDepthStencilAttachment(gbufferPass, depth, true, clearDepth);
+
+	// Nothing reads the debug image, so this pass is culled
+	const VulkanU32 debugPass = graph->addGraphicsPass("Debug", nullptr);
+	graph->addColorAttachment(debugPass, debug, true, clearColor);
+
+	const VulkanU32 lightingPass = graph->addGraphicsPass("Lighting", nullptr);
+	graph->addSampledImage(lightingPass, gbuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	graph->addColorAttachment(lightingPass, lighting, true, clearColor);
+
+	const VulkanU32 compositePass = graph->addGraphicsPass("Composite", nullptr);
+	graph->addSampledImage(compositePass, lighting, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	graph->addColorAttachment(compositePass, backbuffer, true, clearColor);
+
+	const VulkanU32 interfacePass = graph->addGraphicsPass("Interface", nullptr);
+	graph->addColorAttachment(interfacePass, backbuffer, false, clearColor);
+
+	CHECK(graph->compile());
+	if (!graph->isCompiled())
+	{
+		return;
+	}
+
+	// Culling
+	CHECK(graph->isPassCulled(debugPass));
+	CHECK(!graph->isPassCulled(gbufferPass) && !graph->isPassCulled(lightingPass) && !graph->isPassCulled(compositePass) && !graph->isPassCulled(interfacePass));
+	const std::vector<VulkanU32>& executionOrder = graph->getExecutionOrder();
+	CHECK(executionOrder.size() == 4 && executionOrder[0] == gbufferPass && executionOrder[1] == lightingPass && executionOrder[2] == compositePass && executionOrder[3] == interfacePass);
+	CHECK(graph->getPassBarriers(debugPass).empty() && graph->getPassAttachments(debugPass).empty());
+
+	// Load and store operations : the depth and the debug images are never read, the backbuffer is kept for the presentation
+	CHECK(hasAttachment(graph->getPassAttachments(gbufferPass), gbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE));
+	CHECK(hasAttachment(graph->getPassAttachments(gbufferPass), depth, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE));
+	CHECK(hasAttachment(graph->getPassAttachments(lightingPass), lighting, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE));
+	CHECK(hasAttachment(graph->getPassAttachments(compositePass), backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE));
+	CHECK(hasAttachment(graph->getPassAttachments(interfacePass), backbuffer, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE));
+
+	// Aliasing : the depth image is dead after the first pass, so the lighting image takes its memory
+	CHECK(graph->getMemorySlot(backbuffer) == VulkanRenderGraph::InvalidIndex);
+	CHECK(graph->getMemorySlot(debug) == VulkanRenderGraph::InvalidIndex);
+	CHECK(graph->getMemorySlot(gbuffer) != VulkanRenderGraph::InvalidIndex && graph->getMemorySlot(depth) != VulkanRenderGraph::InvalidIndex);
+	CHECK(graph->getMemorySlot(gbuffer) != graph->getMemorySlot(depth));
+	CHECK(graph->getMemorySlot(lighting) == graph->getMemorySlot(depth));
+	CHECK(graph->getImageUsage(gbuffer) == (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
+	CHECK(graph->getImageUsage(depth) == VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+	// Barriers : an aliased image waits for the last use of the image it replaces, in the previous frame for the first one
+	const std::vector<VulkanRenderGraphBarrier>& gbufferBarriers = graph->getPassBarriers(gbufferPass);
+	CHECK(gbufferBarriers.size() == 2);
+	CHECK(hasBarrier(gbufferBarriers, gbuffer, 0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+	CHECK(hasBarrier(gbufferBarriers, depth, 0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+
+	const std::vector<VulkanRenderGraphBarrier>& lightingBarriers = graph->getPassBarriers(lightingPass);
+	CHECK(lightingBarriers.size() == 2);
+	CHECK(hasBarrier(lightingBarriers, gbuffer, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, colorStage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	CHECK(hasBarrier(lightingBarriers, lighting, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, depthStages, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+	const std::vector<VulkanRenderGraphBarrier>& compositeBarriers = graph->getPassBarriers(compositePass);
+	CHECK(compositeBarriers.size() == 2);
+	CHECK(hasBarrier(compositeBarriers, lighting, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, colorStage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	CHECK(hasBarrier(compositeBarriers, backbuffer, 0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, colorStage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+	const std::vector<VulkanRenderGraphBarrier>& interfaceBarriers = graph->getPassBarriers(interfacePass);
+	CHECK(interfaceBarriers.size() == 1);
+	CHECK(hasBarrier(interfaceBarriers, backbuffer, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, colorStage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+	const std::vector<VulkanRenderGraphBarrier>& finalBarriers = graph->getFinalBarriers();
+	CHECK(finalBarriers.size() == 1);
+	CHECK(hasBarrier(finalBarriers, backbuffer, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, 0, colorStage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR));
+
+	const VulkanRenderGraphStats& stats = graph->getStats();
+	CHECK(stats.passCount == 5 && stats.culledPassCount == 1);
+	CHECK(stats.barrierCount == 8 && stats.barrierBatchCount == 5);
+	CHECK(stats.transientImageCount == 3 && stats.memorySlotCount == 2);
+}
+
+void testReadBeforeWrite(nu::UnitTest& unitTest)
+{
+	const VkExtent2D size = { 256, 256 };
+	const VkClearColorValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+	// A transient image read before any write can't be compiled
+	VulkanRenderGraphPtr graph = VulkanRenderGraph::createRenderGraph();
+	const VulkanU32 source = graph->createImage("Source", VK_FORMAT_R8G8B8A8_UNORM, size, VK_IMAGE_ASPECT_COLOR_BIT);
+	const VulkanU32 target = graph->importImage("Target", VK_FORMAT_R8G8B8A8_UNORM, size, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	const VulkanU32 pass = graph->addGraphicsPass("Copy", nullptr);
+	graph->addSampledImage(pass, source, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	graph->addColorAttachment(pass, target, true, clearColor);
+	CHECK(!graph->compile());
+	CHECK(!graph->isCompiled());
+}
+
+BEGIN_TEST(RenderGraph)
+	TEST("Deferred frame");
+	testDeferredFrame(unitTest);
+	TEST("Read before write");
+	testReadBeforeWrite(unitTest);
+END_TEST
+
+int main()
+{
+	RUN_TEST(RenderGraph);
+	return (nu::UnitTest::getFailedCheckCount() > 0) ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "../../VulkanWrapper/VulkanShaderReflection.hpp"
+#include "../../System/UnitTest.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Reflects the shaders shipped with the examples and compares them with the layouts written by hand in the examples
+// Every binding, push constant block and vertex input used by the shaders must be declared by the layouts of their pipeline
+// The layouts can declare more stages than used, as the examples sometimes do
+// Returns 0 when every pipeline matches, the mismatches are printed
+
+struct ExpectedBinding
+{
+	VulkanU32 set;
+	VulkanU32 binding;
+	VkDescriptorType type;
+	VulkanU32 count;
+	VkShaderStageFlags stages;
+};
+
+struct ExpectedPipeline
+{
+	const char* name;
+	std::vector<const char*> shaders;
+	std::vector<ExpectedBinding> bindings;
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	std::vector<VkVertexInputAttributeDescription> attributes; // Only the location and the format are compared
+};
+
+static const VkShaderStageFlags Vertex = VK_SHADER_STAGE_VERTEX_BIT;
+static const VkShaderStageFlags Fragment = VK_SHADER_STAGE_FRAGMENT_BIT;
+static const VkShaderStageFlags Geometry = VK_SHADER_STAGE_GEOMETRY_BIT;
+static const VkShaderStageFlags Compute = VK_SHADER_STAGE_COMPUTE_BIT;
+static const VkShaderStageFlags Control = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+static const VkShaderStageFlags Evaluation = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+static const VkDescriptorType Uniform = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+static const VkDescriptorType Sampler = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+static const VkFormat Vec2 = VK_FORMAT_R32G32_SFLOAT;
+static const VkFormat Vec3 = VK_FORMAT_R32G32B32_SFLOAT;
+static const VkFormat Vec4 = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+// Copied from the examples, example 1 builds its layouts from the reflection so its shaders are checked with the layouts of example 11
+std::vector<ExpectedPipeline> getExpectedPipelines()
+{
+	return {
+		{ "11 - Model", { "1 - Vertex Diffuse Lightning/shader.vert.spv", "1 - Vertex Diffuse Lightning/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex } }, {}, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 } } },
+		{ "2 - Model", { "2 - Fragment Specular Lightning/shader.vert.spv", "2 - Fragment Specular Lightning/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 } } },
+		{ "3 - Model", { "3 - Normal Mapped Geometry/shader.vert.spv", "3 - Normal Mapped Geometry/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 }, { 2, 0, Vec2, 24 }, { 3, 0, Vec3, 32 }, { 4, 0, Vec3, 44 } } },
+		{ "4 - Model", { "4 - Reflective and Refractive Geometry Using Cubemaps/modelShader.vert.spv", "4 - Reflective and Refractive Geometry Using Cubemaps/modelShader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 } } },
+		{ "4 - Skybox", { "4 - Reflective and Refractive Geometry Using Cubemaps/skyboxShader.vert.spv", "4 - Reflective and Refractive Geometry Using Cubemaps/skyboxShader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 } } },
+		{ "5 - Scene", { "5 - Adding Shadows/scene.vert.spv", "5 - Adding Shadows/scene.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Vertex, 0, 16 } }, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 } } },
+		{ "5 - Shadow", { "5 - Adding Shadows/shadow.vert.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Vertex, 0, 16 } }, { { 0, 0, Vec3, 0 } } },
+		{ "6 - Skybox", { "6 - Drawing Skybox/shader.vert.spv", "6 - Drawing Skybox/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, {}, { { 0, 0, Vec3, 0 } } },
+		{ "7 - Billboards", { "7 - Drawing Billboards Using Geometry Shaders/shader.vert.spv", "7 - Drawing Billboards Using Geometry Shaders/shader.geom.spv", "7 - Drawing Billboards Using Geometry Shaders/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex | Geometry } }, {}, { { 0, 0, Vec3, 0 } } },
+		{ "8 - Particles", { "8 - Drawing Particles Using Compute And Graphics Pipelines/shader.vert.spv", "8 - Drawing Particles Using Compute And Graphics Pipelines/shader.geom.spv", "8 - Drawing Particles Using Compute And Graphics Pipelines/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex | Geometry } }, {}, { { 0, 0, Vec4, 0 }, { 1, 0, Vec4, 16 } } },
+		{ "8 - Compute", { "8 - Drawing Particles Using Compute And Graphics Pipelines/shader.comp.spv" },
+			{ { 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1, Compute } }, { { Compute, 0, 4 } }, {} },
+		{ "9 - Terrain", { "9 - Rendering Tesselated Terrain/shader.vert.spv", "9 - Rendering Tesselated Terrain/shader.tesc.spv", "9 - Rendering Tesselated Terrain/shader.tese.spv", "9 - Rendering Tesselated Terrain/shader.geom.spv", "9 - Rendering Tesselated Terrain/shader.frag.spv" },
+			{ { 0, 0, Uniform, 1, Control | Geometry }, { 0, 1, Sampler, 1, Control | Evaluation } }, {}, { { 0, 0, Vec3, 0 }, { 1, 0, Vec2, 12 } } },
+		{ "10 - Skybox", { "10 - Postprocessing/skybox.vert.spv", "10 - Postprocessing/skybox.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 } } },
+		{ "10 - Model", { "10 - Postprocessing/model.vert.spv", "10 - Postprocessing/model.frag.spv" },
+			{ { 0, 0, Uniform, 1, Vertex }, { 0, 1, Sampler, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 }, { 1, 0, Vec3, 12 } } },
+		{ "10 - Postprocess", { "10 - Postprocessing/postprocess.vert.spv", "10 - Postprocessing/postprocess.frag.spv" },
+			{ { 0, 0, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, Fragment } }, { { Fragment, 0, 16 } }, { { 0, 0, Vec3, 0 } } }
+	};
+}
+
+bool loadFile(const std::string& filename, std::vector<unsigned char>& content)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !content.empty();
+}
+
+bool isFloatFormat(VkFormat format)
+{
+	return format == VK_FORMAT_R32_SFLOAT || format == Vec2 || format == Vec3 || format == Vec4;
+}
+
+// Returns the number of mismatches
+int checkPipeline(const ExpectedPipeline& expected, const VulkanShaderReflection& reflection)
+{
+	int mismatchCount = 0;
+
+	for (const VulkanShaderDescriptorBinding& binding : reflection.getDescriptorBindings())
+	{
+		const ExpectedBinding* layoutBinding = nullptr;
+		for (const ExpectedBinding& expectedBinding : expected.bindings)
+		{
+			if (expectedBinding.set == binding.set && expectedBinding.binding == binding.binding)
+			{
+				layoutBinding = &expectedBinding;
+			}
+		}
+		if (layoutBinding == nullptr)
+		{
+			printf("%s : %s (set %u, binding %u) is not in the layout\n", expected.name, binding.name.c_str(), binding.set, binding.binding);
+			mismatchCount++;
+		}
+		else if (layoutBinding->type != binding.type || layoutBinding->count != binding.count || (binding.stages & ~layoutBinding->stages) != 0)
+		{
+			printf("%s : %s (set %u, binding %u) is type %d, count %u, stages 0x%x but the layout has type %d, count %u, stages 0x%x\n", expected.name, binding.name.c_str(), binding.set, binding.binding, binding.type, binding.count, binding.stages, layoutBinding->type, layoutBinding->count, layoutBinding->stages);
+			mismatchCount++;
+		}
+	}
+
+	for (const VulkanShaderPushConstantBlock& block : reflection.getPushConstantBlocks())
+	{
+		bool covered = false;
+		for (const VkPushConstantRange& range : expected.pushConstantRanges)
+		{
+			covered |= (block.stages & ~range.stageFlags) == 0 && range.offset <= block.offset && block.offset + block.size <= range.offset + range.size;
+		}
+		if (!covered)
+		{
+			printf("%s : the push constants %s (offset %u, size %u, stages 0x%x) are not in a range of the layout\n", expected.name, block.name.c_str(), block.offset, block.size, block.stages);
+			mismatchCount++;
+		}
+	}
+
+	for (const VulkanShaderVertexInput& input : reflection.getVertexInputs())
+	{
+		const VkVertexInputAttributeDescription* attribute = nullptr;
+		for (const VkVertexInputAttributeDescription& expectedAttribute : expected.attributes)
+		{
+			if (expectedAttribute.location == input.location)
+			{
+				attribute = &expectedAttribute;
+			}
+		}
+		// The components missing in the attribute are filled by the vertex fetch, so only the numeric type must match
+		if (attribute == nullptr)
+		{
+			printf("%s : the vertex input %s (location %u) has no attribute\n", expected.name, input.name.c_str(), input.location);
+			mismatchCount++;
+		}
+		else if (isFloatFormat(attribute->format) != isFloatFormat(input.format))
+		{
+			printf("%s : the vertex input %s (location %u) is format %d but its attribute is format %d\n", expected.name, input.name.c_str(), input.location, input.format, attribute->format);
+			mismatchCount++;
+		}
+	}
+
+	return mismatchCount;
+}
+
+void printUsage()
+{
+	printf("Usage : ShaderReflection [examplesDirectory]\n");
+	printf("  examplesDirectory  Directory of the examples, ../../Examples/ by default like the examples themselves\n");
+}
+
+// Set from the command line before the test runs
+static std::string gExamplesDirectory = "../../Examples/";
+
+BEGIN_TEST(ShaderReflection)
+	VulkanShaderReflection moduleReflection;
+	std::vector<unsigned char> spirvBlob;
+	for (const ExpectedPipeline& expected : getExpectedPipelines())
+	{
+		TEST(expected.name);
+		VulkanShaderReflection pipelineReflection;
+		bool reflected = true;
+		for (const char* shader : expected.shaders)
+		{
+			if (!loadFile(gExamplesDirectory + shader, spirvBlob))
+			{
+				printf("%s : can't read %s%s\n", expected.name, gExamplesDirectory.c_str(), shader);
+				reflected = false;
+				continue;
+			}
+			if (!moduleReflection.reflect(spirvBlob) || !pipelineReflection.merge(moduleReflection))
+			{
+				printf("%s : can't reflect %s\n", expected.name, shader);
+				reflected = false;
+			}
+		}
+		CHECK(reflected);
+		CHECK(checkPipeline(expected, pipelineReflection) == 0);
+	}
+END_TEST
+
+int main(int argc, char** argv)
+{
+	if (argc > 2)
+	{
+		printUsage();
+		return 1;
+	}
+	if (argc == 2)
+	{
+		gExamplesDirectory = argv[1];
+	}
+	if (!gExamplesDirectory.empty() && gExamplesDirectory.back() != '/' && gExamplesDirectory.back() != '\\')
+	{
+		gExamplesDirectory += '/';
+	}
+
+	RUN_TEST(ShaderReflection);
+	return (nu::UnitTest::getFailedCheckCount() > 0) ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "../../Mesh.hpp"
+#include "../../MeshFile.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Converts an OBJ file into a binary mesh file, with the same options as Mesh::loadFromFile
+// The output is always indexed, so it can be optimized for the vertex cache
+
+void printUsage()
+{
+	printf("Usage : MeshConverter input.obj output.mesh [options]\n");
+	printf("  -normals    Load the normal vectors\n");
+	printf("  -texcoords  Load the texture coordinates\n");
+	printf("  -tangents   Generate the tangent space vectors (needs -normals and -texcoords)\n");
+	printf("  -unify      Center the mesh and scale it in [-1, 1]\n");
+	printf("  -optimize   Optimize for the vertex cache and the vertex fetch\n");
+	printf("  -overdraw   Also sort the triangles for the overdraw (implies -optimize)\n");
+	printf("  -threads N  Threads used to build the vertices, all the hardware threads by default\n");
+	printf("  -benchmark  Compare the OBJ loading on one thread and on all the threads with the previous sequential loader before converting\n");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printUsage();
+		return 1;
+	}
+
+	bool loadNormals = false;
+	bool loadTexcoords = false;
+	bool generateTangents = false;
+	bool unify = false;
+	bool optimize = false;
+	bool sortForOverdraw = false;
+	bool benchmark = false;
+	uint32_t threadCount = 0;
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-normals") == 0)
+		{
+			loadNormals = true;
+		}
+		else if (strcmp(argv[i], "-texcoords") == 0)
+		{
+			loadTexcoords = true;
+		}
+		else if (strcmp(argv[i], "-tangents") == 0)
+		{
+			generateTangents = true;
+		}
+		else if (strcmp(argv[i], "-unify") == 0)
+		{
+			unify = true;
+		}
+		else if (strcmp(argv[i], "-optimize") == 0)
+		{
+			optimize = true;
+		}
+		else if (strcmp(argv[i], "-overdraw") == 0)
+		{
+			optimize = true;
+			sortForOverdraw = true;
+		}
+		else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			threadCount = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-benchmark") == 0)
+		{
+			benchmark = true;
+		}
+		else
+		{
+			printf("Unknown option '%s'\n", argv[i]);
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (benchmark)
+	{
+		// The previous sequential loader is the reference, the parsing of the file is the same for all of them, the difference is in the vertices building
+		std::vector<uint32_t> benchmarkThreadCounts = { 1 };
+		if (std::thread::hardware_concurrency() > 1)
+		{
+			benchmarkThreadCounts.push_back((uint32_t)std::thread::hardware_concurrency());
+		}
+		for (bool indexed : { false, true })
+		{
+			nu::Mesh referenceMesh;
+			auto benchmarkStart = std::chrono::high_resolution_clock::now();
+			if (!referenceMesh.loadFromFileReference(argv[1], loadNormals, loadTexcoords, generateTangents, unify, indexed))
+			{
+				return 1;
+			}
+			const double referenceTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - benchmarkStart).count();
+			printf("Benchmark : %.3f ms with the reference loader, %s (%u vertices)\n", referenceTime, indexed ? "indexed" : "not indexed", referenceMesh.getVertexCount());
+
+			for (uint32_t benchmarkThreads : benchmarkThreadCounts)
+			{
+				nu::Mesh benchmarkMesh;
+				benchmarkMesh.loadingThreadCount = benchmarkThreads;
+				benchmarkStart = std::chrono::high_resolution_clock::now();
+				if (!benchmarkMesh.loadFromFile(argv[1], loadNormals, loadTexcoords, generateTangents, unify, nullptr, indexed))
+				{
+					return 1;
+				}
+				const double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - benchmarkStart).count();
+
+				const bool sameParts = benchmarkMesh.parts.size() == referenceMesh.parts.size()
+					&& std::equal(benchmarkMesh.parts.begin(), benchmarkMesh.parts.end(), referenceMesh.parts.begin(), [](const nu::Mesh::Part& left, const nu::Mesh::Part& right)
+					{
+						return left.vertexOffset == right.vertexOffset && left.vertexCount == right.vertexCount && left.indexOffset == right.indexOffset && left.indexCount == right.indexCount;
+					});
+				const bool sameOutput = sameParts && benchmarkMesh.indices == referenceMesh.indices && benchmarkMesh.data.size() == referenceMesh.data.size()
+					&& memcmp(benchmarkMesh.data.data(), referenceMesh.data.data(), benchmarkMesh.data.size() * sizeof(float)) == 0;
+				printf("Benchmark : %.3f ms on %u threads, %.2fx the reference, %s\n", time, benchmarkThreads, (time > 0.0) ? referenceTime / time : 0.0, sameOutput ? "same output" : "DIFFERENT OUTPUT");
+				if (!sameOutput)
+				{
+					return 1;
+				}
+			}
+		}
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	nu::Mesh mesh;
+	mesh.loadingThreadCount = threadCount;
+	if (!mesh.loadFromFile(argv[1], loadNormals, loadTexcoords, generateTangents, unify, nullptr, true))
+	{
+		return 1;
+	}
+	if (optimize && !mesh.optimize(sortForOverdraw, true))
+	{
+		return 1;
+	}
+
+	const auto loaded = std::chrono::high_resolution_clock::now();
+
+	if (!mesh.saveToBinaryFile(argv[2]))
+	{
+		return 1;
+	}
+
+	// Load it back, to check the file and to compare the load times
+	nu::Mesh binaryMesh;
+	if (!binaryMesh.loadFromBinaryFile(argv[2]) || binaryMesh.data != mesh.data || binaryMesh.indices != mesh.indices || binaryMesh.parts.size() != mesh.parts.size())
+	{
+		printf("The '%s' file does not match the converted mesh\n", argv[2]);
+		return 1;
+	}
+
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	const double objTime = std::chrono::duration<double, std::milli>(loaded - start).count();
+	const double binaryTime = std::chrono::duration<double, std::milli>(end - loaded).count();
+	printf("%s : %u vertices, %u indices, %u parts\n", argv[2], mesh.getVertexCount(), (uint32_t)mesh.indices.size(), (uint32_t)mesh.parts.size());
+	printf("Load time : %.3f ms from OBJ, %.3f ms to write and read back the binary file\n", objTime, binaryTime);
+	return 0;
+}
\ No newline at end of file
@@ -20,17 +20,24 @@ UniformBuffer::~UniformBuffer()
 {
 }
 
-StagingBuffer::Ptr UniformBuffer::createStagingBuffer()
+bool UniformBuffer::update(StagingBuffer& stagingBuffer, uint32_t offset, uint32_t size, const void* data)
 {
-	return StagingBuffer::createStagingBuffer(*mBuffer);
+	return stagingBuffer.write(*mBuffer, offset, size, data, VK_ACCESS_UNIFORM_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
 }
 
 void UniformBuffer::updateDescriptor(VulkanDescriptorSet* dstSet, uint32_t dstBinding, uint32_t dstArrayElement)
 {
 	assert(dstSet != nullptr);
 
+	updateDescriptor(dstSet->getHandle(), dstBinding, dstArrayElement);
+}
+
+void UniformBuffer::updateDescriptor(VkDescriptorSet dstSet, uint32_t dstBinding, uint32_t dstArrayElement)
+{
+	assert(dstSet != VK_NULL_HANDLE);
+
 	VulkanBufferDescriptorInfo bufferDescriptorUpdate = {
-		dstSet->getHandle(),                        // VkDescriptorSet                      TargetDescriptorSet
+		dstSet,                                     // VkDescriptorSet                      TargetDescriptorSet
 		dstBinding,                                 // uint32_t                             TargetDescriptorBinding
 		dstArrayElement,                            // uint32_t                             TargetArrayElement
 		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          // VkDescriptorType                     TargetDescriptorType
@@ -47,6 +54,15 @@ void UniformBuffer::updateDescriptor(VulkanDescriptorSet* dstSet, uint32_t dstBi
 	mBuffer->getDevice().updateDescriptorSets({}, { bufferDescriptorUpdate }, {}, {});
 }
 
+VkDescriptorBufferInfo UniformBuffer::getDescriptorInfo() const
+{
+	return {
+		mBuffer->getHandle(),                       // VkBuffer                             buffer
+		0,                                          // VkDeviceSize                         offset
+		VK_WHOLE_SIZE                               // VkDeviceSize                         range
+	};
+}
+
 UniformBuffer::UniformBuffer()
 	: mBuffer(nullptr)
 {
@@ -27,13 +27,14 @@ class UniformBuffer
 		static UniformBuffer::Ptr createUniformBuffer(VulkanDevice& device, uint32_t size);
 		~UniformBuffer();
 
-		StagingBuffer::Ptr createStagingBuffer();
+		bool update(StagingBuffer& stagingBuffer, uint32_t offset, uint32_t size, const void* data);
 
 		void updateDescriptor(VulkanDescriptorSet* dstSet, uint32_t dstBinding, uint32_t dstArrayElement);
+		void updateDescriptor(VkDescriptorSet dstSet, uint32_t dstBinding, uint32_t dstArrayElement);
+		// For the data of a VulkanDescriptorUpdateTemplate
+		VkDescriptorBufferInfo getDescriptorInfo() const;
 
 	private:
-		friend class StagingBuffer;
-
 		UniformBuffer();
 
 		bool init(VulkanDevice& device, uint32_t size);
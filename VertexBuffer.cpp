@@ -1,7 +1,5 @@
 #include "VertexBuffer.hpp"
 
-#include "VulkanWrapper/VulkanQueue.hpp"
-
 namespace nu
 {
 
@@ -22,14 +20,15 @@ VertexBuffer::~VertexBuffer()
 {
 }
 
-bool VertexBuffer::updateAndWait(uint32_t size, void* data, uint32_t offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, VulkanQueue* queue, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout)
+bool VertexBuffer::update(VulkanUploadManager& uploadManager, uint32_t size, const void* data, uint32_t offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages)
 {
-	return queue->useStagingBufferToUpdateBufferAndWait(size, data, mBuffer.get(), offset, currentAccess, newAccess, generatingStages, consumingStages, commandBuffer, signalSemaphores, timeout);
+	return uploadManager.uploadBuffer(mBuffer.get(), offset, size, data, currentAccess, newAccess, generatingStages, consumingStages);
 }
 
 void VertexBuffer::bindTo(VulkanCommandBuffer* commandBuffer, uint32_t firstBinding, uint32_t memoryOffset)
 {
-	commandBuffer->bindVertexBuffers(0, { { mBuffer.get(), memoryOffset } });
+	const VulkanVertexBufferParameters bufferParameters = { mBuffer.get(), memoryOffset };
+	commandBuffer->bindVertexBuffers(0, bufferParameters);
 }
 
 VertexBuffer::VertexBuffer()
@@ -3,6 +3,7 @@
 #include "VulkanWrapper/VulkanDevice.hpp"
 #include "VulkanWrapper/VulkanBuffer.hpp"
 #include "VulkanWrapper/VulkanCommandBuffer.hpp"
+#include "VulkanWrapper/VulkanUploadManager.hpp"
 
 #include <memory>
 
@@ -17,7 +18,8 @@ class VertexBuffer
 		static VertexBuffer::Ptr createVertexBuffer(VulkanDevice& device, uint32_t size);
 		~VertexBuffer();
 
-		bool updateAndWait(uint32_t size, void* data, uint32_t offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, VulkanQueue* queue, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout);
+		// The data is copied in the staging memory right away, the buffer is updated once the manager has submitted it
+		bool update(VulkanUploadManager& uploadManager, uint32_t size, const void* data, uint32_t offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages);
 		
 		void bindTo(VulkanCommandBuffer* commandBuffer, uint32_t firstBinding, uint32_t memoryOffset);
 
@@ -66,6 +66,9 @@ VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkDebugReportMessageEXT, VK_EXT_DE
 VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkCreateDebugUtilsMessengerEXT, VK_EXT_DEBUG_UTILS_EXTENSION_NAME)
 VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkDestroyDebugUtilsMessengerEXT, VK_EXT_DEBUG_UTILS_EXTENSION_NAME)
 
+VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceFeatures2KHR, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)
+VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceProperties2KHR, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)
+
 // TODO : Only if OPTION_KHR ?
 VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceSurfaceSupportKHR, VK_KHR_SURFACE_EXTENSION_NAME)
 VULKAN_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, VK_KHR_SURFACE_EXTENSION_NAME)
@@ -105,6 +108,7 @@ VULKAN_DEVICE_LEVEL_FUNCTION(vkBindImageMemory)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateImageView)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkMapMemory)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkFlushMappedMemoryRanges)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkInvalidateMappedMemoryRanges)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkUnmapMemory)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdCopyBuffer)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdCopyBufferToImage)
@@ -122,6 +126,7 @@ VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateSemaphore)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateFence)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkWaitForFences)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkResetFences)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkGetFenceStatus)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroyFence)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroySemaphore)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkResetCommandBuffer)
@@ -157,6 +162,8 @@ VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateGraphicsPipelines)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateComputePipelines)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroyPipeline)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroyEvent)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateQueryPool)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkGetQueryPoolResults)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroyQueryPool)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCreateShaderModule)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkDestroyShaderModule)
@@ -179,6 +186,8 @@ VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdSetDepthBias)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdSetBlendConstants)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdExecuteCommands)
 VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdClearAttachments)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdResetQueryPool)
+VULKAN_DEVICE_LEVEL_FUNCTION(vkCmdWriteTimestamp)
 
 #undef VULKAN_DEVICE_LEVEL_FUNCTION
 
@@ -196,6 +205,9 @@ VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkGetSwapchainImagesKHR, VK_KHR_SWAP
 VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkAcquireNextImageKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME)
 VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkQueuePresentKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME)
 VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkDestroySwapchainKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkCreateDescriptorUpdateTemplateKHR, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)
+VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkUpdateDescriptorSetWithTemplateKHR, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)
+VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION(vkDestroyDescriptorUpdateTemplateKHR, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)
 
 #undef VULKAN_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION
 
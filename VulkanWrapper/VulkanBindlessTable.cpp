@@ -0,0 +1,282 @@
+#include "VulkanBindlessTable.hpp"
+
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanDescriptorPool.hpp"
+#include "VulkanDescriptorSetLayout.hpp"
+#include "VulkanDevice.hpp"
+
+#include <algorithm>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanBindlessTablePtr VulkanBindlessTable::createBindlessTable(VulkanDevice& device, VulkanU32 maxSampledImages, VulkanU32 maxStorageBuffers)
+{
+	if (maxSampledImages == 0 || maxStorageBuffers == 0)
+	{
+		VULKAN_LOG_ERROR("A bindless table needs at least one sampled image and one storage buffer");
+		return nullptr;
+	}
+
+	VulkanBindlessTablePtr bindlessTable(new VulkanBindlessTable(device, maxSampledImages, maxStorageBuffers));
+	if (bindlessTable != nullptr)
+	{
+		if (!bindlessTable->init())
+		{
+			bindlessTable.reset();
+		}
+	}
+	return bindlessTable;
+}
+
+VulkanBindlessTable::~VulkanBindlessTable()
+{
+	// The set is freed with its pool
+}
+
+VulkanU32 VulkanBindlessTable::registerSampledImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+{
+	VulkanDescriptorData data;
+	data.image = { sampler, imageView, imageLayout };
+	return registerResource(mSampledImages, data);
+}
+
+VulkanU32 VulkanBindlessTable::registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	VulkanDescriptorData data;
+	data.buffer = { buffer, offset, range };
+	return registerResource(mStorageBuffers, data);
+}
+
+void VulkanBindlessTable::unregisterSampledImage(VulkanU32 index)
+{
+	unregisterResource(mSampledImages, index);
+}
+
+void VulkanBindlessTable::unregisterStorageBuffer(VulkanU32 index)
+{
+	unregisterResource(mStorageBuffers, index);
+}
+
+void VulkanBindlessTable::bind(VulkanCommandBuffer& commandBuffer, VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 setIndex) const
+{
+	commandBuffer.bindDescriptorSets(pipelineType, pipelineLayout, setIndex, { mDescriptorSet }, {});
+}
+
+VulkanU32 VulkanBindlessTable::getSampledImageCount() const
+{
+	return mSampledImages.registeredCount;
+}
+
+VulkanU32 VulkanBindlessTable::getMaxSampledImages() const
+{
+	return mSampledImages.capacity;
+}
+
+VulkanU32 VulkanBindlessTable::getStorageBufferCount() const
+{
+	return mStorageBuffers.registeredCount;
+}
+
+VulkanU32 VulkanBindlessTable::getMaxStorageBuffers() const
+{
+	return mStorageBuffers.capacity;
+}
+
+bool VulkanBindlessTable::usesDescriptorIndexing() const
+{
+	return mUseDescriptorIndexing;
+}
+
+VulkanDescriptorSetLayout& VulkanBindlessTable::getDescriptorSetLayout() const
+{
+	VULKAN_ASSERT(mDescriptorSetLayout != nullptr, "The bindless table is not initialized");
+	return *mDescriptorSetLayout;
+}
+
+const VkDescriptorSet& VulkanBindlessTable::getDescriptorSet() const
+{
+	return mDescriptorSet;
+}
+
+VulkanBindlessTable::VulkanBindlessTable(VulkanDevice& device, VulkanU32 maxSampledImages, VulkanU32 maxStorageBuffers)
+	: mDevice(device)
+	, mDescriptorSetLayout()
+	, mDescriptorPool()
+	, mDescriptorSet(VK_NULL_HANDLE)
+	, mUseDescriptorIndexing(device.isDescriptorIndexingEnabled())
+	, mSampledImages()
+	, mStorageBuffers()
+{
+	mSampledImages.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	mSampledImages.binding = SampledImagesBinding;
+	mSampledImages.capacity = maxSampledImages;
+	mStorageBuffers.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	mStorageBuffers.binding = StorageBuffersBinding;
+	mStorageBuffers.capacity = maxStorageBuffers;
+}
+
+bool VulkanBindlessTable::init()
+{
+	// The bindings are visible to all the stages, so each stage limit applies to the whole array, and the set limits too
+	// A combined image sampler counts as a sampled image and as a sampler
+	VulkanU32 sampledImagesLimit;
+	VulkanU32 storageBuffersLimit;
+	VulkanU32 resourcesLimit;
+	if (mUseDescriptorIndexing)
+	{
+		const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& properties = mDevice.getDescriptorIndexingProperties();
+		sampledImagesLimit = std::min(std::min(properties.maxPerStageDescriptorUpdateAfterBindSampledImages, properties.maxPerStageDescriptorUpdateAfterBindSamplers), std::min(properties.maxDescriptorSetUpdateAfterBindSampledImages, properties.maxDescriptorSetUpdateAfterBindSamplers));
+		storageBuffersLimit = std::min(properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, properties.maxDescriptorSetUpdateAfterBindStorageBuffers);
+		resourcesLimit = properties.maxPerStageUpdateAfterBindResources;
+	}
+	else
+	{
+		const VkPhysicalDeviceLimits& limits = mDevice.getProperties().limits;
+		sampledImagesLimit = std::min(std::min(limits.maxPerStageDescriptorSampledImages, limits.maxPerStageDescriptorSamplers), std::min(limits.maxDescriptorSetSampledImages, limits.maxDescriptorSetSamplers));
+		storageBuffersLimit = std::min(limits.maxPerStageDescriptorStorageBuffers, limits.maxDescriptorSetStorageBuffers);
+		resourcesLimit = limits.maxPerStageResources;
+	}
+	if (mSampledImages.capacity > sampledImagesLimit)
+	{
+		VULKAN_LOG_WARNING("Bindless table : %u sampled images requested, clamped to %u", mSampledImages.capacity, sampledImagesLimit);
+		mSampledImages.capacity = sampledImagesLimit;
+	}
+	if (mStorageBuffers.capacity > storageBuffersLimit)
+	{
+		VULKAN_LOG_WARNING("Bindless table : %u storage buffers requested, clamped to %u", mStorageBuffers.capacity, storageBuffersLimit);
+		mStorageBuffers.capacity = storageBuffersLimit;
+	}
+
+	// Both arrays are in every stage, so together they must fit in the resources of a stage, they are shrunk in proportion
+	const VulkanU64 resourceCount = static_cast<VulkanU64>(mSampledImages.capacity) + mStorageBuffers.capacity;
+	if (resourceCount > resourcesLimit)
+	{
+		const VulkanU32 storageBuffers = static_cast<VulkanU32>(mStorageBuffers.capacity * static_cast<VulkanU64>(resourcesLimit) / resourceCount);
+		VULKAN_LOG_WARNING("Bindless table : %u sampled images and %u storage buffers exceed the %u resources per stage, clamped to %u and %u", mSampledImages.capacity, mStorageBuffers.capacity, resourcesLimit, resourcesLimit - storageBuffers, storageBuffers);
+		mSampledImages.capacity = resourcesLimit - storageBuffers;
+		mStorageBuffers.capacity = storageBuffers;
+	}
+	mSampledImages.registered.assign(mSampledImages.capacity, false);
+	mStorageBuffers.registered.assign(mStorageBuffers.capacity, false);
+
+	const std::vector<VkDescriptorSetLayoutBinding> bindings = {
+		{ SampledImagesBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mSampledImages.capacity, VK_SHADER_STAGE_ALL, nullptr },
+		{ StorageBuffersBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mStorageBuffers.capacity, VK_SHADER_STAGE_ALL, nullptr }
+	};
+	const std::vector<VkDescriptorPoolSize> poolSizes = {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mSampledImages.capacity },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mStorageBuffers.capacity }
+	};
+
+	if (mUseDescriptorIndexing)
+	{
+		VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT;
+		if (mDevice.getEnabledDescriptorIndexingFeatures().descriptorBindingUpdateUnusedWhilePending == VK_TRUE)
+		{
+			bindingFlags |= VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+		}
+		mDescriptorSetLayout = mDevice.createDescriptorSetLayout(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT, { bindingFlags, bindingFlags });
+		mDescriptorPool = mDevice.createDescriptorPool(false, 1, poolSizes, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT);
+	}
+	else
+	{
+		mDescriptorSetLayout = mDevice.createDescriptorSetLayout(bindings);
+		mDescriptorPool = mDevice.createDescriptorPool(false, 1, poolSizes);
+	}
+	if (mDescriptorSetLayout == nullptr || !mDescriptorSetLayout->isInitialized() || mDescriptorPool == nullptr || !mDescriptorPool->isInitialized())
+	{
+		VULKAN_LOG_ERROR("Could not create the descriptor set layout or pool of the bindless table");
+		return false;
+	}
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,         // VkStructureType                  sType
+		nullptr,                                                // const void                     * pNext
+		mDescriptorPool->getHandle(),                           // VkDescriptorPool                 descriptorPool
+		1u,                                                     // uint32_t                         descriptorSetCount
+		&mDescriptorSetLayout->getHandle()                      // const VkDescriptorSetLayout    * pSetLayouts
+	};
+
+	VkResult result = vkAllocateDescriptorSets(mDevice.getHandle(), &descriptorSetAllocateInfo, &mDescriptorSet);
+	if (result != VK_SUCCESS || mDescriptorSet == VK_NULL_HANDLE)
+	{
+		VULKAN_LOG_ERROR("Could not allocate the descriptor set of the bindless table");
+		return false;
+	}
+
+	return true;
+}
+
+VulkanU32 VulkanBindlessTable::registerResource(Array& array, const VulkanDescriptorData& data)
+{
+	VulkanU32 index;
+	if (!array.freeIndices.empty())
+	{
+		index = array.freeIndices.back();
+		array.freeIndices.pop_back();
+	}
+	else if (array.usedCount < array.capacity)
+	{
+		index = array.usedCount++;
+	}
+	else
+	{
+		VULKAN_LOG_ERROR("Bindless table : no more room for descriptors of type %d (%u)", array.descriptorType, array.capacity);
+		return InvalidIndex;
+	}
+
+	if (!mUseDescriptorIndexing && !array.hasDefault)
+	{
+		// Every descriptor of the array must be valid, the first resource fills them all
+		array.defaultData = data;
+		array.hasDefault = true;
+		write(array, 0, array.capacity, data);
+	}
+	else
+	{
+		write(array, index, 1, data);
+	}
+
+	array.registered[index] = true;
+	array.registeredCount++;
+	return index;
+}
+
+void VulkanBindlessTable::unregisterResource(Array& array, VulkanU32 index)
+{
+	VULKAN_ASSERT(index < array.capacity && array.registered[index], "Bindless table : index %u is not registered", index);
+
+	if (!mUseDescriptorIndexing)
+	{
+		// The descriptor stays valid for the shaders that would still read it
+		write(array, index, 1, array.defaultData);
+	}
+
+	array.registered[index] = false;
+	array.registeredCount--;
+	array.freeIndices.push_back(index);
+}
+
+void VulkanBindlessTable::write(const Array& array, VulkanU32 firstIndex, VulkanU32 count, const VulkanDescriptorData& data)
+{
+	const bool isImage = (array.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	std::vector<VkDescriptorImageInfo> imageInfos(isImage ? count : 0, data.image);
+	std::vector<VkDescriptorBufferInfo> bufferInfos(isImage ? 0 : count, data.buffer);
+
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                 // VkStructureType                  sType
+		nullptr,                                                // const void                     * pNext
+		mDescriptorSet,                                         // VkDescriptorSet                  dstSet
+		array.binding,                                          // uint32_t                         dstBinding
+		firstIndex,                                             // uint32_t                         dstArrayElement
+		count,                                                  // uint32_t                         descriptorCount
+		array.descriptorType,                                   // VkDescriptorType                 descriptorType
+		isImage ? imageInfos.data() : nullptr,                  // const VkDescriptorImageInfo    * pImageInfo
+		isImage ? nullptr : bufferInfos.data(),                 // const VkDescriptorBufferInfo   * pBufferInfo
+		nullptr                                                 // const VkBufferView             * pTexelBufferView
+	};
+
+	vkUpdateDescriptorSets(mDevice.getHandle(), 1, &writeDescriptorSet, 0, nullptr);
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanDescriptorUpdateTemplate.hpp"
+
+// TODO : Storage images and texel buffers arrays
+// TODO : Variable descriptor count for the last binding
+
+VULKAN_NAMESPACE_BEGIN
+
+// One descriptor set with a large array of sampled images (binding 0) and a large array of storage buffers (binding 1)
+// Each registered resource gets a stable index in its array, the shaders read it from push constants or per-instance data
+// The set is bound once per command buffer and pipeline layout, the draws don't bind any descriptor
+//
+//   layout(set = 0, binding = 0) uniform sampler2D textures[];
+//   layout(set = 0, binding = 1) buffer Buffers { vec4 data[]; } buffers[];
+//   layout(push_constant) uniform PushConstants { uint textureIndex; } pc;
+//   color = texture(textures[nonuniformEXT(pc.textureIndex)], uv);
+//
+// With descriptor indexing (VK_EXT_descriptor_indexing enabled by the device), the arrays are partially bound and updated after bind :
+// the unused indices don't need a descriptor, and the resources can be registered while the set is bound in pending command buffers
+// Without it, the first registered resource of each array fills all its unused indices so that every descriptor stays valid,
+// it must outlive the table, and resources must not be registered or unregistered while the set is used by pending submissions
+class VulkanBindlessTable
+{
+	public:
+		static const VulkanU32 InvalidIndex = ~0u;
+		static const VulkanU32 SampledImagesBinding = 0;
+		static const VulkanU32 StorageBuffersBinding = 1;
+
+		// The sizes of the arrays are clamped to the per stage and per set limits of the device, and together to the resources per stage
+		static VulkanBindlessTablePtr createBindlessTable(VulkanDevice& device, VulkanU32 maxSampledImages, VulkanU32 maxStorageBuffers);
+
+		~VulkanBindlessTable();
+
+		// Returns InvalidIndex when the array is full
+		VulkanU32 registerSampledImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		VulkanU32 registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+		// The index can be returned by a next registration, the shaders must not use it anymore
+		void unregisterSampledImage(VulkanU32 index);
+		void unregisterStorageBuffer(VulkanU32 index);
+
+		void bind(VulkanCommandBuffer& commandBuffer, VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 setIndex) const;
+
+		VulkanU32 getSampledImageCount() const; // Registered
+		VulkanU32 getMaxSampledImages() const;
+		VulkanU32 getStorageBufferCount() const; // Registered
+		VulkanU32 getMaxStorageBuffers() const;
+
+		bool usesDescriptorIndexing() const;
+		VulkanDescriptorSetLayout& getDescriptorSetLayout() const; // For the pipeline layouts
+		const VkDescriptorSet& getDescriptorSet() const;
+
+	private:
+		VulkanBindlessTable(VulkanDevice& device, VulkanU32 maxSampledImages, VulkanU32 maxStorageBuffers);
+
+		bool init();
+
+		struct Array
+		{
+			VkDescriptorType descriptorType;
+			VulkanU32 binding;
+			VulkanU32 capacity;
+			VulkanU32 usedCount; // Indices below have been returned at least once
+			VulkanU32 registeredCount;
+			std::vector<VulkanU32> freeIndices;
+			std::vector<bool> registered;
+			bool hasDefault;
+			VulkanDescriptorData defaultData; // First registered resource, without descriptor indexing
+		};
+
+		VulkanU32 registerResource(Array& array, const VulkanDescriptorData& data);
+		void unregisterResource(Array& array, VulkanU32 index);
+		void write(const Array& array, VulkanU32 firstIndex, VulkanU32 count, const VulkanDescriptorData& data);
+
+		VulkanDevice& mDevice;
+		VulkanDescriptorSetLayoutPtr mDescriptorSetLayout;
+		VulkanDescriptorPoolPtr mDescriptorPool;
+		VkDescriptorSet mDescriptorSet;
+		bool mUseDescriptorIndexing;
+
+		Array mSampledImages;
+		Array mStorageBuffers;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
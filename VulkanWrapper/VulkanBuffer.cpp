@@ -27,10 +27,14 @@ const VkMemoryRequirements& VulkanBuffer::getMemoryRequirements() const
 
 VulkanMemoryBlock* VulkanBuffer::allocateMemoryBlock(VkMemoryPropertyFlagBits memoryProperties)
 {
-	mOwnedMemoryBlock = getDevice().createMemoryBlock(getMemoryRequirements(), memoryProperties);
-	if (mOwnedMemoryBlock != nullptr)
+	VulkanMemoryAllocator& memoryAllocator = getDevice().getMemoryAllocator();
+	if (memoryAllocator.allocate(getMemoryRequirements(), memoryProperties, true, mMemoryAllocation))
 	{
-		mOwnedMemoryBlock->bind(this, 0);
+		if (!mMemoryAllocation.memoryBlock->bind(this, mMemoryAllocation.offset))
+		{
+			memoryAllocator.free(mMemoryAllocation);
+			mMemoryBlock = nullptr;
+		}
 	}
 	else
 	{
@@ -41,7 +45,7 @@ VulkanMemoryBlock* VulkanBuffer::allocateMemoryBlock(VkMemoryPropertyFlagBits me
 
 bool VulkanBuffer::ownMemoryBlock() const
 {
-	return mOwnedMemoryBlock != nullptr;
+	return mMemoryAllocation.isValid();
 }
 
 bool VulkanBuffer::isBoundToMemoryBlock() const
@@ -105,6 +109,28 @@ VkBufferUsageFlags VulkanBuffer::getUsage() const
 	return mUsage;
 }
 
+VkAccessFlags VulkanBuffer::getCurrentAccess() const
+{
+	return mCurrentAccess;
+}
+
+VkPipelineStageFlags VulkanBuffer::getCurrentStages() const
+{
+	return mCurrentStages;
+}
+
+VulkanU32 VulkanBuffer::getCurrentQueueFamily() const
+{
+	return mCurrentQueueFamily;
+}
+
+void VulkanBuffer::setCurrentState(VkAccessFlags access, VkPipelineStageFlags stages, VulkanU32 queueFamily)
+{
+	mCurrentAccess = access;
+	mCurrentStages = stages;
+	mCurrentQueueFamily = queueFamily;
+}
+
 const VkBuffer& VulkanBuffer::getHandle() const
 {
 	return mBuffer;
@@ -125,12 +151,15 @@ VulkanBufferPtr VulkanBuffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags
 
 VulkanBuffer::VulkanBuffer(VkDeviceSize size, VkBufferUsageFlags usage)
 	: mBuffer(VK_NULL_HANDLE)
-	, mOwnedMemoryBlock(nullptr)
+	, mMemoryAllocation()
 	, mMemoryBlock(nullptr)
 	, mOffsetInMemoryBlock(0)
 	, mBufferViews()
 	, mSize(size)
 	, mUsage(usage)
+	, mCurrentAccess(0)
+	, mCurrentStages(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT)
+	, mCurrentQueueFamily(VK_QUEUE_FAMILY_IGNORED)
 	, mMemoryRequirementsQueried(false)
 	, mMemoryRequirements()
 {
@@ -167,6 +196,11 @@ void VulkanBuffer::release()
 		vkDestroyBuffer(getDeviceHandle(), mBuffer, nullptr);
 		mBuffer = VK_NULL_HANDLE;
 	}
+	if (mMemoryAllocation.isValid())
+	{
+		getDevice().getMemoryAllocator().free(mMemoryAllocation);
+		mMemoryBlock = nullptr;
+	}
 }
 
 void VulkanBuffer::bindToMemoryBlock(VulkanMemoryBlock* memoryBlock, VkDeviceSize offsetInMemoryBlock)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanMemoryAllocator.hpp"
 
 // TODO : Binding on MemoryBlock side or Image/Buffer side ?
 
@@ -29,6 +30,13 @@ class VulkanBuffer : public VulkanDeviceObject<VulkanObjectType_Buffer>
 		VkDeviceSize getSize() const;
 		VkBufferUsageFlags getUsage() const;
 
+		// State of the buffer at the end of the last recorded command buffer, used by the tracked transitions
+		// Command buffers are expected to be submitted in the order they were recorded
+		VkAccessFlags getCurrentAccess() const;
+		VkPipelineStageFlags getCurrentStages() const;
+		VulkanU32 getCurrentQueueFamily() const;
+		void setCurrentState(VkAccessFlags access, VkPipelineStageFlags stages, VulkanU32 queueFamily = VK_QUEUE_FAMILY_IGNORED);
+
 		const VkBuffer& getHandle() const;
 		
 	private:
@@ -46,7 +54,7 @@ class VulkanBuffer : public VulkanDeviceObject<VulkanObjectType_Buffer>
 	private:
 		VkBuffer mBuffer;
 
-		VulkanMemoryBlockPtr mOwnedMemoryBlock;
+		VulkanMemoryAllocation mMemoryAllocation;
 		VulkanMemoryBlock* mMemoryBlock;
 		VkDeviceSize mOffsetInMemoryBlock;
 
@@ -55,6 +63,10 @@ class VulkanBuffer : public VulkanDeviceObject<VulkanObjectType_Buffer>
 		VkDeviceSize mSize;
 		VkBufferUsageFlags mUsage;
 
+		VkAccessFlags mCurrentAccess;
+		VkPipelineStageFlags mCurrentStages;
+		VulkanU32 mCurrentQueueFamily;
+
 		mutable bool mMemoryRequirementsQueried;
 		mutable VkMemoryRequirements mMemoryRequirements;
 };
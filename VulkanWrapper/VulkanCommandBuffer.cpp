@@ -7,6 +7,10 @@
 #include "VulkanGraphicsPipeline.hpp"
 #include "VulkanComputePipeline.hpp"
 #include "VulkanDevice.hpp"
+#include "VulkanGpuProfiler.hpp"
+#include "VulkanQueryPool.hpp"
+
+#include <cstring>
 
 VULKAN_NAMESPACE_BEGIN
 
@@ -39,12 +43,24 @@ bool VulkanCommandBuffer::beginRecording(VkCommandBufferUsageFlags usage, VkComm
 	}
 
 	mRecording = true;
+	mStats.issuedCalls = 0;
+	mStats.skippedCalls = 0;
+	mStats.barrierCalls = 0;
+	mStats.barriers = 0;
+	invalidateTrackedState();
+	mInsideRenderPass = (usage & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT) != 0;
+	mPendingSrcStages = 0;
+	mPendingDstStages = 0;
+	mPendingBufferBarriers.clear();
+	mPendingImageBarriers.clear();
 	return true;
 }
 
 bool VulkanCommandBuffer::endRecording()
 {
 	// TODO : Do something if not recording ?
+
+	flushBarriers();
 	
 	VkResult result = vkEndCommandBuffer(mCommandBuffer);
 	if (VK_SUCCESS != result)
@@ -58,9 +74,11 @@ bool VulkanCommandBuffer::endRecording()
 	return true;
 }
 
-void VulkanCommandBuffer::beginRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkRect2D renderArea, const std::vector<VkClearValue>& clearValues, VkSubpassContents subpassContents)
+void VulkanCommandBuffer::beginRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkRect2D renderArea, VulkanArrayView<VkClearValue> clearValues, VkSubpassContents subpassContents)
 {
 	// TODO : Check parameters ?
+
+	flushBarriers();
 	
 	VkRenderPassBeginInfo renderPassBeginInfo = {
 		VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,     // VkStructureType        sType
@@ -73,6 +91,7 @@ void VulkanCommandBuffer::beginRenderPass(VkRenderPass renderPass, VkFramebuffer
 	};
 
 	vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, subpassContents);
+	mInsideRenderPass = true;
 }
 
 void VulkanCommandBuffer::progressToTheNextSubpass(VkSubpassContents subpassContents)
@@ -85,63 +104,142 @@ void VulkanCommandBuffer::endRenderPass()
 {
 	// TODO : Check parameters ?
 	vkCmdEndRenderPass(mCommandBuffer);
+	mInsideRenderPass = false;
 }
 
-void VulkanCommandBuffer::clearColorImage(VkImage image, VkImageLayout imageLayout, const std::vector<VkImageSubresourceRange>& imageSubresourceRanges, VkClearColorValue& clearColor)
+void VulkanCommandBuffer::clearColorImage(VkImage image, VkImageLayout imageLayout, VulkanArrayView<VkImageSubresourceRange> imageSubresourceRanges, VkClearColorValue& clearColor)
 {
 	// TODO : Check parameters ?
+	flushBarriers();
 	vkCmdClearColorImage(mCommandBuffer, image, imageLayout, &clearColor, static_cast<VulkanU32>(imageSubresourceRanges.size()), imageSubresourceRanges.data());
 }
 
-void VulkanCommandBuffer::clearDepthStencilImage(VkImage image, VkImageLayout imageLayout, const std::vector<VkImageSubresourceRange>& imageSubresourceRanges, VkClearDepthStencilValue& clearValue)
+void VulkanCommandBuffer::clearDepthStencilImage(VkImage image, VkImageLayout imageLayout, VulkanArrayView<VkImageSubresourceRange> imageSubresourceRanges, VkClearDepthStencilValue& clearValue)
 {
 	// TODO : Check parameters ?
+	flushBarriers();
 	vkCmdClearDepthStencilImage(mCommandBuffer, image, imageLayout, &clearValue, static_cast<VulkanU32>(imageSubresourceRanges.size()), imageSubresourceRanges.data());
 }
 
-void VulkanCommandBuffer::clearRenderPassAttachments(const std::vector<VkClearAttachment>& attachments, const std::vector<VkClearRect>& rects)
+void VulkanCommandBuffer::clearRenderPassAttachments(VulkanArrayView<VkClearAttachment> attachments, VulkanArrayView<VkClearRect> rects)
 {
 	// TODO : Check parameters ?
 	vkCmdClearAttachments(mCommandBuffer, static_cast<VulkanU32>(attachments.size()), attachments.data(), static_cast<VulkanU32>(rects.size()), rects.data());
 }
 
-void VulkanCommandBuffer::bindVertexBuffers(VulkanU32 firstBinding, const std::vector<VulkanVertexBufferParameters>& buffersParameters)
+void VulkanCommandBuffer::bindVertexBuffers(VulkanU32 firstBinding, VulkanArrayView<VulkanVertexBufferParameters> buffersParameters)
 {
 	// TODO : Improve parameters checking ?
 	if (buffersParameters.size() > 0)
 	{
-		std::vector<VkBuffer> buffers;
-		std::vector<VkDeviceSize> offsets;
-		buffers.reserve(buffersParameters.size());
-		offsets.reserve(buffersParameters.size());
+		const VulkanU32 count = static_cast<VulkanU32>(buffersParameters.size());
+		if (mStateTracking)
+		{
+			if (firstBinding + count <= MaxTrackedVertexBindings)
+			{
+				bool redundant = true;
+				for (VulkanU32 i = 0; i < count && redundant; i++)
+				{
+					redundant = mTrackedState.vertexBuffers[firstBinding + i] == buffersParameters[i].buffer->getHandle()
+						&& mTrackedState.vertexBufferOffsets[firstBinding + i] == buffersParameters[i].memoryOffset;
+				}
+				if (redundant)
+				{
+					mStats.skippedCalls++;
+					return;
+				}
+			}
+			for (VulkanU32 i = 0; i < count && firstBinding + i < MaxTrackedVertexBindings; i++)
+			{
+				mTrackedState.vertexBuffers[firstBinding + i] = buffersParameters[i].buffer->getHandle();
+				mTrackedState.vertexBufferOffsets[firstBinding + i] = buffersParameters[i].memoryOffset;
+			}
+		}
+
+		VulkanSmallVector<VkBuffer, 16> buffers;
+		VulkanSmallVector<VkDeviceSize, 16> offsets;
 		for (auto& bufferParameters : buffersParameters)
 		{
 			buffers.push_back(bufferParameters.buffer->getHandle());
 			offsets.push_back(bufferParameters.memoryOffset);
 		}
-		vkCmdBindVertexBuffers(mCommandBuffer, firstBinding, static_cast<VulkanU32>(buffersParameters.size()), buffers.data(), offsets.data());
+		vkCmdBindVertexBuffers(mCommandBuffer, firstBinding, count, buffers.data(), offsets.data());
+		mStats.issuedCalls++;
 	}
 }
 
 void VulkanCommandBuffer::bindIndexBuffer(VulkanBuffer* buffer, VkDeviceSize memoryOffset, VkIndexType indexType)
 {
 	// TODO : Check parameters ?
+	if (mStateTracking)
+	{
+		if (mTrackedState.indexBuffer == buffer->getHandle() && mTrackedState.indexBufferOffset == memoryOffset && mTrackedState.indexType == indexType)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		mTrackedState.indexBuffer = buffer->getHandle();
+		mTrackedState.indexBufferOffset = memoryOffset;
+		mTrackedState.indexType = indexType;
+	}
+
 	vkCmdBindIndexBuffer(mCommandBuffer, buffer->getHandle(), memoryOffset, indexType);
+	mStats.issuedCalls++;
+}
+
+void VulkanCommandBuffer::bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, VulkanArrayView<VulkanDescriptorSet*> descriptorSets, VulkanArrayView<VulkanU32> dynamicOffsets)
+{
+	VulkanSmallVector<VkDescriptorSet, 8> descriptorSetHandles;
+	for (auto& descriptorSet : descriptorSets)
+	{
+		descriptorSetHandles.push_back(descriptorSet->getHandle());
+	}
+
+	bindDescriptorSets(pipelineType, pipelineLayout, indexForFirstSet, VulkanArrayView<VkDescriptorSet>(descriptorSetHandles.data(), descriptorSetHandles.size()), dynamicOffsets);
 }
 
-void VulkanCommandBuffer::bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, const std::vector<VulkanDescriptorSet*>& descriptorSets, const std::vector<VulkanU32>& dynamicOffsets)
+void VulkanCommandBuffer::bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, VulkanArrayView<VkDescriptorSet> descriptorSets, VulkanArrayView<VulkanU32> dynamicOffsets)
 {
 	// TODO : Improve parameters checking ?
 	if (descriptorSets.size() > 0)
 	{
-		std::vector<VkDescriptorSet> descriptorSetHandles;
-		descriptorSetHandles.reserve(descriptorSets.size());
-		for (auto& descriptorSet : descriptorSets)
+		const VulkanU32 count = static_cast<VulkanU32>(descriptorSets.size());
+		if (mStateTracking && pipelineType <= VK_PIPELINE_BIND_POINT_COMPUTE)
 		{
-			descriptorSetHandles.push_back(descriptorSet->getHandle());
+			VkDescriptorSet* trackedSets = mTrackedState.descriptorSets[pipelineType];
+
+			// Sets bound with dynamic offsets are never considered as already bound
+			if (dynamicOffsets.size() == 0 && mTrackedState.pipelineLayouts[pipelineType] == pipelineLayout && indexForFirstSet + count <= MaxTrackedDescriptorSets)
+			{
+				bool redundant = true;
+				for (VulkanU32 i = 0; i < count && redundant; i++)
+				{
+					redundant = trackedSets[indexForFirstSet + i] == descriptorSets[i];
+				}
+				if (redundant)
+				{
+					mStats.skippedCalls++;
+					return;
+				}
+			}
+
+			// The other sets might be disturbed by a different layout
+			if (mTrackedState.pipelineLayouts[pipelineType] != pipelineLayout)
+			{
+				mTrackedState.pipelineLayouts[pipelineType] = pipelineLayout;
+				for (VulkanU32 i = 0; i < MaxTrackedDescriptorSets; i++)
+				{
+					trackedSets[i] = VK_NULL_HANDLE;
+				}
+			}
+			for (VulkanU32 i = 0; i < count && indexForFirstSet + i < MaxTrackedDescriptorSets; i++)
+			{
+				trackedSets[indexForFirstSet + i] = (dynamicOffsets.size() == 0) ? descriptorSets[i] : VK_NULL_HANDLE;
+			}
 		}
 
-		vkCmdBindDescriptorSets(mCommandBuffer, pipelineType, pipelineLayout, indexForFirstSet, static_cast<VulkanU32>(descriptorSetHandles.size()), descriptorSetHandles.data(), static_cast<VulkanU32>(dynamicOffsets.size()), dynamicOffsets.data());
+		vkCmdBindDescriptorSets(mCommandBuffer, pipelineType, pipelineLayout, indexForFirstSet, count, descriptorSets.data(), static_cast<VulkanU32>(dynamicOffsets.size()), dynamicOffsets.data());
+		mStats.issuedCalls++;
 	}
 }
 
@@ -150,7 +248,40 @@ void VulkanCommandBuffer::bindPipeline(VulkanGraphicsPipeline* pipeline)
 	// TODO : Improve parameters checking ?
 	if (pipeline != nullptr && pipeline->isCreated())
 	{
+		if (mStateTracking)
+		{
+			if (mTrackedState.pipelines[VK_PIPELINE_BIND_POINT_GRAPHICS] == pipeline->getHandle())
+			{
+				mStats.skippedCalls++;
+				return;
+			}
+			mTrackedState.pipelines[VK_PIPELINE_BIND_POINT_GRAPHICS] = pipeline->getHandle();
+
+			// The states that are not dynamic in this pipeline are overwritten by its own values
+			if (!pipeline->hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT))
+			{
+				mTrackedState.knownViewports = 0;
+			}
+			if (!pipeline->hasDynamicState(VK_DYNAMIC_STATE_SCISSOR))
+			{
+				mTrackedState.knownScissors = 0;
+			}
+			if (!pipeline->hasDynamicState(VK_DYNAMIC_STATE_LINE_WIDTH))
+			{
+				mTrackedState.knownLineWidth = false;
+			}
+			if (!pipeline->hasDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS))
+			{
+				mTrackedState.knownDepthBias = false;
+			}
+			if (!pipeline->hasDynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS))
+			{
+				mTrackedState.knownBlendConstants = false;
+			}
+		}
+
 		vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getHandle());
+		mStats.issuedCalls++;
 	}
 	else if (pipeline == nullptr)
 	{
@@ -167,7 +298,18 @@ void VulkanCommandBuffer::bindPipeline(VulkanGraphicsPipeline* pipeline)
 void VulkanCommandBuffer::bindPipeline(VulkanComputePipeline* pipeline)
 {
 	// TODO : Check parameters ?
+	if (mStateTracking)
+	{
+		if (mTrackedState.pipelines[VK_PIPELINE_BIND_POINT_COMPUTE] == pipeline->getHandle())
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		mTrackedState.pipelines[VK_PIPELINE_BIND_POINT_COMPUTE] = pipeline->getHandle();
+	}
+
 	vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->getHandle());
+	mStats.issuedCalls++;
 }
 
 void VulkanCommandBuffer::provideDataToShadersThroughPushConstants(VkPipelineLayout pipelineLayout, VkShaderStageFlags pipelineStages, VulkanU32 offset, VulkanU32 size, void* data)
@@ -176,34 +318,116 @@ void VulkanCommandBuffer::provideDataToShadersThroughPushConstants(VkPipelineLay
 	vkCmdPushConstants(mCommandBuffer, pipelineLayout, pipelineStages, offset, size, data);
 }
 
-void VulkanCommandBuffer::setViewportStateDynamically(VulkanU32 firstViewport, const std::vector<VkViewport>& viewports)
+void VulkanCommandBuffer::setViewportStateDynamically(VulkanU32 firstViewport, VulkanArrayView<VkViewport> viewports)
 {
 	// TODO : Check parameters ?
-	vkCmdSetViewport(mCommandBuffer, firstViewport, static_cast<VulkanU32>(viewports.size()), viewports.data());
+	const VulkanU32 count = static_cast<VulkanU32>(viewports.size());
+	if (mStateTracking && firstViewport + count <= MaxTrackedViewports)
+	{
+		bool redundant = true;
+		for (VulkanU32 i = 0; i < count && redundant; i++)
+		{
+			redundant = (mTrackedState.knownViewports & (1u << (firstViewport + i))) != 0
+				&& std::memcmp(&mTrackedState.viewports[firstViewport + i], &viewports[i], sizeof(VkViewport)) == 0;
+		}
+		if (redundant)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		for (VulkanU32 i = 0; i < count; i++)
+		{
+			mTrackedState.viewports[firstViewport + i] = viewports[i];
+			mTrackedState.knownViewports |= (1u << (firstViewport + i));
+		}
+	}
+
+	vkCmdSetViewport(mCommandBuffer, firstViewport, count, viewports.data());
+	mStats.issuedCalls++;
 }
 
-void VulkanCommandBuffer::setScissorStateDynamically(VulkanU32 firstScissor, const std::vector<VkRect2D>& scissors)
+void VulkanCommandBuffer::setScissorStateDynamically(VulkanU32 firstScissor, VulkanArrayView<VkRect2D> scissors)
 {
 	// TODO : Check parameters ?
-	vkCmdSetScissor(mCommandBuffer, firstScissor, static_cast<VulkanU32>(scissors.size()), scissors.data());
+	const VulkanU32 count = static_cast<VulkanU32>(scissors.size());
+	if (mStateTracking && firstScissor + count <= MaxTrackedViewports)
+	{
+		bool redundant = true;
+		for (VulkanU32 i = 0; i < count && redundant; i++)
+		{
+			redundant = (mTrackedState.knownScissors & (1u << (firstScissor + i))) != 0
+				&& std::memcmp(&mTrackedState.scissors[firstScissor + i], &scissors[i], sizeof(VkRect2D)) == 0;
+		}
+		if (redundant)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		for (VulkanU32 i = 0; i < count; i++)
+		{
+			mTrackedState.scissors[firstScissor + i] = scissors[i];
+			mTrackedState.knownScissors |= (1u << (firstScissor + i));
+		}
+	}
+
+	vkCmdSetScissor(mCommandBuffer, firstScissor, count, scissors.data());
+	mStats.issuedCalls++;
 }
 
 void VulkanCommandBuffer::setLineWidthStateDynamically(float lineWidth)
 {
 	// TODO : Check parameters ?
+	if (mStateTracking)
+	{
+		if (mTrackedState.knownLineWidth && mTrackedState.lineWidth == lineWidth)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		mTrackedState.lineWidth = lineWidth;
+		mTrackedState.knownLineWidth = true;
+	}
+
 	vkCmdSetLineWidth(mCommandBuffer, lineWidth);
+	mStats.issuedCalls++;
 }
 
 void VulkanCommandBuffer::setDepthBiasStateDynamically(float constantFactor, float clampValue, float slopeFactor)
 {
 	// TODO : Check parameters ?
+	if (mStateTracking)
+	{
+		if (mTrackedState.knownDepthBias && mTrackedState.depthBias[0] == constantFactor && mTrackedState.depthBias[1] == clampValue && mTrackedState.depthBias[2] == slopeFactor)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		mTrackedState.depthBias[0] = constantFactor;
+		mTrackedState.depthBias[1] = clampValue;
+		mTrackedState.depthBias[2] = slopeFactor;
+		mTrackedState.knownDepthBias = true;
+	}
+
 	vkCmdSetDepthBias(mCommandBuffer, constantFactor, clampValue, slopeFactor);
+	mStats.issuedCalls++;
 }
 
 void VulkanCommandBuffer::setBlendConstantsStateDynamically(const float (&blendConstants)[4])
 {
 	// TODO : Check parameters ?
+	if (mStateTracking)
+	{
+		if (mTrackedState.knownBlendConstants && std::memcmp(mTrackedState.blendConstants, blendConstants, sizeof(mTrackedState.blendConstants)) == 0)
+		{
+			mStats.skippedCalls++;
+			return;
+		}
+		std::memcpy(mTrackedState.blendConstants, blendConstants, sizeof(mTrackedState.blendConstants));
+		mTrackedState.knownBlendConstants = true;
+	}
+
 	vkCmdSetBlendConstants(mCommandBuffer, blendConstants);
+	mStats.issuedCalls++;
 }
 
 void VulkanCommandBuffer::drawGeometry(VulkanU32 vertexCount, VulkanU32 instanceCount, VulkanU32 firstVertex,VulkanU32 firstInstance)
@@ -221,57 +445,67 @@ void VulkanCommandBuffer::drawIndexedGeometry(VulkanU32 indexCount, VulkanU32 in
 void VulkanCommandBuffer::dispatchComputeWork(VulkanU32 xSize, VulkanU32 ySize, VulkanU32 zSize)
 {
 	// TODO : Check parameters ?
+	flushBarriers();
 	vkCmdDispatch(mCommandBuffer, xSize, ySize, zSize);
 }
 
-void VulkanCommandBuffer::executeSecondaryCommandBuffer(const std::vector<VulkanCommandBuffer*>& secondaryCommandBuffers)
+void VulkanCommandBuffer::executeSecondaryCommandBuffer(VulkanArrayView<VulkanCommandBuffer*> secondaryCommandBuffers)
 {
 	// TODO : Improve parameters checking ?
 	if (secondaryCommandBuffers.size() > 0)
 	{
-		std::vector<VkCommandBuffer> commandBuffers;
-		commandBuffers.reserve(secondaryCommandBuffers.size());
+		if (!mInsideRenderPass)
+		{
+			flushBarriers();
+		}
+
+		VulkanSmallVector<VkCommandBuffer, 16> commandBuffers;
 		for (auto& commandBuffer : secondaryCommandBuffers)
 		{
 			commandBuffers.push_back(commandBuffer->getHandle());
 		}
 
 		vkCmdExecuteCommands(mCommandBuffer, static_cast<VulkanU32>(commandBuffers.size()), commandBuffers.data());
+
+		// The state of the primary command buffer is undefined after the execution of secondary command buffers
+		invalidateTrackedState();
 	}
 }
 
-void VulkanCommandBuffer::copyDataBetweenBuffers(VulkanBuffer* sourceBuffer, VulkanBuffer* destinationBuffer, std::vector<VkBufferCopy> regions)
+void VulkanCommandBuffer::copyDataBetweenBuffers(VulkanBuffer* sourceBuffer, VulkanBuffer* destinationBuffer, VulkanArrayView<VkBufferCopy> regions)
 {
 	// TODO : Improve parameters checking ?
 	if (regions.size() > 0)
 	{
+		flushBarriers();
 		vkCmdCopyBuffer(mCommandBuffer, sourceBuffer->getHandle(), destinationBuffer->getHandle(), static_cast<VulkanU32>(regions.size()), regions.data());
 	}
 }
 
-void VulkanCommandBuffer::copyDataFromBufferToImage(VulkanBuffer* sourceBuffer, VulkanImage* destinationImage, VkImageLayout imageLayout, std::vector<VkBufferImageCopy> regions)
+void VulkanCommandBuffer::copyDataFromBufferToImage(VulkanBuffer* sourceBuffer, VulkanImage* destinationImage, VkImageLayout imageLayout, VulkanArrayView<VkBufferImageCopy> regions)
 {
 	// TODO : Improve parameters checking ?
 	if (regions.size() > 0)
 	{
+		flushBarriers();
 		vkCmdCopyBufferToImage(mCommandBuffer, sourceBuffer->getHandle(), destinationImage->getHandle(), imageLayout, static_cast<VulkanU32>(regions.size()), regions.data());
 	}
 }
 
-void VulkanCommandBuffer::copyDataFromImageToBuffer(VulkanImage* sourceImage, VkImageLayout imageLayout, VulkanBuffer* destinationBuffer, std::vector<VkBufferImageCopy> regions)
+void VulkanCommandBuffer::copyDataFromImageToBuffer(VulkanImage* sourceImage, VkImageLayout imageLayout, VulkanBuffer* destinationBuffer, VulkanArrayView<VkBufferImageCopy> regions)
 {
 	// TODO : Improve parameters checking ?
 	if (regions.size() > 0)
 	{
+		flushBarriers();
 		vkCmdCopyImageToBuffer(mCommandBuffer, sourceImage->getHandle(), imageLayout, destinationBuffer->getHandle(), static_cast<VulkanU32>(regions.size()), regions.data());
 	}
 }
 
-void VulkanCommandBuffer::setBufferMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, const std::vector<VulkanBufferTransition>& bufferTransitions)
+void VulkanCommandBuffer::setBufferMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanArrayView<VulkanBufferTransition> bufferTransitions)
 {
 	// TODO : Improve parameters checking ?
-	std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers;
-	bufferMemoryBarriers.reserve(bufferTransitions.size());
+	VulkanSmallVector<VkBufferMemoryBarrier, 16> bufferMemoryBarriers;
 	for (auto& bufferTransition : bufferTransitions) 
 	{
 		bufferMemoryBarriers.push_back({
@@ -290,15 +524,25 @@ void VulkanCommandBuffer::setBufferMemoryBarrier(VkPipelineStageFlags generating
 
 	if (bufferMemoryBarriers.size() > 0) 
 	{
+		flushBarriers();
+
 		// TODO : What are those 0 parameters ?
 		vkCmdPipelineBarrier(mCommandBuffer, generatingStages, consumingStages, 0, 0, nullptr, static_cast<VulkanU32>(bufferMemoryBarriers.size()), bufferMemoryBarriers.data(), 0, nullptr);
+		mStats.barrierCalls++;
+		mStats.barriers += bufferMemoryBarriers.size();
+
+		// Keep the tracked state of the buffers up to date
+		for (auto& bufferTransition : bufferTransitions)
+		{
+			VulkanU32 queueFamily = (bufferTransition.newQueueFamily != VK_QUEUE_FAMILY_IGNORED) ? bufferTransition.newQueueFamily : bufferTransition.buffer->getCurrentQueueFamily();
+			bufferTransition.buffer->setCurrentState(bufferTransition.newAccess, consumingStages, queueFamily);
+		}
 	}
 }
 
-void VulkanCommandBuffer::setImageMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, const std::vector<VulkanImageTransition>& imageTransitions)
+void VulkanCommandBuffer::setImageMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanArrayView<VulkanImageTransition> imageTransitions)
 {
-	std::vector<VkImageMemoryBarrier> imageMemoryBarriers;
-	imageMemoryBarriers.reserve(imageTransitions.size());
+	VulkanSmallVector<VkImageMemoryBarrier, 16> imageMemoryBarriers;
 	for (auto& imageTransition : imageTransitions) 
 	{
 		imageMemoryBarriers.push_back({
@@ -324,11 +568,192 @@ void VulkanCommandBuffer::setImageMemoryBarrier(VkPipelineStageFlags generatingS
 
 	if (imageMemoryBarriers.size() > 0) 
 	{
+		flushBarriers();
+
 		// TODO : What are those 0 parameters ?
 		vkCmdPipelineBarrier(mCommandBuffer, generatingStages, consumingStages, 0, 0, nullptr, 0, nullptr, static_cast<VulkanU32>(imageMemoryBarriers.size()), imageMemoryBarriers.data());
+		mStats.barrierCalls++;
+		mStats.barriers += imageMemoryBarriers.size();
+	}
+}
+
+void VulkanCommandBuffer::transitionBuffer(VulkanBuffer* buffer, VkAccessFlags newAccess, VkPipelineStageFlags newStages)
+{
+	VULKAN_ASSERT(buffer != nullptr);
+	if (mInsideRenderPass)
+	{
+		VULKAN_LOG_ERROR("Buffer transitions can't be recorded inside a render pass");
+		return;
+	}
+
+	const VkAccessFlags currentAccess = buffer->getCurrentAccess();
+	const VkPipelineStageFlags currentStages = buffer->getCurrentStages();
+	const bool readAfterRead = isReadOnlyAccess(currentAccess) && isReadOnlyAccess(newAccess);
+	const VkAccessFlags access = readAfterRead ? (currentAccess | newAccess) : newAccess;
+	const VkPipelineStageFlags stages = readAfterRead ? (currentStages | newStages) : newStages;
+
+	// Nothing used the buffer since its pending barrier, so this barrier can be retargeted
+	for (VkBufferMemoryBarrier& barrier : mPendingBufferBarriers)
+	{
+		if (barrier.buffer == buffer->getHandle())
+		{
+			barrier.dstAccessMask = access;
+			mPendingDstStages |= newStages;
+			buffer->setCurrentState(access, stages, buffer->getCurrentQueueFamily());
+			return;
+		}
+	}
+
+	// Already visible to these readers
+	if (readAfterRead && (newAccess & ~currentAccess) == 0 && (newStages & ~currentStages) == 0)
+	{
+		return;
+	}
+
+	// Only the writes need to be made available
+	const VkAccessFlags srcAccess = isReadOnlyAccess(currentAccess) ? 0 : currentAccess;
+	mPendingBufferBarriers.push_back({
+		VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,    // VkStructureType    sType
+		nullptr,                                    // const void       * pNext
+		srcAccess,                                  // VkAccessFlags      srcAccessMask
+		newAccess,                                  // VkAccessFlags      dstAccessMask
+		VK_QUEUE_FAMILY_IGNORED,                    // uint32_t           srcQueueFamilyIndex
+		VK_QUEUE_FAMILY_IGNORED,                    // uint32_t           dstQueueFamilyIndex
+		buffer->getHandle(),                        // VkBuffer           buffer
+		0,                                          // VkDeviceSize       offset
+		VK_WHOLE_SIZE                               // VkDeviceSize       size
+	});
+	mPendingSrcStages |= currentStages;
+	mPendingDstStages |= newStages;
+	buffer->setCurrentState(access, stages, buffer->getCurrentQueueFamily());
+}
+
+void VulkanCommandBuffer::transitionImage(VulkanImage* image, VkAccessFlags newAccess, VkImageLayout newLayout, VkPipelineStageFlags newStages, VkImageAspectFlags aspect)
+{
+	VULKAN_ASSERT(image != nullptr);
+	if (mInsideRenderPass)
+	{
+		VULKAN_LOG_ERROR("Image transitions can't be recorded inside a render pass");
+		return;
+	}
+
+	const VkAccessFlags currentAccess = image->getCurrentAccess();
+	const VkPipelineStageFlags currentStages = image->getCurrentStages();
+	const VkImageLayout currentLayout = image->getCurrentLayout();
+
+	// A layout transition reads and writes the image
+	const bool readAfterRead = currentLayout == newLayout && isReadOnlyAccess(currentAccess) && isReadOnlyAccess(newAccess);
+	const VkAccessFlags access = readAfterRead ? (currentAccess | newAccess) : newAccess;
+	const VkPipelineStageFlags stages = readAfterRead ? (currentStages | newStages) : newStages;
+
+	// Nothing used the image since its pending barrier, so this barrier can be retargeted
+	for (VkImageMemoryBarrier& barrier : mPendingImageBarriers)
+	{
+		if (barrier.image == image->getHandle())
+		{
+			barrier.dstAccessMask = access;
+			barrier.newLayout = newLayout;
+			barrier.subresourceRange.aspectMask |= aspect;
+			mPendingDstStages |= newStages;
+			image->setCurrentState(access, stages, newLayout, image->getCurrentQueueFamily());
+			return;
+		}
+	}
+
+	// Already visible to these readers
+	if (readAfterRead && (newAccess & ~currentAccess) == 0 && (newStages & ~currentStages) == 0)
+	{
+		return;
+	}
+
+	// Only the writes need to be made available
+	const VkAccessFlags srcAccess = isReadOnlyAccess(currentAccess) ? 0 : currentAccess;
+	mPendingImageBarriers.push_back({
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,   // VkStructureType            sType
+		nullptr,                                  // const void               * pNext
+		srcAccess,                                // VkAccessFlags              srcAccessMask
+		newAccess,                                // VkAccessFlags              dstAccessMask
+		currentLayout,                            // VkImageLayout              oldLayout
+		newLayout,                                // VkImageLayout              newLayout
+		VK_QUEUE_FAMILY_IGNORED,                  // uint32_t                   srcQueueFamilyIndex
+		VK_QUEUE_FAMILY_IGNORED,                  // uint32_t                   dstQueueFamilyIndex
+		image->getHandle(),                       // VkImage                    image
+		{                                         // VkImageSubresourceRange    subresourceRange
+			aspect,                                   // VkImageAspectFlags         aspectMask
+			0,                                        // uint32_t                   baseMipLevel
+			VK_REMAINING_MIP_LEVELS,                  // uint32_t                   levelCount
+			0,                                        // uint32_t                   baseArrayLayer
+			VK_REMAINING_ARRAY_LAYERS                 // uint32_t                   layerCount
+		}
+	});
+	mPendingSrcStages |= currentStages;
+	mPendingDstStages |= newStages;
+	image->setCurrentState(access, stages, newLayout, image->getCurrentQueueFamily());
+}
+
+void VulkanCommandBuffer::flushBarriers()
+{
+	if (!hasPendingBarriers())
+	{
+		return;
 	}
+
+	vkCmdPipelineBarrier(mCommandBuffer, mPendingSrcStages, mPendingDstStages, 0, 0, nullptr, mPendingBufferBarriers.size(), mPendingBufferBarriers.data(), mPendingImageBarriers.size(), mPendingImageBarriers.data());
+	mStats.barrierCalls++;
+	mStats.barriers += mPendingBufferBarriers.size() + mPendingImageBarriers.size();
+
+	mPendingSrcStages = 0;
+	mPendingDstStages = 0;
+	mPendingBufferBarriers.clear();
+	mPendingImageBarriers.clear();
+}
+
+bool VulkanCommandBuffer::hasPendingBarriers() const
+{
+	return !mPendingBufferBarriers.empty() || !mPendingImageBarriers.empty();
 }
 
+void VulkanCommandBuffer::resetQueryPool(VulkanQueryPool* queryPool, VulkanU32 firstQuery, VulkanU32 queryCount)
+{
+	VULKAN_ASSERT(queryPool != nullptr, "Invalid query pool");
+	VULKAN_ASSERT(!mInsideRenderPass, "Queries can't be reset inside a render pass");
+	vkCmdResetQueryPool(mCommandBuffer, queryPool->getHandle(), firstQuery, queryCount);
+}
+
+void VulkanCommandBuffer::writeTimestamp(VkPipelineStageFlagBits pipelineStage, VulkanQueryPool* queryPool, VulkanU32 query)
+{
+	VULKAN_ASSERT(queryPool != nullptr, "Invalid query pool");
+	vkCmdWriteTimestamp(mCommandBuffer, pipelineStage, queryPool->getHandle(), query);
+}
+
+#if (defined VULKAN_OPTION_PROFILE)
+void VulkanCommandBuffer::setProfiler(VulkanGpuProfiler* profiler)
+{
+	mProfiler = profiler;
+}
+
+VulkanGpuProfiler* VulkanCommandBuffer::getProfiler() const
+{
+	return mProfiler;
+}
+
+void VulkanCommandBuffer::beginProfileScope(const char* name)
+{
+	if (mProfiler != nullptr)
+	{
+		mProfiler->beginScope(*this, name);
+	}
+}
+
+void VulkanCommandBuffer::endProfileScope()
+{
+	if (mProfiler != nullptr)
+	{
+		mProfiler->endScope(*this);
+	}
+}
+#endif
+
 bool VulkanCommandBuffer::reset()
 {
 	// TODO : Release or not ?
@@ -340,6 +765,9 @@ bool VulkanCommandBuffer::reset()
 		VULKAN_LOG_ERROR("Error occurred during command buffer reset\n");
 		return false;
 	}
+	invalidateTrackedState();
+	mPendingBufferBarriers.clear();
+	mPendingImageBarriers.clear();
 	return true;
 }
 
@@ -348,6 +776,26 @@ bool VulkanCommandBuffer::isRecording() const
 	return mRecording;
 }
 
+void VulkanCommandBuffer::setStateTracking(bool enabled)
+{
+	if (enabled && !mStateTracking)
+	{
+		// Calls made while disabled were not tracked
+		invalidateTrackedState();
+	}
+	mStateTracking = enabled;
+}
+
+bool VulkanCommandBuffer::isStateTrackingEnabled() const
+{
+	return mStateTracking;
+}
+
+const VulkanCommandBufferStats& VulkanCommandBuffer::getStats() const
+{
+	return mStats;
+}
+
 const VulkanCommandPool& VulkanCommandBuffer::getCommandPool() const
 {
 	return mCommandPool;
@@ -378,6 +826,17 @@ VulkanCommandBuffer::VulkanCommandBuffer(VulkanCommandPool& commandPool, VulkanC
 	, mCommandPool(commandPool)
 	, mType(type)
 	, mRecording(false)
+	, mStateTracking(false)
+	, mTrackedState()
+	, mStats()
+	, mInsideRenderPass(false)
+	, mPendingSrcStages(0)
+	, mPendingDstStages(0)
+	, mPendingBufferBarriers()
+	, mPendingImageBarriers()
+	#if (defined VULKAN_OPTION_PROFILE)
+	, mProfiler(nullptr)
+	#endif
 {
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
@@ -413,4 +872,16 @@ bool VulkanCommandBuffer::release()
 	return false;
 }
 
+void VulkanCommandBuffer::invalidateTrackedState()
+{
+	// VK_NULL_HANDLE and the known flags are all zero
+	std::memset(&mTrackedState, 0, sizeof(TrackedState));
+}
+
+bool VulkanCommandBuffer::isReadOnlyAccess(VkAccessFlags access)
+{
+	const VkAccessFlags writeAccesses = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	return (access & writeAccesses) == 0;
+}
+
 VULKAN_NAMESPACE_END
\ No newline at end of file
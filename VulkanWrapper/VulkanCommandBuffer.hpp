@@ -1,15 +1,10 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanContainers.hpp"
 
 VULKAN_NAMESPACE_BEGIN
 
-enum VulkanCommandBufferType
-{
-	Primary = 0,
-	Secondary = 1
-};
-
 struct VulkanBufferTransition 
 {
 	VulkanBuffer* buffer;
@@ -37,6 +32,15 @@ struct VulkanVertexBufferParameters
 	VkDeviceSize memoryOffset;
 };
 
+// Counters since the last beginRecording()
+struct VulkanCommandBufferStats
+{
+	VulkanU32 issuedCalls; // Binding and dynamic state calls sent to Vulkan
+	VulkanU32 skippedCalls; // Binding and dynamic state calls dropped by the state tracking
+	VulkanU32 barrierCalls; // vkCmdPipelineBarrier calls
+	VulkanU32 barriers; // Buffer and image barriers in these calls
+};
+
 class VulkanCommandBuffer : public VulkanObject<VulkanObjectType_CommandBuffer>
 {
 	public:
@@ -46,20 +50,22 @@ class VulkanCommandBuffer : public VulkanObject<VulkanObjectType_CommandBuffer>
 		bool endRecording();
 
 		// TODO : Pass Vulkan...* instead
-		void beginRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkRect2D renderArea, const std::vector<VkClearValue>& clearsValues, VkSubpassContents subpassContents);
+		void beginRenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, VkRect2D renderArea, VulkanArrayView<VkClearValue> clearsValues, VkSubpassContents subpassContents);
 		void progressToTheNextSubpass(VkSubpassContents subpassContents);
 		void endRenderPass();
 		
 		// TODO : Pass Vulkan...* instead
 		// TODO : Save layout in image
-		void clearColorImage(VkImage image, VkImageLayout imageLayout, const std::vector<VkImageSubresourceRange>& imageSubresourceRanges, VkClearColorValue& clearColor);
-		void clearDepthStencilImage(VkImage image, VkImageLayout imageLayout, const std::vector<VkImageSubresourceRange>& imageSubresourceRanges, VkClearDepthStencilValue& clearValue);
-		void clearRenderPassAttachments(const std::vector<VkClearAttachment>& attachments, const std::vector<VkClearRect>& rects);
+		void clearColorImage(VkImage image, VkImageLayout imageLayout, VulkanArrayView<VkImageSubresourceRange> imageSubresourceRanges, VkClearColorValue& clearColor);
+		void clearDepthStencilImage(VkImage image, VkImageLayout imageLayout, VulkanArrayView<VkImageSubresourceRange> imageSubresourceRanges, VkClearDepthStencilValue& clearValue);
+		void clearRenderPassAttachments(VulkanArrayView<VkClearAttachment> attachments, VulkanArrayView<VkClearRect> rects);
 
 		// TODO : Pass Vulkan...* instead
-		void bindVertexBuffers(VulkanU32 firstBinding, const std::vector<VulkanVertexBufferParameters>& buffersParameters);
+		void bindVertexBuffers(VulkanU32 firstBinding, VulkanArrayView<VulkanVertexBufferParameters> buffersParameters);
 		void bindIndexBuffer(VulkanBuffer* buffer, VkDeviceSize memoryOffset, VkIndexType indexType);
-		void bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, const std::vector<VulkanDescriptorSet*>& descriptorsSets, const std::vector<VulkanU32>& dynamicOffsets);
+		void bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, VulkanArrayView<VulkanDescriptorSet*> descriptorsSets, VulkanArrayView<VulkanU32> dynamicOffsets);
+		// Sets allocated by a VulkanDescriptorAllocator
+		void bindDescriptorSets(VkPipelineBindPoint pipelineType, VkPipelineLayout pipelineLayout, VulkanU32 indexForFirstSet, VulkanArrayView<VkDescriptorSet> descriptorsSets, VulkanArrayView<VulkanU32> dynamicOffsets);
 		void bindPipeline(VulkanGraphicsPipeline* pipeline);
 		void bindPipeline(VulkanComputePipeline* pipeline);
 
@@ -67,8 +73,8 @@ class VulkanCommandBuffer : public VulkanObject<VulkanObjectType_CommandBuffer>
 		void provideDataToShadersThroughPushConstants(VkPipelineLayout pipelineLayout, VkShaderStageFlags pipelineStages, VulkanU32 offset, VulkanU32 size, void* data);
 
 		// TODO : Create our own Viewport/Scissor class
-		void setViewportStateDynamically(VulkanU32 firstViewport, const std::vector<VkViewport>& viewports);
-		void setScissorStateDynamically(VulkanU32 firstScissor, const std::vector<VkRect2D>& scissors);
+		void setViewportStateDynamically(VulkanU32 firstViewport, VulkanArrayView<VkViewport> viewports);
+		void setScissorStateDynamically(VulkanU32 firstScissor, VulkanArrayView<VkRect2D> scissors);
 		void setLineWidthStateDynamically(float lineWidth);
 		void setDepthBiasStateDynamically(float constantFactor, float clampValue, float slopeFactor);
 		void setBlendConstantsStateDynamically(const float (&blendConstants)[4]);
@@ -81,20 +87,51 @@ class VulkanCommandBuffer : public VulkanObject<VulkanObjectType_CommandBuffer>
 
 		// TODO : Pass Vulkan...* instead
 		// TODO : Store this as members ? Allow creation of secondary from primary ?
-		void executeSecondaryCommandBuffer(const std::vector<VulkanCommandBuffer*>& secondaryCommandBuffers);
+		void executeSecondaryCommandBuffer(VulkanArrayView<VulkanCommandBuffer*> secondaryCommandBuffers);
 
 		// TODO : Save ImageLayout in Image ?
-		void copyDataBetweenBuffers(VulkanBuffer* sourceBuffer, VulkanBuffer* destinationBuffer, std::vector<VkBufferCopy> regions);
-		void copyDataFromBufferToImage(VulkanBuffer* sourceBuffer, VulkanImage* destinationImage, VkImageLayout imageLayout, std::vector<VkBufferImageCopy> regions);
-		void copyDataFromImageToBuffer(VulkanImage* sourceImage, VkImageLayout imageLayout, VulkanBuffer* destinationBuffer, std::vector<VkBufferImageCopy> regions);
-
-		void setBufferMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, const std::vector<VulkanBufferTransition>& bufferTransitions);
-		void setImageMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, const std::vector<VulkanImageTransition>& imageTransitions);
+		void copyDataBetweenBuffers(VulkanBuffer* sourceBuffer, VulkanBuffer* destinationBuffer, VulkanArrayView<VkBufferCopy> regions);
+		void copyDataFromBufferToImage(VulkanBuffer* sourceBuffer, VulkanImage* destinationImage, VkImageLayout imageLayout, VulkanArrayView<VkBufferImageCopy> regions);
+		void copyDataFromImageToBuffer(VulkanImage* sourceImage, VkImageLayout imageLayout, VulkanBuffer* destinationBuffer, VulkanArrayView<VkBufferImageCopy> regions);
+
+		// Sent immediately, after the pending tracked transitions
+		void setBufferMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanArrayView<VulkanBufferTransition> bufferTransitions);
+		void setImageMemoryBarrier(VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanArrayView<VulkanImageTransition> imageTransitions);
+
+		// Tracked transitions : the current state is read from the resource, and the new state is saved in it
+		// The barriers are accumulated and sent as a single vkCmdPipelineBarrier before the next render pass, copy, clear or dispatch
+		// Nothing is sent when the resource is already readable with these accesses and stages
+		// They can't be recorded inside a render pass, and queue family ownership transfers still need the barriers above
+		void transitionBuffer(VulkanBuffer* buffer, VkAccessFlags newAccess, VkPipelineStageFlags newStages);
+		void transitionImage(VulkanImage* image, VkAccessFlags newAccess, VkImageLayout newLayout, VkPipelineStageFlags newStages, VkImageAspectFlags aspect);
+		void flushBarriers();
+		bool hasPendingBarriers() const;
+
+		// Queries must be reset outside of a render pass before being written
+		void resetQueryPool(VulkanQueryPool* queryPool, VulkanU32 firstQuery, VulkanU32 queryCount);
+		void writeTimestamp(VkPipelineStageFlagBits pipelineStage, VulkanQueryPool* queryPool, VulkanU32 query);
+
+		#if (defined VULKAN_OPTION_PROFILE)
+		// The scopes are measured by the profiler, nothing is written without one (see VULKAN_PROFILE_GPU_SCOPE)
+		void setProfiler(VulkanGpuProfiler* profiler);
+		VulkanGpuProfiler* getProfiler() const;
+		void beginProfileScope(const char* name);
+		void endProfileScope();
+		#endif
+
+		// Accesses without any write don't need to be made available by a barrier
+		static bool isReadOnlyAccess(VkAccessFlags access);
 
 		bool reset();
 
 		bool isRecording() const;
 
+		// When enabled, the bound pipelines, descriptor sets, vertex and index buffers and the dynamic states are remembered
+		// and the calls that would not change them are dropped
+		void setStateTracking(bool enabled);
+		bool isStateTrackingEnabled() const;
+		const VulkanCommandBufferStats& getStats() const;
+
 		const VulkanCommandPool& getCommandPool() const;
 
 		const VulkanCommandBufferType& getType() const;
@@ -111,10 +148,57 @@ class VulkanCommandBuffer : public VulkanObject<VulkanObjectType_CommandBuffer>
 		bool init();
 		bool release();
 
+		// Everything is unknown at the beginning of a command buffer and after executing secondary command buffers
+		void invalidateTrackedState();
+
 		VkCommandBuffer mCommandBuffer;
 		VulkanCommandPool& mCommandPool;
 		VulkanCommandBufferType mType;
 		bool mRecording;
+
+		// Calls outside of these ranges are always sent
+		static const VulkanU32 MaxTrackedDescriptorSets = 8;
+		static const VulkanU32 MaxTrackedVertexBindings = 16;
+		static const VulkanU32 MaxTrackedViewports = 16;
+
+		// Indexed by VK_PIPELINE_BIND_POINT_GRAPHICS and VK_PIPELINE_BIND_POINT_COMPUTE
+		// A VK_NULL_HANDLE entry is unknown
+		struct TrackedState
+		{
+			VkPipeline pipelines[2];
+			VkPipelineLayout pipelineLayouts[2];
+			VkDescriptorSet descriptorSets[2][MaxTrackedDescriptorSets];
+			VkBuffer vertexBuffers[MaxTrackedVertexBindings];
+			VkDeviceSize vertexBufferOffsets[MaxTrackedVertexBindings];
+			VkBuffer indexBuffer;
+			VkDeviceSize indexBufferOffset;
+			VkIndexType indexType;
+			VkViewport viewports[MaxTrackedViewports];
+			VkRect2D scissors[MaxTrackedViewports];
+			VulkanU32 knownViewports; // One bit per viewport
+			VulkanU32 knownScissors; // One bit per scissor
+			VulkanF32 lineWidth;
+			VulkanF32 depthBias[3];
+			VulkanF32 blendConstants[4];
+			bool knownLineWidth;
+			bool knownDepthBias;
+			bool knownBlendConstants;
+		};
+
+		bool mStateTracking;
+		TrackedState mTrackedState;
+		VulkanCommandBufferStats mStats;
+
+		// Tracked transitions not sent yet
+		bool mInsideRenderPass;
+		VkPipelineStageFlags mPendingSrcStages;
+		VkPipelineStageFlags mPendingDstStages;
+		VulkanSmallVector<VkBufferMemoryBarrier, 16> mPendingBufferBarriers;
+		VulkanSmallVector<VkImageMemoryBarrier, 16> mPendingImageBarriers;
+
+		#if (defined VULKAN_OPTION_PROFILE)
+		VulkanGpuProfiler* mProfiler;
+		#endif
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -53,6 +53,40 @@ VulkanCommandBufferPtr VulkanCommandPool::allocateSecondaryCommandBuffer()
 	return commandBuffer;
 }
 
+bool VulkanCommandPool::allocateCommandBuffers(VulkanCommandBufferType type, VulkanU32 count, std::vector<VulkanCommandBufferPtr>& commandBuffers)
+{
+	if (count == 0)
+	{
+		return true;
+	}
+
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,   // VkStructureType          sType
+		nullptr,                                          // const void             * pNext
+		mCommandPool,                                     // VkCommandPool            commandPool
+		(VkCommandBufferLevel)type,                       // VkCommandBufferLevel     level
+		count                                             // uint32_t                 commandBufferCount
+	};
+
+	std::vector<VkCommandBuffer> handles(count, VK_NULL_HANDLE);
+	VkResult result = vkAllocateCommandBuffers(getDeviceHandle(), &commandBufferAllocateInfo, handles.data());
+	if (result != VK_SUCCESS)
+	{
+		VULKAN_LOG_ERROR("Could not allocate %d command buffers", count);
+		return false;
+	}
+
+	commandBuffers.reserve(commandBuffers.size() + count);
+	for (VkCommandBuffer handle : handles)
+	{
+		VulkanCommandBufferPtr commandBuffer(new VulkanCommandBuffer(*this, type));
+		commandBuffer->mCommandBuffer = handle;
+		commandBuffers.push_back(std::move(commandBuffer));
+	}
+
+	return true;
+}
+
 bool VulkanCommandPool::reset()
 {
 	// TODO : What is the 0 parameter ?
@@ -15,7 +15,8 @@ class VulkanCommandPool : public VulkanDeviceObject<VulkanObjectType_CommandPool
         // TODO : Store the unique ptr inside pool ?
 		VulkanCommandBufferPtr allocatePrimaryCommandBuffer();
 		VulkanCommandBufferPtr allocateSecondaryCommandBuffer();
-		// TODO : Allocate n at once
+		// All the command buffers are allocated with a single call, they are appended to commandBuffers
+		bool allocateCommandBuffers(VulkanCommandBufferType type, VulkanU32 count, std::vector<VulkanCommandBufferPtr>& commandBuffers);
 		
 		bool reset(); // TODO : Add release resources parameter ?
 
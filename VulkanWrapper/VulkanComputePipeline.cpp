@@ -5,11 +5,13 @@
 #include "VulkanPipelineLayout.hpp"
 #include "VulkanShaderModule.hpp"
 
+#include <chrono>
+
 VULKAN_NAMESPACE_BEGIN
 
-VulkanComputePipelinePtr VulkanComputePipeline::createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions)
+VulkanComputePipelinePtr VulkanComputePipeline::createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants)
 {
-	VulkanComputePipelinePtr computePipeline(new VulkanComputePipeline(computeShader, layout, cache, additionalOptions));
+	VulkanComputePipelinePtr computePipeline(new VulkanComputePipeline(computeShader, layout, cache, additionalOptions, specializationConstants));
 	if (computePipeline != nullptr)
 	{
 		if (!computePipeline->init())
@@ -37,9 +39,10 @@ const VkPipeline& VulkanComputePipeline::getHandle() const
 	return mComputePipeline;
 }
 
-VulkanComputePipeline::VulkanComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions)
+VulkanComputePipeline::VulkanComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants)
 	: mComputePipeline(VK_NULL_HANDLE)
 	, mComputeShader(computeShader->getShaderStage())
+	, mSpecializationConstants((specializationConstants != nullptr) ? *specializationConstants : VulkanSpecializationConstants())
 	, mLayout(layout)
 	, mCache(cache)
 	, mAdditionalOptions(additionalOptions)
@@ -47,9 +50,9 @@ VulkanComputePipeline::VulkanComputePipeline(VulkanShaderModule* computeShader,
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
 
-bool VulkanComputePipeline::init()
+void VulkanComputePipeline::fillCreateInfo(VkComputePipelineCreateInfo& createInfo) const
 {
-	VkComputePipelineCreateInfo computePipelineCreateInfo = {
+	createInfo = {
 		VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,   // VkStructureType                    sType
 		nullptr,                                          // const void                       * pNext
 		mAdditionalOptions,                               // VkPipelineCreateFlags              flags
@@ -58,9 +61,18 @@ bool VulkanComputePipeline::init()
 		VK_NULL_HANDLE,                                   // VkPipeline                         basePipelineHandle
 		-1                                                // int32_t                            basePipelineIndex
 	};
+	createInfo.stage.pSpecializationInfo = mSpecializationConstants.getInfo();
+}
+
+bool VulkanComputePipeline::init()
+{
+	VkComputePipelineCreateInfo computePipelineCreateInfo;
+	fillCreateInfo(computePipelineCreateInfo);
 
 	VkPipelineCache cacheHandle = (mCache != nullptr) ? mCache->getHandle() : VK_NULL_HANDLE;
 
+	auto start = std::chrono::high_resolution_clock::now();
+
 	VkResult result = vkCreateComputePipelines(getDeviceHandle(), cacheHandle, 1, &computePipelineCreateInfo, nullptr, &mComputePipeline);
 	if (result != VK_SUCCESS || mComputePipeline == VK_NULL_HANDLE)
 	{
@@ -68,6 +80,11 @@ bool VulkanComputePipeline::init()
 		return false;
 	}
 
+	if (mCache != nullptr)
+	{
+		mCache->addPipelineCreationTime(std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
 	return true;
 }
 
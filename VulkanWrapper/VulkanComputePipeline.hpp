@@ -1,13 +1,14 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanSpecializationConstants.hpp"
 
 VULKAN_NAMESPACE_BEGIN
 
 class VulkanComputePipeline : public VulkanDeviceObject<VulkanObjectType_ComputePipeline>
 {
 	public:
-		static VulkanComputePipelinePtr createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions);
+		static VulkanComputePipelinePtr createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants = nullptr);
 
 		~VulkanComputePipeline();
 
@@ -15,14 +16,17 @@ class VulkanComputePipeline : public VulkanDeviceObject<VulkanObjectType_Compute
 		const VkPipeline& getHandle() const;
 
 	private:
-		VulkanComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions);
+		friend class VulkanPipelineBatch;
+		VulkanComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants);
 
+		void fillCreateInfo(VkComputePipelineCreateInfo& createInfo) const;
 		bool init();
 		bool release();
 
 		VkPipeline mComputePipeline;
 
 		VkPipelineShaderStageCreateInfo mComputeShader;
+		VulkanSpecializationConstants mSpecializationConstants;
 		VulkanPipelineLayout* mLayout;
 		VulkanPipelineCache* mCache;
 		VkPipelineCreateFlags mAdditionalOptions;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "VulkanCore.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+VULKAN_NAMESPACE_BEGIN
+
+// Non-owning view on contiguous elements, to pass arrays without allocating
+// It can be built from a std::vector, a single element (also written { element }) or a pointer and a count
+// The elements must outlive the view : only use it as a parameter, never store it
+// There is no std::initializer_list constructor, its array would be destroyed before the view when not used as a parameter
+template <typename T>
+class VulkanArrayView
+{
+	public:
+		VulkanArrayView() : mData(nullptr), mSize(0) {}
+		VulkanArrayView(const T* data, VulkanU32 size) : mData(data), mSize(size) {}
+		VulkanArrayView(const T& element) : mData(&element), mSize(1) {}
+		template <typename Allocator>
+		VulkanArrayView(const std::vector<T, Allocator>& elements) : mData(elements.data()), mSize(static_cast<VulkanU32>(elements.size())) {}
+
+		const T* data() const { return mData; }
+		VulkanU32 size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+
+		const T& operator[](VulkanU32 index) const { return mData[index]; }
+		const T* begin() const { return mData; }
+		const T* end() const { return mData + mSize; }
+
+	private:
+		const T* mData;
+		VulkanU32 mSize;
+};
+
+// Vector with its first N elements stored inline, it only allocates when it grows past N elements
+// Used as scratch storage to convert the parameters before calling Vulkan
+template <typename T, VulkanU32 N>
+class VulkanSmallVector
+{
+	static_assert(std::is_trivially_copyable<T>::value, "VulkanSmallVector only handles trivially copyable types");
+
+	public:
+		VulkanSmallVector() : mHeap(), mSize(0), mCapacity(N) {}
+
+		void push_back(const T& value)
+		{
+			if (mSize == mCapacity)
+			{
+				grow();
+			}
+			data()[mSize++] = value;
+		}
+
+		void clear() { mSize = 0; }
+
+		T* data() { return mHeap.empty() ? mInline : mHeap.data(); }
+		const T* data() const { return mHeap.empty() ? mInline : mHeap.data(); }
+		VulkanU32 size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+
+		T& operator[](VulkanU32 index) { return data()[index]; }
+		const T& operator[](VulkanU32 index) const { return data()[index]; }
+		T* begin() { return data(); }
+		T* end() { return data() + mSize; }
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + mSize; }
+
+		operator VulkanArrayView<T>() const { return VulkanArrayView<T>(data(), mSize); }
+
+	private:
+		void grow()
+		{
+			std::vector<T> heap(mCapacity * 2);
+			std::memcpy(heap.data(), data(), mSize * sizeof(T));
+			mHeap.swap(heap);
+			mCapacity *= 2;
+		}
+
+		T mInline[N];
+		std::vector<T> mHeap;
+		VulkanU32 mSize;
+		VulkanU32 mCapacity;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
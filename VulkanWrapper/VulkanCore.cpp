@@ -43,6 +43,7 @@ const char* objectTypeToCString(VulkanObjectType type)
 		case VulkanObjectType_DescriptorPool: return "DescriptorPool";
 		case VulkanObjectType_DescriptorSet: return "DescriptorSet";
 		case VulkanObjectType_DescriptorSetLayout: return "DescriptorSetLayout";
+		case VulkanObjectType_DescriptorUpdateTemplate: return "DescriptorUpdateTemplate";
 		case VulkanObjectType_Device: return "Device";
 		case VulkanObjectType_Fence: return "Fence";
 		case VulkanObjectType_Framebuffer: return "Framebuffer";
@@ -53,6 +54,7 @@ const char* objectTypeToCString(VulkanObjectType type)
 		case VulkanObjectType_MemoryBlock: return "MemoryBlock";
 		case VulkanObjectType_PipelineCache: return "PipelineCache";
 		case VulkanObjectType_PipelineLayout: return "PipelineLayout";
+		case VulkanObjectType_QueryPool: return "QueryPool";
 		case VulkanObjectType_Queue: return "Queue";
 		case VulkanObjectType_RenderPass: return "RenderPass";
 		case VulkanObjectType_Sampler: return "Sampler";
@@ -109,7 +109,15 @@
 #if (defined VULKAN_OPTION_NO_PROFILE)
 	#undef VULKAN_OPTION_PROFILE
 #endif
-// TODO : Implement profiling
+// TODO : CPU profiling
+#if (defined VULKAN_OPTION_PROFILE)
+	#define VULKAN_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define VULKAN_PROFILE_CONCAT(a, b) VULKAN_PROFILE_CONCAT_IMPL(a, b)
+	// GPU timestamps around the rest of the C++ scope, written by the VulkanGpuProfiler of the command buffer (see VulkanGpuProfiler.hpp)
+	#define VULKAN_PROFILE_GPU_SCOPE(commandBuffer, name) VulkanGpuProfileScope VULKAN_PROFILE_CONCAT(vulkanGpuProfileScope, __LINE__)((commandBuffer), (name))
+#else
+	#define VULKAN_PROFILE_GPU_SCOPE(commandBuffer, name) ((void)0)
+#endif
 
 ///////////////////////////////////////////
 // VULKAN_PLATFORM
@@ -225,35 +233,58 @@ namespace VulkanPriv
 // TODO : Ex for Pooled type (CmdBuffer, DescSet)
 #define VULKAN_UNIQUE_PTR_DECLARATION(Type) typedef std::unique_ptr<Type> Type##Ptr;
 // TODO : ForwardDeclarations
-// TODO : How to deal with enum ? (Like VulkanCommandBufferType)
 
+// Enums can't be forward declared, the ones used by several headers are declared here
+enum VulkanCommandBufferType
+{
+	Primary = 0,
+	Secondary = 1
+};
+
+class VulkanBindlessTable; VULKAN_UNIQUE_PTR_DECLARATION(VulkanBindlessTable);
 class VulkanBuffer; VULKAN_UNIQUE_PTR_DECLARATION(VulkanBuffer);
 class VulkanBufferView; VULKAN_UNIQUE_PTR_DECLARATION(VulkanBufferView);
 class VulkanCommandBuffer; VULKAN_UNIQUE_PTR_DECLARATION(VulkanCommandBuffer);
 class VulkanCommandPool; VULKAN_UNIQUE_PTR_DECLARATION(VulkanCommandPool);
 class VulkanComputePipeline; VULKAN_UNIQUE_PTR_DECLARATION(VulkanComputePipeline);
+class VulkanDescriptorAllocator; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorAllocator);
 class VulkanDescriptorPool; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorPool);
 class VulkanDescriptorSet; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorSet);
+class VulkanDescriptorSetCache; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorSetCache);
 class VulkanDescriptorSetLayout; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorSetLayout);
+class VulkanDescriptorUpdateTemplate; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDescriptorUpdateTemplate);
 class VulkanDevice; VULKAN_UNIQUE_PTR_DECLARATION(VulkanDevice);
 class VulkanFence; VULKAN_UNIQUE_PTR_DECLARATION(VulkanFence);
 class VulkanFramebuffer; VULKAN_UNIQUE_PTR_DECLARATION(VulkanFramebuffer);
+class VulkanGpuProfiler; VULKAN_UNIQUE_PTR_DECLARATION(VulkanGpuProfiler);
 class VulkanGraphicsPipeline; VULKAN_UNIQUE_PTR_DECLARATION(VulkanGraphicsPipeline);
 class VulkanImage; VULKAN_UNIQUE_PTR_DECLARATION(VulkanImage);
 class VulkanImageHelper; VULKAN_UNIQUE_PTR_DECLARATION(VulkanImageHelper);
 class VulkanImageView; VULKAN_UNIQUE_PTR_DECLARATION(VulkanImageView);
 class VulkanInstance; VULKAN_UNIQUE_PTR_DECLARATION(VulkanInstance);
 class VulkanMemoryBlock; VULKAN_UNIQUE_PTR_DECLARATION(VulkanMemoryBlock);
+class VulkanParallelRecorder; VULKAN_UNIQUE_PTR_DECLARATION(VulkanParallelRecorder);
 class VulkanPhysicalDevice; VULKAN_UNIQUE_PTR_DECLARATION(VulkanPhysicalDevice);
+class VulkanPipelineBatch; VULKAN_UNIQUE_PTR_DECLARATION(VulkanPipelineBatch);
 class VulkanPipelineCache; VULKAN_UNIQUE_PTR_DECLARATION(VulkanPipelineCache);
 class VulkanPipelineLayout; VULKAN_UNIQUE_PTR_DECLARATION(VulkanPipelineLayout);
+class VulkanPipelineStateCache; VULKAN_UNIQUE_PTR_DECLARATION(VulkanPipelineStateCache);
+class VulkanQueryPool; VULKAN_UNIQUE_PTR_DECLARATION(VulkanQueryPool);
 class VulkanQueue; VULKAN_UNIQUE_PTR_DECLARATION(VulkanQueue);
+class VulkanRenderGraph; VULKAN_UNIQUE_PTR_DECLARATION(VulkanRenderGraph);
 class VulkanRenderPass; VULKAN_UNIQUE_PTR_DECLARATION(VulkanRenderPass);
 class VulkanSampler; VULKAN_UNIQUE_PTR_DECLARATION(VulkanSampler);
 class VulkanSemaphore; VULKAN_UNIQUE_PTR_DECLARATION(VulkanSemaphore);
 class VulkanShaderModule; VULKAN_UNIQUE_PTR_DECLARATION(VulkanShaderModule);
+class VulkanShaderModuleCache; VULKAN_UNIQUE_PTR_DECLARATION(VulkanShaderModuleCache);
+class VulkanShaderReflection; VULKAN_UNIQUE_PTR_DECLARATION(VulkanShaderReflection);
+class VulkanSpecializationConstants; VULKAN_UNIQUE_PTR_DECLARATION(VulkanSpecializationConstants);
 class VulkanSurface; VULKAN_UNIQUE_PTR_DECLARATION(VulkanSurface);
 class VulkanSwapchain; VULKAN_UNIQUE_PTR_DECLARATION(VulkanSwapchain);
+class VulkanUploadManager; VULKAN_UNIQUE_PTR_DECLARATION(VulkanUploadManager);
+
+// Shader modules returned by VulkanShaderModuleCache are shared by the pipelines using them
+typedef std::shared_ptr<VulkanShaderModule> VulkanShaderModuleSharedPtr;
 
 enum VulkanObjectType : VulkanU32
 {
@@ -266,6 +297,7 @@ enum VulkanObjectType : VulkanU32
 	VulkanObjectType_DescriptorPool,
 	VulkanObjectType_DescriptorSet,
 	VulkanObjectType_DescriptorSetLayout,
+	VulkanObjectType_DescriptorUpdateTemplate,
 	VulkanObjectType_Device,
 	VulkanObjectType_Fence,
 	VulkanObjectType_Framebuffer,
@@ -276,6 +308,7 @@ enum VulkanObjectType : VulkanU32
 	VulkanObjectType_MemoryBlock,
 	VulkanObjectType_PipelineCache,
 	VulkanObjectType_PipelineLayout,
+	VulkanObjectType_QueryPool,
 	VulkanObjectType_Queue,
 	VulkanObjectType_RenderPass,
 	VulkanObjectType_Sampler,
@@ -0,0 +1,270 @@
+#include "VulkanDescriptorAllocator.hpp"
+
+#include "VulkanDescriptorPool.hpp"
+#include "VulkanDescriptorSetLayout.hpp"
+#include "VulkanDevice.hpp"
+
+#include <algorithm>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanDescriptorAllocatorPtr VulkanDescriptorAllocator::createDescriptorAllocator(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 setsPerPool)
+{
+	if (frameCount == 0 || setsPerPool == 0)
+	{
+		VULKAN_LOG_ERROR("A descriptor allocator needs at least one frame and one set per pool");
+		return nullptr;
+	}
+	return VulkanDescriptorAllocatorPtr(new VulkanDescriptorAllocator(device, frameCount, setsPerPool));
+}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+{
+	// The pools are destroyed with their sets
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocateDescriptorSet(VulkanDescriptorSetLayout* descriptorSetLayout)
+{
+	return allocate(mPersistentPools, descriptorSetLayout);
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocateTransientDescriptorSet(VulkanDescriptorSetLayout* descriptorSetLayout)
+{
+	return allocate(mFramePools[mCurrentFrame], descriptorSetLayout);
+}
+
+bool VulkanDescriptorAllocator::beginFrame(VulkanU32 frameIndex)
+{
+	VULKAN_ASSERT(frameIndex < getFrameCount(), "Invalid frame index");
+	mCurrentFrame = frameIndex;
+	return resetPools(mFramePools[frameIndex]);
+}
+
+VulkanU32 VulkanDescriptorAllocator::getCurrentFrame() const
+{
+	return mCurrentFrame;
+}
+
+VulkanU32 VulkanDescriptorAllocator::getFrameCount() const
+{
+	return static_cast<VulkanU32>(mFramePools.size());
+}
+
+bool VulkanDescriptorAllocator::reset()
+{
+	bool result = resetPools(mPersistentPools);
+	for (PoolLists& poolLists : mFramePools)
+	{
+		result = resetPools(poolLists) && result;
+	}
+	return result;
+}
+
+VulkanU32 VulkanDescriptorAllocator::getPoolCount() const
+{
+	size_t count = 0;
+	for (const Pattern& pattern : mPatterns)
+	{
+		count += pattern.freePools.size();
+	}
+	for (const std::vector<VulkanDescriptorPoolPtr>& pools : mPersistentPools)
+	{
+		count += pools.size();
+	}
+	for (const PoolLists& poolLists : mFramePools)
+	{
+		for (const std::vector<VulkanDescriptorPoolPtr>& pools : poolLists)
+		{
+			count += pools.size();
+		}
+	}
+	return static_cast<VulkanU32>(count);
+}
+
+const VulkanDescriptorAllocatorStats& VulkanDescriptorAllocator::getStats() const
+{
+	return mStats;
+}
+
+void VulkanDescriptorAllocator::resetStats()
+{
+	mStats.allocatedSets = 0;
+	mStats.createdPools = 0;
+	mStats.recycledPools = 0;
+	mStats.fullPools = 0;
+	mStats.resetPools = 0;
+}
+
+void VulkanDescriptorAllocator::printStats() const
+{
+	printf("Descriptors : %u sets allocated, %u layout patterns, %u pools (%u created, %u recycled)\n", mStats.allocatedSets, static_cast<VulkanU32>(mPatterns.size()), getPoolCount(), mStats.createdPools, mStats.recycledPools);
+	printf("Descriptors : %u full pools, %u pool resets\n", mStats.fullPools, mStats.resetPools);
+}
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 setsPerPool)
+	: mDevice(device)
+	, mInitialSetsPerPool(std::min(setsPerPool, MaxSetsPerPool))
+	, mCurrentFrame(0)
+	, mPatterns()
+	, mSetSizes()
+	, mFramePools(frameCount)
+	, mPersistentPools()
+	, mStats()
+{
+	resetStats();
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocate(PoolLists& poolLists, VulkanDescriptorSetLayout* descriptorSetLayout)
+{
+	VULKAN_ASSERT(descriptorSetLayout != nullptr && descriptorSetLayout->isInitialized(), "Invalid descriptor set layout");
+
+	const VulkanU32 pattern = getPattern(descriptorSetLayout);
+	if (poolLists.size() <= pattern)
+	{
+		poolLists.resize(mPatterns.size());
+	}
+	std::vector<VulkanDescriptorPoolPtr>& pools = poolLists[pattern];
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,         // VkStructureType                  sType
+		nullptr,                                                // const void                     * pNext
+		VK_NULL_HANDLE,                                         // VkDescriptorPool                 descriptorPool
+		1u,                                                     // uint32_t                         descriptorSetCount
+		&descriptorSetLayout->getHandle()                       // const VkDescriptorSetLayout    * pSetLayouts
+	};
+
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	if (!pools.empty())
+	{
+		descriptorSetAllocateInfo.descriptorPool = pools.back()->getHandle();
+		VkResult result = vkAllocateDescriptorSets(mDevice.getHandle(), &descriptorSetAllocateInfo, &descriptorSet);
+		if (result == VK_SUCCESS)
+		{
+			mStats.allocatedSets++;
+			return descriptorSet;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+		{
+			VULKAN_LOG_ERROR("Could not allocate descriptor set");
+			return VK_NULL_HANDLE;
+		}
+		mStats.fullPools++;
+	}
+
+	// The current pool is full (or there is none yet), the allocation can't fail in a new pool
+	VulkanDescriptorPoolPtr pool = acquirePool(pattern);
+	if (pool == nullptr)
+	{
+		return VK_NULL_HANDLE;
+	}
+	pools.push_back(std::move(pool));
+
+	descriptorSetAllocateInfo.descriptorPool = pools.back()->getHandle();
+	VkResult result = vkAllocateDescriptorSets(mDevice.getHandle(), &descriptorSetAllocateInfo, &descriptorSet);
+	if (result != VK_SUCCESS)
+	{
+		VULKAN_LOG_ERROR("Could not allocate descriptor set in a new pool");
+		return VK_NULL_HANDLE;
+	}
+
+	mStats.allocatedSets++;
+	return descriptorSet;
+}
+
+VulkanU32 VulkanDescriptorAllocator::getPattern(VulkanDescriptorSetLayout* descriptorSetLayout)
+{
+	// Found from the descriptors each time and not memorized by layout handle, a destroyed layout handle can be reused by a layout with other descriptors
+	// Descriptors of one set, one entry per type sorted by type, so the bindings order doesn't matter
+	std::vector<VkDescriptorPoolSize>& setSizes = mSetSizes;
+	setSizes.clear();
+	for (const VkDescriptorSetLayoutBinding& binding : descriptorSetLayout->getBindings())
+	{
+		auto sizeItr = std::find_if(setSizes.begin(), setSizes.end(), [&binding](const VkDescriptorPoolSize& size) { return size.type == binding.descriptorType; });
+		if (sizeItr != setSizes.end())
+		{
+			sizeItr->descriptorCount += binding.descriptorCount;
+		}
+		else if (binding.descriptorCount > 0)
+		{
+			setSizes.push_back({ binding.descriptorType, binding.descriptorCount });
+		}
+	}
+	std::sort(setSizes.begin(), setSizes.end(), [](const VkDescriptorPoolSize& left, const VkDescriptorPoolSize& right) { return left.type < right.type; });
+
+	VulkanU32 pattern = 0;
+	while (pattern < mPatterns.size())
+	{
+		const std::vector<VkDescriptorPoolSize>& patternSizes = mPatterns[pattern].setSizes;
+		if (patternSizes.size() == setSizes.size() && std::equal(setSizes.begin(), setSizes.end(), patternSizes.begin(), [](const VkDescriptorPoolSize& left, const VkDescriptorPoolSize& right) { return left.type == right.type && left.descriptorCount == right.descriptorCount; }))
+		{
+			break;
+		}
+		pattern++;
+	}
+	if (pattern == mPatterns.size())
+	{
+		mPatterns.push_back({ setSizes, mInitialSetsPerPool, {} });
+	}
+	return pattern;
+}
+
+VulkanDescriptorPoolPtr VulkanDescriptorAllocator::acquirePool(VulkanU32 pattern)
+{
+	Pattern& poolPattern = mPatterns[pattern];
+	if (!poolPattern.freePools.empty())
+	{
+		VulkanDescriptorPoolPtr pool = std::move(poolPattern.freePools.back());
+		poolPattern.freePools.pop_back();
+		mStats.recycledPools++;
+		return pool;
+	}
+
+	const VulkanU32 setsCount = poolPattern.setsPerPool;
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	poolSizes.reserve(poolPattern.setSizes.size());
+	for (const VkDescriptorPoolSize& setSize : poolPattern.setSizes)
+	{
+		poolSizes.push_back({ setSize.type, setSize.descriptorCount * setsCount });
+	}
+	if (poolSizes.empty())
+	{
+		// Sets without descriptors, but a pool needs at least one size
+		poolSizes.push_back({ VK_DESCRIPTOR_TYPE_SAMPLER, 1 });
+	}
+
+	// Individual sets are never freed, the pools are reset as a whole
+	VulkanDescriptorPoolPtr pool = mDevice.createDescriptorPool(false, setsCount, poolSizes);
+	if (pool == nullptr || !pool->isInitialized())
+	{
+		return nullptr;
+	}
+
+	poolPattern.setsPerPool = std::min(setsCount * 2, MaxSetsPerPool);
+	mStats.createdPools++;
+	return pool;
+}
+
+bool VulkanDescriptorAllocator::resetPools(PoolLists& poolLists)
+{
+	bool result = true;
+	for (VulkanU32 pattern = 0; pattern < poolLists.size(); pattern++)
+	{
+		std::vector<VulkanDescriptorPoolPtr>& pools = poolLists[pattern];
+		for (VulkanDescriptorPoolPtr& pool : pools)
+		{
+			if (pool->reset())
+			{
+				mPatterns[pattern].freePools.push_back(std::move(pool));
+				mStats.resetPools++;
+			}
+			else
+			{
+				result = false;
+			}
+		}
+		pools.clear();
+	}
+	return result;
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+#include <vector>
+
+// TODO : Thread safety (one allocator per recording thread for now)
+// TODO : Variable descriptor counts
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanDescriptorAllocatorStats
+{
+	VulkanU32 allocatedSets;
+	VulkanU32 createdPools;
+	VulkanU32 recycledPools; // Reset pools used again instead of creating new ones
+	VulkanU32 fullPools; // Allocations that had to move to another pool
+	VulkanU32 resetPools;
+};
+
+// Allocates descriptor sets without pools sized by hand
+// The layouts with the same descriptors share the same pools, sized for DefaultSetsPerPool sets of this layout
+// When a pool is full, the allocation moves to a new pool twice bigger, or to a pool recycled from a previous frame
+// The transient sets belong to the current frame : when the frame comes back, its pools are reset at once instead of freeing the sets
+// The persistent sets live until reset() or the destruction of the allocator
+class VulkanDescriptorAllocator
+{
+	public:
+		static const VulkanU32 DefaultSetsPerPool = 64;
+		static const VulkanU32 MaxSetsPerPool = 4096;
+
+		// frameCount is the number of frames in flight, the transient sets of a frame are reused frameCount frames later
+		static VulkanDescriptorAllocatorPtr createDescriptorAllocator(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 setsPerPool = DefaultSetsPerPool);
+
+		~VulkanDescriptorAllocator();
+
+		// The layout must stay alive while the allocator uses it
+		VkDescriptorSet allocateDescriptorSet(VulkanDescriptorSetLayout* descriptorSetLayout);
+		VkDescriptorSet allocateTransientDescriptorSet(VulkanDescriptorSetLayout* descriptorSetLayout);
+
+		// The previous submissions of this frame must be finished (ex: after waiting its fence)
+		// The transient sets of the frame are freed by resetting their pools
+		bool beginFrame(VulkanU32 frameIndex);
+		VulkanU32 getCurrentFrame() const;
+		VulkanU32 getFrameCount() const;
+
+		// Frees all the sets, persistent ones included, the pools are kept for the next allocations
+		bool reset();
+
+		VulkanU32 getPoolCount() const;
+		const VulkanDescriptorAllocatorStats& getStats() const;
+		void resetStats();
+		void printStats() const;
+
+	private:
+		VulkanDescriptorAllocator(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 setsPerPool);
+
+		// Descriptors needed by one set, shared by the layouts with the same descriptors
+		struct Pattern
+		{
+			std::vector<VkDescriptorPoolSize> setSizes;
+			VulkanU32 setsPerPool; // Of the next pool created for this pattern
+			std::vector<VulkanDescriptorPoolPtr> freePools; // Reset and ready to be used again
+		};
+
+		// Pools in use by one frame (or by the persistent sets), per pattern, the last one is the one being filled
+		typedef std::vector<std::vector<VulkanDescriptorPoolPtr>> PoolLists;
+
+		VkDescriptorSet allocate(PoolLists& poolLists, VulkanDescriptorSetLayout* descriptorSetLayout);
+		VulkanU32 getPattern(VulkanDescriptorSetLayout* descriptorSetLayout);
+		VulkanDescriptorPoolPtr acquirePool(VulkanU32 pattern);
+		bool resetPools(PoolLists& poolLists);
+
+		VulkanDevice& mDevice;
+		VulkanU32 mInitialSetsPerPool;
+		VulkanU32 mCurrentFrame;
+
+		std::vector<Pattern> mPatterns;
+		std::vector<VkDescriptorPoolSize> mSetSizes; // Kept to not allocate while finding the pattern of each set
+		std::vector<PoolLists> mFramePools;
+		PoolLists mPersistentPools;
+
+		VulkanDescriptorAllocatorStats mStats;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -6,9 +6,9 @@
 
 VULKAN_NAMESPACE_BEGIN
 
-VulkanDescriptorPoolPtr VulkanDescriptorPool::createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes)
+VulkanDescriptorPoolPtr VulkanDescriptorPool::createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags)
 {
-	VulkanDescriptorPoolPtr descriptorPool(new VulkanDescriptorPool(freeIndividualSets, maxSetsCount, descriptorTypes));
+	VulkanDescriptorPoolPtr descriptorPool(new VulkanDescriptorPool(freeIndividualSets, maxSetsCount, descriptorTypes, additionalFlags));
 	if (descriptorPool != nullptr)
 	{
 		if (!descriptorPool->init())
@@ -73,11 +73,12 @@ const VkDescriptorPool& VulkanDescriptorPool::getHandle() const
 	return mDescriptorPool;
 }
 
-VulkanDescriptorPool::VulkanDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes)
+VulkanDescriptorPool::VulkanDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags)
 	: mDescriptorPool(VK_NULL_HANDLE)
 	, mFreeIndividualSets(freeIndividualSets)
 	, mMaxSetsCount(maxSetsCount)
 	, mDescriptorTypes(descriptorTypes)
+	, mAdditionalFlags(additionalFlags)
 {
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
@@ -87,8 +88,8 @@ bool VulkanDescriptorPool::init()
 	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
 		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,                // VkStructureType                sType
 		nullptr,                                                      // const void                   * pNext
-		mFreeIndividualSets ?                                         // VkDescriptorPoolCreateFlags    flags
-		VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0u,
+		mAdditionalFlags | (mFreeIndividualSets ?                     // VkDescriptorPoolCreateFlags    flags
+		VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0u),
 		mMaxSetsCount,                                                // uint32_t                       maxSets
 		static_cast<VulkanU32>(mDescriptorTypes.size()),               // uint32_t                       poolSizeCount
 		mDescriptorTypes.data()                                       // const VkDescriptorPoolSize   * pPoolSizes
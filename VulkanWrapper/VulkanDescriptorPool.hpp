@@ -7,7 +7,8 @@ VULKAN_NAMESPACE_BEGIN
 class VulkanDescriptorPool : public VulkanDeviceObject<VulkanObjectType_DescriptorPool>
 {
 	public:
-		static VulkanDescriptorPoolPtr createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes);
+		// additionalFlags : e.g. VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT for layouts created with the matching flag
+		static VulkanDescriptorPoolPtr createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags = 0);
 
 		~VulkanDescriptorPool();
 
@@ -27,7 +28,7 @@ class VulkanDescriptorPool : public VulkanDeviceObject<VulkanObjectType_Descript
 		const VkDescriptorPool& getHandle() const;
 
 	private:
-		VulkanDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes);
+		VulkanDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags);
 
 		bool init();
 		bool release();
@@ -37,6 +38,7 @@ class VulkanDescriptorPool : public VulkanDeviceObject<VulkanObjectType_Descript
 		bool mFreeIndividualSets;
 		VulkanU32 mMaxSetsCount;
 		std::vector<VkDescriptorPoolSize> mDescriptorTypes;
+		VkDescriptorPoolCreateFlags mAdditionalFlags;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
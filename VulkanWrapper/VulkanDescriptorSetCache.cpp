@@ -0,0 +1,113 @@
+#include "VulkanDescriptorSetCache.hpp"
+
+#include "VulkanDescriptorAllocator.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanHash.hpp"
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanDescriptorSetCachePtr VulkanDescriptorSetCache::createDescriptorSetCache(VulkanDevice& device)
+{
+	VulkanDescriptorSetCachePtr descriptorSetCache(new VulkanDescriptorSetCache(device));
+	if (descriptorSetCache != nullptr)
+	{
+		if (!descriptorSetCache->init())
+		{
+			descriptorSetCache.reset();
+		}
+	}
+	return descriptorSetCache;
+}
+
+VulkanDescriptorSetCache::~VulkanDescriptorSetCache()
+{
+	// The sets are freed with the pools of the allocator
+}
+
+VkDescriptorSet VulkanDescriptorSetCache::getDescriptorSet(const VulkanDescriptorUpdateTemplate& descriptorUpdateTemplate, const VulkanDescriptorData* data)
+{
+	mStats.requests++;
+
+	const VulkanDescriptorUpdateTemplate* templatePointer = &descriptorUpdateTemplate;
+	const VulkanU64 dataHash = descriptorUpdateTemplate.hash(data);
+	VulkanHasher hasher;
+	hasher.add(&templatePointer, sizeof(templatePointer));
+	hasher.add(&dataHash, sizeof(dataHash));
+	const VulkanU64 hash = hasher.getHash();
+
+	auto range = mEntries.equal_range(hash);
+	for (auto itr = range.first; itr != range.second; ++itr)
+	{
+		const Entry& entry = itr->second;
+		if (entry.descriptorUpdateTemplate == templatePointer && descriptorUpdateTemplate.equals(mData.data() + entry.dataOffset, data))
+		{
+			mStats.hits++;
+			return entry.descriptorSet;
+		}
+	}
+
+	VkDescriptorSet descriptorSet = mDescriptorAllocator->allocateDescriptorSet(&descriptorUpdateTemplate.getDescriptorSetLayout());
+	if (descriptorSet == VK_NULL_HANDLE)
+	{
+		return VK_NULL_HANDLE;
+	}
+	descriptorUpdateTemplate.update(descriptorSet, data);
+
+	const VulkanU32 descriptorCount = descriptorUpdateTemplate.getDescriptorCount();
+	const VulkanU32 dataOffset = static_cast<VulkanU32>(mData.size());
+	mData.insert(mData.end(), data, data + descriptorCount);
+	mEntries.insert({ hash, { templatePointer, dataOffset, descriptorSet } });
+
+	mStats.writtenSets++;
+	mStats.writtenDescriptors += descriptorCount;
+	return descriptorSet;
+}
+
+bool VulkanDescriptorSetCache::clear()
+{
+	mEntries.clear();
+	mData.clear();
+	return mDescriptorAllocator->reset();
+}
+
+VulkanU32 VulkanDescriptorSetCache::getSetCount() const
+{
+	return static_cast<VulkanU32>(mEntries.size());
+}
+
+const VulkanDescriptorSetCacheStats& VulkanDescriptorSetCache::getStats() const
+{
+	return mStats;
+}
+
+void VulkanDescriptorSetCache::resetStats()
+{
+	mStats.requests = 0;
+	mStats.hits = 0;
+	mStats.writtenSets = 0;
+	mStats.writtenDescriptors = 0;
+}
+
+void VulkanDescriptorSetCache::printStats() const
+{
+	printf("Descriptor sets : %u requests, %u hits, %u sets written (%u descriptors), %u sets cached\n", mStats.requests, mStats.hits, mStats.writtenSets, mStats.writtenDescriptors, getSetCount());
+}
+
+VulkanDescriptorSetCache::VulkanDescriptorSetCache(VulkanDevice& device)
+	: mDevice(device)
+	, mDescriptorAllocator()
+	, mEntries()
+	, mData()
+	, mStats()
+{
+	resetStats();
+}
+
+bool VulkanDescriptorSetCache::init()
+{
+	// Only persistent sets, a single frame is enough
+	mDescriptorAllocator = VulkanDescriptorAllocator::createDescriptorAllocator(mDevice, 1);
+	return mDescriptorAllocator != nullptr;
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanDescriptorUpdateTemplate.hpp"
+
+#include <unordered_map>
+
+// TODO : Forget only the sets that use a destroyed resource
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanDescriptorSetCacheStats
+{
+	VulkanU32 requests;
+	VulkanU32 hits;
+	VulkanU32 writtenSets; // Sets allocated and written with their template
+	VulkanU32 writtenDescriptors;
+};
+
+// Returns the same descriptor set for the same template and the same resources
+// The sets are never written again once created, so with many materials most frames don't write any descriptor
+// The sets are keyed by the hash of the resources, and the resources are compared on a hash hit
+// The sets refer to the resources by handle : clear() must be called (with the device idle) before destroying a resource still cached
+class VulkanDescriptorSetCache
+{
+	public:
+		static VulkanDescriptorSetCachePtr createDescriptorSetCache(VulkanDevice& device);
+
+		~VulkanDescriptorSetCache();
+
+		// data holds descriptorUpdateTemplate.getDescriptorCount() descriptors
+		VkDescriptorSet getDescriptorSet(const VulkanDescriptorUpdateTemplate& descriptorUpdateTemplate, const VulkanDescriptorData* data);
+
+		// Forgets all the sets, the previous submissions using them must be finished
+		bool clear();
+
+		VulkanU32 getSetCount() const;
+		const VulkanDescriptorSetCacheStats& getStats() const;
+		void resetStats();
+		void printStats() const;
+
+	private:
+		VulkanDescriptorSetCache(VulkanDevice& device);
+
+		bool init();
+
+		struct Entry
+		{
+			const VulkanDescriptorUpdateTemplate* descriptorUpdateTemplate;
+			VulkanU32 dataOffset; // In mData
+			VkDescriptorSet descriptorSet;
+		};
+
+		VulkanDevice& mDevice;
+		VulkanDescriptorAllocatorPtr mDescriptorAllocator;
+
+		std::unordered_multimap<VulkanU64, Entry> mEntries; // By hash of the template and the resources
+		std::vector<VulkanDescriptorData> mData; // Resources of the cached sets, to compare them on a hash hit
+		VulkanDescriptorSetCacheStats mStats;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -4,9 +4,9 @@
 
 VULKAN_NAMESPACE_BEGIN
 
-VulkanDescriptorSetLayoutPtr VulkanDescriptorSetLayout::createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+VulkanDescriptorSetLayoutPtr VulkanDescriptorSetLayout::createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags)
 {
-	VulkanDescriptorSetLayoutPtr descriptorSetLayout(new VulkanDescriptorSetLayout(bindings));
+	VulkanDescriptorSetLayoutPtr descriptorSetLayout(new VulkanDescriptorSetLayout(bindings, flags, bindingFlags));
 	if (descriptorSetLayout != nullptr)
 	{
 		if (!descriptorSetLayout->init())
@@ -34,20 +34,45 @@ const VkDescriptorSetLayout& VulkanDescriptorSetLayout::getHandle() const
 	return mDescriptorSetLayout;
 }
 
-VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+const std::vector<VkDescriptorSetLayoutBinding>& VulkanDescriptorSetLayout::getBindings() const
+{
+	return mBindings;
+}
+
+VkDescriptorSetLayoutCreateFlags VulkanDescriptorSetLayout::getFlags() const
+{
+	return mFlags;
+}
+
+VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags)
 	: mDescriptorSetLayout(VK_NULL_HANDLE)
 	, mBindings(bindings)
+	, mFlags(flags)
+	, mBindingFlags(bindingFlags)
 {
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
 
 bool VulkanDescriptorSetLayout::init()
 {
-	// TODO : Flags ?
+	if (!mBindingFlags.empty() && mBindingFlags.size() != mBindings.size())
+	{
+		VULKAN_LOG_ERROR("The binding flags of a layout for descriptor sets must match its bindings");
+		return false;
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT, // VkStructureType                      sType
+		nullptr,                                                               // const void                         * pNext
+		static_cast<VulkanU32>(mBindingFlags.size()),                           // uint32_t                             bindingCount
+		mBindingFlags.data()                                                   // const VkDescriptorBindingFlagsEXT  * pBindingFlags
+	};
+
 	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
 		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
-		nullptr,                                              // const void                         * pNext
-		0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
+		mBindingFlags.empty() ?                               // const void                         * pNext
+		nullptr : &bindingFlagsCreateInfo,
+		mFlags,                                               // VkDescriptorSetLayoutCreateFlags     flags
 		static_cast<VulkanU32>(mBindings.size()),              // uint32_t                             bindingCount
 		mBindings.data()                                      // const VkDescriptorSetLayoutBinding * pBindings
 	};
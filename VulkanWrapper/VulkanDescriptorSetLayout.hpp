@@ -7,21 +7,26 @@ VULKAN_NAMESPACE_BEGIN
 class VulkanDescriptorSetLayout : public VulkanDeviceObject<VulkanObjectType_DescriptorSetLayout>
 {
 	public:
-		static VulkanDescriptorSetLayoutPtr createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+		// bindingFlags is empty or has one VkDescriptorBindingFlagsEXT per binding, it needs VK_EXT_descriptor_indexing
+		static VulkanDescriptorSetLayoutPtr createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags = 0, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags = {});
 
 		~VulkanDescriptorSetLayout();
 
 		bool isInitialized() const;
 		const VkDescriptorSetLayout& getHandle() const;
+		const std::vector<VkDescriptorSetLayoutBinding>& getBindings() const;
+		VkDescriptorSetLayoutCreateFlags getFlags() const;
 
 	private:
-		VulkanDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+		VulkanDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags);
 
 		bool init();
 		bool release();
 
 		VkDescriptorSetLayout mDescriptorSetLayout;
 		std::vector<VkDescriptorSetLayoutBinding> mBindings;
+		VkDescriptorSetLayoutCreateFlags mFlags;
+		std::vector<VkDescriptorBindingFlagsEXT> mBindingFlags;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
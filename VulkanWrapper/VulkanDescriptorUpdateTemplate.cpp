@@ -0,0 +1,303 @@
+#include "VulkanDescriptorUpdateTemplate.hpp"
+
+#include "VulkanContainers.hpp"
+#include "VulkanDescriptorSetLayout.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanHash.hpp"
+
+#include <algorithm>
+
+VULKAN_NAMESPACE_BEGIN
+
+static_assert(sizeof(VulkanDescriptorData) == sizeof(VkDescriptorImageInfo) && sizeof(VulkanDescriptorData) == sizeof(VkDescriptorBufferInfo), "The image and buffer infos of consecutive descriptors must be contiguous");
+
+VulkanDescriptorUpdateTemplatePtr VulkanDescriptorUpdateTemplate::createDescriptorUpdateTemplate(VulkanDescriptorSetLayout& descriptorSetLayout)
+{
+	VulkanDescriptorUpdateTemplatePtr descriptorUpdateTemplate(new VulkanDescriptorUpdateTemplate(descriptorSetLayout));
+	if (descriptorUpdateTemplate != nullptr)
+	{
+		if (!descriptorUpdateTemplate->init())
+		{
+			descriptorUpdateTemplate.reset();
+		}
+	}
+	return descriptorUpdateTemplate;
+}
+
+VulkanDescriptorUpdateTemplate::~VulkanDescriptorUpdateTemplate()
+{
+	release();
+
+	VULKAN_OBJECTTRACKER_UNREGISTER();
+}
+
+void VulkanDescriptorUpdateTemplate::update(VkDescriptorSet descriptorSet, const VulkanDescriptorData* data) const
+{
+	VULKAN_ASSERT(mInitialized, "Invalid descriptor update template");
+	VULKAN_ASSERT(descriptorSet != VK_NULL_HANDLE && (data != nullptr || mDescriptorCount == 0), "Invalid descriptor set or data");
+
+	if (mUseExtension)
+	{
+		vkUpdateDescriptorSetWithTemplateKHR(getDeviceHandle(), descriptorSet, mDescriptorUpdateTemplate, data);
+		return;
+	}
+
+	// The texel buffer views are the only descriptors that are not contiguous in the data
+	VulkanSmallVector<VkBufferView, 8> texelBufferViews;
+	if (mTexelBufferViewCount > 0)
+	{
+		for (const Entry& entry : mEntries)
+		{
+			if (entry.dataType == DataType::TexelBuffer)
+			{
+				for (VulkanU32 i = 0; i < entry.descriptorCount; i++)
+				{
+					texelBufferViews.push_back(data[entry.descriptorIndex + i].texelBufferView);
+				}
+			}
+		}
+	}
+
+	VulkanSmallVector<VkWriteDescriptorSet, 8> writes;
+	VulkanU32 texelBufferViewIndex = 0;
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		VkWriteDescriptorSet write = mWrites[i];
+		write.dstSet = descriptorSet;
+		const VulkanDescriptorData* entryData = data + mEntries[i].descriptorIndex;
+		switch (mEntries[i].dataType)
+		{
+			case DataType::Image: write.pImageInfo = &entryData->image; break;
+			case DataType::Buffer: write.pBufferInfo = &entryData->buffer; break;
+			case DataType::TexelBuffer: write.pTexelBufferView = texelBufferViews.data() + texelBufferViewIndex; texelBufferViewIndex += write.descriptorCount; break;
+		}
+		writes.push_back(write);
+	}
+
+	vkUpdateDescriptorSets(getDeviceHandle(), static_cast<VulkanU32>(writes.size()), writes.data(), 0, nullptr);
+}
+
+VulkanU32 VulkanDescriptorUpdateTemplate::getDescriptorIndex(VulkanU32 binding, VulkanU32 arrayElement) const
+{
+	for (const Entry& entry : mEntries)
+	{
+		if (entry.binding == binding)
+		{
+			return (arrayElement < entry.descriptorCount) ? entry.descriptorIndex + arrayElement : InvalidIndex;
+		}
+	}
+	return InvalidIndex;
+}
+
+VulkanU32 VulkanDescriptorUpdateTemplate::getDescriptorCount() const
+{
+	return mDescriptorCount;
+}
+
+VulkanU64 VulkanDescriptorUpdateTemplate::hash(const VulkanDescriptorData* data) const
+{
+	VulkanHasher hasher;
+	for (const Entry& entry : mEntries)
+	{
+		for (VulkanU32 i = entry.descriptorIndex; i < entry.descriptorIndex + entry.descriptorCount; i++)
+		{
+			switch (entry.dataType)
+			{
+				case DataType::Image:
+					hasher.add(&data[i].image.sampler, sizeof(VkSampler));
+					hasher.add(&data[i].image.imageView, sizeof(VkImageView));
+					hasher.add(&data[i].image.imageLayout, sizeof(VkImageLayout));
+					break;
+				case DataType::Buffer:
+					hasher.add(&data[i].buffer, sizeof(VkDescriptorBufferInfo));
+					break;
+				case DataType::TexelBuffer:
+					hasher.add(&data[i].texelBufferView, sizeof(VkBufferView));
+					break;
+			}
+		}
+	}
+	return hasher.getHash();
+}
+
+bool VulkanDescriptorUpdateTemplate::equals(const VulkanDescriptorData* left, const VulkanDescriptorData* right) const
+{
+	for (const Entry& entry : mEntries)
+	{
+		for (VulkanU32 i = entry.descriptorIndex; i < entry.descriptorIndex + entry.descriptorCount; i++)
+		{
+			switch (entry.dataType)
+			{
+				case DataType::Image:
+					if (left[i].image.sampler != right[i].image.sampler || left[i].image.imageView != right[i].image.imageView || left[i].image.imageLayout != right[i].image.imageLayout)
+					{
+						return false;
+					}
+					break;
+				case DataType::Buffer:
+					if (left[i].buffer.buffer != right[i].buffer.buffer || left[i].buffer.offset != right[i].buffer.offset || left[i].buffer.range != right[i].buffer.range)
+					{
+						return false;
+					}
+					break;
+				case DataType::TexelBuffer:
+					if (left[i].texelBufferView != right[i].texelBufferView)
+					{
+						return false;
+					}
+					break;
+			}
+		}
+	}
+	return true;
+}
+
+bool VulkanDescriptorUpdateTemplate::usesExtension() const
+{
+	return mUseExtension;
+}
+
+VulkanDescriptorSetLayout& VulkanDescriptorUpdateTemplate::getDescriptorSetLayout() const
+{
+	return mDescriptorSetLayout;
+}
+
+bool VulkanDescriptorUpdateTemplate::isInitialized() const
+{
+	return mInitialized;
+}
+
+const VkDescriptorUpdateTemplateKHR& VulkanDescriptorUpdateTemplate::getHandle() const
+{
+	return mDescriptorUpdateTemplate;
+}
+
+VulkanDescriptorUpdateTemplate::VulkanDescriptorUpdateTemplate(VulkanDescriptorSetLayout& descriptorSetLayout)
+	: mDescriptorSetLayout(descriptorSetLayout)
+	, mDescriptorUpdateTemplate(VK_NULL_HANDLE)
+	, mEntries()
+	, mWrites()
+	, mDescriptorCount(0)
+	, mTexelBufferViewCount(0)
+	, mUseExtension(false)
+	, mInitialized(false)
+{
+	VULKAN_OBJECTTRACKER_REGISTER();
+}
+
+bool VulkanDescriptorUpdateTemplate::init()
+{
+	std::vector<VkDescriptorSetLayoutBinding> bindings = mDescriptorSetLayout.getBindings();
+	std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& left, const VkDescriptorSetLayoutBinding& right) { return left.binding < right.binding; });
+
+	for (const VkDescriptorSetLayoutBinding& binding : bindings)
+	{
+		if (binding.descriptorCount == 0)
+		{
+			continue;
+		}
+
+		DataType dataType;
+		switch (binding.descriptorType)
+		{
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				dataType = DataType::Image;
+				break;
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				dataType = DataType::Buffer;
+				break;
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				dataType = DataType::TexelBuffer;
+				mTexelBufferViewCount += binding.descriptorCount;
+				break;
+			default:
+				VULKAN_LOG_ERROR("Descriptor type %d of binding %d is not handled by the update templates", binding.descriptorType, binding.binding);
+				return false;
+		}
+
+		mEntries.push_back({ binding.binding, mDescriptorCount, binding.descriptorCount, binding.descriptorType, dataType });
+		mDescriptorCount += binding.descriptorCount;
+	}
+
+	mUseExtension = getDevice().isExtensionEnabled(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+	if (mUseExtension)
+	{
+		std::vector<VkDescriptorUpdateTemplateEntryKHR> templateEntries;
+		templateEntries.reserve(mEntries.size());
+		for (const Entry& entry : mEntries)
+		{
+			templateEntries.push_back({
+				entry.binding,                                                    // uint32_t             dstBinding
+				0,                                                                // uint32_t             dstArrayElement
+				entry.descriptorCount,                                            // uint32_t             descriptorCount
+				entry.descriptorType,                                             // VkDescriptorType     descriptorType
+				entry.descriptorIndex * sizeof(VulkanDescriptorData),             // size_t               offset
+				sizeof(VulkanDescriptorData)                                      // size_t               stride
+			});
+		}
+
+		VkDescriptorUpdateTemplateCreateInfoKHR descriptorUpdateTemplateCreateInfo = {
+			VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR,        // VkStructureType                              sType
+			nullptr,                                                          // const void                                 * pNext
+			0,                                                                // VkDescriptorUpdateTemplateCreateFlags        flags
+			static_cast<VulkanU32>(templateEntries.size()),                   // uint32_t                                     descriptorUpdateEntryCount
+			templateEntries.data(),                                           // const VkDescriptorUpdateTemplateEntry      * pDescriptorUpdateEntries
+			VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR,            // VkDescriptorUpdateTemplateType               templateType
+			mDescriptorSetLayout.getHandle(),                                 // VkDescriptorSetLayout                        descriptorSetLayout
+			VK_PIPELINE_BIND_POINT_GRAPHICS,                                  // VkPipelineBindPoint                          pipelineBindPoint
+			VK_NULL_HANDLE,                                                   // VkPipelineLayout                             pipelineLayout
+			0                                                                 // uint32_t                                     set
+		};
+
+		VkResult result = vkCreateDescriptorUpdateTemplateKHR(getDeviceHandle(), &descriptorUpdateTemplateCreateInfo, nullptr, &mDescriptorUpdateTemplate);
+		if (result != VK_SUCCESS || mDescriptorUpdateTemplate == VK_NULL_HANDLE)
+		{
+			VULKAN_LOG_ERROR("Could not create a descriptor update template");
+			return false;
+		}
+	}
+	else
+	{
+		mWrites.reserve(mEntries.size());
+		for (const Entry& entry : mEntries)
+		{
+			mWrites.push_back({
+				VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                           // VkStructureType                  sType
+				nullptr,                                                          // const void                     * pNext
+				VK_NULL_HANDLE,                                                   // VkDescriptorSet                  dstSet
+				entry.binding,                                                    // uint32_t                         dstBinding
+				0,                                                                // uint32_t                         dstArrayElement
+				entry.descriptorCount,                                            // uint32_t                         descriptorCount
+				entry.descriptorType,                                             // VkDescriptorType                 descriptorType
+				nullptr,                                                          // const VkDescriptorImageInfo    * pImageInfo
+				nullptr,                                                          // const VkDescriptorBufferInfo   * pBufferInfo
+				nullptr                                                           // const VkBufferView             * pTexelBufferView
+			});
+		}
+	}
+
+	mInitialized = true;
+	return true;
+}
+
+bool VulkanDescriptorUpdateTemplate::release()
+{
+	mInitialized = false;
+	if (mDescriptorUpdateTemplate != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorUpdateTemplateKHR(getDeviceHandle(), mDescriptorUpdateTemplate, nullptr);
+		mDescriptorUpdateTemplate = VK_NULL_HANDLE;
+		return true;
+	}
+	return false;
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
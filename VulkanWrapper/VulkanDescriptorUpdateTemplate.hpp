@@ -0,0 +1,78 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+// TODO : Push descriptors templates (VK_KHR_push_descriptor)
+// TODO : Inline uniform blocks
+
+VULKAN_NAMESPACE_BEGIN
+
+// One descriptor of the data of a template, the member used depends on the type of its binding
+union VulkanDescriptorData
+{
+	VkDescriptorImageInfo image; // Samplers, images and input attachments
+	VkDescriptorBufferInfo buffer; // Uniform and storage buffers, dynamic or not
+	VkBufferView texelBufferView;
+};
+
+// Writes all the descriptors of a set in one call, from a flat array with one VulkanDescriptorData per descriptor
+// The data of each binding starts at getDescriptorIndex(binding), its array elements follow each other
+// Uses VK_KHR_descriptor_update_template when the device has it, or a single vkUpdateDescriptorSets with writes prepared once
+class VulkanDescriptorUpdateTemplate : public VulkanDeviceObject<VulkanObjectType_DescriptorUpdateTemplate>
+{
+	public:
+		static const VulkanU32 InvalidIndex = ~0u;
+
+		// The layout must outlive the template
+		static VulkanDescriptorUpdateTemplatePtr createDescriptorUpdateTemplate(VulkanDescriptorSetLayout& descriptorSetLayout);
+
+		~VulkanDescriptorUpdateTemplate();
+
+		void update(VkDescriptorSet descriptorSet, const VulkanDescriptorData* data) const;
+
+		VulkanU32 getDescriptorIndex(VulkanU32 binding, VulkanU32 arrayElement = 0) const; // InvalidIndex if the binding is not in the layout
+		VulkanU32 getDescriptorCount() const;
+
+		// Only the members used by the type of each binding are read, so the unused bytes of the data don't matter
+		VulkanU64 hash(const VulkanDescriptorData* data) const;
+		bool equals(const VulkanDescriptorData* left, const VulkanDescriptorData* right) const;
+
+		bool usesExtension() const;
+		VulkanDescriptorSetLayout& getDescriptorSetLayout() const;
+
+		bool isInitialized() const;
+		const VkDescriptorUpdateTemplateKHR& getHandle() const; // VK_NULL_HANDLE without the extension
+
+	private:
+		VulkanDescriptorUpdateTemplate(VulkanDescriptorSetLayout& descriptorSetLayout);
+
+		bool init();
+		bool release();
+
+		enum class DataType
+		{
+			Image,
+			Buffer,
+			TexelBuffer
+		};
+
+		struct Entry
+		{
+			VulkanU32 binding;
+			VulkanU32 descriptorIndex;
+			VulkanU32 descriptorCount;
+			VkDescriptorType descriptorType;
+			DataType dataType;
+		};
+
+		VulkanDescriptorSetLayout& mDescriptorSetLayout;
+		VkDescriptorUpdateTemplateKHR mDescriptorUpdateTemplate;
+		std::vector<Entry> mEntries; // Sorted by binding
+		std::vector<VkWriteDescriptorSet> mWrites; // Without the extension, one per entry
+		VulkanU32 mDescriptorCount;
+		VulkanU32 mTexelBufferViewCount;
+		bool mUseExtension;
+		bool mInitialized;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
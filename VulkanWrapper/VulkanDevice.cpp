@@ -15,6 +15,7 @@
 #include "VulkanMemoryBlock.hpp"
 #include "VulkanPipelineCache.hpp"
 #include "VulkanPipelineLayout.hpp"
+#include "VulkanQueryPool.hpp"
 #include "VulkanQueue.hpp"
 #include "VulkanRenderPass.hpp"
 #include "VulkanSampler.hpp"
@@ -22,6 +23,8 @@
 #include "VulkanShaderModule.hpp"
 #include "VulkanSwapchain.hpp"
 
+#include <cstring>
+
 VULKAN_NAMESPACE_BEGIN
 
 #if (defined VULKAN_MONO_DEVICE)
@@ -146,14 +149,14 @@ VulkanCommandPoolPtr VulkanDevice::createCommandPool(VkCommandPoolCreateFlags pa
 	return VulkanCommandPool::createCommandPool(parameters, queueFamily);
 }
 
-VulkanDescriptorPoolPtr VulkanDevice::createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes)
+VulkanDescriptorPoolPtr VulkanDevice::createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags)
 {
-	return VulkanDescriptorPool::createDescriptorPool(freeIndividualSets, maxSetsCount, descriptorTypes);
+	return VulkanDescriptorPool::createDescriptorPool(freeIndividualSets, maxSetsCount, descriptorTypes, additionalFlags);
 }
 
-VulkanDescriptorSetLayoutPtr VulkanDevice::createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+VulkanDescriptorSetLayoutPtr VulkanDevice::createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags)
 {
-	return VulkanDescriptorSetLayout::createDescriptorSetLayout(bindings);
+	return VulkanDescriptorSetLayout::createDescriptorSetLayout(bindings, flags, bindingFlags);
 }
 
 void VulkanDevice::updateDescriptorSets(const std::vector<VulkanImageDescriptorInfo>& imageDescriptorInfos, const std::vector<VulkanBufferDescriptorInfo>& bufferDescriptorInfos, const std::vector<VulkanTexelBufferDescriptorInfo>& texelBufferDescriptorInfos, const std::vector<VulkanCopyDescriptorInfo>& copyDescriptorInfos)
@@ -291,9 +294,9 @@ bool VulkanDevice::resetFences(const std::vector<VulkanFence*>& fences)
 	return false;
 }
 
-VulkanImagePtr VulkanDevice::createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usageScenarios, bool cubemap)
+VulkanImagePtr VulkanDevice::createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usageScenarios, bool cubemap, VkImageTiling tiling)
 {
-	return VulkanImage::createImage(type, format, size, numMipmaps, numLayers, samples, usageScenarios, cubemap);
+	return VulkanImage::createImage(type, format, size, numMipmaps, numLayers, samples, usageScenarios, cubemap, tiling);
 }
 
 VulkanMemoryBlockPtr VulkanDevice::createMemoryBlock(VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags memoryProperties)
@@ -301,19 +304,34 @@ VulkanMemoryBlockPtr VulkanDevice::createMemoryBlock(VkMemoryRequirements memory
 	return VulkanMemoryBlock::createMemoryBlock(memoryRequirements, memoryProperties);
 }
 
+VulkanMemoryAllocator& VulkanDevice::getMemoryAllocator()
+{
+	return mMemoryAllocator;
+}
+
+const VulkanMemoryAllocator& VulkanDevice::getMemoryAllocator() const
+{
+	return mMemoryAllocator;
+}
+
 VulkanPipelineCachePtr VulkanDevice::createPipelineCache(const std::vector<VulkanU8>& cacheData)
 {
 	return VulkanPipelineCache::createPipelineCache(cacheData);
 }
 
+VulkanPipelineCachePtr VulkanDevice::createPipelineCacheFromFile(const std::string& filename, bool autoSave)
+{
+	return VulkanPipelineCache::createPipelineCacheFromFile(filename, autoSave);
+}
+
 VulkanPipelineLayoutPtr VulkanDevice::createPipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts, const std::vector<VkPushConstantRange> pushConstantRanges)
 {
 	return VulkanPipelineLayout::createPipelineLayout(descriptorSetLayouts, pushConstantRanges);
 }
 
-VulkanComputePipelinePtr VulkanDevice::createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions)
+VulkanComputePipelinePtr VulkanDevice::createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants)
 {
-	return VulkanComputePipeline::createComputePipeline(computeShader, layout, cache, additionalOptions);
+	return VulkanComputePipeline::createComputePipeline(computeShader, layout, cache, additionalOptions, specializationConstants);
 }
 
 VulkanGraphicsPipelinePtr VulkanDevice::initGraphicsPipeline(VulkanPipelineLayout& layout, VulkanRenderPass& renderPass, VulkanPipelineCache* cache)
@@ -321,6 +339,11 @@ VulkanGraphicsPipelinePtr VulkanDevice::initGraphicsPipeline(VulkanPipelineLayou
 	return VulkanGraphicsPipelinePtr(new VulkanGraphicsPipeline(*this, layout, renderPass, cache));
 }
 
+VulkanQueryPoolPtr VulkanDevice::createQueryPool(VkQueryType queryType, VulkanU32 queryCount)
+{
+	return VulkanQueryPool::createQueryPool(queryType, queryCount);
+}
+
 VulkanRenderPassPtr VulkanDevice::initRenderPass()
 {
 	return VulkanRenderPassPtr(new VulkanRenderPass());
@@ -341,6 +364,11 @@ VulkanShaderModulePtr VulkanDevice::initShaderModule()
 	return VulkanShaderModulePtr(new VulkanShaderModule());
 }
 
+VulkanShaderModuleCache& VulkanDevice::getShaderModuleCache()
+{
+	return mShaderModuleCache;
+}
+
 VulkanSwapchainPtr VulkanDevice::createSwapchain(VulkanSurface& surface, std::vector<FrameResources>& framesResources)
 {
 	return VulkanSwapchain::createSwapchain(*this, surface, framesResources);
@@ -413,6 +441,33 @@ bool VulkanDevice::isExtensionSupported(const char* extensionName) const
 	return mPhysicalDevice.isExtensionSupported(extensionName);	
 }
 
+bool VulkanDevice::isExtensionEnabled(const char* extensionName) const
+{
+	for (const char* enabledExtension : mEnabledExtensions)
+	{
+		if (strcmp(enabledExtension, extensionName) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool VulkanDevice::isDescriptorIndexingEnabled() const
+{
+	return mDescriptorIndexingFeatures.runtimeDescriptorArray == VK_TRUE;
+}
+
+const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& VulkanDevice::getEnabledDescriptorIndexingFeatures() const
+{
+	return mDescriptorIndexingFeatures;
+}
+
+const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& VulkanDevice::getDescriptorIndexingProperties() const
+{
+	return mPhysicalDevice.getDescriptorIndexingProperties();
+}
+
 VulkanQueue* VulkanDevice::getQueue(VulkanU32 index)
 {
 	return mQueueManager.getQueue(index);
@@ -431,7 +486,11 @@ VulkanU32 VulkanDevice::getQueueCount() const
 VulkanDevice::VulkanDevice(VulkanPhysicalDevice& physicalDevice)
 	: mDevice(VK_NULL_HANDLE)
 	, mPhysicalDevice(physicalDevice)
+	, mEnabledExtensions()
+	, mDescriptorIndexingFeatures()
 	, mQueueManager(*this)
+	, mMemoryAllocator(*this)
+	, mShaderModuleCache(*this)
 {
 	if (!physicalDevice.areAllPropertiesQueried())
 	{
@@ -470,6 +529,41 @@ bool VulkanDevice::initializeInternal(VkPhysicalDeviceFeatures* desiredFeatures,
 			return false;
 		}
 	}
+	{
+		// Optional extensions, the wrapper falls back on the core functions without them
+		const char* optionalExtensions[] = {
+			VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME
+		};
+		for (const char* optionalExtension : optionalExtensions)
+		{
+			if (mPhysicalDevice.isExtensionSupported(optionalExtension))
+			{
+				desiredExtensions.emplace_back(optionalExtension);
+			}
+		}
+	}
+	{
+		// Descriptor indexing, only enabled with the features needed for bindless descriptors
+		mDescriptorIndexingFeatures = {};
+		mDescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& supportedFeatures = mPhysicalDevice.getDescriptorIndexingFeatures();
+		if (supportedFeatures.runtimeDescriptorArray
+			&& supportedFeatures.descriptorBindingPartiallyBound
+			&& supportedFeatures.descriptorBindingSampledImageUpdateAfterBind
+			&& supportedFeatures.descriptorBindingStorageBufferUpdateAfterBind
+			&& mPhysicalDevice.isExtensionSupported(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+		{
+			mDescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+			mDescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+			mDescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			mDescriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+			mDescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = supportedFeatures.descriptorBindingUpdateUnusedWhilePending;
+			mDescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = supportedFeatures.shaderSampledImageArrayNonUniformIndexing;
+			mDescriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = supportedFeatures.shaderStorageBufferArrayNonUniformIndexing;
+			desiredExtensions.emplace_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+			desiredExtensions.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		}
+	}
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 	if (!mQueueManager.initialize(queueParameters, surface, queueCreateInfos))
@@ -480,7 +574,8 @@ bool VulkanDevice::initializeInternal(VkPhysicalDeviceFeatures* desiredFeatures,
 	// TODO : Layers ?
 	VkDeviceCreateInfo deviceCreateInfo = {
 		VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,               // VkStructureType                  sType
-		nullptr,                                            // const void                     * pNext
+		isDescriptorIndexingEnabled() ?                     // const void                     * pNext
+		&mDescriptorIndexingFeatures : nullptr,
 		0,                                                  // VkDeviceCreateFlags              flags
 		static_cast<VulkanU32>(queueCreateInfos.size()),    // uint32_t                         queueCreateInfoCount
 		queueCreateInfos.data(),                            // const VkDeviceQueueCreateInfo  * pQueueCreateInfos
@@ -502,6 +597,7 @@ bool VulkanDevice::initializeInternal(VkPhysicalDeviceFeatures* desiredFeatures,
 	{
 		return false;
 	}
+	mEnabledExtensions = desiredExtensions;
 
 	if (!mQueueManager.initializeQueues())
 	{
@@ -516,8 +612,12 @@ bool VulkanDevice::uninitializeInternal()
 	if (mDevice != VK_NULL_HANDLE)
 	{
 		mQueueManager.release();
+		mMemoryAllocator.release();
+		mShaderModuleCache.clear();
 		vkDestroyDevice(mDevice, nullptr);
 		mDevice = VK_NULL_HANDLE;
+		mEnabledExtensions.clear();
+		mDescriptorIndexingFeatures = {};
 	}
 	return true;
 }
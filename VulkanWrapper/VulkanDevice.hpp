@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <unordered_map>
 
 #include "VulkanFunctions.hpp"
@@ -7,6 +8,8 @@
 #include "../CookBook/Common.hpp" // TODO : Remove this
 
 #include "VulkanQueueManager.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanShaderModuleCache.hpp"
 
 VULKAN_NAMESPACE_BEGIN
 
@@ -72,27 +75,32 @@ class VulkanDevice : VulkanObject<VulkanObjectType_Device>
 
 		VulkanCommandPoolPtr createCommandPool(VkCommandPoolCreateFlags parameters, VulkanU32 queueFamily);
 
-		VulkanDescriptorPoolPtr createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes); 
-		VulkanDescriptorSetLayoutPtr createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+		VulkanDescriptorPoolPtr createDescriptorPool(bool freeIndividualSets, VulkanU32 maxSetsCount, const std::vector<VkDescriptorPoolSize>& descriptorTypes, VkDescriptorPoolCreateFlags additionalFlags = 0); 
+		VulkanDescriptorSetLayoutPtr createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags = 0, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags = {});
 		void updateDescriptorSets(const std::vector<VulkanImageDescriptorInfo>& imageDescriptorInfos, const std::vector<VulkanBufferDescriptorInfo>& bufferDescriptorInfos, const std::vector<VulkanTexelBufferDescriptorInfo>& texelBufferDescriptorInfos, const std::vector<VulkanCopyDescriptorInfo>& copyDescriptorInfos);
 
 		VulkanFencePtr createFence(bool signaled = false);
 		bool waitFences(const std::vector<VulkanFence*>& fences, bool waitForAll, VulkanU64 timeout); // TODO : Friendlier Time type
 		bool resetFences(const std::vector<VulkanFence*>& fences);
 
-		VulkanImagePtr createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usageScenarios, bool cubemap);
+		VulkanImagePtr createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usageScenarios, bool cubemap, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL);
 		
 		VulkanMemoryBlockPtr createMemoryBlock(VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags memoryProperties);
+		VulkanMemoryAllocator& getMemoryAllocator();
+		const VulkanMemoryAllocator& getMemoryAllocator() const;
    
    		// TODO : Endianness ?
 		VulkanPipelineCachePtr createPipelineCache(const std::vector<VulkanU8>& cacheData = {});
+		VulkanPipelineCachePtr createPipelineCacheFromFile(const std::string& filename, bool autoSave = true);
 
 		VulkanPipelineLayoutPtr createPipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts, const std::vector<VkPushConstantRange> pushConstantRanges);
 
-		VulkanComputePipelinePtr createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions);
+		VulkanComputePipelinePtr createComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants = nullptr);
 
 		VulkanGraphicsPipelinePtr initGraphicsPipeline(VulkanPipelineLayout& layout, VulkanRenderPass& renderPass, VulkanPipelineCache* cache = nullptr);
 
+		VulkanQueryPoolPtr createQueryPool(VkQueryType queryType, VulkanU32 queryCount);
+
 		VulkanRenderPassPtr initRenderPass();
 
 		VulkanSamplerPtr createSampler(VkFilter magFilter, VkFilter minFilter, VkSamplerMipmapMode mipmapMode, VkSamplerAddressMode uAddressMode, VkSamplerAddressMode vAddressMode, VkSamplerAddressMode wAddressMode, VulkanF32 lodBias, VulkanF32 minLod, VulkanF32 maxLod, bool anisotropyEnable, VulkanF32 maxAnisotropy, bool compareEnable, VkCompareOp compareOperator, VkBorderColor borderColor, bool unnormalizedCoords);
@@ -100,6 +108,7 @@ class VulkanDevice : VulkanObject<VulkanObjectType_Device>
 		VulkanSemaphorePtr createSemaphore();
 		
 		VulkanShaderModulePtr initShaderModule();
+		VulkanShaderModuleCache& getShaderModuleCache();
 
 		VulkanSwapchainPtr createSwapchain(VulkanSurface& surface, std::vector<FrameResources>& framesResources);
 
@@ -118,6 +127,10 @@ class VulkanDevice : VulkanObject<VulkanObjectType_Device>
 		const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
 		const VkFormatProperties& getFormatProperties(VkFormat format) const;
 		bool isExtensionSupported(const char* extensionName) const;
+		bool isExtensionEnabled(const char* extensionName) const; // Required or optional extension enabled at the creation of the device
+		bool isDescriptorIndexingEnabled() const; // Runtime arrays, partially bound and updated after bind
+		const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& getEnabledDescriptorIndexingFeatures() const;
+		const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& getDescriptorIndexingProperties() const;
 
 		// VulkanQueueManager
 		VulkanQueue* getQueue(VulkanU32 index);
@@ -139,7 +152,11 @@ class VulkanDevice : VulkanObject<VulkanObjectType_Device>
 
 		VkDevice mDevice;
 		VulkanPhysicalDevice& mPhysicalDevice;
+		std::vector<const char*> mEnabledExtensions;
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT mDescriptorIndexingFeatures;
 		VulkanQueueManager mQueueManager;
+		VulkanMemoryAllocator mMemoryAllocator;
+		VulkanShaderModuleCache mShaderModuleCache;
 		
 		#if (defined VULKAN_MONO_DEVICE)
 		static VulkanDevice* sDevice;
@@ -41,6 +41,21 @@ bool VulkanFence::reset()
 	return true;
 }
 
+bool VulkanFence::isSignaled() const
+{
+	if (mSignaled)
+	{
+		return true;
+	}
+
+	VkResult result = vkGetFenceStatus(getDeviceHandle(), mFence);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+	{
+		VULKAN_LOG_ERROR("Could not get the status of a fence");
+	}
+	return result == VK_SUCCESS;
+}
+
 const VkFence& VulkanFence::getHandle() const
 {
 	return mFence;
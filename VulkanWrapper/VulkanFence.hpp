@@ -14,7 +14,7 @@ class VulkanFence : public VulkanDeviceObject<VulkanObjectType_Fence>
 
 		bool reset();
 
-		// TODO : Really precise ? If not : remove or improve
+		// Polls the fence without blocking
 		bool isSignaled() const;
 
 		const VkFence& getHandle() const;
@@ -0,0 +1,184 @@
+#include "VulkanGpuProfiler.hpp"
+
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanQueryPool.hpp"
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanGpuProfilerPtr VulkanGpuProfiler::createGpuProfiler(VulkanDevice& device, VulkanU32 queueFamilyIndex, VulkanU32 frameCount, VulkanU32 maxScopesPerFrame)
+{
+	if (frameCount == 0 || maxScopesPerFrame == 0)
+	{
+		VULKAN_LOG_ERROR("A GPU profiler needs at least one frame and one scope per frame");
+		return nullptr;
+	}
+
+	VulkanGpuProfilerPtr gpuProfiler(new VulkanGpuProfiler(device, frameCount, maxScopesPerFrame));
+	if (gpuProfiler != nullptr)
+	{
+		if (!gpuProfiler->init(queueFamilyIndex))
+		{
+			gpuProfiler.reset();
+		}
+	}
+	return gpuProfiler;
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+	// The query pools are destroyed with the frames
+}
+
+bool VulkanGpuProfiler::beginFrame(VulkanU32 frameIndex, VulkanCommandBuffer& commandBuffer)
+{
+	VULKAN_ASSERT(frameIndex < mFrames.size(), "Invalid frame index");
+
+	if (!mOpenScopes.empty())
+	{
+		VULKAN_LOG_WARNING("GPU profiler : %u scopes not ended in the previous frame", static_cast<VulkanU32>(mOpenScopes.size()));
+		mOpenScopes.clear();
+	}
+
+	Frame& frame = mFrames[frameIndex];
+	if (!frame.scopes.empty())
+	{
+		readResults(frame);
+		frame.scopes.clear();
+	}
+
+	commandBuffer.resetQueryPool(frame.queryPool.get(), 0, frame.queryPool->getQueryCount());
+	mCurrentFrame = frameIndex;
+	return true;
+}
+
+void VulkanGpuProfiler::beginScope(VulkanCommandBuffer& commandBuffer, const char* name)
+{
+	Frame& frame = mFrames[mCurrentFrame];
+	if (frame.scopes.size() >= mMaxScopesPerFrame)
+	{
+		mOpenScopes.push_back(DroppedScope);
+		mDroppedScopeCount++;
+		return;
+	}
+
+	const VulkanU32 scope = static_cast<VulkanU32>(frame.scopes.size());
+	frame.scopes.push_back({ name, static_cast<VulkanU32>(mOpenScopes.size()) });
+	mOpenScopes.push_back(scope);
+
+	// Once all the previous commands have started
+	commandBuffer.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool.get(), 2 * scope);
+}
+
+void VulkanGpuProfiler::endScope(VulkanCommandBuffer& commandBuffer)
+{
+	VULKAN_ASSERT(!mOpenScopes.empty(), "GPU profiler : no scope to end");
+
+	const VulkanU32 scope = mOpenScopes.back();
+	mOpenScopes.pop_back();
+	if (scope != DroppedScope)
+	{
+		// Once all the previous commands have completed
+		commandBuffer.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mFrames[mCurrentFrame].queryPool.get(), 2 * scope + 1);
+	}
+}
+
+const std::vector<VulkanGpuProfileResult>& VulkanGpuProfiler::getResults() const
+{
+	return mResults;
+}
+
+VulkanU32 VulkanGpuProfiler::getDroppedScopeCount() const
+{
+	return mDroppedScopeCount;
+}
+
+void VulkanGpuProfiler::printResults() const
+{
+	for (const VulkanGpuProfileResult& result : mResults)
+	{
+		printf("GPU : %*s%s %.3f ms\n", static_cast<int>(2 * result.depth), "", result.name, result.milliseconds);
+	}
+	if (mDroppedScopeCount > 0)
+	{
+		printf("GPU : %u scopes dropped\n", mDroppedScopeCount);
+	}
+}
+
+VulkanGpuProfiler::VulkanGpuProfiler(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 maxScopesPerFrame)
+	: mDevice(device)
+	, mMaxScopesPerFrame(maxScopesPerFrame)
+	, mTimestampPeriod(1.0)
+	, mTimestampMask(~0ull)
+	, mCurrentFrame(0)
+	, mFrames(frameCount)
+	, mOpenScopes()
+	, mTimestamps()
+	, mResults()
+	, mDroppedScopeCount(0)
+{
+}
+
+bool VulkanGpuProfiler::init(VulkanU32 queueFamilyIndex)
+{
+	const std::vector<VkQueueFamilyProperties>& queueFamilies = mDevice.getQueueFamiliesProperties();
+	VULKAN_ASSERT(queueFamilyIndex < queueFamilies.size(), "Invalid queue family index");
+	const VulkanU32 validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+	if (validBits == 0)
+	{
+		VULKAN_LOG_WARNING("GPU profiler : the queue family %u doesn't support timestamps", queueFamilyIndex);
+		return false;
+	}
+	mTimestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+	mTimestampPeriod = static_cast<VulkanF64>(mDevice.getProperties().limits.timestampPeriod);
+
+	for (Frame& frame : mFrames)
+	{
+		frame.queryPool = mDevice.createQueryPool(VK_QUERY_TYPE_TIMESTAMP, 2 * mMaxScopesPerFrame);
+		if (frame.queryPool == nullptr || !frame.queryPool->isInitialized())
+		{
+			return false;
+		}
+		frame.scopes.reserve(mMaxScopesPerFrame);
+	}
+	mOpenScopes.reserve(16);
+	mTimestamps.reserve(2 * mMaxScopesPerFrame);
+	mResults.reserve(mMaxScopesPerFrame);
+
+	return true;
+}
+
+bool VulkanGpuProfiler::readResults(Frame& frame)
+{
+	const VulkanU32 queryCount = 2 * static_cast<VulkanU32>(frame.scopes.size());
+	mTimestamps.resize(queryCount);
+
+	// The frame has been waited, the results should be there, but don't wait for them if they are not (ex: unbalanced scopes)
+	if (!frame.queryPool->getResults(0, queryCount, mTimestamps.data(), VK_QUERY_RESULT_64_BIT))
+	{
+		return false;
+	}
+
+	mResults.clear();
+	for (VulkanU32 i = 0; i < frame.scopes.size(); i++)
+	{
+		const VulkanU64 ticks = ((mTimestamps[2 * i + 1] & mTimestampMask) - (mTimestamps[2 * i] & mTimestampMask)) & mTimestampMask;
+		mResults.push_back({ frame.scopes[i].name, frame.scopes[i].depth, static_cast<VulkanF64>(ticks) * mTimestampPeriod * 0.000001 });
+	}
+	return true;
+}
+
+#if (defined VULKAN_OPTION_PROFILE)
+VulkanGpuProfileScope::VulkanGpuProfileScope(VulkanCommandBuffer& commandBuffer, const char* name)
+	: mCommandBuffer(commandBuffer)
+{
+	mCommandBuffer.beginProfileScope(name);
+}
+
+VulkanGpuProfileScope::~VulkanGpuProfileScope()
+{
+	mCommandBuffer.endProfileScope();
+}
+#endif
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+// TODO : Average the results over several frames
+// TODO : Thread safety (scopes recorded from one thread for now)
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanGpuProfileResult
+{
+	const char* name;
+	VulkanU32 depth; // 0 for the outermost scopes
+	VulkanF64 milliseconds;
+};
+
+// Measures the GPU time of nested scopes with timestamp queries, one query pool per frame in flight
+// The results of a frame are read when the frame comes back, after its fence has been waited, so the CPU never waits for them
+//
+//   commandBuffer->setProfiler(profiler.get()); // Once
+//   commandBuffer->beginRecording(...);
+//   profiler->beginFrame(frameIndex, *commandBuffer); // Outside of a render pass, before the scopes of the frame
+//   {
+//       VULKAN_PROFILE_GPU_SCOPE(*commandBuffer, "Shadows");
+//       ...
+//   }
+//
+// The names must outlive the results (string literals)
+class VulkanGpuProfiler
+{
+	public:
+		static const VulkanU32 DefaultMaxScopesPerFrame = 128;
+
+		// Returns nullptr when the queue family doesn't support timestamps
+		static VulkanGpuProfilerPtr createGpuProfiler(VulkanDevice& device, VulkanU32 queueFamilyIndex, VulkanU32 frameCount, VulkanU32 maxScopesPerFrame = DefaultMaxScopesPerFrame);
+
+		~VulkanGpuProfiler();
+
+		// The previous submissions of this frame must be finished (ex: after waiting its fence)
+		// Reads their results and resets the queries of the frame in the command buffer
+		bool beginFrame(VulkanU32 frameIndex, VulkanCommandBuffer& commandBuffer);
+
+		void beginScope(VulkanCommandBuffer& commandBuffer, const char* name);
+		void endScope(VulkanCommandBuffer& commandBuffer);
+
+		// Of the last frame read back, in the order the scopes began
+		const std::vector<VulkanGpuProfileResult>& getResults() const;
+		VulkanU32 getDroppedScopeCount() const; // Scopes beyond maxScopesPerFrame
+		void printResults() const;
+
+	private:
+		VulkanGpuProfiler(VulkanDevice& device, VulkanU32 frameCount, VulkanU32 maxScopesPerFrame);
+
+		bool init(VulkanU32 queueFamilyIndex);
+
+		struct Scope
+		{
+			const char* name;
+			VulkanU32 depth;
+		};
+
+		// The scope i writes the queries 2 * i (begin) and 2 * i + 1 (end)
+		struct Frame
+		{
+			VulkanQueryPoolPtr queryPool;
+			std::vector<Scope> scopes;
+		};
+
+		bool readResults(Frame& frame);
+
+		static const VulkanU32 DroppedScope = ~0u;
+
+		VulkanDevice& mDevice;
+		VulkanU32 mMaxScopesPerFrame;
+		VulkanF64 mTimestampPeriod; // Nanoseconds per tick
+		VulkanU64 mTimestampMask; // Valid bits of the timestamps
+		VulkanU32 mCurrentFrame;
+
+		std::vector<Frame> mFrames;
+		std::vector<VulkanU32> mOpenScopes; // Scopes of the current frame, or DroppedScope
+		std::vector<VulkanU64> mTimestamps;
+		std::vector<VulkanGpuProfileResult> mResults;
+		VulkanU32 mDroppedScopeCount;
+};
+
+#if (defined VULKAN_OPTION_PROFILE)
+// Used by VULKAN_PROFILE_GPU_SCOPE
+class VulkanGpuProfileScope
+{
+	public:
+		VulkanGpuProfileScope(VulkanCommandBuffer& commandBuffer, const char* name);
+		~VulkanGpuProfileScope();
+
+	private:
+		VulkanCommandBuffer& mCommandBuffer;
+};
+#endif
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "VulkanGraphicsPipeline.hpp"
 
 #include "VulkanDevice.hpp"
+#include "VulkanHash.hpp"
 #include "VulkanPipelineLayout.hpp"
 #include "VulkanPipelineCache.hpp"
 #include "VulkanRenderPass.hpp"
 #include "VulkanShaderModule.hpp"
 
+#include <chrono>
+
 VULKAN_NAMESPACE_BEGIN
 
 VulkanGraphicsPipeline::~VulkanGraphicsPipeline()
@@ -25,9 +28,43 @@ void VulkanGraphicsPipeline::addShaderModule(VulkanShaderModule* shaderModule)
 	if (shaderModule != nullptr)
 	{
 		shaderModule->addShaderStages(mShaderStages);
+		mShaderHashes.resize(mShaderStages.size(), shaderModule->getSpirvHash());
+		mSpecializations.resize(mShaderStages.size());
 	}
 }
 
+void VulkanGraphicsPipeline::addShaderModule(const VulkanShaderModuleSharedPtr& shaderModule)
+{
+	if (shaderModule != nullptr)
+	{
+		addShaderModule(shaderModule.get());
+		mSharedShaderModules.push_back(shaderModule);
+	}
+}
+
+void VulkanGraphicsPipeline::setSpecializationConstants(VkShaderStageFlags stages, const VulkanSpecializationConstants& specializationConstants)
+{
+	for (size_t i = 0; i < mShaderStages.size(); i++)
+	{
+		if ((mShaderStages[i].stage & stages) != 0)
+		{
+			mSpecializations[i] = specializationConstants;
+		}
+	}
+}
+
+const VulkanSpecializationConstants* VulkanGraphicsPipeline::getSpecializationConstants(VkShaderStageFlagBits stage) const
+{
+	for (size_t i = 0; i < mShaderStages.size(); i++)
+	{
+		if (mShaderStages[i].stage == stage)
+		{
+			return &mSpecializations[i];
+		}
+	}
+	return nullptr;
+}
+
 void VulkanGraphicsPipeline::addVertexBinding(VulkanU32 binding, VulkanU32 stride, VkVertexInputRate inputRate)
 {
 	mVertexBindingDescriptions.push_back({ binding, stride, inputRate });
@@ -490,88 +527,211 @@ void VulkanGraphicsPipeline::addDynamicState(VkDynamicState dynamicState)
 	mDynamicStates.push_back(dynamicState);
 }
 
-bool VulkanGraphicsPipeline::create()
+bool VulkanGraphicsPipeline::hasDynamicState(VkDynamicState dynamicState) const
 {
-	VkPipelineVertexInputStateCreateInfo vertexInputState = {
-		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,    // VkStructureType                           sType
-		nullptr,                                                      // const void                              * pNext
-		0,                                                            // VkPipelineVertexInputStateCreateFlags     flags
-		static_cast<VulkanU32>(mVertexBindingDescriptions.size()),     // VulkanU32                                  vertexBindingDescriptionCount
-		mVertexBindingDescriptions.data(),                            // const VkVertexInputBindingDescription   * pVertexBindingDescriptions
-		static_cast<VulkanU32>(mVertexAttributeDescriptions.size()),   // VulkanU32                                  vertexAttributeDescriptionCount
-		mVertexAttributeDescriptions.data()                           // const VkVertexInputAttributeDescription * pVertexAttributeDescriptions
-	};
+	for (VkDynamicState state : mDynamicStates)
+	{
+		if (state == dynamicState)
+		{
+			return true;
+		}
+	}
+	return false;
+}
 
-	VkPipelineViewportStateCreateInfo viewportState = {
-		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,    // VkStructureType                      sType
-		nullptr,                                                  // const void                         * pNext
-		0,                                                        // VkPipelineViewportStateCreateFlags   flags
-		1,                                                        // VulkanU32                             viewportCount
-		&mViewport,                                               // const VkViewport                   * pViewports
-		1,                                                        // VulkanU32                             scissorCount
-		&mScissor                                                 // const VkRect2D                     * pScissors
-	};
+void VulkanGraphicsPipeline::setCreateFlags(VkPipelineCreateFlags createFlags)
+{
+	mCreateFlags = createFlags;
+}
 
-	VkPipelineDynamicStateCreateInfo dynamicStates = {
-		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,     // VkStructureType                      sType
-		nullptr,                                                  // const void                         * pNext
-		0,                                                        // VkPipelineDynamicStateCreateFlags    flags
-		static_cast<VulkanU32>(mDynamicStates.size()),             // VulkanU32                             dynamicStateCount
-		mDynamicStates.data()                                     // const VkDynamicState               * pDynamicStates
-	};
+VkPipelineCreateFlags VulkanGraphicsPipeline::getCreateFlags() const
+{
+	return mCreateFlags;
+}
 
-	if (mBlendAttachments.empty())
+void VulkanGraphicsPipeline::setBasePipeline(const VulkanGraphicsPipeline* basePipeline)
+{
+	mBasePipeline = (basePipeline != nullptr) ? basePipeline->getHandle() : VK_NULL_HANDLE;
+}
+
+void VulkanGraphicsPipeline::computeStateKey(VulkanStateKey& stateKey, VulkanStateKey* familyKey) const
+{
+	// Family : what a derivative pipeline must share with its base
+	VulkanStateKey localFamilyKey;
+	VulkanStateKey& family = (familyKey != nullptr) ? *familyKey : localFamilyKey;
+	family.clear();
+	family.add(mLayout.getHandle());
+	family.add(mRenderPass.getHandle());
+	family.add(mSubpass);
+	family.add(static_cast<VulkanU32>(mShaderStages.size()));
+	for (size_t i = 0; i < mShaderStages.size(); i++)
 	{
-		VkPipelineColorBlendAttachmentState blend = {
-			false,                          // Vkbool32                 blendEnable
-			VK_BLEND_FACTOR_ONE,            // VkBlendFactor            srcColorBlendFactor
-			VK_BLEND_FACTOR_ZERO,           // VkBlendFactor            dstColorBlendFactor
-			VK_BLEND_OP_ADD,                // VkBlendOp                colorBlendOp
-			VK_BLEND_FACTOR_ONE,            // VkBlendFactor            srcAlphaBlendFactor
-			VK_BLEND_FACTOR_ZERO,           // VkBlendFactor            dstAlphaBlendFactor
-			VK_BLEND_OP_ADD,                // VkBlendOp                alphaBlendOp
-			VK_COLOR_COMPONENT_R_BIT |      // VkColorComponentFlags    colorWriteMask
-			VK_COLOR_COMPONENT_G_BIT |
-			VK_COLOR_COMPONENT_B_BIT |
-			VK_COLOR_COMPONENT_A_BIT
-		};
-		mBlendAttachments.push_back(blend);
+		const VkPipelineShaderStageCreateInfo& stage = mShaderStages[i];
+		family.add(stage.stage);
+		family.add(mShaderHashes[i]);
+		family.add(std::string(stage.pName));
+	}
+	family.finalize();
+
+	stateKey.clear();
+	// The family fields are compared through the hash of the family, the layout, the render pass and the subpass
+	stateKey.add(family.getHash());
+	stateKey.add(mLayout.getHandle());
+	stateKey.add(mRenderPass.getHandle());
+	stateKey.add(mSubpass);
+	// The derivative bits are set by the cache depending on which pipeline of the family comes first, they don't change the state
+	stateKey.add(mCreateFlags & ~(VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT | VK_PIPELINE_CREATE_DERIVATIVE_BIT));
+
+	// The entries are sorted by constant id, so the same values always give the same key
+	for (const VulkanSpecializationConstants& specialization : mSpecializations)
+	{
+		const std::vector<VkSpecializationMapEntry>& entries = specialization.getEntries();
+		stateKey.add(static_cast<VulkanU32>(entries.size()));
+		for (const VkSpecializationMapEntry& entry : entries)
+		{
+			stateKey.add(entry.constantID);
+			stateKey.add(entry.offset);
+			stateKey.add(static_cast<VulkanU64>(entry.size));
+		}
+		stateKey.add(static_cast<VulkanU64>(specialization.getData().size()));
+		stateKey.addBytes(specialization.getData().data(), specialization.getData().size());
 	}
-	auto count = (VulkanU32)mBlendAttachments.size();
-	mBlendState.attachmentCount = count;
-	mBlendState.pAttachments = count ? mBlendAttachments.data() : nullptr;
 
-	VkGraphicsPipelineCreateInfo pipelineCreateInfo = {
-		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,            // VkStructureType                                sType
-		nullptr,                                                    // const void                                   * pNext
-		0,                                                          // VkPipelineCreateFlags                          flags
-		static_cast<VulkanU32>(mShaderStages.size()),                // VulkanU32                                       stageCount
-		mShaderStages.data(),                                       // const VkPipelineShaderStageCreateInfo        * pStages
-		&vertexInputState,                                          // const VkPipelineVertexInputStateCreateInfo   * pVertexInputState
-		mInputAssemblyState ? mInputAssemblyState.get() : &sDefaultInputAssemblyState,  // const VkPipelineInputAssemblyStateCreateInfo * pInputAssemblyState
-		mTessellationState ? mTessellationState.get() : nullptr,    // const VkPipelineTessellationStateCreateInfo  * pTessellationState
-		&viewportState,                                             // const VkPipelineViewportStateCreateInfo      * pViewportState
-		mRasterizationState ? mRasterizationState.get() : &sDefaultRasterizationState,  // const VkPipelineRasterizationStateCreateInfo * pRasterizationState
-		mMultisampleState ? mMultisampleState.get() : &sDefaultMultisampleState,        // const VkPipelineMultisampleStateCreateInfo   * pMultisampleState
-		mDepthStencilState ? mDepthStencilState.get() : &sDefaultDepthStencilState,     // const VkPipelineDepthStencilStateCreateInfo  * pDepthStencilState
-		&mBlendState,                                               // const VkPipelineColorBlendStateCreateInfo    * pColorBlendState
-		mDynamicStates.empty() ? nullptr : &dynamicStates,          // const VkPipelineDynamicStateCreateInfo       * pDynamicState
-		mLayout.getHandle(),                                        // VkPipelineLayout                               layout
-		mRenderPass.getHandle(),                                    // VkRenderPass                                   renderPass
-		mSubpass,                                                   // VulkanU32                                       subpass
-		VK_NULL_HANDLE,                                             // VkPipeline                                     basePipelineHandle
-		-1                                                          // VulkanI32                                        basePipelineIndex
-	};
+	stateKey.add(static_cast<VulkanU32>(mVertexBindingDescriptions.size()));
+	for (const VkVertexInputBindingDescription& binding : mVertexBindingDescriptions)
+	{
+		stateKey.add(binding.binding);
+		stateKey.add(binding.stride);
+		stateKey.add(binding.inputRate);
+	}
+	stateKey.add(static_cast<VulkanU32>(mVertexAttributeDescriptions.size()));
+	for (const VkVertexInputAttributeDescription& attribute : mVertexAttributeDescriptions)
+	{
+		stateKey.add(attribute.location);
+		stateKey.add(attribute.binding);
+		stateKey.add(attribute.format);
+		stateKey.add(attribute.offset);
+	}
+
+	const VkPipelineInputAssemblyStateCreateInfo& inputAssembly = mInputAssemblyState ? *mInputAssemblyState : sDefaultInputAssemblyState;
+	stateKey.add(inputAssembly.topology);
+	stateKey.add(inputAssembly.primitiveRestartEnable);
+
+	stateKey.add(mTessellationState ? mTessellationState->patchControlPoints : 0u);
+
+	// The viewport and the scissor are ignored when they are dynamic
+	if (!hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT))
+	{
+		stateKey.add(mViewport.x);
+		stateKey.add(mViewport.y);
+		stateKey.add(mViewport.width);
+		stateKey.add(mViewport.height);
+		stateKey.add(mViewport.minDepth);
+		stateKey.add(mViewport.maxDepth);
+	}
+	if (!hasDynamicState(VK_DYNAMIC_STATE_SCISSOR))
+	{
+		stateKey.add(mScissor.offset.x);
+		stateKey.add(mScissor.offset.y);
+		stateKey.add(mScissor.extent.width);
+		stateKey.add(mScissor.extent.height);
+	}
+
+	const VkPipelineRasterizationStateCreateInfo& rasterization = mRasterizationState ? *mRasterizationState : sDefaultRasterizationState;
+	stateKey.add(rasterization.depthClampEnable);
+	stateKey.add(rasterization.rasterizerDiscardEnable);
+	stateKey.add(rasterization.polygonMode);
+	stateKey.add(rasterization.cullMode);
+	stateKey.add(rasterization.frontFace);
+	stateKey.add(rasterization.depthBiasEnable);
+	stateKey.add(rasterization.depthBiasConstantFactor);
+	stateKey.add(rasterization.depthBiasClamp);
+	stateKey.add(rasterization.depthBiasSlopeFactor);
+	stateKey.add(rasterization.lineWidth);
+
+	const VkPipelineMultisampleStateCreateInfo& multisample = mMultisampleState ? *mMultisampleState : sDefaultMultisampleState;
+	stateKey.add(multisample.rasterizationSamples);
+	stateKey.add(multisample.sampleShadingEnable);
+	stateKey.add(multisample.minSampleShading);
+	stateKey.add(multisample.alphaToCoverageEnable);
+	stateKey.add(multisample.alphaToOneEnable);
+	stateKey.add(multisample.pSampleMask != nullptr);
+	if (multisample.pSampleMask != nullptr)
+	{
+		stateKey.addBytes(multisample.pSampleMask, sizeof(VkSampleMask) * ((multisample.rasterizationSamples + 31) / 32));
+	}
+
+	const VkPipelineDepthStencilStateCreateInfo& depthStencil = mDepthStencilState ? *mDepthStencilState : sDefaultDepthStencilState;
+	stateKey.add(depthStencil.depthTestEnable);
+	stateKey.add(depthStencil.depthWriteEnable);
+	stateKey.add(depthStencil.depthCompareOp);
+	stateKey.add(depthStencil.depthBoundsTestEnable);
+	stateKey.add(depthStencil.stencilTestEnable);
+	for (const VkStencilOpState* stencil : { &depthStencil.front, &depthStencil.back })
+	{
+		stateKey.add(stencil->failOp);
+		stateKey.add(stencil->passOp);
+		stateKey.add(stencil->depthFailOp);
+		stateKey.add(stencil->compareOp);
+		stateKey.add(stencil->compareMask);
+		stateKey.add(stencil->writeMask);
+		stateKey.add(stencil->reference);
+	}
+	stateKey.add(depthStencil.minDepthBounds);
+	stateKey.add(depthStencil.maxDepthBounds);
+
+	// No blend attachment means the default one, see fillCreateInfo()
+	const VulkanU32 blendCount = mBlendAttachments.empty() ? 1 : static_cast<VulkanU32>(mBlendAttachments.size());
+	stateKey.add(blendCount);
+	for (VulkanU32 i = 0; i < blendCount; i++)
+	{
+		const VkPipelineColorBlendAttachmentState& blend = mBlendAttachments.empty() ? sDefaultBlendAttachment : mBlendAttachments[i];
+		stateKey.add(blend.blendEnable);
+		stateKey.add(blend.srcColorBlendFactor);
+		stateKey.add(blend.dstColorBlendFactor);
+		stateKey.add(blend.colorBlendOp);
+		stateKey.add(blend.srcAlphaBlendFactor);
+		stateKey.add(blend.dstAlphaBlendFactor);
+		stateKey.add(blend.alphaBlendOp);
+		stateKey.add(blend.colorWriteMask);
+	}
+	stateKey.add(mBlendState.logicOpEnable);
+	stateKey.add(mBlendState.logicOp);
+	for (VulkanU32 i = 0; i < 4; i++)
+	{
+		stateKey.add(mBlendState.blendConstants[i]);
+	}
+
+	stateKey.add(static_cast<VulkanU32>(mDynamicStates.size()));
+	for (VkDynamicState dynamicState : mDynamicStates)
+	{
+		stateKey.add(dynamicState);
+	}
+
+	stateKey.finalize();
+}
+
+bool VulkanGraphicsPipeline::create()
+{
+	CreateInfo createInfo;
+	fillCreateInfo(createInfo);
 
 	VkPipelineCache cacheHandle = (mCache != nullptr) ? mCache->getHandle() : VK_NULL_HANDLE;
 
-	VkResult result = vkCreateGraphicsPipelines(mDevice.getHandle(), cacheHandle, 1, &pipelineCreateInfo, nullptr, &mGraphicsPipeline);
+	auto start = std::chrono::high_resolution_clock::now();
+
+	VkResult result = vkCreateGraphicsPipelines(mDevice.getHandle(), cacheHandle, 1, &createInfo.pipelineCreateInfo, nullptr, &mGraphicsPipeline);
 	if (result != VK_SUCCESS || mGraphicsPipeline == VK_NULL_HANDLE)
 	{
 		VULKAN_LOG_ERROR("Could not create a graphics pipeline\n");
 		return false;
 	}
 
+	if (mCache != nullptr)
+	{
+		mCache->addPipelineCreationTime(std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
 	return true;
 }
 
@@ -603,7 +763,12 @@ VulkanGraphicsPipeline::VulkanGraphicsPipeline(VulkanDevice& device, VulkanPipel
 	, mCache(cache)
 	, mGraphicsPipeline(VK_NULL_HANDLE)
 	, mSubpass(0)
+	, mCreateFlags(0)
+	, mBasePipeline(VK_NULL_HANDLE)
 	, mShaderStages()
+	, mShaderHashes()
+	, mSpecializations()
+	, mSharedShaderModules()
 	, mVertexBindingDescriptions()
 	, mVertexAttributeDescriptions()
 	, mInputAssemblyState(nullptr)
@@ -636,6 +801,72 @@ VulkanGraphicsPipeline::VulkanGraphicsPipeline(VulkanDevice& device, VulkanPipel
 	};
 }
 
+void VulkanGraphicsPipeline::fillCreateInfo(CreateInfo& createInfo)
+{
+	for (size_t i = 0; i < mShaderStages.size(); i++)
+	{
+		mShaderStages[i].pSpecializationInfo = mSpecializations[i].getInfo();
+	}
+
+	createInfo.vertexInputState = {
+		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,    // VkStructureType                           sType
+		nullptr,                                                      // const void                              * pNext
+		0,                                                            // VkPipelineVertexInputStateCreateFlags     flags
+		static_cast<VulkanU32>(mVertexBindingDescriptions.size()),     // VulkanU32                                  vertexBindingDescriptionCount
+		mVertexBindingDescriptions.data(),                            // const VkVertexInputBindingDescription   * pVertexBindingDescriptions
+		static_cast<VulkanU32>(mVertexAttributeDescriptions.size()),   // VulkanU32                                  vertexAttributeDescriptionCount
+		mVertexAttributeDescriptions.data()                           // const VkVertexInputAttributeDescription * pVertexAttributeDescriptions
+	};
+
+	createInfo.viewportState = {
+		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,    // VkStructureType                      sType
+		nullptr,                                                  // const void                         * pNext
+		0,                                                        // VkPipelineViewportStateCreateFlags   flags
+		1,                                                        // VulkanU32                             viewportCount
+		&mViewport,                                               // const VkViewport                   * pViewports
+		1,                                                        // VulkanU32                             scissorCount
+		&mScissor                                                 // const VkRect2D                     * pScissors
+	};
+
+	createInfo.dynamicStates = {
+		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,     // VkStructureType                      sType
+		nullptr,                                                  // const void                         * pNext
+		0,                                                        // VkPipelineDynamicStateCreateFlags    flags
+		static_cast<VulkanU32>(mDynamicStates.size()),             // VulkanU32                             dynamicStateCount
+		mDynamicStates.data()                                     // const VkDynamicState               * pDynamicStates
+	};
+
+	if (mBlendAttachments.empty())
+	{
+		mBlendAttachments.push_back(sDefaultBlendAttachment);
+	}
+	auto count = (VulkanU32)mBlendAttachments.size();
+	mBlendState.attachmentCount = count;
+	mBlendState.pAttachments = count ? mBlendAttachments.data() : nullptr;
+
+	createInfo.pipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,            // VkStructureType                                sType
+		nullptr,                                                    // const void                                   * pNext
+		mCreateFlags,                                               // VkPipelineCreateFlags                          flags
+		static_cast<VulkanU32>(mShaderStages.size()),                // VulkanU32                                       stageCount
+		mShaderStages.data(),                                       // const VkPipelineShaderStageCreateInfo        * pStages
+		&createInfo.vertexInputState,                               // const VkPipelineVertexInputStateCreateInfo   * pVertexInputState
+		mInputAssemblyState ? mInputAssemblyState.get() : &sDefaultInputAssemblyState,  // const VkPipelineInputAssemblyStateCreateInfo * pInputAssemblyState
+		mTessellationState ? mTessellationState.get() : nullptr,    // const VkPipelineTessellationStateCreateInfo  * pTessellationState
+		&createInfo.viewportState,                                  // const VkPipelineViewportStateCreateInfo      * pViewportState
+		mRasterizationState ? mRasterizationState.get() : &sDefaultRasterizationState,  // const VkPipelineRasterizationStateCreateInfo * pRasterizationState
+		mMultisampleState ? mMultisampleState.get() : &sDefaultMultisampleState,        // const VkPipelineMultisampleStateCreateInfo   * pMultisampleState
+		mDepthStencilState ? mDepthStencilState.get() : &sDefaultDepthStencilState,     // const VkPipelineDepthStencilStateCreateInfo  * pDepthStencilState
+		&mBlendState,                                               // const VkPipelineColorBlendStateCreateInfo    * pColorBlendState
+		mDynamicStates.empty() ? nullptr : &createInfo.dynamicStates,  // const VkPipelineDynamicStateCreateInfo       * pDynamicState
+		mLayout.getHandle(),                                        // VkPipelineLayout                               layout
+		mRenderPass.getHandle(),                                    // VkRenderPass                                   renderPass
+		mSubpass,                                                   // VulkanU32                                       subpass
+		mBasePipeline,                                              // VkPipeline                                     basePipelineHandle
+		-1                                                          // VulkanI32                                        basePipelineIndex
+	};
+}
+
 void VulkanGraphicsPipeline::ensuresInputAssemblyStateInitialized()
 {
 	if (mInputAssemblyState == nullptr)
@@ -746,4 +977,18 @@ const VkPipelineDepthStencilStateCreateInfo VulkanGraphicsPipeline::sDefaultDept
 	1.0f                                                          // float                                      maxDepthBounds
 };
 
+const VkPipelineColorBlendAttachmentState VulkanGraphicsPipeline::sDefaultBlendAttachment = {
+	false,                          // Vkbool32                 blendEnable
+	VK_BLEND_FACTOR_ONE,            // VkBlendFactor            srcColorBlendFactor
+	VK_BLEND_FACTOR_ZERO,           // VkBlendFactor            dstColorBlendFactor
+	VK_BLEND_OP_ADD,                // VkBlendOp                colorBlendOp
+	VK_BLEND_FACTOR_ONE,            // VkBlendFactor            srcAlphaBlendFactor
+	VK_BLEND_FACTOR_ZERO,           // VkBlendFactor            dstAlphaBlendFactor
+	VK_BLEND_OP_ADD,                // VkBlendOp                alphaBlendOp
+	VK_COLOR_COMPONENT_R_BIT |      // VkColorComponentFlags    colorWriteMask
+	VK_COLOR_COMPONENT_G_BIT |
+	VK_COLOR_COMPONENT_B_BIT |
+	VK_COLOR_COMPONENT_A_BIT
+};
+
 VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanSpecializationConstants.hpp"
 
 // TODO : Move the current pipeline creation process to another class.
 //		  The current approach is very repetitive and not optimized for creating similar pipelines
 
 VULKAN_NAMESPACE_BEGIN
 
+class VulkanStateKey;
+
 class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipeline>
 {
 	public:
@@ -15,6 +18,24 @@ class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipe
 		void setSubpass(VulkanU32 subpass);
 
 		void addShaderModule(VulkanShaderModule* shaderModule);
+		// The pipeline keeps the module alive, see VulkanShaderModuleCache
+		void addShaderModule(const VulkanShaderModuleSharedPtr& shaderModule);
+
+		// The shader modules must be added first, the value is set for each stage of the mask
+		// One module can then be used by many pipelines with different values, and the driver folds the constants
+		template <typename T>
+		void setSpecializationConstant(VkShaderStageFlags stages, VulkanU32 constantId, T value)
+		{
+			for (size_t i = 0; i < mShaderStages.size(); i++)
+			{
+				if ((mShaderStages[i].stage & stages) != 0)
+				{
+					mSpecializations[i].set(constantId, value);
+				}
+			}
+		}
+		void setSpecializationConstants(VkShaderStageFlags stages, const VulkanSpecializationConstants& specializationConstants);
+		const VulkanSpecializationConstants* getSpecializationConstants(VkShaderStageFlagBits stage) const;
 
 		void addVertexBinding(VulkanU32 binding, VulkanU32 stride, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX);
 		void addVertexBinding(const VkVertexInputBindingDescription& description);
@@ -89,8 +110,19 @@ class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipe
 		void setBlendConstants(VulkanF32 r, VulkanF32 g, VulkanF32 b, VulkanF32 a);
 
 		void addDynamicState(VkDynamicState dynamicState);
+		bool hasDynamicState(VkDynamicState dynamicState) const;
+
+		// VulkanPipelineStateCache adds the derivative flags itself
+		void setCreateFlags(VkPipelineCreateFlags createFlags);
+		VkPipelineCreateFlags getCreateFlags() const;
+		// The base pipeline must have been created with VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT
+		void setBasePipeline(const VulkanGraphicsPipeline* basePipeline);
 
-		// TODO : Create multiple pipelines at once
+		// Everything that changes the compiled pipeline : shaders (by code), specialization constants, fixed function states, create flags, layout, render pass and subpass
+		// The family key only covers the layout, the render pass, the subpass and the shaders : the pipelines of a family are near-identical variants, specializations included
+		void computeStateKey(VulkanStateKey& stateKey, VulkanStateKey* familyKey = nullptr) const;
+
+		// Use VulkanPipelineBatch to create many pipelines at once
 		bool create();
 		bool destroy();
 
@@ -99,8 +131,19 @@ class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipe
 
 	private:
 		friend class VulkanDevice;
+		friend class VulkanPipelineBatch;
 		VulkanGraphicsPipeline(VulkanDevice& device, VulkanPipelineLayout& layout, VulkanRenderPass& renderPass, VulkanPipelineCache* cache = nullptr);
 
+		// States referenced by the create info, must stay alive until the pipeline is created
+		struct CreateInfo
+		{
+			VkPipelineVertexInputStateCreateInfo vertexInputState;
+			VkPipelineViewportStateCreateInfo viewportState;
+			VkPipelineDynamicStateCreateInfo dynamicStates;
+			VkGraphicsPipelineCreateInfo pipelineCreateInfo;
+		};
+		void fillCreateInfo(CreateInfo& createInfo);
+
 	private:
 		VulkanDevice& mDevice;
 		VulkanPipelineLayout& mLayout;
@@ -108,8 +151,13 @@ class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipe
 		VulkanPipelineCache* mCache;
 		VkPipeline mGraphicsPipeline;
 		VulkanU32 mSubpass;
+		VkPipelineCreateFlags mCreateFlags;
+		VkPipeline mBasePipeline;
 
 		std::vector<VkPipelineShaderStageCreateInfo> mShaderStages;
+		std::vector<VulkanU64> mShaderHashes; // SPIR-V hash of the module of each stage
+		std::vector<VulkanSpecializationConstants> mSpecializations; // Per stage
+		std::vector<VulkanShaderModuleSharedPtr> mSharedShaderModules;
 		std::vector<VkVertexInputBindingDescription> mVertexBindingDescriptions;
 		std::vector<VkVertexInputAttributeDescription> mVertexAttributeDescriptions;
 		std::unique_ptr<VkPipelineInputAssemblyStateCreateInfo> mInputAssemblyState;
@@ -134,6 +182,7 @@ class VulkanGraphicsPipeline : public VulkanObject<VulkanObjectType_GraphicsPipe
 		static const VkPipelineRasterizationStateCreateInfo sDefaultRasterizationState;
 		static const VkPipelineMultisampleStateCreateInfo sDefaultMultisampleState;
 		static const VkPipelineDepthStencilStateCreateInfo sDefaultDepthStencilState;
+		static const VkPipelineColorBlendAttachmentState sDefaultBlendAttachment;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "VulkanCore.hpp"
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+VULKAN_NAMESPACE_BEGIN
+
+// FNV-1a 64 bits, fast enough for keys built once per pipeline or shader
+class VulkanHasher
+{
+	public:
+		VulkanHasher() : mHash(14695981039346656037ull) {}
+
+		void add(const void* data, size_t size)
+		{
+			const VulkanU8* bytes = static_cast<const VulkanU8*>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				mHash ^= bytes[i];
+				mHash *= 1099511628211ull;
+			}
+		}
+
+		VulkanU64 getHash() const { return mHash; }
+
+		static VulkanU64 hash(const void* data, size_t size)
+		{
+			VulkanHasher hasher;
+			hasher.add(data, size);
+			return hasher.getHash();
+		}
+
+	private:
+		VulkanU64 mHash;
+};
+
+// Serialized state compared byte per byte, the hash only selects the bucket
+// The values are added one by one, so the padding of the Vulkan structures never ends in the key
+class VulkanStateKey
+{
+	public:
+		VulkanStateKey() : mData(), mHash(0) {}
+
+		template <typename T>
+		void add(const T& value)
+		{
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value, "Add the fields of the structures one by one");
+			addBytes(&value, sizeof(T));
+		}
+		void add(const std::string& value)
+		{
+			add(static_cast<VulkanU32>(value.size()));
+			addBytes(value.data(), value.size());
+		}
+		void addBytes(const void* data, size_t size)
+		{
+			const size_t offset = mData.size();
+			mData.resize(offset + size);
+			if (size > 0)
+			{
+				std::memcpy(mData.data() + offset, data, size);
+			}
+		}
+
+		// Must be called once all the values are added
+		void finalize() { mHash = VulkanHasher::hash(mData.data(), mData.size()); }
+		void clear() { mData.clear(); mHash = 0; }
+
+		VulkanU64 getHash() const { return mHash; }
+		size_t getSize() const { return mData.size(); }
+
+		bool operator==(const VulkanStateKey& other) const { return mHash == other.mHash && mData == other.mData; }
+		bool operator!=(const VulkanStateKey& other) const { return !operator==(other); }
+
+		struct Hasher
+		{
+			size_t operator()(const VulkanStateKey& key) const { return static_cast<size_t>(key.getHash()); }
+		};
+
+	private:
+		std::vector<VulkanU8> mData;
+		VulkanU64 mHash;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
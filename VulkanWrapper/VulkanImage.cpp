@@ -29,10 +29,15 @@ const VkMemoryRequirements& VulkanImage::getMemoryRequirements() const
 
 VulkanMemoryBlock* VulkanImage::allocateMemoryBlock(VkMemoryPropertyFlagBits memoryProperties)
 {
-	mOwnedMemoryBlock = getDevice().createMemoryBlock(getMemoryRequirements(), memoryProperties);
-	if (mOwnedMemoryBlock != nullptr)
+	VulkanMemoryAllocator& memoryAllocator = getDevice().getMemoryAllocator();
+	// Linear images can share the pages of the buffers, but not the ones of the optimal images
+	if (memoryAllocator.allocate(getMemoryRequirements(), memoryProperties, mTiling == VK_IMAGE_TILING_LINEAR, mMemoryAllocation))
 	{
-		mOwnedMemoryBlock->bind(this, 0);
+		if (!mMemoryAllocation.memoryBlock->bind(this, mMemoryAllocation.offset))
+		{
+			memoryAllocator.free(mMemoryAllocation);
+			mMemoryBlock = nullptr;
+		}
 	}
 	else
 	{
@@ -43,7 +48,7 @@ VulkanMemoryBlock* VulkanImage::allocateMemoryBlock(VkMemoryPropertyFlagBits mem
 
 bool VulkanImage::ownMemoryBlock() const
 {
-	return mOwnedMemoryBlock != nullptr;
+	return mMemoryAllocation.isValid();
 }
 
 bool VulkanImage::isBoundToMemoryBlock() const
@@ -137,19 +142,52 @@ bool VulkanImage::isCubemap() const
 	return mCubemap;
 }
 
+VkImageTiling VulkanImage::getTiling() const
+{
+	return mTiling;
+}
+
 bool VulkanImage::isSwapchainImage() const
 {
 	return mIsSwapchainImage;
 }
 
+VkAccessFlags VulkanImage::getCurrentAccess() const
+{
+	return mCurrentAccess;
+}
+
+VkPipelineStageFlags VulkanImage::getCurrentStages() const
+{
+	return mCurrentStages;
+}
+
+VkImageLayout VulkanImage::getCurrentLayout() const
+{
+	return mCurrentLayout;
+}
+
+VulkanU32 VulkanImage::getCurrentQueueFamily() const
+{
+	return mCurrentQueueFamily;
+}
+
+void VulkanImage::setCurrentState(VkAccessFlags access, VkPipelineStageFlags stages, VkImageLayout layout, VulkanU32 queueFamily)
+{
+	mCurrentAccess = access;
+	mCurrentStages = stages;
+	mCurrentLayout = layout;
+	mCurrentQueueFamily = queueFamily;
+}
+
 const VkImage& VulkanImage::getHandle() const
 {
 	return mImage;
 }
 
-VulkanImagePtr VulkanImage::createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap)
+VulkanImagePtr VulkanImage::createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap, VkImageTiling tiling)
 {
-	VulkanImagePtr image(new VulkanImage(type, format, size, numMipmaps, numLayers, samples, usage, cubemap));
+	VulkanImagePtr image(new VulkanImage(type, format, size, numMipmaps, numLayers, samples, usage, cubemap, tiling));
 	if (image != nullptr)
 	{
 		if (!image->init())
@@ -162,7 +200,7 @@ VulkanImagePtr VulkanImage::createImage(VkImageType type, VkFormat format, VkExt
 
 VulkanImagePtr VulkanImage::createImageFromSwapchain(VulkanDevice& device, VkImage swapchainImageHandle, VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap)
 {
-	VulkanImagePtr image(new VulkanImage(type, format, size, numMipmaps, numLayers, samples, usage, cubemap));
+	VulkanImagePtr image(new VulkanImage(type, format, size, numMipmaps, numLayers, samples, usage, cubemap, VK_IMAGE_TILING_OPTIMAL));
 	if (image != nullptr)
 	{
 		image->mImage = swapchainImageHandle;
@@ -171,9 +209,9 @@ VulkanImagePtr VulkanImage::createImageFromSwapchain(VulkanDevice& device, VkIma
 	return image;
 }
 
-VulkanImage::VulkanImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap)
+VulkanImage::VulkanImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap, VkImageTiling tiling)
 	: mImage(VK_NULL_HANDLE)
-	, mOwnedMemoryBlock(nullptr)
+	, mMemoryAllocation()
 	, mMemoryBlock(nullptr)
 	, mOffsetInMemoryBlock(0)
 	, mImageViews()
@@ -185,7 +223,12 @@ VulkanImage::VulkanImage(VkImageType type, VkFormat format, VkExtent3D size, Vul
 	, mSamples(samples)
 	, mUsage(usage)
 	, mCubemap(cubemap)
+	, mTiling(tiling)
 	, mIsSwapchainImage(false)
+	, mCurrentAccess(0)
+	, mCurrentStages(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT)
+	, mCurrentLayout(VK_IMAGE_LAYOUT_UNDEFINED)
+	, mCurrentQueueFamily(VK_QUEUE_FAMILY_IGNORED)
 	, mMemoryRequirementsQueried(false)
 	, mMemoryRequirements()
 {
@@ -204,7 +247,7 @@ bool VulkanImage::init()
 		mNumMipmaps,                                        // VulkanU32                 mipLevels
 		mCubemap ? 6 * mNumLayers : mNumLayers,             // VulkanU32                 arrayLayers
 		mSamples,                                           // VkSampleCountFlagBits    samples
-		VK_IMAGE_TILING_OPTIMAL,                            // VkImageTiling            tiling
+		mTiling,                                            // VkImageTiling            tiling
 		mUsage,                                             // VkImageUsageFlags        usage
 		VK_SHARING_MODE_EXCLUSIVE,                          // VkSharingMode            sharingMode
 		0,                                                  // VulkanU32                 queueFamilyIndexCount
@@ -229,6 +272,11 @@ void VulkanImage::release()
 		vkDestroyImage(getDeviceHandle(), mImage, nullptr);
 		mImage = VK_NULL_HANDLE;
 	}
+	if (mMemoryAllocation.isValid())
+	{
+		getDevice().getMemoryAllocator().free(mMemoryAllocation);
+		mMemoryBlock = nullptr;
+	}
 }
 
 void VulkanImage::bindToMemoryBlock(VulkanMemoryBlock* memoryBlock, VkDeviceSize offsetInMemoryBlock)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanMemoryAllocator.hpp"
 
 // TODO : Binding on MemoryBlock side or Image/Buffer side ?
 
@@ -33,19 +34,28 @@ class VulkanImage : public VulkanDeviceObject<VulkanObjectType_Image>
 		VkSampleCountFlagBits getSamples() const;
 		VkImageUsageFlags getUsage() const;
 		bool isCubemap() const;
+		VkImageTiling getTiling() const;
 
 		bool isSwapchainImage() const;
 
+		// State of the image at the end of the last recorded command buffer, used by the tracked transitions
+		// The layout changes done by render passes are not seen, setCurrentState() must be called after them
+		VkAccessFlags getCurrentAccess() const;
+		VkPipelineStageFlags getCurrentStages() const;
+		VkImageLayout getCurrentLayout() const;
+		VulkanU32 getCurrentQueueFamily() const;
+		void setCurrentState(VkAccessFlags access, VkPipelineStageFlags stages, VkImageLayout layout, VulkanU32 queueFamily = VK_QUEUE_FAMILY_IGNORED);
+
 		const VkImage& getHandle() const;
 
 	private:
 		friend class VulkanDevice;
-		static VulkanImagePtr createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap);
+		static VulkanImagePtr createImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap, VkImageTiling tiling);
 
 		friend class VulkanSwapchain;
 		static VulkanImagePtr createImageFromSwapchain(VulkanDevice& device, VkImage swapchainImageHandle, VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap);
 
-		VulkanImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap);
+		VulkanImage(VkImageType type, VkFormat format, VkExtent3D size, VulkanU32 numMipmaps, VulkanU32 numLayers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, bool cubemap, VkImageTiling tiling);
 
 		bool init();
 		void release(); 
@@ -56,7 +66,7 @@ class VulkanImage : public VulkanDeviceObject<VulkanObjectType_Image>
 	private:
 		VkImage mImage;
 
-		VulkanMemoryBlockPtr mOwnedMemoryBlock;
+		VulkanMemoryAllocation mMemoryAllocation;
 		VulkanMemoryBlock* mMemoryBlock;
 		VkDeviceSize mOffsetInMemoryBlock;
 
@@ -70,9 +80,15 @@ class VulkanImage : public VulkanDeviceObject<VulkanObjectType_Image>
 		VkSampleCountFlagBits mSamples;
 		VkImageUsageFlags mUsage;
 		bool mCubemap;
+		VkImageTiling mTiling;
 
 		bool mIsSwapchainImage;
 
+		VkAccessFlags mCurrentAccess;
+		VkPipelineStageFlags mCurrentStages;
+		VkImageLayout mCurrentLayout;
+		VulkanU32 mCurrentQueueFamily;
+
 		mutable bool mMemoryRequirementsQueried;
 		mutable VkMemoryRequirements mMemoryRequirements;
 };
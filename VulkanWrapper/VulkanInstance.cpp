@@ -90,6 +90,18 @@ const std::vector<const char*>& VulkanInstance::getExtensions() const
 	return mExtensions;
 }
 
+bool VulkanInstance::isExtensionEnabled(const char* extensionName) const
+{
+	for (const char* extension : mExtensions)
+	{
+		if (strcmp(extension, extensionName) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 const std::vector<const char*>& VulkanInstance::getLayers() const
 {
 	return mLayers;
@@ -196,6 +208,19 @@ bool VulkanInstance::initializeInternal(const std::vector<const char*>& desiredE
 			return false;
 		}
 	}
+	{
+		// Optional extensions, needed to query the features of the device extensions
+		const char* optionalExtensions[] = {
+			VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME
+		};
+		for (const char* optionalExtension : optionalExtensions)
+		{
+			if (isInstanceExtensionSupported(optionalExtension) && !isExtensionEnabled(optionalExtension))
+			{
+				mExtensions.emplace_back(optionalExtension);
+			}
+		}
+	}
 	
 	// Layers
 	mLayers.reserve(desiredLayers.size());
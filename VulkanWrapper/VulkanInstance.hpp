@@ -28,6 +28,7 @@ class VulkanInstance : public VulkanObject<VulkanObjectType_Instance>
 		const VkInstance& getHandle() const;
 
 		const std::vector<const char*>& getExtensions() const;
+		bool isExtensionEnabled(const char* extensionName) const; // Desired or optional extension
 		const std::vector<const char*>& getLayers() const;
 
 		static bool isInstanceExtensionSupported(const char* extensionName);
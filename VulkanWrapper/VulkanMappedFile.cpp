@@ -0,0 +1,139 @@
+#include "VulkanMappedFile.hpp"
+
+#if (defined VULKAN_PLATFORM_WINDOWS)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanMappedFile::VulkanMappedFile()
+	#if (defined VULKAN_PLATFORM_WINDOWS)
+	: mFileHandle(INVALID_HANDLE_VALUE)
+	, mMappingHandle(nullptr)
+	#else
+	: mFileDescriptor(-1)
+	#endif
+	, mData(nullptr)
+	, mSize(0)
+{
+}
+
+VulkanMappedFile::~VulkanMappedFile()
+{
+	close();
+}
+
+bool VulkanMappedFile::open(const std::string& filename)
+{
+	close();
+
+	#if (defined VULKAN_PLATFORM_WINDOWS)
+		mFileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (mFileHandle == INVALID_HANDLE_VALUE)
+		{
+			VULKAN_LOG_ERROR("Could not open '%s' file", filename.c_str());
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(mFileHandle, &fileSize) == 0 || fileSize.QuadPart == 0)
+		{
+			VULKAN_LOG_ERROR("The '%s' file is empty", filename.c_str());
+			close();
+			return false;
+		}
+		mSize = static_cast<size_t>(fileSize.QuadPart);
+
+		mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMappingHandle != nullptr)
+		{
+			mData = static_cast<const VulkanU8*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+		}
+	#else
+		mFileDescriptor = ::open(filename.c_str(), O_RDONLY);
+		if (mFileDescriptor < 0)
+		{
+			VULKAN_LOG_ERROR("Could not open '%s' file", filename.c_str());
+			return false;
+		}
+
+		struct stat fileStatus;
+		if (fstat(mFileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+		{
+			VULKAN_LOG_ERROR("The '%s' file is empty", filename.c_str());
+			close();
+			return false;
+		}
+		mSize = static_cast<size_t>(fileStatus.st_size);
+
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+		if (data != MAP_FAILED)
+		{
+			mData = static_cast<const VulkanU8*>(data);
+		}
+	#endif
+
+	if (mData == nullptr)
+	{
+		VULKAN_LOG_ERROR("Could not map '%s' file", filename.c_str());
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool VulkanMappedFile::isOpen() const
+{
+	return mData != nullptr;
+}
+
+void VulkanMappedFile::close()
+{
+	#if (defined VULKAN_PLATFORM_WINDOWS)
+		if (mData != nullptr)
+		{
+			UnmapViewOfFile(mData);
+		}
+		if (mMappingHandle != nullptr)
+		{
+			CloseHandle(mMappingHandle);
+			mMappingHandle = nullptr;
+		}
+		if (mFileHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFileHandle);
+			mFileHandle = INVALID_HANDLE_VALUE;
+		}
+	#else
+		if (mData != nullptr)
+		{
+			munmap(const_cast<VulkanU8*>(mData), mSize);
+		}
+		if (mFileDescriptor >= 0)
+		{
+			::close(mFileDescriptor);
+			mFileDescriptor = -1;
+		}
+	#endif
+
+	mData = nullptr;
+	mSize = 0;
+}
+
+const VulkanU8* VulkanMappedFile::getData() const
+{
+	return mData;
+}
+
+size_t VulkanMappedFile::getSize() const
+{
+	return mSize;
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
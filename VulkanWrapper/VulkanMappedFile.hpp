@@ -0,0 +1,40 @@
+#pragma once
+
+#include "VulkanCore.hpp"
+
+#include <string>
+
+VULKAN_NAMESPACE_BEGIN
+
+// Read-only view of a whole file, mapped in memory instead of copied
+// The data is page-aligned, so it can be used directly as SPIR-V words
+class VulkanMappedFile
+{
+	public:
+		VulkanMappedFile();
+		~VulkanMappedFile();
+
+		bool open(const std::string& filename);
+		bool isOpen() const;
+		void close();
+
+		const VulkanU8* getData() const;
+		size_t getSize() const;
+
+	private:
+		// NonCopyable
+		VulkanMappedFile(const VulkanMappedFile& other) = delete;
+		VulkanMappedFile& operator=(const VulkanMappedFile& other) = delete;
+
+		#if (defined VULKAN_PLATFORM_WINDOWS)
+			void* mFileHandle;
+			void* mMappingHandle;
+		#else
+			int mFileDescriptor;
+		#endif
+
+		const VulkanU8* mData;
+		size_t mSize;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,399 @@
+#include "VulkanMemoryAllocator.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanMemoryBlock.hpp"
+
+#include <algorithm>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanMemoryAllocation::VulkanMemoryAllocation()
+	: memoryBlock(nullptr)
+	, offset(0)
+	, size(0)
+	, poolIndex(VulkanInvalidU32)
+{
+}
+
+bool VulkanMemoryAllocation::isValid() const
+{
+	return memoryBlock != nullptr;
+}
+
+VulkanMemoryAllocatorStats::VulkanMemoryAllocatorStats()
+	: poolCount(0)
+	, pageCount(0)
+	, dedicatedPageCount(0)
+	, allocationCount(0)
+	, freeRangeCount(0)
+	, reservedBytes(0)
+	, usedBytes(0)
+	, freeBytes(0)
+	, largestFreeRange(0)
+	, totalAllocations(0)
+	, totalFrees(0)
+	, totalDeviceAllocations(0)
+{
+}
+
+VulkanF32 VulkanMemoryAllocatorStats::getFragmentation() const
+{
+	if (freeBytes == 0)
+	{
+		return 0.0f;
+	}
+	return 1.0f - static_cast<VulkanF32>(largestFreeRange) / static_cast<VulkanF32>(freeBytes);
+}
+
+bool VulkanMemoryAllocator::allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags memoryProperties, bool linear, VulkanMemoryAllocation& allocation)
+{
+	VULKAN_ASSERT(!allocation.isValid(), "allocation must be freed before being reused");
+	VULKAN_ASSERT(memoryRequirements.size > 0, "size must be greater than 0");
+
+	const VkPhysicalDeviceMemoryProperties& deviceMemoryProperties = mDevice.getMemoryProperties();
+	const VkDeviceSize alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+	const bool dedicated = memoryRequirements.size > mPageSize / 2;
+
+	for (VulkanU32 type = 0; type < deviceMemoryProperties.memoryTypeCount; type++)
+	{
+		VkMemoryPropertyFlags deviceMemoryPropertiesFlags = deviceMemoryProperties.memoryTypes[type].propertyFlags;
+		if ((memoryRequirements.memoryTypeBits & (1 << type)) == 0 || (deviceMemoryPropertiesFlags & memoryProperties) != memoryProperties)
+		{
+			continue;
+		}
+
+		VulkanU32 poolIndex = getPoolIndex(type, memoryProperties, linear);
+		Pool& pool = mPools[poolIndex];
+
+		Page* selectedPage = nullptr;
+		VkDeviceSize offset = 0;
+		if (!dedicated)
+		{
+			for (auto& page : pool.pages)
+			{
+				if (!page->dedicated && allocateFromPage(*page, memoryRequirements.size, alignment, offset))
+				{
+					selectedPage = page.get();
+					break;
+				}
+			}
+		}
+		if (selectedPage == nullptr)
+		{
+			selectedPage = createPage(pool, dedicated ? memoryRequirements.size : mPageSize, dedicated);
+			if (selectedPage == nullptr)
+			{
+				// Try the next compatible memory type
+				continue;
+			}
+			if (!allocateFromPage(*selectedPage, memoryRequirements.size, alignment, offset))
+			{
+				// The new page is the last one, don't keep it empty
+				pool.pages.pop_back();
+				continue;
+			}
+		}
+
+		selectedPage->usedBytes += memoryRequirements.size;
+		selectedPage->allocationCount++;
+		mTotalAllocations++;
+
+		allocation.memoryBlock = selectedPage->memoryBlock.get();
+		allocation.offset = offset;
+		allocation.size = memoryRequirements.size;
+		allocation.poolIndex = poolIndex;
+		return true;
+	}
+
+	VULKAN_LOG_ERROR("Could not sub-allocate %llu bytes of memory", static_cast<unsigned long long>(memoryRequirements.size));
+	return false;
+}
+
+void VulkanMemoryAllocator::free(VulkanMemoryAllocation& allocation)
+{
+	if (!allocation.isValid())
+	{
+		return;
+	}
+
+	if (allocation.poolIndex >= mPools.size())
+	{
+		VULKAN_LOG_WARNING("Freeing an allocation which does not belong to this allocator");
+		allocation = VulkanMemoryAllocation();
+		return;
+	}
+
+	Pool& pool = mPools[allocation.poolIndex];
+	auto pageItr = std::find_if(pool.pages.begin(), pool.pages.end(), [&allocation](const PagePtr& page) { return page->memoryBlock.get() == allocation.memoryBlock; });
+	if (pageItr == pool.pages.end())
+	{
+		VULKAN_LOG_WARNING("Freeing an allocation which does not belong to this allocator");
+		allocation = VulkanMemoryAllocation();
+		return;
+	}
+
+	Page& page = *(*pageItr);
+	freeToPage(page, allocation.offset, allocation.size);
+	page.usedBytes -= allocation.size;
+	page.allocationCount--;
+	mTotalFrees++;
+
+	if (page.allocationCount == 0)
+	{
+		bool releasePage = page.dedicated;
+		if (!releasePage)
+		{
+			// Release the page only if the pool has another empty page
+			for (auto& otherPage : pool.pages)
+			{
+				if (otherPage.get() != &page && !otherPage->dedicated && otherPage->allocationCount == 0)
+				{
+					releasePage = true;
+					break;
+				}
+			}
+		}
+		if (releasePage)
+		{
+			pool.pages.erase(pageItr);
+		}
+	}
+
+	allocation = VulkanMemoryAllocation();
+}
+
+void VulkanMemoryAllocator::releaseEmptyPages(bool keepOnePerPool)
+{
+	for (Pool& pool : mPools)
+	{
+		bool keptOne = !keepOnePerPool;
+		for (auto itr = pool.pages.begin(); itr != pool.pages.end(); )
+		{
+			if ((*itr)->allocationCount == 0 && (keptOne || (*itr)->dedicated))
+			{
+				itr = pool.pages.erase(itr);
+			}
+			else
+			{
+				if ((*itr)->allocationCount == 0)
+				{
+					keptOne = true;
+				}
+				++itr;
+			}
+		}
+	}
+}
+
+void VulkanMemoryAllocator::setPageSize(VkDeviceSize pageSize)
+{
+	VULKAN_ASSERT(pageSize > 0, "pageSize must be greater than 0");
+	mPageSize = pageSize;
+}
+
+VkDeviceSize VulkanMemoryAllocator::getPageSize() const
+{
+	return mPageSize;
+}
+
+VulkanMemoryAllocatorStats VulkanMemoryAllocator::getStats() const
+{
+	VulkanMemoryAllocatorStats stats;
+	stats.poolCount = static_cast<VulkanU32>(mPools.size());
+	stats.totalAllocations = mTotalAllocations;
+	stats.totalFrees = mTotalFrees;
+	stats.totalDeviceAllocations = mTotalDeviceAllocations;
+	for (const Pool& pool : mPools)
+	{
+		for (const PagePtr& page : pool.pages)
+		{
+			stats.pageCount++;
+			if (page->dedicated)
+			{
+				stats.dedicatedPageCount++;
+			}
+			stats.allocationCount += page->allocationCount;
+			stats.reservedBytes += page->memoryBlock->getSize();
+			stats.usedBytes += page->usedBytes;
+			stats.freeRangeCount += static_cast<VulkanU32>(page->freeRanges.size());
+			for (const FreeRange& range : page->freeRanges)
+			{
+				stats.freeBytes += range.size;
+				stats.largestFreeRange = std::max(stats.largestFreeRange, range.size);
+			}
+		}
+	}
+	return stats;
+}
+
+void VulkanMemoryAllocator::printStats() const
+{
+	VulkanMemoryAllocatorStats stats = getStats();
+	VULKAN_LOG_INFO("MemoryAllocator: %d pools, %d pages (%d dedicated), %d allocations", stats.poolCount, stats.pageCount, stats.dedicatedPageCount, stats.allocationCount);
+	VULKAN_LOG_INFO("MemoryAllocator: %llu bytes reserved, %llu bytes used, %llu bytes free in %d ranges (largest: %llu, fragmentation: %.3f)", stats.reservedBytes, stats.usedBytes, stats.freeBytes, stats.freeRangeCount, stats.largestFreeRange, stats.getFragmentation());
+	VULKAN_LOG_INFO("MemoryAllocator: %llu allocations, %llu frees, %llu device allocations since creation", stats.totalAllocations, stats.totalFrees, stats.totalDeviceAllocations);
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(VulkanDevice& device)
+	: mDevice(device)
+	, mPools()
+	, mPageSize(DefaultPageSize)
+	, mTotalAllocations(0)
+	, mTotalFrees(0)
+	, mTotalDeviceAllocations(0)
+{
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator()
+{
+	release();
+}
+
+bool VulkanMemoryAllocator::release()
+{
+	for (const Pool& pool : mPools)
+	{
+		for (const PagePtr& page : pool.pages)
+		{
+			if (page->allocationCount > 0)
+			{
+				VULKAN_LOG_WARNING("MemoryAllocator released while %d allocations are still alive in a page", page->allocationCount);
+			}
+		}
+	}
+	mPools.clear();
+	return true;
+}
+
+VulkanU32 VulkanMemoryAllocator::getPoolIndex(VulkanU32 memoryType, VkMemoryPropertyFlags memoryProperties, bool linear)
+{
+	for (size_t i = 0; i < mPools.size(); i++)
+	{
+		if (mPools[i].memoryType == memoryType && mPools[i].memoryProperties == memoryProperties && mPools[i].linear == linear)
+		{
+			return static_cast<VulkanU32>(i);
+		}
+	}
+
+	mPools.emplace_back();
+	Pool& pool = mPools.back();
+	pool.memoryType = memoryType;
+	pool.memoryProperties = memoryProperties;
+	pool.linear = linear;
+	return static_cast<VulkanU32>(mPools.size() - 1);
+}
+
+VulkanMemoryAllocator::Page* VulkanMemoryAllocator::createPage(Pool& pool, VkDeviceSize size, bool dedicated)
+{
+	VkMemoryRequirements pageRequirements = {
+		size,                     // VkDeviceSize    size
+		1,                        // VkDeviceSize    alignment
+		1u << pool.memoryType     // uint32_t        memoryTypeBits
+	};
+
+	VulkanMemoryBlockPtr memoryBlock = mDevice.createMemoryBlock(pageRequirements, pool.memoryProperties);
+	if (memoryBlock == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Pages are shared by many resources, so host visible ones stay mapped instead of being mapped by each of them
+	if (memoryBlock->isHostVisible() && !memoryBlock->mapPersistently())
+	{
+		return nullptr;
+	}
+
+	PagePtr page(new Page());
+	page->memoryBlock = std::move(memoryBlock);
+	page->freeRanges.push_back({ 0, size });
+	page->usedBytes = 0;
+	page->allocationCount = 0;
+	page->dedicated = dedicated;
+
+	// Counted once the page is usable, a page discarded above has already released its memory
+	mTotalDeviceAllocations++;
+	pool.pages.emplace_back(std::move(page));
+	return pool.pages.back().get();
+}
+
+bool VulkanMemoryAllocator::allocateFromPage(Page& page, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+	// Best-fit : take the range which will leave the smallest remaining space
+	size_t bestRange = page.freeRanges.size();
+	VkDeviceSize bestRemaining = 0;
+	VkDeviceSize bestOffset = 0;
+	for (size_t i = 0; i < page.freeRanges.size(); i++)
+	{
+		const FreeRange& range = page.freeRanges[i];
+		VkDeviceSize alignedOffset = (range.offset + alignment - 1) / alignment * alignment;
+		VkDeviceSize padding = alignedOffset - range.offset;
+		if (padding + size <= range.size)
+		{
+			VkDeviceSize remaining = range.size - padding - size;
+			if (bestRange == page.freeRanges.size() || remaining < bestRemaining)
+			{
+				bestRange = i;
+				bestRemaining = remaining;
+				bestOffset = alignedOffset;
+				if (remaining == 0)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	if (bestRange == page.freeRanges.size())
+	{
+		return false;
+	}
+
+	// Split the range : the alignment padding stays free before the allocation, the remaining space after it
+	FreeRange range = page.freeRanges[bestRange];
+	VkDeviceSize padding = bestOffset - range.offset;
+	auto itr = page.freeRanges.erase(page.freeRanges.begin() + bestRange);
+	if (bestRemaining > 0)
+	{
+		itr = page.freeRanges.insert(itr, { bestOffset + size, bestRemaining });
+	}
+	if (padding > 0)
+	{
+		page.freeRanges.insert(itr, { range.offset, padding });
+	}
+
+	offset = bestOffset;
+	return true;
+}
+
+void VulkanMemoryAllocator::freeToPage(Page& page, VkDeviceSize offset, VkDeviceSize size)
+{
+	auto next = std::lower_bound(page.freeRanges.begin(), page.freeRanges.end(), offset, [](const FreeRange& range, VkDeviceSize value) { return range.offset < value; });
+
+	// Merge with the previous range
+	if (next != page.freeRanges.begin())
+	{
+		auto previous = next - 1;
+		if (previous->offset + previous->size == offset)
+		{
+			previous->size += size;
+			if (next != page.freeRanges.end() && previous->offset + previous->size == next->offset)
+			{
+				previous->size += next->size;
+				page.freeRanges.erase(next);
+			}
+			return;
+		}
+	}
+
+	// Merge with the next range
+	if (next != page.freeRanges.end() && offset + size == next->offset)
+	{
+		next->offset = offset;
+		next->size += size;
+		return;
+	}
+
+	page.freeRanges.insert(next, { offset, size });
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
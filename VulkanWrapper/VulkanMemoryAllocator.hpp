@@ -0,0 +1,112 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+// TODO : TLSF placement if the free ranges of a page become too numerous for a best-fit search
+// TODO : Defragmentation
+// TODO : Thread safety
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanMemoryAllocation
+{
+	VulkanMemoryAllocation();
+
+	bool isValid() const;
+
+	VulkanMemoryBlock* memoryBlock;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	VulkanU32 poolIndex;
+};
+
+struct VulkanMemoryAllocatorStats
+{
+	VulkanMemoryAllocatorStats();
+
+	// 0 when all the free memory of the pages is contiguous, close to 1 when it is split in many small ranges
+	VulkanF32 getFragmentation() const;
+
+	VulkanU32 poolCount;
+	VulkanU32 pageCount;
+	VulkanU32 dedicatedPageCount;
+	VulkanU32 allocationCount;
+	VulkanU32 freeRangeCount;
+	VkDeviceSize reservedBytes;
+	VkDeviceSize usedBytes;
+	VkDeviceSize freeBytes;
+	VkDeviceSize largestFreeRange;
+	VulkanU64 totalAllocations;
+	VulkanU64 totalFrees;
+	VulkanU64 totalDeviceAllocations;
+};
+
+// Reserves big VkDeviceMemory pages per memory type and hands out aligned sub-ranges of them
+// Linear resources (buffers and VK_IMAGE_TILING_LINEAR images) and optimal tiling images never share a page, so bufferImageGranularity is always respected
+// Host visible pages are persistently mapped, use VulkanMemoryBlock::writeRange/readRange with the offset of the allocation
+class VulkanMemoryAllocator
+{
+	public:
+		static const VkDeviceSize DefaultPageSize = 64 * 1024 * 1024;
+
+		bool allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags memoryProperties, bool linear, VulkanMemoryAllocation& allocation);
+		void free(VulkanMemoryAllocation& allocation);
+
+		// Keep at least one empty page per pool to avoid allocating a new page each time a pool becomes empty
+		void releaseEmptyPages(bool keepOnePerPool = true);
+
+		// Only affects the pages created after the call
+		void setPageSize(VkDeviceSize pageSize);
+		VkDeviceSize getPageSize() const;
+
+		VulkanMemoryAllocatorStats getStats() const;
+		void printStats() const;
+
+	private:
+		friend class VulkanDevice;
+		VulkanMemoryAllocator(VulkanDevice& device);
+		~VulkanMemoryAllocator();
+
+		bool release();
+
+		struct FreeRange
+		{
+			VkDeviceSize offset;
+			VkDeviceSize size;
+		};
+
+		struct Page
+		{
+			VulkanMemoryBlockPtr memoryBlock;
+			std::vector<FreeRange> freeRanges; // Sorted by offset
+			VkDeviceSize usedBytes;
+			VulkanU32 allocationCount;
+			bool dedicated;
+		};
+		typedef std::unique_ptr<Page> PagePtr;
+
+		struct Pool
+		{
+			VulkanU32 memoryType;
+			VkMemoryPropertyFlags memoryProperties;
+			bool linear;
+			std::vector<PagePtr> pages;
+		};
+
+		VulkanU32 getPoolIndex(VulkanU32 memoryType, VkMemoryPropertyFlags memoryProperties, bool linear);
+		Page* createPage(Pool& pool, VkDeviceSize size, bool dedicated);
+
+		static bool allocateFromPage(Page& page, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+		static void freeToPage(Page& page, VkDeviceSize offset, VkDeviceSize size);
+
+	private:
+		VulkanDevice& mDevice;
+		std::vector<Pool> mPools;
+		VkDeviceSize mPageSize;
+
+		VulkanU64 mTotalAllocations;
+		VulkanU64 mTotalFrees;
+		VulkanU64 mTotalDeviceAllocations;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
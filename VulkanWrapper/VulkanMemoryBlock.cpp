@@ -5,6 +5,8 @@
 #include "VulkanBuffer.hpp"
 #include "VulkanImage.hpp"
 
+#include <algorithm>
+
 VULKAN_NAMESPACE_BEGIN
 
 VulkanMemoryBlock::~VulkanMemoryBlock()
@@ -25,12 +27,24 @@ bool VulkanMemoryBlock::map(VkDeviceSize offset, VkDeviceSize size)
 	VULKAN_ASSERT(size == VK_WHOLE_SIZE || size <= mMemoryRequirements.size - offset, "If size is not equal to VK_WHOLE_SIZE, size must be less than or equal to the size of the memory minus offset");
 	VULKAN_ASSERT(isHostVisible(), "memory must have been created with a memory type that reports VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT");
 
-	VkResult result = vkMapMemory(getDeviceHandle(), mMemoryBlock, offset, size, 0, &mMappedData);
-	if (result != VK_SUCCESS)
+	if (size == VK_WHOLE_SIZE)
 	{
-		// TODO : Log more
-		VULKAN_LOG_ERROR("Could not map memory object\n");
-		return false;
+		size = mMemoryRequirements.size - offset;
+	}
+
+	if (isPersistentlyMapped())
+	{
+		mMappedData = static_cast<VulkanU8*>(mPersistentData) + offset;
+	}
+	else
+	{
+		VkResult result = vkMapMemory(getDeviceHandle(), mMemoryBlock, offset, size, 0, &mMappedData);
+		if (result != VK_SUCCESS)
+		{
+			// TODO : Log more
+			VULKAN_LOG_ERROR("Could not map memory object\n");
+			return false;
+		}
 	}
 
 	mMappedOffset = offset;
@@ -43,56 +57,184 @@ bool VulkanMemoryBlock::read(void* data)
 {
 	VULKAN_ASSERT(isMapped(), "memory must be mapped to be read");
 
-	std::memcpy(data, mMappedData, mMappedSize);
-
-	return true;
+	return readRange(mMappedOffset, mMappedSize, data);
 }
 
 bool VulkanMemoryBlock::write(const void* data)
 {
 	VULKAN_ASSERT(isMapped(), "memory must be mapped to be written");
 
-	std::memcpy(mMappedData, data, mMappedSize);
+	return writeRange(mMappedOffset, mMappedSize, data);
+}
+
+bool VulkanMemoryBlock::unmap()
+{
+	if (isMapped())
+	{
+		if (!isPersistentlyMapped())
+		{
+			// Pending ranges can't be flushed once the memory is unmapped
+			flush();
+			mPendingInvalidateRanges.clear();
+
+			vkUnmapMemory(getDeviceHandle(), mMemoryBlock);
+		}
+		mMappedData = nullptr;
+		mMappedOffset = 0;
+		mMappedSize = 0;
+	}
+	return true;
+}
+
+bool VulkanMemoryBlock::mapPersistently()
+{
+	if (isPersistentlyMapped())
+	{
+		return true;
+	}
+
+	VULKAN_ASSERT(isHostVisible(), "memory must have been created with a memory type that reports VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT");
+
+	unmap();
+
+	VkResult result = vkMapMemory(getDeviceHandle(), mMemoryBlock, 0, VK_WHOLE_SIZE, 0, &mPersistentData);
+	if (result != VK_SUCCESS || mPersistentData == nullptr)
+	{
+		VULKAN_LOG_ERROR("Could not persistently map memory object");
+		mPersistentData = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool VulkanMemoryBlock::isPersistentlyMapped() const
+{
+	return mPersistentData != nullptr;
+}
+
+bool VulkanMemoryBlock::writeRange(VkDeviceSize offset, VkDeviceSize size, const void* data, bool flushNow)
+{
+	void* mappedPointer = getMappedPointer(offset);
+	VULKAN_ASSERT(mappedPointer != nullptr, "memory must be mapped to be written");
+	VULKAN_ASSERT(isPersistentlyMapped() || offset + size <= mMappedOffset + mMappedSize, "range must be inside the mapped memory");
+	if (mappedPointer == nullptr)
+	{
+		return false;
+	}
+
+	std::memcpy(mappedPointer, data, static_cast<size_t>(size));
 
 	if (!isHostCoherent())
 	{
-		std::vector<VkMappedMemoryRange> memoryRanges = {
-			{
-				VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
-				nullptr,                                // const void       * pNext
-				mMemoryBlock,                           // VkDeviceMemory     memory
-				mMappedOffset,                          // VkDeviceSize       offset
-				mMappedSize                             // VkDeviceSize       size
-			}
-		};
-		// TODO : Instead of mMappedSize, there was VK_WHOLE_SIZE. Is mMappedSize better ? (Probably, but need to be sure)
-		// TODO : Allow multiple memory ranges flushing
-		// TODO : Flush only if wanted ?
-		// TODO : Invalidate instead of Flush ?
-		VkResult result = vkFlushMappedMemoryRanges(getDeviceHandle(), static_cast<uint32_t>(memoryRanges.size()), memoryRanges.data());
-		if (result != VK_SUCCESS)
+		addFlushRange(offset, size);
+		if (flushNow)
+		{
+			return flush();
+		}
+	}
+
+	return true;
+}
+
+bool VulkanMemoryBlock::readRange(VkDeviceSize offset, VkDeviceSize size, void* data, bool invalidateNow)
+{
+	void* mappedPointer = getMappedPointer(offset);
+	VULKAN_ASSERT(mappedPointer != nullptr, "memory must be mapped to be read");
+	VULKAN_ASSERT(isPersistentlyMapped() || offset + size <= mMappedOffset + mMappedSize, "range must be inside the mapped memory");
+	if (mappedPointer == nullptr)
+	{
+		return false;
+	}
+
+	if (!isHostCoherent())
+	{
+		addInvalidateRange(offset, size);
+		if (invalidateNow && !invalidate())
 		{
-			// TODO : Use Numea System Log
-			printf("Could not flush mapped memory\n");
 			return false;
 		}
 	}
 
+	std::memcpy(data, mappedPointer, static_cast<size_t>(size));
+
 	return true;
 }
 
-bool VulkanMemoryBlock::unmap()
+void* VulkanMemoryBlock::getMappedPointer(VkDeviceSize offset) const
 {
-	if (isMapped())
+	if (isPersistentlyMapped())
 	{
-		vkUnmapMemory(getDeviceHandle(), mMemoryBlock);
-		mMappedData = nullptr;
-		mMappedOffset = 0;
-		mMappedSize = 0;
+		return static_cast<VulkanU8*>(mPersistentData) + offset;
+	}
+	if (isMapped() && offset >= mMappedOffset && offset < mMappedOffset + mMappedSize)
+	{
+		return static_cast<VulkanU8*>(mMappedData) + (offset - mMappedOffset);
+	}
+	return nullptr;
+}
+
+void VulkanMemoryBlock::addFlushRange(VkDeviceSize offset, VkDeviceSize size)
+{
+	if (!isHostCoherent())
+	{
+		addRange(mPendingFlushRanges, offset, size);
 	}
+}
+
+bool VulkanMemoryBlock::flush()
+{
+	if (mPendingFlushRanges.empty())
+	{
+		return true;
+	}
+
+	mergeRanges(mPendingFlushRanges);
+
+	VkResult result = vkFlushMappedMemoryRanges(getDeviceHandle(), static_cast<VulkanU32>(mPendingFlushRanges.size()), mPendingFlushRanges.data());
+	mPendingFlushRanges.clear();
+	if (result != VK_SUCCESS)
+	{
+		VULKAN_LOG_ERROR("Could not flush mapped memory");
+		return false;
+	}
+
 	return true;
 }
 
+void VulkanMemoryBlock::addInvalidateRange(VkDeviceSize offset, VkDeviceSize size)
+{
+	if (!isHostCoherent())
+	{
+		addRange(mPendingInvalidateRanges, offset, size);
+	}
+}
+
+bool VulkanMemoryBlock::invalidate()
+{
+	if (mPendingInvalidateRanges.empty())
+	{
+		return true;
+	}
+
+	mergeRanges(mPendingInvalidateRanges);
+
+	VkResult result = vkInvalidateMappedMemoryRanges(getDeviceHandle(), static_cast<VulkanU32>(mPendingInvalidateRanges.size()), mPendingInvalidateRanges.data());
+	mPendingInvalidateRanges.clear();
+	if (result != VK_SUCCESS)
+	{
+		VULKAN_LOG_ERROR("Could not invalidate mapped memory");
+		return false;
+	}
+
+	return true;
+}
+
+bool VulkanMemoryBlock::hasPendingFlush() const
+{
+	return !mPendingFlushRanges.empty();
+}
+
 bool VulkanMemoryBlock::bind(VulkanBuffer* buffer, VkDeviceSize offsetInMemory)
 {
 	VULKAN_ASSERT(buffer != nullptr, "Valid buffer must be provided");
@@ -204,6 +346,9 @@ VulkanMemoryBlock::VulkanMemoryBlock(VkMemoryRequirements memoryRequirements, Vk
 	, mMappedData(nullptr)
 	, mMappedOffset(0)
 	, mMappedSize(0)
+	, mPersistentData(nullptr)
+	, mPendingFlushRanges()
+	, mPendingInvalidateRanges()
 {
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
@@ -248,9 +393,60 @@ void VulkanMemoryBlock::release()
 {
 	if (mMemoryBlock != VK_NULL_HANDLE)
 	{
+		if (isPersistentlyMapped())
+		{
+			flush();
+			vkUnmapMemory(getDeviceHandle(), mMemoryBlock);
+			mPersistentData = nullptr;
+		}
 		vkFreeMemory(getDeviceHandle(), mMemoryBlock, nullptr);
 		mMemoryBlock = VK_NULL_HANDLE;
 	}
 }
 
+void VulkanMemoryBlock::addRange(std::vector<VkMappedMemoryRange>& ranges, VkDeviceSize offset, VkDeviceSize size) const
+{
+	// Offset and size must be multiples of nonCoherentAtomSize, except if the range ends at the end of the memory
+	const VkDeviceSize atomSize = std::max<VkDeviceSize>(getDevice().getProperties().limits.nonCoherentAtomSize, 1);
+	VkDeviceSize begin = offset / atomSize * atomSize;
+	VkDeviceSize end = (offset + size + atomSize - 1) / atomSize * atomSize;
+	if (end > mMemoryRequirements.size)
+	{
+		end = mMemoryRequirements.size;
+	}
+
+	ranges.push_back({
+		VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
+		nullptr,                                // const void       * pNext
+		mMemoryBlock,                           // VkDeviceMemory     memory
+		begin,                                  // VkDeviceSize       offset
+		end - begin                             // VkDeviceSize       size
+	});
+}
+
+void VulkanMemoryBlock::mergeRanges(std::vector<VkMappedMemoryRange>& ranges) const
+{
+	if (ranges.size() <= 1)
+	{
+		return;
+	}
+
+	std::sort(ranges.begin(), ranges.end(), [](const VkMappedMemoryRange& a, const VkMappedMemoryRange& b) { return a.offset < b.offset; });
+
+	size_t last = 0;
+	for (size_t i = 1; i < ranges.size(); i++)
+	{
+		VkMappedMemoryRange& previous = ranges[last];
+		if (ranges[i].offset <= previous.offset + previous.size)
+		{
+			previous.size = std::max(previous.size, ranges[i].offset + ranges[i].size - previous.offset);
+		}
+		else
+		{
+			ranges[++last] = ranges[i];
+		}
+	}
+	ranges.resize(last + 1);
+}
+
 VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -2,9 +2,6 @@
 
 #include "VulkanFunctions.hpp"
 
-// TODO : Can multiple memory range from the same memory block be mapped at the same time ? -> If yes, instead of the variables, use a vector. It will be easier to flush everything at the same time
-// TODO : Control over flushing
-// TODO : Read/Write only a subpart of mapped memory
 // TODO : Binding on MemoryBlock side or Image/Buffer side ?
 
 VULKAN_NAMESPACE_BEGIN
@@ -14,11 +11,30 @@ class VulkanMemoryBlock : public VulkanDeviceObject<VulkanObjectType_MemoryBlock
 	public:
 		~VulkanMemoryBlock();
 
+		// When the block is persistently mapped, map/unmap only move the mapped window and never call vkMapMemory/vkUnmapMemory
 		bool map(VkDeviceSize offset, VkDeviceSize size);
 		bool read(void* data);
 		bool write(const void* data);
 		bool unmap();
 
+		// Map the whole block until its destruction
+		bool mapPersistently();
+		bool isPersistentlyMapped() const;
+
+		// Offsets are relative to the start of the block, the range must be accessible through the current mapping
+		// Flushes/Invalidates can be batched by passing false and calling flush()/invalidate() later
+		bool writeRange(VkDeviceSize offset, VkDeviceSize size, const void* data, bool flushNow = true);
+		bool readRange(VkDeviceSize offset, VkDeviceSize size, void* data, bool invalidateNow = true);
+		void* getMappedPointer(VkDeviceSize offset) const;
+
+		// Ranges are merged and rounded to nonCoherentAtomSize, then sent in a single call
+		// Nothing is done for host coherent memory
+		void addFlushRange(VkDeviceSize offset, VkDeviceSize size);
+		bool flush();
+		void addInvalidateRange(VkDeviceSize offset, VkDeviceSize size);
+		bool invalidate();
+		bool hasPendingFlush() const;
+
 		bool bind(VulkanBuffer* buffer, VkDeviceSize memoryOffset);
 		bool bind(VulkanImage* image, VkDeviceSize memoryOffset);
 
@@ -46,6 +62,9 @@ class VulkanMemoryBlock : public VulkanDeviceObject<VulkanObjectType_MemoryBlock
 		bool init();
 		void release();
 
+		void addRange(std::vector<VkMappedMemoryRange>& ranges, VkDeviceSize offset, VkDeviceSize size) const;
+		void mergeRanges(std::vector<VkMappedMemoryRange>& ranges) const;
+
 	private:
 		VkDeviceMemory mMemoryBlock;
 		VkMemoryRequirements mMemoryRequirements;
@@ -54,6 +73,11 @@ class VulkanMemoryBlock : public VulkanDeviceObject<VulkanObjectType_MemoryBlock
 		void* mMappedData;
 		VkDeviceSize mMappedOffset;
 		VkDeviceSize mMappedSize;
+
+		void* mPersistentData;
+
+		std::vector<VkMappedMemoryRange> mPendingFlushRanges;
+		std::vector<VkMappedMemoryRange> mPendingInvalidateRanges;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
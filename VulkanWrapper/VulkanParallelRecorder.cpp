@@ -0,0 +1,276 @@
+#include "VulkanParallelRecorder.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanCommandPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanParallelRecorderPtr VulkanParallelRecorder::createParallelRecorder(VulkanDevice& device, VulkanU32 queueFamily, VulkanU32 framesCount, VulkanU32 threadCount)
+{
+	VulkanParallelRecorderPtr recorder(new VulkanParallelRecorder(framesCount, threadCount));
+	if (recorder != nullptr)
+	{
+		if (!recorder->init(device, queueFamily))
+		{
+			recorder.reset();
+		}
+	}
+	return recorder;
+}
+
+VulkanParallelRecorder::~VulkanParallelRecorder()
+{
+	release();
+}
+
+bool VulkanParallelRecorder::record(VulkanU32 frameIndex, VulkanCommandBuffer* primaryCommandBuffer, const VkCommandBufferInheritanceInfo& inheritanceInfo, VulkanU32 itemCount, const RecordFunction& recordFunction)
+{
+	VULKAN_ASSERT(frameIndex < mFramesCount);
+	VULKAN_ASSERT(primaryCommandBuffer != nullptr && primaryCommandBuffer->isRecording());
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Resetting the pool is cheaper than resetting each command buffer
+	for (VulkanU32 i = 0; i < mActiveThreadCount; i++)
+	{
+		if (!mCommandPools[frameIndex * mThreadCount + i]->reset())
+		{
+			return false;
+		}
+	}
+
+	mJobFrameIndex = frameIndex;
+	mJobItemCount = itemCount;
+	mJobInheritanceInfo = &inheritanceInfo;
+	mJobRecordFunction = &recordFunction;
+	for (VulkanU32 i = 0; i < mThreadCount; i++)
+	{
+		mJobResults[i] = 1;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPendingWorkers = mActiveThreadCount - 1;
+		mGeneration++;
+	}
+	mWorkCondition.notify_all();
+
+	recordSlice(0);
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDoneCondition.wait(lock, [this]() { return mPendingWorkers == 0; });
+	}
+
+	mJobInheritanceInfo = nullptr;
+	mJobRecordFunction = nullptr;
+
+	mLastRecordingStats.issuedCalls = 0;
+	mLastRecordingStats.skippedCalls = 0;
+
+	mSecondaryCommandBuffers.clear();
+	for (VulkanU32 i = 0; i < mActiveThreadCount; i++)
+	{
+		if (mJobResults[i] == 0)
+		{
+			return false;
+		}
+
+		// Empty slices have not been recorded
+		if ((itemCount * (i + 1)) / mActiveThreadCount > (itemCount * i) / mActiveThreadCount)
+		{
+			VulkanCommandBuffer* commandBuffer = mCommandBuffers[frameIndex * mThreadCount + i].get();
+			mLastRecordingStats.issuedCalls += commandBuffer->getStats().issuedCalls;
+			mLastRecordingStats.skippedCalls += commandBuffer->getStats().skippedCalls;
+			mSecondaryCommandBuffers.push_back(commandBuffer);
+		}
+	}
+	primaryCommandBuffer->executeSecondaryCommandBuffer(mSecondaryCommandBuffers);
+
+	mLastRecordingTime = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return true;
+}
+
+void VulkanParallelRecorder::setActiveThreadCount(VulkanU32 activeThreadCount)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mActiveThreadCount = std::max(1u, std::min(activeThreadCount, mThreadCount));
+}
+
+VulkanU32 VulkanParallelRecorder::getActiveThreadCount() const
+{
+	return mActiveThreadCount;
+}
+
+VulkanU32 VulkanParallelRecorder::getThreadCount() const
+{
+	return mThreadCount;
+}
+
+VulkanU32 VulkanParallelRecorder::getFramesCount() const
+{
+	return mFramesCount;
+}
+
+VulkanF32 VulkanParallelRecorder::getLastRecordingTime() const
+{
+	return mLastRecordingTime;
+}
+
+void VulkanParallelRecorder::setStateTracking(bool enabled)
+{
+	mStateTracking = enabled;
+	for (VulkanCommandBufferPtr& commandBuffer : mCommandBuffers)
+	{
+		commandBuffer->setStateTracking(enabled);
+	}
+}
+
+bool VulkanParallelRecorder::isStateTrackingEnabled() const
+{
+	return mStateTracking;
+}
+
+VulkanCommandBufferStats VulkanParallelRecorder::getLastRecordingStats() const
+{
+	return mLastRecordingStats;
+}
+
+VulkanParallelRecorder::VulkanParallelRecorder(VulkanU32 framesCount, VulkanU32 threadCount)
+	: mCommandPools()
+	, mCommandBuffers()
+	, mFramesCount(framesCount)
+	, mThreadCount(std::max(1u, threadCount))
+	, mActiveThreadCount(std::max(1u, threadCount))
+	, mWorkers()
+	, mMutex()
+	, mWorkCondition()
+	, mDoneCondition()
+	, mGeneration(0)
+	, mPendingWorkers(0)
+	, mExit(false)
+	, mJobFrameIndex(0)
+	, mJobItemCount(0)
+	, mJobInheritanceInfo(nullptr)
+	, mJobRecordFunction(nullptr)
+	, mJobResults(std::max(1u, threadCount), 1)
+	, mSecondaryCommandBuffers()
+	, mLastRecordingTime(0.0f)
+	, mLastRecordingStats()
+	, mStateTracking(false)
+{
+}
+
+bool VulkanParallelRecorder::init(VulkanDevice& device, VulkanU32 queueFamily)
+{
+	mCommandPools.reserve(mFramesCount * mThreadCount);
+	mCommandBuffers.reserve(mFramesCount * mThreadCount);
+	for (VulkanU32 i = 0; i < mFramesCount * mThreadCount; i++)
+	{
+		VulkanCommandPoolPtr commandPool = device.createCommandPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, queueFamily);
+		if (commandPool == nullptr || !commandPool->isInitialized())
+		{
+			return false;
+		}
+		if (!commandPool->allocateCommandBuffers(VulkanCommandBufferType::Secondary, 1, mCommandBuffers))
+		{
+			return false;
+		}
+		mCommandPools.push_back(std::move(commandPool));
+	}
+
+	mSecondaryCommandBuffers.reserve(mThreadCount);
+
+	// The calling thread is the thread 0
+	mWorkers.reserve(mThreadCount - 1);
+	for (VulkanU32 i = 1; i < mThreadCount; i++)
+	{
+		mWorkers.emplace_back(&VulkanParallelRecorder::workerMain, this, i);
+	}
+
+	return true;
+}
+
+void VulkanParallelRecorder::release()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mExit = true;
+	}
+	mWorkCondition.notify_all();
+	for (std::thread& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+
+	mCommandBuffers.clear();
+	mCommandPools.clear();
+}
+
+void VulkanParallelRecorder::workerMain(VulkanU32 threadIndex)
+{
+	VulkanU64 generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkCondition.wait(lock, [this, generation]() { return mExit || mGeneration != generation; });
+			if (mExit)
+			{
+				return;
+			}
+			generation = mGeneration;
+			if (threadIndex >= mActiveThreadCount)
+			{
+				continue;
+			}
+		}
+
+		recordSlice(threadIndex);
+
+		bool lastWorker;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mPendingWorkers--;
+			lastWorker = (mPendingWorkers == 0);
+		}
+		if (lastWorker)
+		{
+			mDoneCondition.notify_one();
+		}
+	}
+}
+
+void VulkanParallelRecorder::recordSlice(VulkanU32 threadIndex)
+{
+	const VulkanU32 firstItem = (mJobItemCount * threadIndex) / mActiveThreadCount;
+	const VulkanU32 endItem = (mJobItemCount * (threadIndex + 1)) / mActiveThreadCount;
+	if (endItem == firstItem)
+	{
+		return;
+	}
+
+	VulkanCommandBuffer* commandBuffer = mCommandBuffers[mJobFrameIndex * mThreadCount + threadIndex].get();
+
+	VkCommandBufferInheritanceInfo inheritanceInfo = *mJobInheritanceInfo;
+	if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritanceInfo))
+	{
+		mJobResults[threadIndex] = 0;
+		return;
+	}
+
+	(*mJobRecordFunction)(commandBuffer, firstItem, endItem - firstItem, threadIndex);
+
+	if (!commandBuffer->endRecording())
+	{
+		mJobResults[threadIndex] = 0;
+	}
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanCommandBuffer.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// TODO : Split the items by cost instead of count
+// TODO : Share the worker threads with other systems
+
+VULKAN_NAMESPACE_BEGIN
+
+// Records the items of a render pass in secondary command buffers from several threads
+// Each thread has its own command pool per frame in flight, so no synchronization is needed while recording
+// The calling thread records the first slice, then the secondary command buffers are executed in order in the primary command buffer
+class VulkanParallelRecorder
+{
+	public:
+		// Records the items [firstItem, firstItem + itemCount) in a secondary command buffer, called from any thread
+		typedef std::function<void(VulkanCommandBuffer* commandBuffer, VulkanU32 firstItem, VulkanU32 itemCount, VulkanU32 threadIndex)> RecordFunction;
+
+		static VulkanParallelRecorderPtr createParallelRecorder(VulkanDevice& device, VulkanU32 queueFamily, VulkanU32 framesCount, VulkanU32 threadCount);
+
+		~VulkanParallelRecorder();
+
+		// The render pass of the inheritance info must have been begun on the primary command buffer with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		// The previous submission of the frame must be finished, as the command pools of the frame are reset
+		bool record(VulkanU32 frameIndex, VulkanCommandBuffer* primaryCommandBuffer, const VkCommandBufferInheritanceInfo& inheritanceInfo, VulkanU32 itemCount, const RecordFunction& recordFunction);
+
+		// Between 1 and getThreadCount(), the others threads stay asleep
+		void setActiveThreadCount(VulkanU32 activeThreadCount);
+		VulkanU32 getActiveThreadCount() const;
+		VulkanU32 getThreadCount() const;
+		VulkanU32 getFramesCount() const;
+
+		// CPU time of the last record(), in milliseconds
+		VulkanF32 getLastRecordingTime() const;
+
+		// Applied to all the secondary command buffers
+		void setStateTracking(bool enabled);
+		bool isStateTrackingEnabled() const;
+
+		// Sum of the stats of the secondary command buffers recorded by the last record()
+		VulkanCommandBufferStats getLastRecordingStats() const;
+
+	private:
+		VulkanParallelRecorder(VulkanU32 framesCount, VulkanU32 threadCount);
+
+		bool init(VulkanDevice& device, VulkanU32 queueFamily);
+		void release();
+
+		void workerMain(VulkanU32 threadIndex);
+		void recordSlice(VulkanU32 threadIndex);
+
+		// Per frame and per thread : mThreadCount * frameIndex + threadIndex
+		std::vector<VulkanCommandPoolPtr> mCommandPools;
+		std::vector<VulkanCommandBufferPtr> mCommandBuffers;
+
+		VulkanU32 mFramesCount;
+		VulkanU32 mThreadCount;
+		VulkanU32 mActiveThreadCount;
+
+		std::vector<std::thread> mWorkers;
+		std::mutex mMutex;
+		std::condition_variable mWorkCondition;
+		std::condition_variable mDoneCondition;
+		VulkanU64 mGeneration;
+		VulkanU32 mPendingWorkers;
+		bool mExit;
+
+		// Current job, only valid during record()
+		VulkanU32 mJobFrameIndex;
+		VulkanU32 mJobItemCount;
+		const VkCommandBufferInheritanceInfo* mJobInheritanceInfo;
+		const RecordFunction* mJobRecordFunction;
+		std::vector<VulkanU8> mJobResults; // Not a vector<bool>, each thread writes its own element
+		std::vector<VulkanCommandBuffer*> mSecondaryCommandBuffers; // Reserved once, record() does not allocate
+
+		VulkanF32 mLastRecordingTime;
+		VulkanCommandBufferStats mLastRecordingStats;
+		bool mStateTracking;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "VulkanPhysicalDevice.hpp"
 
+#include "VulkanInstance.hpp"
 #include "VulkanSurface.hpp"
 
 VULKAN_NAMESPACE_BEGIN
@@ -15,6 +16,9 @@ VulkanPhysicalDevice::VulkanPhysicalDevice(const VkPhysicalDevice& physicalDevic
 	, mMemoryPropertiesQueried(false)
 	, mMemoryProperties()
 	, mFormatProperties()
+	, mDescriptorIndexingPropertiesQueried(false)
+	, mDescriptorIndexingFeatures()
+	, mDescriptorIndexingProperties()
 {
 }
 
@@ -60,6 +64,18 @@ const VkFormatProperties& VulkanPhysicalDevice::getFormatProperties(VkFormat for
 	return itr->second;
 }
 
+const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& VulkanPhysicalDevice::getDescriptorIndexingFeatures() const
+{
+	VULKAN_ASSERT(areDescriptorIndexingPropertiesQueried());
+	return mDescriptorIndexingFeatures;
+}
+
+const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& VulkanPhysicalDevice::getDescriptorIndexingProperties() const
+{
+	VULKAN_ASSERT(areDescriptorIndexingPropertiesQueried());
+	return mDescriptorIndexingProperties;
+}
+
 bool VulkanPhysicalDevice::queryAvailableExtensions()
 {
 	mAvailableExtensions.clear();
@@ -137,6 +153,38 @@ bool VulkanPhysicalDevice::queryFormatProperties(VkFormat format)
 	return areFormatPropertiesQueried(format);
 }
 
+bool VulkanPhysicalDevice::queryDescriptorIndexingProperties()
+{
+	mDescriptorIndexingFeatures = {};
+	mDescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	mDescriptorIndexingProperties = {};
+	mDescriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+	// Not an error : the features and properties stay zeroed
+	if (VulkanInstance::get().isExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) && isExtensionSupported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+	{
+		VkPhysicalDeviceFeatures2KHR features = {
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,       // VkStructureType                  sType
+			&mDescriptorIndexingFeatures,                           // void                           * pNext
+			{}                                                      // VkPhysicalDeviceFeatures         features
+		};
+		vkGetPhysicalDeviceFeatures2KHR(mPhysicalDevice, &features);
+
+		VkPhysicalDeviceProperties2KHR properties = {
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR,     // VkStructureType                  sType
+			&mDescriptorIndexingProperties,                         // void                           * pNext
+			{}                                                      // VkPhysicalDeviceProperties       properties
+		};
+		vkGetPhysicalDeviceProperties2KHR(mPhysicalDevice, &properties);
+
+		mDescriptorIndexingFeatures.pNext = nullptr;
+		mDescriptorIndexingProperties.pNext = nullptr;
+	}
+
+	mDescriptorIndexingPropertiesQueried = true;
+	return areDescriptorIndexingPropertiesQueried();
+}
+
 bool VulkanPhysicalDevice::queryAllProperties()
 {
 	bool everythingWentWell = true;
@@ -145,6 +193,7 @@ bool VulkanPhysicalDevice::queryAllProperties()
 	everythingWentWell &= queryProperties();
 	everythingWentWell &= queryQueueFamiliesProperties();
 	everythingWentWell &= queryMemoryProperties();
+	everythingWentWell &= queryDescriptorIndexingProperties(); // After the extensions
 	// TODO : Query some/all VkFormat ?
 	return everythingWentWell;
 }
@@ -179,13 +228,19 @@ bool VulkanPhysicalDevice::areFormatPropertiesQueried(VkFormat format) const
 	return mFormatProperties.find(format) != mFormatProperties.end();
 }
 
+bool VulkanPhysicalDevice::areDescriptorIndexingPropertiesQueried() const
+{
+	return mDescriptorIndexingPropertiesQueried;
+}
+
 bool VulkanPhysicalDevice::areAllPropertiesQueried() const
 {
 	return areAvailableExtensionsQueried()
 		&& areSupportedFeaturesQueried()
 		&& arePropertiesQueried()
 		&& areQueueFamiliesPropertiesQueried()
-		&& areMemoryPropertiesQueried();
+		&& areMemoryPropertiesQueried()
+		&& areDescriptorIndexingPropertiesQueried();
 	// TODO : Query some/all VkFormat ?
 }
 
@@ -16,6 +16,9 @@ class VulkanPhysicalDevice
 		const std::vector<VkQueueFamilyProperties>& getQueueFamiliesProperties() const;
 		const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
 		const VkFormatProperties& getFormatProperties(VkFormat format) const;
+		// Zeroed when VK_EXT_descriptor_indexing or VK_KHR_get_physical_device_properties2 are not available
+		const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& getDescriptorIndexingFeatures() const;
+		const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& getDescriptorIndexingProperties() const;
 		
 		bool queryAvailableExtensions();
 		bool querySupportedFeatures();
@@ -23,6 +26,7 @@ class VulkanPhysicalDevice
 		bool queryQueueFamiliesProperties();
 		bool queryMemoryProperties();
 		bool queryFormatProperties(VkFormat format);
+		bool queryDescriptorIndexingProperties();
 		bool queryAllProperties();
 		
 		bool areAvailableExtensionsQueried() const;
@@ -31,6 +35,7 @@ class VulkanPhysicalDevice
 		bool areQueueFamiliesPropertiesQueried() const;
 		bool areMemoryPropertiesQueried() const;
 		bool areFormatPropertiesQueried(VkFormat format) const;
+		bool areDescriptorIndexingPropertiesQueried() const;
 		bool areAllPropertiesQueried() const;
 
 		bool isExtensionSupported(const char* extensionName) const;
@@ -56,6 +61,9 @@ class VulkanPhysicalDevice
 		bool mMemoryPropertiesQueried;
 		VkPhysicalDeviceMemoryProperties mMemoryProperties;
 		mutable std::unordered_map<VkFormat, VkFormatProperties> mFormatProperties;
+		bool mDescriptorIndexingPropertiesQueried;
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT mDescriptorIndexingFeatures;
+		VkPhysicalDeviceDescriptorIndexingPropertiesEXT mDescriptorIndexingProperties;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
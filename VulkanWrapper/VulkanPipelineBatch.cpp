@@ -0,0 +1,310 @@
+#include "VulkanPipelineBatch.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanPipelineCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanPipelineBatchPtr VulkanPipelineBatch::createPipelineBatch(VulkanDevice& device, VulkanU32 threadCount)
+{
+	return VulkanPipelineBatchPtr(new VulkanPipelineBatch(device, threadCount));
+}
+
+VulkanPipelineBatch::~VulkanPipelineBatch()
+{
+}
+
+VulkanU32 VulkanPipelineBatch::addGraphicsPipeline(VulkanGraphicsPipeline* pipeline)
+{
+	VULKAN_ASSERT(pipeline != nullptr && !pipeline->isCreated());
+
+	GraphicsEntry entry;
+	entry.pipeline = pipeline;
+	entry.result = VK_NOT_READY;
+	entry.time = 0.0f;
+	mGraphicsEntries.push_back(entry);
+	return static_cast<VulkanU32>(mGraphicsEntries.size() - 1);
+}
+
+VulkanU32 VulkanPipelineBatch::addComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants)
+{
+	VULKAN_ASSERT(computeShader != nullptr && layout != nullptr);
+
+	ComputeEntry entry;
+	entry.pipeline.reset(new VulkanComputePipeline(computeShader, layout, cache, additionalOptions, specializationConstants));
+	entry.result = VK_NOT_READY;
+	entry.time = 0.0f;
+	mComputeEntries.push_back(std::move(entry));
+	return static_cast<VulkanU32>(mComputeEntries.size() - 1);
+}
+
+bool VulkanPipelineBatch::build()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// The create infos point to themselves, so they are filled once the entries don't move anymore
+	for (GraphicsEntry& entry : mGraphicsEntries)
+	{
+		entry.pipeline->fillCreateInfo(entry.createInfo);
+	}
+	for (ComputeEntry& entry : mComputeEntries)
+	{
+		entry.pipeline->fillCreateInfo(entry.createInfo);
+	}
+
+	if (mThreadCount == 1)
+	{
+		buildSingleCalls();
+	}
+	else
+	{
+		buildJobs();
+	}
+
+	bool success = true;
+	for (GraphicsEntry& entry : mGraphicsEntries)
+	{
+		if (entry.result != VK_SUCCESS || !entry.pipeline->isCreated())
+		{
+			success = false;
+		}
+		else if (entry.pipeline->mCache != nullptr)
+		{
+			entry.pipeline->mCache->addPipelineCreationTime(entry.time);
+		}
+	}
+	for (ComputeEntry& entry : mComputeEntries)
+	{
+		if (entry.result != VK_SUCCESS || !entry.pipeline->isInitialized())
+		{
+			success = false;
+		}
+		else if (entry.pipeline->mCache != nullptr)
+		{
+			entry.pipeline->mCache->addPipelineCreationTime(entry.time);
+		}
+	}
+
+	mBuildTime = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (!success)
+	{
+		VULKAN_LOG_ERROR("Could not create all the pipelines of the batch");
+	}
+	return success;
+}
+
+void VulkanPipelineBatch::clear()
+{
+	mGraphicsEntries.clear();
+	mComputeEntries.clear();
+}
+
+VulkanComputePipelinePtr VulkanPipelineBatch::takeComputePipeline(VulkanU32 index)
+{
+	VULKAN_ASSERT(index < mComputeEntries.size());
+	if (!mComputeEntries[index].pipeline || !mComputeEntries[index].pipeline->isInitialized())
+	{
+		return nullptr;
+	}
+	return std::move(mComputeEntries[index].pipeline);
+}
+
+void VulkanPipelineBatch::setThreadCount(VulkanU32 threadCount)
+{
+	VulkanU32 hardwareThreads = std::max(1u, static_cast<VulkanU32>(std::thread::hardware_concurrency()));
+	mThreadCount = std::max(1u, std::min(threadCount, hardwareThreads));
+}
+
+VulkanU32 VulkanPipelineBatch::getThreadCount() const
+{
+	return mThreadCount;
+}
+
+VulkanU32 VulkanPipelineBatch::getGraphicsPipelineCount() const
+{
+	return static_cast<VulkanU32>(mGraphicsEntries.size());
+}
+
+VulkanU32 VulkanPipelineBatch::getComputePipelineCount() const
+{
+	return static_cast<VulkanU32>(mComputeEntries.size());
+}
+
+VulkanF32 VulkanPipelineBatch::getGraphicsPipelineTime(VulkanU32 index) const
+{
+	VULKAN_ASSERT(index < mGraphicsEntries.size());
+	return mGraphicsEntries[index].time;
+}
+
+VulkanF32 VulkanPipelineBatch::getComputePipelineTime(VulkanU32 index) const
+{
+	VULKAN_ASSERT(index < mComputeEntries.size());
+	return mComputeEntries[index].time;
+}
+
+VulkanF32 VulkanPipelineBatch::getBuildTime() const
+{
+	return mBuildTime;
+}
+
+void VulkanPipelineBatch::printTimings() const
+{
+	VulkanF32 driverTime = 0.0f;
+	for (VulkanU32 i = 0; i < mGraphicsEntries.size(); i++)
+	{
+		printf("Graphics pipeline %u : %.3f ms\n", i, mGraphicsEntries[i].time);
+		driverTime += mGraphicsEntries[i].time;
+	}
+	for (VulkanU32 i = 0; i < mComputeEntries.size(); i++)
+	{
+		printf("Compute pipeline %u : %.3f ms\n", i, mComputeEntries[i].time);
+		driverTime += mComputeEntries[i].time;
+	}
+	printf("%u pipelines built in %.3f ms on %u threads (%.3f ms in the driver)\n", getGraphicsPipelineCount() + getComputePipelineCount(), mBuildTime, mThreadCount, driverTime);
+}
+
+VulkanPipelineBatch::VulkanPipelineBatch(VulkanDevice& device, VulkanU32 threadCount)
+	: mDevice(device)
+	, mThreadCount(1)
+	, mGraphicsEntries()
+	, mComputeEntries()
+	, mNextJob(0)
+	, mBuildTime(0.0f)
+{
+	setThreadCount(threadCount);
+}
+
+void VulkanPipelineBatch::buildSingleCalls()
+{
+	std::vector<VkGraphicsPipelineCreateInfo> graphicsCreateInfos;
+	std::vector<VkComputePipelineCreateInfo> computeCreateInfos;
+	std::vector<VkPipeline> pipelines;
+	std::vector<VulkanU32> indices;
+
+	// One call per cache, most of the time all the pipelines share the same one
+	std::vector<VulkanPipelineCache*> caches;
+	for (const GraphicsEntry& entry : mGraphicsEntries)
+	{
+		if (std::find(caches.begin(), caches.end(), entry.pipeline->mCache) == caches.end())
+		{
+			caches.push_back(entry.pipeline->mCache);
+		}
+	}
+	for (VulkanPipelineCache* cache : caches)
+	{
+		graphicsCreateInfos.clear();
+		indices.clear();
+		for (VulkanU32 i = 0; i < mGraphicsEntries.size(); i++)
+		{
+			if (mGraphicsEntries[i].pipeline->mCache == cache)
+			{
+				graphicsCreateInfos.push_back(mGraphicsEntries[i].createInfo.pipelineCreateInfo);
+				indices.push_back(i);
+			}
+		}
+		pipelines.assign(indices.size(), VK_NULL_HANDLE);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		VkResult result = vkCreateGraphicsPipelines(mDevice.getHandle(), (cache != nullptr) ? cache->getHandle() : VK_NULL_HANDLE, static_cast<VulkanU32>(graphicsCreateInfos.size()), graphicsCreateInfos.data(), nullptr, pipelines.data());
+		VulkanF32 time = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / static_cast<VulkanF32>(indices.size());
+
+		for (VulkanU32 i = 0; i < indices.size(); i++)
+		{
+			GraphicsEntry& entry = mGraphicsEntries[indices[i]];
+			entry.pipeline->mGraphicsPipeline = pipelines[i];
+			entry.result = (pipelines[i] != VK_NULL_HANDLE) ? VK_SUCCESS : result;
+			entry.time = time;
+		}
+	}
+
+	caches.clear();
+	for (const ComputeEntry& entry : mComputeEntries)
+	{
+		if (std::find(caches.begin(), caches.end(), entry.pipeline->mCache) == caches.end())
+		{
+			caches.push_back(entry.pipeline->mCache);
+		}
+	}
+	for (VulkanPipelineCache* cache : caches)
+	{
+		computeCreateInfos.clear();
+		indices.clear();
+		for (VulkanU32 i = 0; i < mComputeEntries.size(); i++)
+		{
+			if (mComputeEntries[i].pipeline->mCache == cache)
+			{
+				computeCreateInfos.push_back(mComputeEntries[i].createInfo);
+				indices.push_back(i);
+			}
+		}
+		pipelines.assign(indices.size(), VK_NULL_HANDLE);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		VkResult result = vkCreateComputePipelines(mDevice.getHandle(), (cache != nullptr) ? cache->getHandle() : VK_NULL_HANDLE, static_cast<VulkanU32>(computeCreateInfos.size()), computeCreateInfos.data(), nullptr, pipelines.data());
+		VulkanF32 time = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / static_cast<VulkanF32>(indices.size());
+
+		for (VulkanU32 i = 0; i < indices.size(); i++)
+		{
+			ComputeEntry& entry = mComputeEntries[indices[i]];
+			entry.pipeline->mComputePipeline = pipelines[i];
+			entry.result = (pipelines[i] != VK_NULL_HANDLE) ? VK_SUCCESS : result;
+			entry.time = time;
+		}
+	}
+}
+
+void VulkanPipelineBatch::buildJobs()
+{
+	const VulkanU32 jobCount = static_cast<VulkanU32>(mGraphicsEntries.size() + mComputeEntries.size());
+	const VulkanU32 workerCount = std::min(mThreadCount, jobCount);
+
+	mNextJob = 0;
+	auto work = [this, jobCount]()
+	{
+		VulkanU32 job;
+		while ((job = mNextJob.fetch_add(1)) < jobCount)
+		{
+			createJob(job);
+		}
+	};
+
+	// Only used at loading, the threads don't need to outlive build()
+	std::vector<std::thread> workers;
+	workers.reserve(workerCount);
+	for (VulkanU32 i = 1; i < workerCount; i++)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void VulkanPipelineBatch::createJob(VulkanU32 job)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (job < mGraphicsEntries.size())
+	{
+		GraphicsEntry& entry = mGraphicsEntries[job];
+		VulkanPipelineCache* cache = entry.pipeline->mCache;
+		entry.result = vkCreateGraphicsPipelines(mDevice.getHandle(), (cache != nullptr) ? cache->getHandle() : VK_NULL_HANDLE, 1, &entry.createInfo.pipelineCreateInfo, nullptr, &entry.pipeline->mGraphicsPipeline);
+		entry.time = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	else
+	{
+		ComputeEntry& entry = mComputeEntries[job - mGraphicsEntries.size()];
+		VulkanPipelineCache* cache = entry.pipeline->mCache;
+		entry.result = vkCreateComputePipelines(mDevice.getHandle(), (cache != nullptr) ? cache->getHandle() : VK_NULL_HANDLE, 1, &entry.createInfo, nullptr, &entry.pipeline->mComputePipeline);
+		entry.time = std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanComputePipeline.hpp"
+#include "VulkanGraphicsPipeline.hpp"
+
+#include <atomic>
+
+// TODO : Share the worker threads with other systems
+// TODO : Derivative pipelines
+
+VULKAN_NAMESPACE_BEGIN
+
+// Creates many configured pipelines at once
+// With one thread, the pipelines sharing the same cache are created by a single driver call
+// With more threads, each pipeline is created by its own driver call, the calling thread takes part and the caches are shared (they are internally synchronized)
+class VulkanPipelineBatch
+{
+	public:
+		static VulkanPipelineBatchPtr createPipelineBatch(VulkanDevice& device, VulkanU32 threadCount);
+
+		~VulkanPipelineBatch();
+
+		// The pipeline must be fully configured, and stay alive until build() returns
+		VulkanU32 addGraphicsPipeline(VulkanGraphicsPipeline* pipeline);
+		// The pipeline can be taken with takeComputePipeline() once built
+		VulkanU32 addComputePipeline(VulkanShaderModule* computeShader, VulkanPipelineLayout* layout, VulkanPipelineCache* cache, VkPipelineCreateFlags additionalOptions, const VulkanSpecializationConstants* specializationConstants = nullptr);
+
+		// Fails if any pipeline could not be created, the others are still usable
+		bool build();
+		// Forgets the pipelines of the previous build()
+		void clear();
+
+		VulkanComputePipelinePtr takeComputePipeline(VulkanU32 index);
+
+		// Between 1 and the number of hardware threads
+		void setThreadCount(VulkanU32 threadCount);
+		VulkanU32 getThreadCount() const;
+
+		VulkanU32 getGraphicsPipelineCount() const;
+		VulkanU32 getComputePipelineCount() const;
+
+		// Time of the driver call that created the pipeline, in milliseconds
+		// When several pipelines share a call, its time is split evenly between them
+		VulkanF32 getGraphicsPipelineTime(VulkanU32 index) const;
+		VulkanF32 getComputePipelineTime(VulkanU32 index) const;
+		// Wall time of the last build(), in milliseconds
+		VulkanF32 getBuildTime() const;
+
+		void printTimings() const;
+
+	private:
+		VulkanPipelineBatch(VulkanDevice& device, VulkanU32 threadCount);
+
+		struct GraphicsEntry
+		{
+			VulkanGraphicsPipeline* pipeline;
+			VulkanGraphicsPipeline::CreateInfo createInfo;
+			VkResult result;
+			VulkanF32 time;
+		};
+
+		struct ComputeEntry
+		{
+			VulkanComputePipelinePtr pipeline;
+			VkComputePipelineCreateInfo createInfo;
+			VkResult result;
+			VulkanF32 time;
+		};
+
+		void buildSingleCalls();
+		void buildJobs();
+		void createJob(VulkanU32 job);
+
+		VulkanDevice& mDevice;
+		VulkanU32 mThreadCount;
+
+		std::vector<GraphicsEntry> mGraphicsEntries;
+		std::vector<ComputeEntry> mComputeEntries;
+
+		std::atomic<VulkanU32> mNextJob;
+		VulkanF32 mBuildTime;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -2,6 +2,14 @@
 
 #include "VulkanDevice.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if (defined VULKAN_PLATFORM_WINDOWS)
+	#include <windows.h>
+#endif
+
 VULKAN_NAMESPACE_BEGIN
 
 VulkanPipelineCachePtr VulkanPipelineCache::createPipelineCache(const std::vector<unsigned char>& cacheData)
@@ -17,13 +25,142 @@ VulkanPipelineCachePtr VulkanPipelineCache::createPipelineCache(const std::vecto
 	return pipelineCache;
 }
 
+VulkanPipelineCachePtr VulkanPipelineCache::createPipelineCacheFromFile(const std::string& filename, bool autoSave)
+{
+	std::vector<unsigned char> cacheData;
+
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (file.is_open())
+	{
+		std::streamoff size = file.tellg();
+		if (size > 0)
+		{
+			cacheData.resize(static_cast<size_t>(size));
+			file.seekg(0, std::ios::beg);
+			file.read(reinterpret_cast<char*>(cacheData.data()), size);
+			if (file.fail())
+			{
+				VULKAN_LOG_WARNING("Could not read the pipeline cache file '%s'", filename.c_str());
+				cacheData.clear();
+			}
+		}
+		file.close();
+	}
+
+	VulkanPipelineCachePtr pipelineCache = createPipelineCache(cacheData);
+	if (pipelineCache != nullptr && autoSave)
+	{
+		pipelineCache->setAutoSaveFilename(filename);
+	}
+	return pipelineCache;
+}
+
 VulkanPipelineCache::~VulkanPipelineCache()
 {
+	if (!mAutoSaveFilename.empty() && isInitialized())
+	{
+		saveToFile(mAutoSaveFilename);
+	}
+
 	release();
 
 	VULKAN_OBJECTTRACKER_UNREGISTER();
 }
 
+bool VulkanPipelineCache::saveToFile(const std::string& filename)
+{
+	if (!retrieveData())
+	{
+		return false;
+	}
+
+	const std::string temporaryFilename = filename + ".tmp";
+	{
+		std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			VULKAN_LOG_ERROR("Could not open '%s' to save the pipeline cache", temporaryFilename.c_str());
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(mCacheData.data()), static_cast<std::streamsize>(mCacheData.size()));
+		file.close();
+		if (file.fail())
+		{
+			VULKAN_LOG_ERROR("Could not write the pipeline cache to '%s'", temporaryFilename.c_str());
+			std::remove(temporaryFilename.c_str());
+			return false;
+		}
+	}
+
+	// The rename replaces the destination in a single step, readers see either the previous or the new cache
+	#if (defined VULKAN_PLATFORM_WINDOWS)
+		bool replaced = (MoveFileExA(temporaryFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+	#else
+		bool replaced = (std::rename(temporaryFilename.c_str(), filename.c_str()) == 0);
+	#endif
+	if (!replaced)
+	{
+		VULKAN_LOG_ERROR("Could not replace the pipeline cache file '%s'", filename.c_str());
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void VulkanPipelineCache::setAutoSaveFilename(const std::string& filename)
+{
+	mAutoSaveFilename = filename;
+}
+
+const std::string& VulkanPipelineCache::getAutoSaveFilename() const
+{
+	return mAutoSaveFilename;
+}
+
+bool VulkanPipelineCache::isCompatible(const std::vector<unsigned char>& cacheData, const VkPhysicalDeviceProperties& properties)
+{
+	// Header version one : headerLength, headerVersion, vendorID, deviceID, pipelineCacheUUID
+	const size_t headerSize = 4 * sizeof(VulkanU32) + VK_UUID_SIZE;
+	if (cacheData.size() < headerSize)
+	{
+		return false;
+	}
+
+	VulkanU32 header[4];
+	std::memcpy(header, cacheData.data(), sizeof(header));
+	if (header[0] < headerSize || header[0] > cacheData.size() || header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+	{
+		return false;
+	}
+	if (header[2] != properties.vendorID || header[3] != properties.deviceID)
+	{
+		return false;
+	}
+	return std::memcmp(cacheData.data() + 4 * sizeof(VulkanU32), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool VulkanPipelineCache::isWarm() const
+{
+	return mWarm;
+}
+
+void VulkanPipelineCache::addPipelineCreationTime(VulkanF32 milliseconds)
+{
+	mCreatedPipelineCount++;
+	mPipelineCreationTime += milliseconds;
+}
+
+VulkanU32 VulkanPipelineCache::getCreatedPipelineCount() const
+{
+	return mCreatedPipelineCount;
+}
+
+VulkanF32 VulkanPipelineCache::getPipelineCreationTime() const
+{
+	return mPipelineCreationTime;
+}
+
 bool VulkanPipelineCache::retrieveData()
 {
 	mCacheData.clear();
@@ -91,12 +228,24 @@ const VkPipelineCache& VulkanPipelineCache::getHandle() const
 VulkanPipelineCache::VulkanPipelineCache(const std::vector<unsigned char>& cacheData)
 	: mPipelineCache(VK_NULL_HANDLE)
 	, mCacheData(cacheData)
+	, mAutoSaveFilename()
+	, mWarm(false)
+	, mCreatedPipelineCount(0)
+	, mPipelineCreationTime(0.0f)
 {
 	VULKAN_OBJECTTRACKER_REGISTER();
 }
 
 bool VulkanPipelineCache::init()
 {
+	// Drivers should reject foreign data themselves, but some crash or return garbage pipelines instead
+	if (!mCacheData.empty() && !isCompatible(mCacheData, getDevice().getProperties()))
+	{
+		VULKAN_LOG_WARNING("Pipeline cache data does not match the device or the driver, it is discarded");
+		mCacheData.clear();
+	}
+	mWarm = !mCacheData.empty();
+
 	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
 		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,     // VkStructureType                sType
 		nullptr,                                          // const void                   * pNext
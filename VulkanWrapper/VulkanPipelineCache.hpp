@@ -2,6 +2,8 @@
 
 #include "VulkanFunctions.hpp"
 
+#include <string>
+
 /*
 
 Very, very roughly, vkGetPipelineCache will get you a block of bytes 
@@ -29,12 +31,30 @@ VULKAN_NAMESPACE_BEGIN
 class VulkanPipelineCache : public VulkanDeviceObject<VulkanObjectType_PipelineCache>
 {
 	public:
+		// The initial data is discarded when it was not written by the same driver and device
 		static VulkanPipelineCachePtr createPipelineCache(const std::vector<unsigned char>& cacheData = {});
+		// A missing or stale file gives an empty cache, which is saved to the same file on destruction when autoSave is set
+		static VulkanPipelineCachePtr createPipelineCacheFromFile(const std::string& filename, bool autoSave = true);
 
 		~VulkanPipelineCache();
 
-		// TODO : Load From File
-		// TODO : Save To File
+		// The data is written to a temporary file which then replaces the previous one, so an interrupted save never leaves a truncated cache
+		bool saveToFile(const std::string& filename);
+
+		// Empty to disable the save on destruction
+		void setAutoSaveFilename(const std::string& filename);
+		const std::string& getAutoSaveFilename() const;
+
+		// Checks the header written by vkGetPipelineCacheData against the vendorID, deviceID and pipelineCacheUUID of the device
+		static bool isCompatible(const std::vector<unsigned char>& cacheData, const VkPhysicalDeviceProperties& properties);
+
+		// True when valid initial data has been given to the driver
+		bool isWarm() const;
+
+		// Time spent in vkCreate*Pipelines by the pipelines created with this cache, in milliseconds
+		void addPipelineCreationTime(VulkanF32 milliseconds);
+		VulkanU32 getCreatedPipelineCount() const;
+		VulkanF32 getPipelineCreationTime() const;
 
 		bool retrieveData();
 		const std::vector<unsigned char>& getCacheData() const;
@@ -53,6 +73,12 @@ class VulkanPipelineCache : public VulkanDeviceObject<VulkanObjectType_PipelineC
 		VkPipelineCache mPipelineCache; 
 		
 		std::vector<unsigned char> mCacheData;
+
+		std::string mAutoSaveFilename;
+		bool mWarm;
+
+		VulkanU32 mCreatedPipelineCount;
+		VulkanF32 mPipelineCreationTime;
 };
 
 VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "VulkanPipelineStateCache.hpp"
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanPipelineStateCachePtr VulkanPipelineStateCache::createPipelineStateCache()
+{
+	return VulkanPipelineStateCachePtr(new VulkanPipelineStateCache());
+}
+
+VulkanPipelineStateCache::~VulkanPipelineStateCache()
+{
+	clear();
+}
+
+VulkanGraphicsPipeline* VulkanPipelineStateCache::getPipeline(VulkanGraphicsPipelinePtr description)
+{
+	VULKAN_ASSERT(description != nullptr && !description->isCreated());
+
+	VulkanStateKey stateKey;
+	VulkanStateKey familyKey;
+	description->computeStateKey(stateKey, &familyKey);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mStats.requests++;
+
+	// A null pipeline is the placeholder of a state being created by another thread, only the requests of this state wait for it
+	auto itr = mPipelines.find(stateKey);
+	while (itr != mPipelines.end() && itr->second == nullptr)
+	{
+		mCreatedCondition.wait(lock);
+		itr = mPipelines.find(stateKey);
+	}
+	if (itr != mPipelines.end())
+	{
+		mStats.hits++;
+		return itr->second.get();
+	}
+
+	// The base of a family can still be in creation, the pipeline is then created as another base
+	VulkanGraphicsPipeline* basePipeline = nullptr;
+	const bool derivativesEnabled = mDerivativesEnabled;
+	if (derivativesEnabled)
+	{
+		auto familyItr = mFamilyBases.find(familyKey);
+		if (familyItr != mFamilyBases.end())
+		{
+			basePipeline = familyItr->second;
+			description->setCreateFlags(description->getCreateFlags() | VK_PIPELINE_CREATE_DERIVATIVE_BIT);
+			description->setBasePipeline(basePipeline);
+		}
+		else
+		{
+			description->setCreateFlags(description->getCreateFlags() | VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT);
+		}
+	}
+
+	mPipelines.emplace(stateKey, nullptr);
+	mPendingCount++;
+
+	// The compilation is the slow part, the other states can be requested meanwhile
+	lock.unlock();
+	const bool created = description->create();
+	lock.lock();
+
+	mPendingCount--;
+	mCreatedCondition.notify_all();
+	if (!created)
+	{
+		// The waiting requests will try to create it with their own description
+		mPipelines.erase(stateKey);
+		return nullptr;
+	}
+
+	mStats.createdPipelines++;
+	if (basePipeline != nullptr)
+	{
+		mStats.derivativePipelines++;
+	}
+	else if (derivativesEnabled)
+	{
+		mFamilyBases.emplace(familyKey, description.get());
+	}
+
+	VulkanGraphicsPipeline* pipeline = description.get();
+	mPipelines[stateKey] = std::move(description);
+	return pipeline;
+}
+
+bool VulkanPipelineStateCache::contains(const VulkanGraphicsPipeline& description) const
+{
+	VulkanStateKey stateKey;
+	description.computeStateKey(stateKey);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto itr = mPipelines.find(stateKey);
+	return itr != mPipelines.end() && itr->second != nullptr;
+}
+
+void VulkanPipelineStateCache::setDerivativesEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mDerivativesEnabled = enabled;
+}
+
+bool VulkanPipelineStateCache::areDerivativesEnabled() const
+{
+	return mDerivativesEnabled;
+}
+
+void VulkanPipelineStateCache::clear()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCreatedCondition.wait(lock, [this]() { return mPendingCount == 0; });
+	mFamilyBases.clear();
+	mPipelines.clear();
+}
+
+VulkanU32 VulkanPipelineStateCache::getPipelineCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<VulkanU32>(mPipelines.size()) - mPendingCount;
+}
+
+VulkanPipelineStateCacheStats VulkanPipelineStateCache::getStats() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+VulkanF32 VulkanPipelineStateCache::getHitRate() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return (mStats.requests > 0) ? static_cast<VulkanF32>(mStats.hits) / static_cast<VulkanF32>(mStats.requests) : 0.0f;
+}
+
+void VulkanPipelineStateCache::resetStats()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStats = VulkanPipelineStateCacheStats();
+}
+
+void VulkanPipelineStateCache::printStats() const
+{
+	VulkanPipelineStateCacheStats stats = getStats();
+	printf("Pipeline states : %u requests, %u hits (%.1f%%), %u pipelines created including %u derivatives\n", stats.requests, stats.hits, 100.0f * getHitRate(), stats.createdPipelines, stats.derivativePipelines);
+}
+
+VulkanPipelineStateCache::VulkanPipelineStateCache()
+	: mPipelines()
+	, mFamilyBases()
+	, mMutex()
+	, mCreatedCondition()
+	, mPendingCount(0)
+	, mStats()
+	, mDerivativesEnabled(true)
+{
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanGraphicsPipeline.hpp"
+#include "VulkanHash.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+// TODO : Compute pipelines
+// TODO : Evict the pipelines not used for a while
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanPipelineStateCacheStats
+{
+	VulkanU32 requests;
+	VulkanU32 hits;
+	VulkanU32 createdPipelines;
+	VulkanU32 derivativePipelines; // Created with VK_PIPELINE_CREATE_DERIVATIVE_BIT, included in createdPipelines
+};
+
+// Returns the same pipeline for the same state, so a state is never compiled twice
+// The key is the serialized state of the description (see VulkanGraphicsPipeline::computeStateKey), compared entirely and not only by hash
+// The first pipeline of a family (same layout, render pass, subpass and shaders) allows derivatives, the next ones derive from it
+// The specializations of a shader are in the same family, so they all derive from the first one
+class VulkanPipelineStateCache
+{
+	public:
+		static VulkanPipelineStateCachePtr createPipelineStateCache();
+
+		~VulkanPipelineStateCache();
+
+		// The description is a configured pipeline that is not created yet
+		// Returns the pipeline owned by the cache, or nullptr if the creation failed
+		// Can be called from several threads, the same state is created once and the others wait for it
+		// The layout and the render pass of the pipelines must outlive the cache
+		VulkanGraphicsPipeline* getPipeline(VulkanGraphicsPipelinePtr description);
+		bool contains(const VulkanGraphicsPipeline& description) const;
+
+		// Enabled by default, only applies to the pipelines created after the change
+		void setDerivativesEnabled(bool enabled);
+		bool areDerivativesEnabled() const;
+
+		// The previous submissions using the pipelines must be finished, the pipelines in creation are waited
+		void clear();
+		VulkanU32 getPipelineCount() const;
+
+		VulkanPipelineStateCacheStats getStats() const;
+		VulkanF32 getHitRate() const; // Between 0 and 1
+		void resetStats();
+		void printStats() const;
+
+	private:
+		VulkanPipelineStateCache();
+
+		std::unordered_map<VulkanStateKey, VulkanGraphicsPipelinePtr, VulkanStateKey::Hasher> mPipelines;
+		std::unordered_map<VulkanStateKey, VulkanGraphicsPipeline*, VulkanStateKey::Hasher> mFamilyBases;
+
+		// A pipeline is created unlocked behind a null placeholder, so two threads asking for the same state don't compile it twice
+		mutable std::mutex mMutex;
+		std::condition_variable mCreatedCondition;
+		VulkanU32 mPendingCount;
+		VulkanPipelineStateCacheStats mStats;
+		bool mDerivativesEnabled;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
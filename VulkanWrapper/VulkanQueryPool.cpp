@@ -0,0 +1,98 @@
+#include "VulkanQueryPool.hpp"
+
+#include "VulkanDevice.hpp"
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanQueryPool::~VulkanQueryPool()
+{
+	release();
+
+	VULKAN_OBJECTTRACKER_UNREGISTER();
+}
+
+bool VulkanQueryPool::getResults(VulkanU32 firstQuery, VulkanU32 queryCount, void* results, VkQueryResultFlags flags) const
+{
+	VULKAN_ASSERT(firstQuery + queryCount <= mQueryCount, "Queries out of the pool");
+
+	const VkDeviceSize stride = (flags & VK_QUERY_RESULT_64_BIT) ? sizeof(VulkanU64) : sizeof(VulkanU32);
+	VkResult result = vkGetQueryPoolResults(getDeviceHandle(), mQueryPool, firstQuery, queryCount, static_cast<size_t>(stride * queryCount), results, stride, flags);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+	{
+		VULKAN_LOG_ERROR("Could not get the results of a query pool");
+	}
+	return result == VK_SUCCESS;
+}
+
+VkQueryType VulkanQueryPool::getQueryType() const
+{
+	return mQueryType;
+}
+
+VulkanU32 VulkanQueryPool::getQueryCount() const
+{
+	return mQueryCount;
+}
+
+bool VulkanQueryPool::isInitialized() const
+{
+	return mQueryPool != VK_NULL_HANDLE;
+}
+
+const VkQueryPool& VulkanQueryPool::getHandle() const
+{
+	return mQueryPool;
+}
+
+VulkanQueryPoolPtr VulkanQueryPool::createQueryPool(VkQueryType queryType, VulkanU32 queryCount)
+{
+	VulkanQueryPoolPtr queryPool(new VulkanQueryPool(queryType, queryCount));
+	if (queryPool != nullptr)
+	{
+		if (!queryPool->init())
+		{
+			queryPool.reset();
+		}
+	}
+	return queryPool;
+}
+
+VulkanQueryPool::VulkanQueryPool(VkQueryType queryType, VulkanU32 queryCount)
+	: mQueryPool(VK_NULL_HANDLE)
+	, mQueryType(queryType)
+	, mQueryCount(queryCount)
+{
+	VULKAN_OBJECTTRACKER_REGISTER();
+}
+
+bool VulkanQueryPool::init()
+{
+	VkQueryPoolCreateInfo queryPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,     // VkStructureType                  sType
+		nullptr,                                      // const void                     * pNext
+		0,                                            // VkQueryPoolCreateFlags           flags
+		mQueryType,                                   // VkQueryType                      queryType
+		mQueryCount,                                  // uint32_t                         queryCount
+		0                                             // VkQueryPipelineStatisticFlags    pipelineStatistics
+	};
+
+	VkResult result = vkCreateQueryPool(getDeviceHandle(), &queryPoolCreateInfo, nullptr, &mQueryPool);
+	if (result != VK_SUCCESS || mQueryPool == VK_NULL_HANDLE)
+	{
+		VULKAN_LOG_ERROR("Could not create a query pool");
+		return false;
+	}
+
+	return true;
+}
+
+void VulkanQueryPool::release()
+{
+	if (mQueryPool != VK_NULL_HANDLE)
+	{
+		vkDestroyQueryPool(getDeviceHandle(), mQueryPool, nullptr);
+		mQueryPool = VK_NULL_HANDLE;
+	}
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+// TODO : Pipeline statistics queries
+
+VULKAN_NAMESPACE_BEGIN
+
+class VulkanQueryPool : public VulkanDeviceObject<VulkanObjectType_QueryPool>
+{
+	public:
+		~VulkanQueryPool();
+
+		// Returns false when the results are not available yet without VK_QUERY_RESULT_WAIT_BIT, or on error
+		// results holds queryCount values of 32 bits, or of 64 bits with VK_QUERY_RESULT_64_BIT
+		bool getResults(VulkanU32 firstQuery, VulkanU32 queryCount, void* results, VkQueryResultFlags flags) const;
+
+		VkQueryType getQueryType() const;
+		VulkanU32 getQueryCount() const;
+
+		bool isInitialized() const;
+		const VkQueryPool& getHandle() const;
+
+	private:
+		friend class VulkanDevice;
+		static VulkanQueryPoolPtr createQueryPool(VkQueryType queryType, VulkanU32 queryCount);
+
+		VulkanQueryPool(VkQueryType queryType, VulkanU32 queryCount);
+
+		bool init();
+		void release();
+
+	private:
+		VkQueryPool mQueryPool;
+
+		VkQueryType mQueryType;
+		VulkanU32 mQueryCount;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -1,9 +1,7 @@
 #include "VulkanQueue.hpp"
 
 #include "VulkanDevice.hpp"
-#include "VulkanBuffer.hpp"
-#include "VulkanImage.hpp"
-#include "VulkanMemoryBlock.hpp"
+#include "VulkanCommandBuffer.hpp"
 #include "VulkanFence.hpp"
 
 VULKAN_NAMESPACE_BEGIN
@@ -13,167 +11,20 @@ VulkanQueue::~VulkanQueue()
 	VULKAN_OBJECTTRACKER_UNREGISTER();
 }
 
-bool VulkanQueue::useStagingBufferToUpdateBufferAndWait(VkDeviceSize dataSize, void* data, VulkanBuffer* buffer, VkDeviceSize offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout)
+bool VulkanQueue::submitCommandBuffers(VulkanArrayView<VulkanCommandBuffer*> commandBuffers, VulkanArrayView<WaitSemaphoreInfo> waitSemaphoreInfos, VulkanArrayView<VkSemaphore> signalSemaphores, VulkanFence* fence)
 {
-	VulkanFencePtr fence = getDevice().createFence(false);
-	if (fence == nullptr)
-	{
-		return false;
-	}
-
-	VulkanBufferPtr stagingBuffer = getDevice().createBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-	if (stagingBuffer == nullptr)
-	{
-		return false;
-	}
-	VulkanMemoryBlock* stagingBufferMemory = stagingBuffer->allocateMemoryBlock(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-	if (stagingBufferMemory == nullptr)
-	{
-		return false;
-	}
-
-	if (!stagingBufferMemory->map(0, dataSize))
-	{
-		return false;
-	}
-	if (!stagingBufferMemory->write(data))
-	{
-		return false;
-	}
-	if (!stagingBufferMemory->unmap())
-	{
-		return false;
-	}
-
-	if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
-	{
-		return false;
-	}
-
-	commandBuffer->setBufferMemoryBarrier(generatingStages, VK_PIPELINE_STAGE_TRANSFER_BIT, { { buffer, currentAccess, VK_ACCESS_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED } });
-	commandBuffer->copyDataBetweenBuffers(stagingBuffer.get(), buffer, { { 0, offset, dataSize } });
-	commandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, consumingStages, { { buffer, VK_ACCESS_TRANSFER_WRITE_BIT, newAccess, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED } });
-
-	if (!commandBuffer->endRecording())
-	{
-		return false;
-	}
-
-	if (!submitCommandBuffers({ commandBuffer }, {}, signalSemaphores, fence.get()))
-	{
-		return false;
-	}
-
-	return fence->wait(timeout);
-}
-
-bool VulkanQueue::useStagingBufferToUpdateImageAndWait(VkDeviceSize dataSize, void* data, VulkanImage* image, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D size, VkImageLayout currentLayout, VkImageLayout newLayout, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkImageAspectFlags aspect, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout)
-{
-	VulkanFencePtr fence = getDevice().createFence(false);
-	if (fence == nullptr)
-	{
-		return false;
-	}
-
-	VulkanBufferPtr stagingBuffer = getDevice().createBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-	if (stagingBuffer == nullptr)
-	{
-		return false;
-	}
-	VulkanMemoryBlock* stagingBufferMemory = stagingBuffer->allocateMemoryBlock(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-	if (stagingBufferMemory == nullptr)
-	{
-		return false;
-	}
-
-	if (!stagingBufferMemory->map(0, dataSize))
-	{
-		return false;
-	}
-	if (!stagingBufferMemory->write(data))
-	{
-		return false;
-	}
-	if (!stagingBufferMemory->unmap())
-	{
-		return false;
-	}
-
-	if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
-	{
-		return false;
-	}
-
-	commandBuffer->setImageMemoryBarrier(generatingStages, VK_PIPELINE_STAGE_TRANSFER_BIT,
-		{
-			{
-				image->getHandle(),                       // VkImage            image
-				currentAccess,                            // VkAccessFlags      currentAccess
-				VK_ACCESS_TRANSFER_WRITE_BIT,             // VkAccessFlags      newAccess
-				currentLayout,                            // VkImageLayout      currentLayout
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // VkImageLayout      newLayout
-				VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           currentQueueFamily
-				VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           newQueueFamily
-				aspect                                    // VkImageAspectFlags aspect
-			}
-		}
-	);
-
-	commandBuffer->copyDataFromBufferToImage(stagingBuffer.get(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		{
-			{
-				0,                                        // VkDeviceSize               bufferOffset
-				0,                                        // uint32_t                   bufferRowLength
-				0,                                        // uint32_t                   bufferImageHeight
-				subresource,                              // VkImageSubresourceLayers   imageSubresource
-				offset,                                   // VkOffset3D                 imageOffset
-				size,                                     // VkExtent3D                 imageExtent
-			}
-		}
-	);
-
-	commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, consumingStages,
-		{
-			{
-				image->getHandle(),                       // VkImage            image
-				VK_ACCESS_TRANSFER_WRITE_BIT,             // VkAccessFlags      currentAccess
-				newAccess,                                // VkAccessFlags      newAccess
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // VkImageLayout      currentLayout
-				newLayout,                                // VkImageLayout      newLayout
-				VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           currentQueueFamily
-				VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           newQueueFamily
-				aspect                                    // VkImageAspectFlags aspect
-			}
-		}
-	);
-
-	if (!commandBuffer->endRecording())
-	{
-		return false;
-	}
-
-	if (!submitCommandBuffers({ commandBuffer }, {}, signalSemaphores, fence.get()))
-	{
-		return false;
-	}
-
-	return fence->wait(timeout);
-}
-
-bool VulkanQueue::submitCommandBuffers(std::vector<VulkanCommandBuffer*> commandBuffers, std::vector<WaitSemaphoreInfo> waitSemaphoreInfos, std::vector<VkSemaphore> signalSemaphores, VulkanFence* fence)
-{
-	std::vector<VkSemaphore> waitSemaphoreHandles;
-	std::vector<VkPipelineStageFlags> waitSemaphoreStages;
+	VulkanSmallVector<VkSemaphore, 8> waitSemaphoreHandles;
+	VulkanSmallVector<VkPipelineStageFlags, 8> waitSemaphoreStages;
 	for (auto& waitSemaphoreInfo : waitSemaphoreInfos) 
 	{
-		waitSemaphoreHandles.emplace_back(waitSemaphoreInfo.Semaphore);
-		waitSemaphoreStages.emplace_back(waitSemaphoreInfo.WaitingStage);
+		waitSemaphoreHandles.push_back(waitSemaphoreInfo.Semaphore);
+		waitSemaphoreStages.push_back(waitSemaphoreInfo.WaitingStage);
 	}
 
-	std::vector<VkCommandBuffer> commandBufferHandles;
+	VulkanSmallVector<VkCommandBuffer, 16> commandBufferHandles;
 	for (auto& commandBuffer : commandBuffers)
 	{
-		commandBufferHandles.emplace_back(commandBuffer->getHandle());
+		commandBufferHandles.push_back(commandBuffer->getHandle());
 	}
 
 	VkSubmitInfo submitInfo = {
@@ -188,7 +39,7 @@ bool VulkanQueue::submitCommandBuffers(std::vector<VulkanCommandBuffer*> command
 		signalSemaphores.data()                               // const VkSemaphore            * pSignalSemaphores
 	};
 
-	VkResult result = vkQueueSubmit(mQueue, 1, &submitInfo, fence->getHandle());
+	VkResult result = vkQueueSubmit(mQueue, 1, &submitInfo, (fence != nullptr) ? fence->getHandle() : VK_NULL_HANDLE);
 	if (result != VK_SUCCESS)
 	{
 		printf("Error occurred during command buffer submission\n");
@@ -197,7 +48,7 @@ bool VulkanQueue::submitCommandBuffers(std::vector<VulkanCommandBuffer*> command
 	return true;
 }
 
-bool VulkanQueue::submitCommandBuffersAndWait(std::vector<VulkanCommandBuffer*> commandBuffers, std::vector<WaitSemaphoreInfo> waitSemaphoreInfos, std::vector<VkSemaphore> signalSemaphores, VulkanFence* fence, uint64_t timeout)
+bool VulkanQueue::submitCommandBuffersAndWait(VulkanArrayView<VulkanCommandBuffer*> commandBuffers, VulkanArrayView<WaitSemaphoreInfo> waitSemaphoreInfos, VulkanArrayView<VkSemaphore> signalSemaphores, VulkanFence* fence, uint64_t timeout)
 {
 	if (!submitCommandBuffers(commandBuffers, waitSemaphoreInfos, signalSemaphores, fence))
 	{
@@ -207,16 +58,16 @@ bool VulkanQueue::submitCommandBuffersAndWait(std::vector<VulkanCommandBuffer*>
 	return fence->wait(timeout);
 }
 
-bool VulkanQueue::presentImage(std::vector<VkSemaphore> renderingSemaphores, std::vector<PresentInfo> imagesToPresent)
+bool VulkanQueue::presentImage(VulkanArrayView<VkSemaphore> renderingSemaphores, VulkanArrayView<PresentInfo> imagesToPresent)
 {
 	VkResult result;
 
-	std::vector<VkSwapchainKHR> swapchains;
-	std::vector<uint32_t> imageIndices;
+	VulkanSmallVector<VkSwapchainKHR, 4> swapchains;
+	VulkanSmallVector<uint32_t, 4> imageIndices;
 	for (auto& imageToPresent : imagesToPresent) 
 	{
-		swapchains.emplace_back(imageToPresent.Swapchain);
-		imageIndices.emplace_back(imageToPresent.ImageIndex);
+		swapchains.push_back(imageToPresent.Swapchain);
+		imageIndices.push_back(imageToPresent.ImageIndex);
 	}
 
 	VkPresentInfoKHR presentInfo = {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanContainers.hpp"
 
 #include "../CookBook/Common.hpp" // TODO : WaitSemaphore & PresentInfo
 
@@ -13,13 +14,11 @@ class VulkanQueue : public VulkanDeviceObject<VulkanObjectType_Queue>
 	public:
 		~VulkanQueue();
 
-		bool useStagingBufferToUpdateBufferAndWait(VkDeviceSize dataSize, void* data, VulkanBuffer* buffer, VkDeviceSize offset, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout);
-		bool useStagingBufferToUpdateImageAndWait(VkDeviceSize dataSize, void* data, VulkanImage* image, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D size, VkImageLayout currentLayout, VkImageLayout newLayout, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkImageAspectFlags aspect, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages, VulkanCommandBuffer* commandBuffer, std::vector<VkSemaphore> signalSemaphores, uint64_t timeout);
-
-		bool submitCommandBuffers(std::vector<VulkanCommandBuffer*> commandBuffers, std::vector<WaitSemaphoreInfo> waitSemaphoreInfos, std::vector<VkSemaphore> signalSemaphores, VulkanFence* fence);
-		bool submitCommandBuffersAndWait(std::vector<VulkanCommandBuffer*> commandBuffers, std::vector<WaitSemaphoreInfo> waitSemaphoreInfos, std::vector<VkSemaphore> signalSemaphores, VulkanFence* fence, uint64_t timeout);
+		// fence can be nullptr
+		bool submitCommandBuffers(VulkanArrayView<VulkanCommandBuffer*> commandBuffers, VulkanArrayView<WaitSemaphoreInfo> waitSemaphoreInfos, VulkanArrayView<VkSemaphore> signalSemaphores, VulkanFence* fence);
+		bool submitCommandBuffersAndWait(VulkanArrayView<VulkanCommandBuffer*> commandBuffers, VulkanArrayView<WaitSemaphoreInfo> waitSemaphoreInfos, VulkanArrayView<VkSemaphore> signalSemaphores, VulkanFence* fence, uint64_t timeout);
 		
-		bool presentImage(std::vector<VkSemaphore> renderingSemaphores, std::vector<PresentInfo> imagesToPresent);
+		bool presentImage(VulkanArrayView<VkSemaphore> renderingSemaphores, VulkanArrayView<PresentInfo> imagesToPresent);
 
 		VulkanU32 getFamilyIndex() const;
 		VulkanU32 getIndex() const;
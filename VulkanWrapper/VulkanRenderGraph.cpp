@@ -0,0 +1,1005 @@
+#include "VulkanRenderGraph.hpp"
+
+#include "VulkanBuffer.hpp"
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFramebuffer.hpp"
+#include "VulkanImage.hpp"
+#include "VulkanImageView.hpp"
+#include "VulkanMemoryBlock.hpp"
+#include "VulkanRenderPass.hpp"
+
+#include <algorithm>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanRenderGraphPtr VulkanRenderGraph::createRenderGraph()
+{
+	return VulkanRenderGraphPtr(new VulkanRenderGraph());
+}
+
+VulkanRenderGraph::~VulkanRenderGraph()
+{
+	invalidate();
+}
+
+VulkanU32 VulkanRenderGraph::createImage(const std::string& name, VkFormat format, VkExtent2D size, VkImageAspectFlags aspect, VkSampleCountFlagBits samples)
+{
+	Resource resource = {};
+	resource.name = name;
+	resource.image = true;
+	resource.imported = false;
+	resource.format = format;
+	resource.size = size;
+	resource.aspect = aspect;
+	resource.samples = samples;
+	resource.initialState = { 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+	resource.finalState = resource.initialState;
+	mResources.push_back(std::move(resource));
+	invalidate();
+	return static_cast<VulkanU32>(mResources.size() - 1);
+}
+
+void VulkanRenderGraph::setImageSize(VulkanU32 resource, VkExtent2D size)
+{
+	VULKAN_ASSERT(resource < mResources.size() && mResources[resource].image);
+	mResources[resource].size = size;
+}
+
+VulkanU32 VulkanRenderGraph::importImage(const std::string& name, VkFormat format, VkExtent2D size, VkImageAspectFlags aspect, VkAccessFlags initialAccess, VkPipelineStageFlags initialStages, VkImageLayout initialLayout, VkAccessFlags finalAccess, VkPipelineStageFlags finalStages, VkImageLayout finalLayout)
+{
+	Resource resource = {};
+	resource.name = name;
+	resource.image = true;
+	resource.imported = true;
+	resource.format = format;
+	resource.size = size;
+	resource.aspect = aspect;
+	resource.samples = VK_SAMPLE_COUNT_1_BIT;
+	resource.initialState = { initialAccess, initialStages, initialLayout };
+	resource.finalState = { finalAccess, finalStages, finalLayout };
+	mResources.push_back(std::move(resource));
+	invalidate();
+	return static_cast<VulkanU32>(mResources.size() - 1);
+}
+
+VulkanU32 VulkanRenderGraph::importBuffer(const std::string& name, VkAccessFlags initialAccess, VkPipelineStageFlags initialStages, VkAccessFlags finalAccess, VkPipelineStageFlags finalStages)
+{
+	Resource resource = {};
+	resource.name = name;
+	resource.image = false;
+	resource.imported = true;
+	resource.format = VK_FORMAT_UNDEFINED;
+	resource.initialState = { initialAccess, initialStages, VK_IMAGE_LAYOUT_UNDEFINED };
+	resource.finalState = { finalAccess, finalStages, VK_IMAGE_LAYOUT_UNDEFINED };
+	mResources.push_back(std::move(resource));
+	invalidate();
+	return static_cast<VulkanU32>(mResources.size() - 1);
+}
+
+void VulkanRenderGraph::setImportedImage(VulkanU32 resource, VulkanImage* image, VkImageView imageView)
+{
+	VULKAN_ASSERT(resource < mResources.size() && mResources[resource].image && mResources[resource].imported);
+	mResources[resource].importedImage = image;
+	mResources[resource].importedImageView = imageView;
+}
+
+void VulkanRenderGraph::setImportedBuffer(VulkanU32 resource, VulkanBuffer* buffer)
+{
+	VULKAN_ASSERT(resource < mResources.size() && !mResources[resource].image);
+	mResources[resource].importedBuffer = buffer;
+}
+
+VulkanU32 VulkanRenderGraph::addGraphicsPass(const std::string& name, const ExecuteFunction& executeFunction)
+{
+	Pass pass = {};
+	pass.name = name;
+	pass.type = VulkanRenderGraphPassType::Graphics;
+	pass.executeFunction = executeFunction;
+	mPasses.push_back(std::move(pass));
+	invalidate();
+	return static_cast<VulkanU32>(mPasses.size() - 1);
+}
+
+VulkanU32 VulkanRenderGraph::addComputePass(const std::string& name, const ExecuteFunction& executeFunction)
+{
+	Pass pass = {};
+	pass.name = name;
+	pass.type = VulkanRenderGraphPassType::Compute;
+	pass.executeFunction = executeFunction;
+	mPasses.push_back(std::move(pass));
+	invalidate();
+	return static_cast<VulkanU32>(mPasses.size() - 1);
+}
+
+void VulkanRenderGraph::setPassSideEffects(VulkanU32 pass, bool sideEffects)
+{
+	VULKAN_ASSERT(pass < mPasses.size());
+	invalidate();
+	mPasses[pass].sideEffects = sideEffects;
+}
+
+void VulkanRenderGraph::addColorAttachment(VulkanU32 pass, VulkanU32 resource, bool clear, VkClearColorValue clearColor)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::ColorAttachment;
+	usage.access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (clear ? 0 : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
+	usage.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	usage.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	usage.read = !clear;
+	usage.write = true;
+	usage.clear = clear;
+	usage.clearValue.color = clearColor;
+	addUsage(pass, usage);
+}
+
+void VulkanRenderGraph::addDepthStencilAttachment(VulkanU32 pass, VulkanU32 resource, bool clear, VkClearDepthStencilValue clearDepthStencil)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::DepthStencilAttachment;
+	usage.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	usage.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	usage.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	usage.read = !clear;
+	usage.write = true;
+	usage.clear = clear;
+	usage.clearValue.depthStencil = clearDepthStencil;
+	addUsage(pass, usage);
+}
+
+void VulkanRenderGraph::addSampledImage(VulkanU32 pass, VulkanU32 resource, VkPipelineStageFlags stages)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::SampledImage;
+	usage.access = VK_ACCESS_SHADER_READ_BIT;
+	usage.stages = stages;
+	usage.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	usage.read = true;
+	usage.write = false;
+	addUsage(pass, usage);
+}
+
+void VulkanRenderGraph::addStorageImage(VulkanU32 pass, VulkanU32 resource, VkPipelineStageFlags stages, bool write)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::StorageImage;
+	usage.access = VK_ACCESS_SHADER_READ_BIT | (write ? VK_ACCESS_SHADER_WRITE_BIT : 0);
+	usage.stages = stages;
+	usage.layout = VK_IMAGE_LAYOUT_GENERAL;
+	usage.read = true; // Storage writes can be partial
+	usage.write = write;
+	addUsage(pass, usage);
+}
+
+void VulkanRenderGraph::addBufferRead(VulkanU32 pass, VulkanU32 resource, VkAccessFlags access, VkPipelineStageFlags stages)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::Buffer;
+	usage.access = access;
+	usage.stages = stages;
+	usage.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	usage.read = true;
+	usage.write = false;
+	addUsage(pass, usage);
+}
+
+void VulkanRenderGraph::addBufferWrite(VulkanU32 pass, VulkanU32 resource, VkAccessFlags access, VkPipelineStageFlags stages)
+{
+	Usage usage = {};
+	usage.resource = resource;
+	usage.type = UsageType::Buffer;
+	usage.access = access;
+	usage.stages = stages;
+	usage.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	usage.read = false;
+	usage.write = true;
+	addUsage(pass, usage);
+}
+
+bool VulkanRenderGraph::compile()
+{
+	invalidate();
+
+	const VulkanU32 passCount = static_cast<VulkanU32>(mPasses.size());
+	const VulkanU32 resourceCount = static_cast<VulkanU32>(mResources.size());
+
+	// A resource must be written before being read, except the imported ones
+	std::vector<VulkanU8> written(resourceCount, 0);
+	for (const Pass& pass : mPasses)
+	{
+		if (pass.type == VulkanRenderGraphPassType::Graphics && pass.usages.end() == std::find_if(pass.usages.begin(), pass.usages.end(), [](const Usage& usage) { return usage.type == UsageType::ColorAttachment || usage.type == UsageType::DepthStencilAttachment; }))
+		{
+			VULKAN_LOG_ERROR("Graphics pass %s has no attachment", pass.name.c_str());
+			return false;
+		}
+		for (const Usage& usage : pass.usages)
+		{
+			if (usage.read && !mResources[usage.resource].imported && written[usage.resource] == 0)
+			{
+				VULKAN_LOG_ERROR("Pass %s reads %s before it is written", pass.name.c_str(), mResources[usage.resource].name.c_str());
+				return false;
+			}
+		}
+		for (const Usage& usage : pass.usages)
+		{
+			written[usage.resource] |= usage.write ? 1 : 0;
+		}
+	}
+
+	// Culling : walk the passes backward, a pass is needed if it writes a resource read later
+	// A cleared attachment doesn't need the previous writes, the imported resources are needed after the last pass
+	std::vector<VulkanU8> needed(resourceCount, 0);
+	for (VulkanU32 i = 0; i < resourceCount; i++)
+	{
+		needed[i] = mResources[i].imported ? 1 : 0;
+	}
+	for (VulkanU32 i = passCount; i-- > 0; )
+	{
+		Pass& pass = mPasses[i];
+		pass.culled = !pass.sideEffects;
+		for (const Usage& usage : pass.usages)
+		{
+			if (usage.write && needed[usage.resource] != 0)
+			{
+				pass.culled = false;
+			}
+		}
+		if (pass.culled)
+		{
+			mStats.culledPassCount++;
+			continue;
+		}
+		for (const Usage& usage : pass.usages)
+		{
+			if (usage.clear)
+			{
+				needed[usage.resource] = 0;
+			}
+		}
+		for (const Usage& usage : pass.usages)
+		{
+			if (usage.read)
+			{
+				needed[usage.resource] = 1;
+			}
+		}
+	}
+
+	// Order : the declaration order is already a valid order once the reads are checked
+	for (VulkanU32 i = 0; i < passCount; i++)
+	{
+		if (!mPasses[i].culled)
+		{
+			mExecutionOrder.push_back(i);
+		}
+	}
+	const VulkanU32 executedCount = static_cast<VulkanU32>(mExecutionOrder.size());
+
+	// Lifetimes and usage flags of the resources
+	for (VulkanU32 i = 0; i < executedCount; i++)
+	{
+		for (const Usage& usage : mPasses[mExecutionOrder[i]].usages)
+		{
+			Resource& resource = mResources[usage.resource];
+			if (resource.firstUse == InvalidIndex)
+			{
+				resource.firstUse = i;
+			}
+			resource.lastUse = i;
+			switch (usage.type)
+			{
+				case UsageType::ColorAttachment: resource.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+				case UsageType::DepthStencilAttachment: resource.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+				case UsageType::SampledImage: resource.usage |= VK_IMAGE_USAGE_SAMPLED_BIT; break;
+				case UsageType::StorageImage: resource.usage |= VK_IMAGE_USAGE_STORAGE_BIT; break;
+				default: break;
+			}
+		}
+	}
+
+	// Aliasing : in the order of their first use, the transient images take the first memory slot free since their first use
+	// A slot whose last image has the same description is preferred, so the slots don't grow needlessly
+	std::vector<VulkanU32> slotLastUses;
+	for (VulkanU32 i = 0; i < executedCount; i++)
+	{
+		for (const Usage& usage : mPasses[mExecutionOrder[i]].usages)
+		{
+			Resource& resource = mResources[usage.resource];
+			if (resource.imported || resource.firstUse != i || resource.memorySlot != InvalidIndex)
+			{
+				continue;
+			}
+
+			VulkanU32 slot = InvalidIndex;
+			for (VulkanU32 j = 0; j < mMemorySlots.size(); j++)
+			{
+				if (slotLastUses[j] >= i)
+				{
+					continue;
+				}
+				const Resource& previous = mResources[mMemorySlots[j].resources.back()];
+				if (previous.format == resource.format && previous.samples == resource.samples && previous.size.width == resource.size.width && previous.size.height == resource.size.height)
+				{
+					slot = j;
+					break;
+				}
+				if (slot == InvalidIndex)
+				{
+					slot = j;
+				}
+			}
+			if (slot == InvalidIndex)
+			{
+				slot = static_cast<VulkanU32>(mMemorySlots.size());
+				mMemorySlots.emplace_back();
+				slotLastUses.push_back(0);
+			}
+
+			mMemorySlots[slot].resources.push_back(usage.resource);
+			slotLastUses[slot] = resource.lastUse;
+			resource.memorySlot = slot;
+			mStats.transientImageCount++;
+		}
+	}
+	for (const MemorySlot& slot : mMemorySlots)
+	{
+		// The first image of a slot follows the last one of the previous frame
+		const VulkanU32 count = static_cast<VulkanU32>(slot.resources.size());
+		for (VulkanU32 i = 0; i < count; i++)
+		{
+			mResources[slot.resources[i]].aliasPredecessor = slot.resources[(i + count - 1) % count];
+		}
+	}
+
+	// Load and store operations of the attachments
+	std::vector<VulkanU8> hasContent(resourceCount, 0);
+	for (VulkanU32 i = 0; i < resourceCount; i++)
+	{
+		hasContent[i] = (mResources[i].imported && mResources[i].initialState.layout != VK_IMAGE_LAYOUT_UNDEFINED) ? 1 : 0;
+	}
+	for (VulkanU32 i = 0; i < executedCount; i++)
+	{
+		Pass& pass = mPasses[mExecutionOrder[i]];
+		for (const Usage& usage : pass.usages)
+		{
+			if (usage.type != UsageType::ColorAttachment && usage.type != UsageType::DepthStencilAttachment)
+			{
+				continue;
+			}
+
+			VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			if (usage.clear)
+			{
+				loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			}
+			else if (hasContent[usage.resource] != 0)
+			{
+				loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			}
+
+			// Stored only if the next pass using the resource reads it
+			bool store = mResources[usage.resource].imported;
+			for (VulkanU32 j = i + 1; j < executedCount && !store; j++)
+			{
+				const std::vector<Usage>& nextUsages = mPasses[mExecutionOrder[j]].usages;
+				auto nextUsage = std::find_if(nextUsages.begin(), nextUsages.end(), [&usage](const Usage& next) { return next.resource == usage.resource; });
+				if (nextUsage != nextUsages.end())
+				{
+					store = nextUsage->read;
+					break;
+				}
+			}
+
+			const VkAttachmentStoreOp storeOp = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			pass.attachments.push_back({
+				usage.resource,             // VulkanU32               resource
+				loadOp,                     // VkAttachmentLoadOp      loadOp
+				storeOp,                    // VkAttachmentStoreOp     storeOp
+				usage.layout                // VkImageLayout           layout
+			});
+			pass.clearValues.push_back(usage.clearValue);
+		}
+		for (const Usage& usage : pass.usages)
+		{
+			hasContent[usage.resource] |= usage.write ? 1 : 0;
+		}
+	}
+
+	// Barriers : the first simulation gives the state left by a frame, which is the state seen by the next one
+	std::vector<ResourceState> states(resourceCount);
+	for (VulkanU32 i = 0; i < resourceCount; i++)
+	{
+		states[i] = mResources[i].initialState;
+	}
+	if (!simulateBarriers(states, false) || !simulateBarriers(states, true))
+	{
+		return false;
+	}
+
+	mStats.passCount = passCount;
+	mStats.memorySlotCount = static_cast<VulkanU32>(mMemorySlots.size());
+	for (VulkanU32 passIndex : mExecutionOrder)
+	{
+		mStats.barrierCount += static_cast<VulkanU32>(mPasses[passIndex].barriers.size());
+		mStats.barrierBatchCount += mPasses[passIndex].barriers.empty() ? 0 : 1;
+	}
+	mStats.barrierCount += static_cast<VulkanU32>(mFinalBarriers.size());
+	mStats.barrierBatchCount += mFinalBarriers.empty() ? 0 : 1;
+
+	mCompiled = true;
+	return true;
+}
+
+bool VulkanRenderGraph::isCompiled() const
+{
+	return mCompiled;
+}
+
+bool VulkanRenderGraph::isPassCulled(VulkanU32 pass) const
+{
+	VULKAN_ASSERT(mCompiled && pass < mPasses.size());
+	return mPasses[pass].culled;
+}
+
+const std::vector<VulkanU32>& VulkanRenderGraph::getExecutionOrder() const
+{
+	return mExecutionOrder;
+}
+
+const std::vector<VulkanRenderGraphBarrier>& VulkanRenderGraph::getPassBarriers(VulkanU32 pass) const
+{
+	VULKAN_ASSERT(pass < mPasses.size());
+	return mPasses[pass].barriers;
+}
+
+const std::vector<VulkanRenderGraphBarrier>& VulkanRenderGraph::getFinalBarriers() const
+{
+	return mFinalBarriers;
+}
+
+const std::vector<VulkanRenderGraphAttachment>& VulkanRenderGraph::getPassAttachments(VulkanU32 pass) const
+{
+	VULKAN_ASSERT(pass < mPasses.size());
+	return mPasses[pass].attachments;
+}
+
+VulkanU32 VulkanRenderGraph::getMemorySlot(VulkanU32 resource) const
+{
+	VULKAN_ASSERT(resource < mResources.size());
+	return mResources[resource].memorySlot;
+}
+
+VkImageUsageFlags VulkanRenderGraph::getImageUsage(VulkanU32 resource) const
+{
+	VULKAN_ASSERT(resource < mResources.size());
+	return mResources[resource].usage;
+}
+
+const VulkanRenderGraphStats& VulkanRenderGraph::getStats() const
+{
+	return mStats;
+}
+
+void VulkanRenderGraph::printCompiledGraph() const
+{
+	VULKAN_LOG_INFO("RenderGraph: %d passes (%d culled), %d barriers in %d batches, %d transient images in %d memory slots", mStats.passCount, mStats.culledPassCount, mStats.barrierCount, mStats.barrierBatchCount, mStats.transientImageCount, mStats.memorySlotCount);
+	for (const Pass& pass : mPasses)
+	{
+		if (pass.culled)
+		{
+			VULKAN_LOG_INFO("RenderGraph: %s is culled", pass.name.c_str());
+		}
+	}
+
+	auto printBarriers = [this](const std::vector<VulkanRenderGraphBarrier>& barriers)
+	{
+		for (const VulkanRenderGraphBarrier& barrier : barriers)
+		{
+			VULKAN_LOG_INFO("RenderGraph:     %s : access 0x%x -> 0x%x, stages 0x%x -> 0x%x, layout %d -> %d", mResources[barrier.resource].name.c_str(), barrier.srcAccess, barrier.dstAccess, barrier.srcStages, barrier.dstStages, barrier.oldLayout, barrier.newLayout);
+		}
+	};
+	for (VulkanU32 passIndex : mExecutionOrder)
+	{
+		const Pass& pass = mPasses[passIndex];
+		VULKAN_LOG_INFO("RenderGraph: %s, %d barriers before", pass.name.c_str(), static_cast<VulkanU32>(pass.barriers.size()));
+		printBarriers(pass.barriers);
+		for (const VulkanRenderGraphAttachment& attachment : pass.attachments)
+		{
+			VULKAN_LOG_INFO("RenderGraph:     %s : load op %d, store op %d", mResources[attachment.resource].name.c_str(), attachment.loadOp, attachment.storeOp);
+		}
+	}
+	VULKAN_LOG_INFO("RenderGraph: %d final barriers", static_cast<VulkanU32>(mFinalBarriers.size()));
+	printBarriers(mFinalBarriers);
+
+	for (VulkanU32 i = 0; i < mMemorySlots.size(); i++)
+	{
+		for (VulkanU32 resourceIndex : mMemorySlots[i].resources)
+		{
+			const Resource& resource = mResources[resourceIndex];
+			VULKAN_LOG_INFO("RenderGraph: %s in memory slot %d, used from pass %d to %d", resource.name.c_str(), i, resource.firstUse, resource.lastUse);
+		}
+	}
+}
+
+bool VulkanRenderGraph::realize(VulkanDevice& device)
+{
+	if (!mCompiled)
+	{
+		VULKAN_LOG_ERROR("The render graph must be compiled before being realized");
+		return false;
+	}
+
+	releaseTransients();
+	mDevice = &device;
+
+	for (VulkanU32 passIndex : mExecutionOrder)
+	{
+		const Pass& pass = mPasses[passIndex];
+		for (const VulkanRenderGraphAttachment& attachment : pass.attachments)
+		{
+			const VkExtent2D& size = mResources[attachment.resource].size;
+			const VkExtent2D& firstSize = mResources[pass.attachments[0].resource].size;
+			if (size.width != firstSize.width || size.height != firstSize.height)
+			{
+				VULKAN_LOG_ERROR("The attachments of pass %s don't have the same size", pass.name.c_str());
+				return false;
+			}
+		}
+	}
+
+	// Transient images, one allocation per memory slot shared by all its images
+	for (MemorySlot& slot : mMemorySlots)
+	{
+		VkMemoryRequirements memoryRequirements = { 0, 1, ~0u };
+		for (VulkanU32 resourceIndex : slot.resources)
+		{
+			Resource& resource = mResources[resourceIndex];
+			resource.transientImage = device.createImage(VK_IMAGE_TYPE_2D, resource.format, { resource.size.width, resource.size.height, 1 }, 1, 1, resource.samples, resource.usage, false);
+			if (resource.transientImage == nullptr)
+			{
+				return false;
+			}
+
+			const VkMemoryRequirements& imageRequirements = resource.transientImage->getMemoryRequirements();
+			memoryRequirements.size = std::max(memoryRequirements.size, imageRequirements.size);
+			memoryRequirements.alignment = std::max(memoryRequirements.alignment, imageRequirements.alignment);
+			memoryRequirements.memoryTypeBits &= imageRequirements.memoryTypeBits;
+		}
+
+		// TODO : Split the slot instead
+		if (memoryRequirements.memoryTypeBits == 0)
+		{
+			VULKAN_LOG_ERROR("The images of a memory slot don't have a common memory type");
+			return false;
+		}
+
+		if (!device.getMemoryAllocator().allocate(memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, slot.allocation))
+		{
+			return false;
+		}
+
+		for (VulkanU32 resourceIndex : slot.resources)
+		{
+			Resource& resource = mResources[resourceIndex];
+			if (!slot.allocation.memoryBlock->bind(resource.transientImage.get(), slot.allocation.offset))
+			{
+				return false;
+			}
+			if (resource.transientImage->createImageView(VK_IMAGE_VIEW_TYPE_2D, resource.format, resource.aspect) == nullptr)
+			{
+				return false;
+			}
+		}
+	}
+
+	// The attachments keep their layout during the render pass, the transitions are done by the barriers of the graph
+	for (VulkanU32 passIndex : mExecutionOrder)
+	{
+		Pass& pass = mPasses[passIndex];
+		if (pass.type != VulkanRenderGraphPassType::Graphics || pass.renderPass != nullptr)
+		{
+			continue;
+		}
+
+		pass.renderPass = device.initRenderPass();
+		if (pass.renderPass == nullptr)
+		{
+			return false;
+		}
+		for (const VulkanRenderGraphAttachment& attachment : pass.attachments)
+		{
+			const Resource& resource = mResources[attachment.resource];
+			const bool stencil = (resource.aspect & VK_IMAGE_ASPECT_STENCIL_BIT) != 0;
+			pass.renderPass->addAttachment(0, resource.format, resource.samples, attachment.loadOp, attachment.storeOp,
+				stencil ? attachment.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE, stencil ? attachment.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE, attachment.layout, attachment.layout);
+		}
+		pass.renderPass->addSubpass(VK_PIPELINE_BIND_POINT_GRAPHICS);
+		for (VulkanU32 i = 0; i < pass.attachments.size(); i++)
+		{
+			if (pass.attachments[i].layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+			{
+				pass.renderPass->addColorAttachmentToSubpass(i, pass.attachments[i].layout);
+			}
+		}
+		for (VulkanU32 i = 0; i < pass.attachments.size(); i++)
+		{
+			if (pass.attachments[i].layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+			{
+				pass.renderPass->addDepthStencilAttachmentToSubpass(i, pass.attachments[i].layout);
+			}
+		}
+		if (!pass.renderPass->create())
+		{
+			return false;
+		}
+	}
+
+	mRealized = true;
+	return true;
+}
+
+bool VulkanRenderGraph::isRealized() const
+{
+	return mRealized;
+}
+
+VulkanRenderPass* VulkanRenderGraph::getRenderPass(VulkanU32 pass)
+{
+	VULKAN_ASSERT(pass < mPasses.size());
+	return mPasses[pass].renderPass.get();
+}
+
+VulkanImage* VulkanRenderGraph::getImage(VulkanU32 resource)
+{
+	VULKAN_ASSERT(resource < mResources.size() && mResources[resource].image);
+	return mResources[resource].imported ? mResources[resource].importedImage : mResources[resource].transientImage.get();
+}
+
+VkImageView VulkanRenderGraph::getImageView(VulkanU32 resource) const
+{
+	VULKAN_ASSERT(resource < mResources.size() && mResources[resource].image);
+	return getAttachmentView(resource);
+}
+
+VkDeviceSize VulkanRenderGraph::getTransientMemorySize() const
+{
+	VkDeviceSize size = 0;
+	for (const MemorySlot& slot : mMemorySlots)
+	{
+		size += slot.allocation.isValid() ? slot.allocation.size : 0;
+	}
+	return size;
+}
+
+bool VulkanRenderGraph::execute(VulkanCommandBuffer* commandBuffer)
+{
+	VULKAN_ASSERT(commandBuffer != nullptr && commandBuffer->isRecording());
+	if (!mRealized)
+	{
+		VULKAN_LOG_ERROR("The render graph must be realized before being executed");
+		return false;
+	}
+
+	for (Resource& resource : mResources)
+	{
+		if (!resource.imported || resource.firstUse == InvalidIndex)
+		{
+			continue;
+		}
+		if (resource.image && resource.importedImage != nullptr)
+		{
+			resource.importedImage->setCurrentState(resource.initialState.access, resource.initialState.stages, resource.initialState.layout);
+		}
+		else if (!resource.image && resource.importedBuffer != nullptr)
+		{
+			resource.importedBuffer->setCurrentState(resource.initialState.access, resource.initialState.stages);
+		}
+		else
+		{
+			VULKAN_LOG_ERROR("The imported resource %s is not set", resource.name.c_str());
+			return false;
+		}
+	}
+
+	const VulkanU32 executedCount = static_cast<VulkanU32>(mExecutionOrder.size());
+	for (VulkanU32 i = 0; i < executedCount; i++)
+	{
+		Pass& pass = mPasses[mExecutionOrder[i]];
+		for (const Usage& usage : pass.usages)
+		{
+			Resource& resource = mResources[usage.resource];
+			if (!resource.image)
+			{
+				commandBuffer->transitionBuffer(resource.importedBuffer, usage.access, usage.stages);
+				continue;
+			}
+
+			VulkanImage* image = getImage(usage.resource);
+			if (!resource.imported && resource.firstUse == i)
+			{
+				// The content is discarded, but the previous uses of the memory must be finished
+				const VulkanImage* predecessor = mResources[resource.aliasPredecessor].transientImage.get();
+				image->setCurrentState(predecessor->getCurrentAccess(), predecessor->getCurrentStages(), VK_IMAGE_LAYOUT_UNDEFINED);
+			}
+			commandBuffer->transitionImage(image, usage.access, usage.layout, usage.stages, resource.aspect);
+		}
+
+		if (pass.type == VulkanRenderGraphPassType::Graphics)
+		{
+			VulkanFramebuffer* framebuffer = getFramebuffer(pass);
+			if (framebuffer == nullptr)
+			{
+				return false;
+			}
+			const VkExtent2D& size = mResources[pass.attachments[0].resource].size;
+			commandBuffer->beginRenderPass(pass.renderPass->getHandle(), framebuffer->getHandle(), { { 0, 0 }, size }, pass.clearValues, VK_SUBPASS_CONTENTS_INLINE);
+			if (pass.executeFunction)
+			{
+				pass.executeFunction(commandBuffer);
+			}
+			commandBuffer->endRenderPass();
+		}
+		else
+		{
+			commandBuffer->flushBarriers();
+			if (pass.executeFunction)
+			{
+				pass.executeFunction(commandBuffer);
+			}
+		}
+	}
+
+	for (Resource& resource : mResources)
+	{
+		if (!resource.imported || resource.firstUse == InvalidIndex)
+		{
+			continue;
+		}
+		if (resource.image)
+		{
+			commandBuffer->transitionImage(resource.importedImage, resource.finalState.access, resource.finalState.layout, resource.finalState.stages, resource.aspect);
+		}
+		else
+		{
+			commandBuffer->transitionBuffer(resource.importedBuffer, resource.finalState.access, resource.finalState.stages);
+		}
+	}
+
+	return true;
+}
+
+const std::string& VulkanRenderGraph::getPassName(VulkanU32 pass) const
+{
+	VULKAN_ASSERT(pass < mPasses.size());
+	return mPasses[pass].name;
+}
+
+const std::string& VulkanRenderGraph::getResourceName(VulkanU32 resource) const
+{
+	VULKAN_ASSERT(resource < mResources.size());
+	return mResources[resource].name;
+}
+
+VulkanU32 VulkanRenderGraph::getPassCount() const
+{
+	return static_cast<VulkanU32>(mPasses.size());
+}
+
+VulkanU32 VulkanRenderGraph::getResourceCount() const
+{
+	return static_cast<VulkanU32>(mResources.size());
+}
+
+VulkanRenderGraph::VulkanRenderGraph()
+	: mResources()
+	, mPasses()
+	, mMemorySlots()
+	, mExecutionOrder()
+	, mFinalBarriers()
+	, mStats()
+	, mDevice(nullptr)
+	, mCompiled(false)
+	, mRealized(false)
+{
+}
+
+void VulkanRenderGraph::releaseTransients()
+{
+	for (Pass& pass : mPasses)
+	{
+		pass.framebuffers.clear();
+	}
+	for (Resource& resource : mResources)
+	{
+		resource.transientImage.reset();
+	}
+	for (MemorySlot& slot : mMemorySlots)
+	{
+		if (slot.allocation.isValid())
+		{
+			mDevice->getMemoryAllocator().free(slot.allocation);
+		}
+	}
+	mRealized = false;
+}
+
+void VulkanRenderGraph::invalidate()
+{
+	releaseTransients();
+
+	for (Pass& pass : mPasses)
+	{
+		pass.culled = false;
+		pass.barriers.clear();
+		pass.attachments.clear();
+		pass.clearValues.clear();
+		pass.renderPass.reset();
+	}
+	for (Resource& resource : mResources)
+	{
+		resource.usage = 0;
+		resource.firstUse = InvalidIndex;
+		resource.lastUse = InvalidIndex;
+		resource.memorySlot = InvalidIndex;
+		resource.aliasPredecessor = InvalidIndex;
+	}
+	mMemorySlots.clear();
+	mExecutionOrder.clear();
+	mFinalBarriers.clear();
+	mStats = VulkanRenderGraphStats();
+	mCompiled = false;
+}
+
+void VulkanRenderGraph::addUsage(VulkanU32 pass, const Usage& usage)
+{
+	VULKAN_ASSERT(pass < mPasses.size() && usage.resource < mResources.size());
+
+	Pass& targetPass = mPasses[pass];
+	const Resource& resource = mResources[usage.resource];
+	const bool attachment = usage.type == UsageType::ColorAttachment || usage.type == UsageType::DepthStencilAttachment;
+	if (attachment && targetPass.type != VulkanRenderGraphPassType::Graphics)
+	{
+		VULKAN_LOG_ERROR("Only graphics passes can have attachments, %s is ignored in %s", resource.name.c_str(), targetPass.name.c_str());
+		return;
+	}
+	if (resource.image != (usage.type != UsageType::Buffer))
+	{
+		VULKAN_LOG_ERROR("%s is not used as the right type of resource in %s", resource.name.c_str(), targetPass.name.c_str());
+		return;
+	}
+	for (const Usage& previousUsage : targetPass.usages)
+	{
+		if (previousUsage.resource == usage.resource)
+		{
+			VULKAN_LOG_ERROR("%s is already used in %s", resource.name.c_str(), targetPass.name.c_str());
+			return;
+		}
+	}
+
+	invalidate();
+	targetPass.usages.push_back(usage);
+}
+
+bool VulkanRenderGraph::simulateBarriers(std::vector<ResourceState>& states, bool record)
+{
+	// The imported resources are reset to their initial state, the transient ones keep the state of the previous frame
+	for (VulkanU32 i = 0; i < mResources.size(); i++)
+	{
+		if (mResources[i].imported)
+		{
+			states[i] = mResources[i].initialState;
+		}
+	}
+
+	const VulkanU32 executedCount = static_cast<VulkanU32>(mExecutionOrder.size());
+	for (VulkanU32 i = 0; i < executedCount; i++)
+	{
+		Pass& pass = mPasses[mExecutionOrder[i]];
+		pass.barriers.clear();
+		for (const Usage& usage : pass.usages)
+		{
+			const Resource& resource = mResources[usage.resource];
+			if (!resource.imported && resource.firstUse == i)
+			{
+				if (resource.aliasPredecessor == InvalidIndex)
+				{
+					return false;
+				}
+				const ResourceState& predecessorState = states[resource.aliasPredecessor];
+				states[usage.resource] = { predecessorState.access, predecessorState.stages, VK_IMAGE_LAYOUT_UNDEFINED };
+			}
+			applyTransition(states, usage.resource, { usage.access, usage.stages, usage.layout }, record ? &pass.barriers : nullptr);
+		}
+	}
+
+	mFinalBarriers.clear();
+	for (VulkanU32 i = 0; i < mResources.size(); i++)
+	{
+		if (mResources[i].imported && mResources[i].firstUse != InvalidIndex)
+		{
+			applyTransition(states, i, mResources[i].finalState, record ? &mFinalBarriers : nullptr);
+		}
+	}
+	return true;
+}
+
+void VulkanRenderGraph::applyTransition(std::vector<ResourceState>& states, VulkanU32 resource, const ResourceState& newState, std::vector<VulkanRenderGraphBarrier>* barriers)
+{
+	// Same rules as VulkanCommandBuffer::transitionImage, so the recorded barriers match the compiled ones
+	ResourceState& currentState = states[resource];
+	const bool readAfterRead = currentState.layout == newState.layout && VulkanCommandBuffer::isReadOnlyAccess(currentState.access) && VulkanCommandBuffer::isReadOnlyAccess(newState.access);
+	if (readAfterRead && (newState.access & ~currentState.access) == 0 && (newState.stages & ~currentState.stages) == 0)
+	{
+		return;
+	}
+
+	if (barriers != nullptr)
+	{
+		const VkAccessFlags srcAccess = VulkanCommandBuffer::isReadOnlyAccess(currentState.access) ? 0 : currentState.access;
+		barriers->push_back({
+			resource,                   // VulkanU32               resource
+			srcAccess,                  // VkAccessFlags           srcAccess
+			newState.access,            // VkAccessFlags           dstAccess
+			currentState.stages,        // VkPipelineStageFlags    srcStages
+			newState.stages,            // VkPipelineStageFlags    dstStages
+			currentState.layout,        // VkImageLayout           oldLayout
+			newState.layout             // VkImageLayout           newLayout
+		});
+	}
+
+	currentState.access = readAfterRead ? (currentState.access | newState.access) : newState.access;
+	currentState.stages = readAfterRead ? (currentState.stages | newState.stages) : newState.stages;
+	currentState.layout = newState.layout;
+}
+
+VkImageView VulkanRenderGraph::getAttachmentView(VulkanU32 resource) const
+{
+	const Resource& attachmentResource = mResources[resource];
+	if (attachmentResource.imported)
+	{
+		return attachmentResource.importedImageView;
+	}
+	if (attachmentResource.transientImage != nullptr && attachmentResource.transientImage->getImageViewCount() > 0)
+	{
+		return attachmentResource.transientImage->getImageView(0)->getHandle();
+	}
+	return VK_NULL_HANDLE;
+}
+
+VulkanFramebuffer* VulkanRenderGraph::getFramebuffer(Pass& pass)
+{
+	const VulkanU32 attachmentCount = static_cast<VulkanU32>(pass.attachments.size());
+	for (FramebufferEntry& entry : pass.framebuffers)
+	{
+		bool match = true;
+		for (VulkanU32 i = 0; i < attachmentCount && match; i++)
+		{
+			match = entry.imageViews[i] == getAttachmentView(pass.attachments[i].resource);
+		}
+		if (match)
+		{
+			return entry.framebuffer.get();
+		}
+	}
+
+	FramebufferEntry entry;
+	for (const VulkanRenderGraphAttachment& attachment : pass.attachments)
+	{
+		entry.imageViews.push_back(getAttachmentView(attachment.resource));
+	}
+	const VkExtent2D& size = mResources[pass.attachments[0].resource].size;
+	entry.framebuffer = pass.renderPass->createFramebuffer(entry.imageViews, size.width, size.height, 1);
+	if (entry.framebuffer == nullptr || !entry.framebuffer->isInitialized())
+	{
+		return nullptr;
+	}
+	pass.framebuffers.push_back(std::move(entry));
+	return pass.framebuffers.back().framebuffer.get();
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
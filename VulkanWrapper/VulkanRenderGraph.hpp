@@ -0,0 +1,247 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanMemoryAllocator.hpp"
+
+#include <functional>
+#include <string>
+
+// TODO : Transient buffers
+// TODO : Passes on other queues (async compute) with ownership transfers
+// TODO : Merge compatible graphics passes in subpasses of a single render pass
+
+VULKAN_NAMESPACE_BEGIN
+
+enum class VulkanRenderGraphPassType
+{
+	Graphics,
+	Compute
+};
+
+// Barrier inserted by the graph before a pass, or after the last pass for the imported resources
+struct VulkanRenderGraphBarrier
+{
+	VulkanU32 resource;
+	VkAccessFlags srcAccess;
+	VkAccessFlags dstAccess;
+	VkPipelineStageFlags srcStages;
+	VkPipelineStageFlags dstStages;
+	VkImageLayout oldLayout; // VK_IMAGE_LAYOUT_UNDEFINED for buffers
+	VkImageLayout newLayout;
+};
+
+// Attachment of the render pass of a graphics pass, in the attachment order of the render pass
+struct VulkanRenderGraphAttachment
+{
+	VulkanU32 resource;
+	VkAttachmentLoadOp loadOp;
+	VkAttachmentStoreOp storeOp;
+	VkImageLayout layout;
+};
+
+struct VulkanRenderGraphStats
+{
+	VulkanU32 passCount;
+	VulkanU32 culledPassCount;
+	VulkanU32 barrierCount; // Buffer and image barriers, including the final ones
+	VulkanU32 barrierBatchCount; // Passes (and end of the graph) that need at least one barrier
+	VulkanU32 transientImageCount; // Used by at least one executed pass
+	VulkanU32 memorySlotCount; // Memory ranges shared by the transient images
+};
+
+// Frame graph : the passes declare the resources they use, and compile() decides everything else
+// - The passes that don't contribute to an imported resource or a pass with side effects are culled
+// - The passes are executed in the declaration order, a resource read by a pass must be written by a previous one
+// - The barriers are computed from the uses of the resources, with the same rules as VulkanCommandBuffer::transitionImage
+// - The transient images whose lifetimes don't overlap share the same memory
+// compile() doesn't need a device, so the result can be inspected on the CPU only
+// realize() then creates the images, the memory and the render passes, and execute() records the passes
+class VulkanRenderGraph
+{
+	public:
+		static const VulkanU32 InvalidIndex = ~0u;
+
+		typedef std::function<void(VulkanCommandBuffer* commandBuffer)> ExecuteFunction;
+
+		static VulkanRenderGraphPtr createRenderGraph();
+
+		~VulkanRenderGraph();
+
+		// Images owned by the graph, only valid during the execution of the graph
+		VulkanU32 createImage(const std::string& name, VkFormat format, VkExtent2D size, VkImageAspectFlags aspect, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+		// The extent can change without compiling again, realize() must be called after
+		void setImageSize(VulkanU32 resource, VkExtent2D size);
+
+		// Resources owned by the application, set into their initial state at the start of execute() and left in their final state
+		VulkanU32 importImage(const std::string& name, VkFormat format, VkExtent2D size, VkImageAspectFlags aspect, VkAccessFlags initialAccess, VkPipelineStageFlags initialStages, VkImageLayout initialLayout, VkAccessFlags finalAccess, VkPipelineStageFlags finalStages, VkImageLayout finalLayout);
+		VulkanU32 importBuffer(const std::string& name, VkAccessFlags initialAccess, VkPipelineStageFlags initialStages, VkAccessFlags finalAccess, VkPipelineStageFlags finalStages);
+		// Can change each frame (ex: swapchain images), the framebuffers are cached per image view
+		void setImportedImage(VulkanU32 resource, VulkanImage* image, VkImageView imageView);
+		void setImportedBuffer(VulkanU32 resource, VulkanBuffer* buffer);
+
+		// The graphics passes are recorded inside a render pass that covers their attachments
+		VulkanU32 addGraphicsPass(const std::string& name, const ExecuteFunction& executeFunction);
+		VulkanU32 addComputePass(const std::string& name, const ExecuteFunction& executeFunction);
+		// Never culled (ex: readback, debug output)
+		void setPassSideEffects(VulkanU32 pass, bool sideEffects);
+
+		// A resource can only be used once per pass
+		// Without clear, the previous content is loaded
+		void addColorAttachment(VulkanU32 pass, VulkanU32 resource, bool clear, VkClearColorValue clearColor = {});
+		void addDepthStencilAttachment(VulkanU32 pass, VulkanU32 resource, bool clear, VkClearDepthStencilValue clearDepthStencil = { 1.0f, 0 });
+		// Sampled images are in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, storage images in VK_IMAGE_LAYOUT_GENERAL
+		void addSampledImage(VulkanU32 pass, VulkanU32 resource, VkPipelineStageFlags stages);
+		void addStorageImage(VulkanU32 pass, VulkanU32 resource, VkPipelineStageFlags stages, bool write);
+		void addBufferRead(VulkanU32 pass, VulkanU32 resource, VkAccessFlags access, VkPipelineStageFlags stages);
+		void addBufferWrite(VulkanU32 pass, VulkanU32 resource, VkAccessFlags access, VkPipelineStageFlags stages);
+
+		// Declaring new passes or resources needs a new compile()
+		bool compile();
+		bool isCompiled() const;
+
+		// Results of compile()
+		bool isPassCulled(VulkanU32 pass) const;
+		const std::vector<VulkanU32>& getExecutionOrder() const;
+		const std::vector<VulkanRenderGraphBarrier>& getPassBarriers(VulkanU32 pass) const;
+		const std::vector<VulkanRenderGraphBarrier>& getFinalBarriers() const;
+		const std::vector<VulkanRenderGraphAttachment>& getPassAttachments(VulkanU32 pass) const;
+		VulkanU32 getMemorySlot(VulkanU32 resource) const; // InvalidIndex for the imported and the unused resources
+		VkImageUsageFlags getImageUsage(VulkanU32 resource) const;
+		const VulkanRenderGraphStats& getStats() const;
+		void printCompiledGraph() const;
+
+		// Creates the transient images and their memory, and the render passes if they don't exist yet
+		// The render passes are kept until the next compile(), so the pipelines created with them stay valid after a resize
+		// The previous submissions using the graph must be finished
+		bool realize(VulkanDevice& device);
+		bool isRealized() const;
+
+		// Results of realize()
+		VulkanRenderPass* getRenderPass(VulkanU32 pass);
+		VulkanImage* getImage(VulkanU32 resource);
+		VkImageView getImageView(VulkanU32 resource) const;
+		VkDeviceSize getTransientMemorySize() const; // Memory reserved for the transient images, after aliasing
+
+		// Records the executed passes and their barriers, outside of any render pass
+		// The final barriers are left pending in the command buffer, so they can be merged with the next transitions
+		bool execute(VulkanCommandBuffer* commandBuffer);
+
+		const std::string& getPassName(VulkanU32 pass) const;
+		const std::string& getResourceName(VulkanU32 resource) const;
+		VulkanU32 getPassCount() const;
+		VulkanU32 getResourceCount() const;
+
+	private:
+		VulkanRenderGraph();
+
+		void releaseTransients();
+		void invalidate();
+
+		enum class UsageType
+		{
+			ColorAttachment,
+			DepthStencilAttachment,
+			SampledImage,
+			StorageImage,
+			Buffer
+		};
+
+		struct Usage
+		{
+			VulkanU32 resource;
+			UsageType type;
+			VkAccessFlags access;
+			VkPipelineStageFlags stages;
+			VkImageLayout layout;
+			bool read; // The previous content is used
+			bool write;
+			bool clear;
+			VkClearValue clearValue;
+		};
+
+		struct ResourceState
+		{
+			VkAccessFlags access;
+			VkPipelineStageFlags stages;
+			VkImageLayout layout;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			bool image;
+			bool imported;
+
+			VkFormat format;
+			VkExtent2D size;
+			VkImageAspectFlags aspect;
+			VkSampleCountFlagBits samples;
+
+			ResourceState initialState;
+			ResourceState finalState;
+			VulkanImage* importedImage;
+			VkImageView importedImageView;
+			VulkanBuffer* importedBuffer;
+
+			// Compiled
+			VkImageUsageFlags usage;
+			VulkanU32 firstUse; // Index in the execution order
+			VulkanU32 lastUse;
+			VulkanU32 memorySlot;
+			VulkanU32 aliasPredecessor; // Previous image in the same memory slot, itself when alone
+
+			// Realized
+			VulkanImagePtr transientImage;
+		};
+
+		struct FramebufferEntry
+		{
+			std::vector<VkImageView> imageViews;
+			VulkanFramebufferPtr framebuffer;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			VulkanRenderGraphPassType type;
+			ExecuteFunction executeFunction;
+			std::vector<Usage> usages;
+			bool sideEffects;
+
+			// Compiled
+			bool culled;
+			std::vector<VulkanRenderGraphBarrier> barriers;
+			std::vector<VulkanRenderGraphAttachment> attachments;
+			std::vector<VkClearValue> clearValues;
+			VkExtent2D extent;
+
+			// Realized
+			VulkanRenderPassPtr renderPass;
+			std::vector<FramebufferEntry> framebuffers;
+		};
+
+		struct MemorySlot
+		{
+			std::vector<VulkanU32> resources;
+			VulkanMemoryAllocation allocation;
+		};
+
+		void addUsage(VulkanU32 pass, const Usage& usage);
+		bool simulateBarriers(std::vector<ResourceState>& states, bool record);
+		void applyTransition(std::vector<ResourceState>& states, VulkanU32 resource, const ResourceState& newState, std::vector<VulkanRenderGraphBarrier>* barriers);
+		VkImageView getAttachmentView(VulkanU32 resource) const;
+		VulkanFramebuffer* getFramebuffer(Pass& pass);
+
+		std::vector<Resource> mResources;
+		std::vector<Pass> mPasses;
+		std::vector<MemorySlot> mMemorySlots;
+		std::vector<VulkanU32> mExecutionOrder;
+		std::vector<VulkanRenderGraphBarrier> mFinalBarriers;
+		VulkanRenderGraphStats mStats;
+
+		VulkanDevice* mDevice;
+		bool mCompiled;
+		bool mRealized;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "VulkanShaderModule.hpp"
 
 #include "VulkanDevice.hpp"
-
-#include <fstream>
+#include "VulkanHash.hpp"
+#include "VulkanMappedFile.hpp"
 
 VULKAN_NAMESPACE_BEGIN
 
@@ -15,36 +15,39 @@ VulkanShaderModule::~VulkanShaderModule()
 
 bool VulkanShaderModule::loadFromFile(const std::string& filename, ShaderStageFlags stage, const std::string& entrypoint)
 {
-	mStages = ShaderStageFlags::None;
-	mShaderStageCreateInfos.clear();
-
-	mSpirvBlob.clear();
+	// Mapped instead of read, the code is copied once into the blob
+	VulkanMappedFile file;
+	if (!file.open(filename))
+	{
+		return false;
+	}
 
-	std::ifstream file(filename, std::ios::binary);
-	if (file.fail())
+	if (!loadFromMemory(file.getData(), file.getSize(), stage, entrypoint))
 	{
-		// TODO : Use Numea Log System
-		printf("Could not open '%s' file\n", filename.c_str());
+		VULKAN_LOG_ERROR("Could not load the '%s' shader", filename.c_str());
 		return false;
 	}
+	return true;
+}
 
-	std::streampos begin;
-	std::streampos end;
-	begin = file.tellg();
-	file.seekg(0, std::ios::end);
-	end = file.tellg();
+bool VulkanShaderModule::loadFromMemory(const void* code, size_t size, ShaderStageFlags stage, const std::string& entrypoint)
+{
+	mStages = ShaderStageFlags::None;
+	mShaderStageCreateInfos.clear();
 
-	if ((end - begin) == 0)
+	if (code == nullptr || size == 0 || (size % sizeof(VulkanU32)) != 0)
 	{
-		// TODO : Use Numea Log System
-		printf("The '%s' file is empty\n", filename.c_str());
+		VULKAN_LOG_ERROR("Invalid SPIR-V code size");
 		return false;
 	}
 
-	mSpirvBlob.resize(static_cast<size_t>(end - begin));
-	file.seekg(0, std::ios::beg);
-	file.read(reinterpret_cast<char*>(mSpirvBlob.data()), end - begin);
-	file.close();
+	const VulkanU8* bytes = static_cast<const VulkanU8*>(code);
+	mSpirvBlob.assign(bytes, bytes + size);
+
+	if (!mReflection.reflect(mSpirvBlob))
+	{
+		VULKAN_LOG_WARNING("Could not reflect the shader");
+	}
 
 	switch (stage)
 	{
@@ -55,7 +58,7 @@ bool VulkanShaderModule::loadFromFile(const std::string& filename, ShaderStageFl
 		case ShaderStageFlags::Geometry: setGeometryEntrypointName(entrypoint); break;
 		case ShaderStageFlags::Fragment: setFragmentEntrypointName(entrypoint); break;
 		case ShaderStageFlags::Compute: setComputeEntrypointName(entrypoint); break;
-		default: printf("Stages combination are not supported at loading"); return false; break;
+		default: VULKAN_LOG_ERROR("Stages combination are not supported at loading"); return false; break;
 	}
 
 	return create();
@@ -97,8 +100,35 @@ void VulkanShaderModule::setComputeEntrypointName(const std::string& entrypoint)
 	mComputeEntrypointName = entrypoint;
 }
 
+bool VulkanShaderModule::setEntrypointsFromReflection()
+{
+	const std::vector<VulkanShaderEntryPoint>& entryPoints = mReflection.getEntryPoints();
+	if (entryPoints.empty())
+	{
+		VULKAN_LOG_ERROR("No entry point found in the shader");
+		return false;
+	}
+
+	for (const VulkanShaderEntryPoint& entryPoint : entryPoints)
+	{
+		switch (entryPoint.stage)
+		{
+			case VK_SHADER_STAGE_VERTEX_BIT: setVertexEntrypointName(entryPoint.name); break;
+			case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: setTessellationControlEntrypointName(entryPoint.name); break;
+			case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: setTessellationEvaluationEntrypointName(entryPoint.name); break;
+			case VK_SHADER_STAGE_GEOMETRY_BIT: setGeometryEntrypointName(entryPoint.name); break;
+			case VK_SHADER_STAGE_FRAGMENT_BIT: setFragmentEntrypointName(entryPoint.name); break;
+			case VK_SHADER_STAGE_COMPUTE_BIT: setComputeEntrypointName(entryPoint.name); break;
+			default: break;
+		}
+	}
+	return true;
+}
+
 bool VulkanShaderModule::create()
 {
+	mSpirvHash = VulkanHasher::hash(mSpirvBlob.data(), mSpirvBlob.size());
+
 	VkShaderModuleCreateInfo shaderModuleCreateInfo = {
 		VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,              // VkStructureType              sType
 		nullptr,                                                  // const void                 * pNext
@@ -172,16 +202,27 @@ const std::vector<unsigned char>& VulkanShaderModule::getSpirvBlob() const
 	return mSpirvBlob;
 }
 
+VulkanU64 VulkanShaderModule::getSpirvHash() const
+{
+	return mSpirvHash;
+}
+
 const VulkanShaderModule::ShaderStageFlags& VulkanShaderModule::getStages() const
 {
 	return mStages;
 }
 
+const VulkanShaderReflection& VulkanShaderModule::getReflection() const
+{
+	return mReflection;
+}
+
 VulkanShaderModule::VulkanShaderModule()
 	: mShaderModule(VK_NULL_HANDLE)
 	, mStages(ShaderStageFlags::None)
 	, mSpirvBlob()
-	, mSpecializationInfo(nullptr)
+	, mSpirvHash(0)
+	, mReflection()
 	, mVertexEntrypointName()
 	, mTessellationControlEntrypointName()
 	, mTessellationEvaluationEntrypointName()
@@ -230,7 +271,7 @@ void VulkanShaderModule::generateShaderStages() const
 	ci.pNext = nullptr; // const void* pNext
 	ci.flags = 0; // VkPipelineShaderStageCreateFlags flags
 	ci.module = mShaderModule; // VkShaderModule module
-	ci.pSpecializationInfo = mSpecializationInfo; // const VkSpecializationInfo* pSpecializationInfo
+	ci.pSpecializationInfo = nullptr; // const VkSpecializationInfo* pSpecializationInfo, set by the pipelines
 
 	if ((mStages & ShaderStageFlags::Vertex) != 0)
 	{
@@ -1,11 +1,11 @@
 #pragma once
 
 #include "VulkanFunctions.hpp"
+#include "VulkanShaderReflection.hpp"
+
+#include <string>
 
-// TODO : SpecializationInfo param
 // TODO : Add GLSL->Spirv tool
-// TODO : Get info about variables in shaders
-// TODO : Auto find entrypoints
 // TODO : Find better interface ?
 
 VULKAN_NAMESPACE_BEGIN
@@ -28,6 +28,8 @@ class VulkanShaderModule : public VulkanDeviceObject<VulkanObjectType_ShaderModu
 		~VulkanShaderModule();
 
 		bool loadFromFile(const std::string& filename, ShaderStageFlags stage = ShaderStageFlags::None, const std::string& entrypoint = "main");
+		// The code is copied, the size is in bytes
+		bool loadFromMemory(const void* code, size_t size, ShaderStageFlags stage = ShaderStageFlags::None, const std::string& entrypoint = "main");
 
 		void setVertexEntrypointName(const std::string& entrypoint);
 		void setTessellationControlEntrypointName(const std::string& entrypoint);
@@ -35,6 +37,8 @@ class VulkanShaderModule : public VulkanDeviceObject<VulkanObjectType_ShaderModu
 		void setGeometryEntrypointName(const std::string& entrypoint);
 		void setFragmentEntrypointName(const std::string& entrypoint);
 		void setComputeEntrypointName(const std::string& entrypoint);
+		// Uses the entry points found in the module, for modules loaded without stage
+		bool setEntrypointsFromReflection();
 
 		bool create();
 		void destroy();
@@ -49,9 +53,14 @@ class VulkanShaderModule : public VulkanDeviceObject<VulkanObjectType_ShaderModu
 		const std::string& getComputeEntrypointName() const;
 
 		const std::vector<unsigned char>& getSpirvBlob() const;
+		// Identifies the code independently of the handle, which can be reused once the module is destroyed
+		VulkanU64 getSpirvHash() const;
 
 		const ShaderStageFlags& getStages() const;
 
+		// Filled by loadFromFile()
+		const VulkanShaderReflection& getReflection() const;
+
 	private:
 		friend class VulkanDevice;
 		VulkanShaderModule();
@@ -69,7 +78,8 @@ class VulkanShaderModule : public VulkanDeviceObject<VulkanObjectType_ShaderModu
 
 		ShaderStageFlags mStages;
 		std::vector<unsigned char> mSpirvBlob;
-		VkSpecializationInfo* mSpecializationInfo;
+		VulkanU64 mSpirvHash;
+		VulkanShaderReflection mReflection;
 
 		std::string mVertexEntrypointName;
 		std::string mTessellationControlEntrypointName;
@@ -0,0 +1,147 @@
+#include "VulkanShaderModuleCache.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanHash.hpp"
+#include "VulkanMappedFile.hpp"
+#include "VulkanShaderModule.hpp"
+
+#include <chrono>
+#include <cstring>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanShaderModuleCache::VulkanShaderModuleCache(VulkanDevice& device)
+	: mDevice(device)
+	, mMutex()
+	, mModules()
+	, mFiles()
+	, mStats()
+{
+	resetStats();
+}
+
+VulkanShaderModuleCache::~VulkanShaderModuleCache()
+{
+	clear();
+}
+
+VulkanShaderModuleSharedPtr VulkanShaderModuleCache::loadShaderModule(const std::string& filename)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	VulkanMappedFile file;
+	if (!file.open(filename))
+	{
+		return nullptr;
+	}
+	const VulkanU64 hash = VulkanHasher::hash(file.getData(), file.getSize());
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mStats.requests++;
+	mStats.mappedBytes += file.getSize();
+
+	auto fileItr = mFiles.find(filename);
+	if (fileItr == mFiles.end())
+	{
+		mFiles[filename] = hash;
+	}
+	else if (fileItr->second != hash)
+	{
+		VULKAN_LOG_INFO("The '%s' shader changed since it was loaded", filename.c_str());
+		mStats.changedFiles++;
+		fileItr->second = hash;
+	}
+
+	auto moduleItr = mModules.find(hash);
+	if (moduleItr != mModules.end())
+	{
+		VulkanShaderModuleSharedPtr shaderModule = moduleItr->second.lock();
+
+		// The code is compared too, in case two different codes have the same hash
+		if (shaderModule != nullptr && shaderModule->getSpirvBlob().size() == file.getSize() && std::memcmp(shaderModule->getSpirvBlob().data(), file.getData(), file.getSize()) == 0)
+		{
+			mStats.hits++;
+			mStats.loadingTime += std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			return shaderModule;
+		}
+	}
+
+	auto creationStart = std::chrono::high_resolution_clock::now();
+	mStats.loadingTime += std::chrono::duration<VulkanF32, std::milli>(creationStart - start).count();
+
+	VulkanShaderModuleSharedPtr shaderModule = mDevice.initShaderModule();
+	if (shaderModule == nullptr || !shaderModule->loadFromMemory(file.getData(), file.getSize()) || !shaderModule->setEntrypointsFromReflection() || !shaderModule->create())
+	{
+		VULKAN_LOG_ERROR("Could not load the '%s' shader", filename.c_str());
+		return nullptr;
+	}
+
+	mModules[hash] = shaderModule;
+	mStats.createdModules++;
+	mStats.creationTime += std::chrono::duration<VulkanF32, std::milli>(std::chrono::high_resolution_clock::now() - creationStart).count();
+
+	return shaderModule;
+}
+
+void VulkanShaderModuleCache::purge()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (auto itr = mModules.begin(); itr != mModules.end(); )
+	{
+		if (itr->second.expired())
+		{
+			itr = mModules.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+}
+
+void VulkanShaderModuleCache::clear()
+{
+	// The modules still used stay alive, they are just not shared anymore
+	std::lock_guard<std::mutex> lock(mMutex);
+	mModules.clear();
+	mFiles.clear();
+}
+
+VulkanU32 VulkanShaderModuleCache::getAliveModuleCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	VulkanU32 count = 0;
+	for (const auto& module : mModules)
+	{
+		if (!module.second.expired())
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+const VulkanShaderModuleCacheStats& VulkanShaderModuleCache::getStats() const
+{
+	return mStats;
+}
+
+void VulkanShaderModuleCache::resetStats()
+{
+	mStats.requests = 0;
+	mStats.hits = 0;
+	mStats.createdModules = 0;
+	mStats.changedFiles = 0;
+	mStats.mappedBytes = 0;
+	mStats.loadingTime = 0.0f;
+	mStats.creationTime = 0.0f;
+}
+
+void VulkanShaderModuleCache::printStats() const
+{
+	printf("Shader modules : %u requests, %u hits, %u modules created (%u alive), %u changed files\n", mStats.requests, mStats.hits, mStats.createdModules, getAliveModuleCount(), mStats.changedFiles);
+	printf("Shader modules : %llu bytes mapped, %.3f ms loading, %.3f ms creating\n", static_cast<unsigned long long>(mStats.mappedBytes), mStats.loadingTime, mStats.creationTime);
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// TODO : Watch the files to reload the modules while running
+
+VULKAN_NAMESPACE_BEGIN
+
+struct VulkanShaderModuleCacheStats
+{
+	VulkanU32 requests;
+	VulkanU32 hits; // Module still alive for the same code, loaded from the same file or not
+	VulkanU32 createdModules;
+	VulkanU32 changedFiles; // Path already loaded but with a different code
+	VulkanU64 mappedBytes;
+	VulkanF32 loadingTime; // Milliseconds, mapping and hashing included
+	VulkanF32 creationTime; // Milliseconds, in vkCreateShaderModule and the reflection
+};
+
+// Shares the shader modules of the device between all their users
+// The modules are keyed by the hash of their code, the file path only remembers the last code loaded from it
+// The cache only keeps weak references : a module is destroyed as soon as the last pipeline or user releases it
+class VulkanShaderModuleCache
+{
+	public:
+		VulkanShaderModuleCache(VulkanDevice& device);
+		~VulkanShaderModuleCache();
+
+		// The file is mapped and hashed, then the module is created only if no module with the same code is alive
+		// The entry points are found by the reflection of the module
+		VulkanShaderModuleSharedPtr loadShaderModule(const std::string& filename);
+
+		// Forgets the modules that are not used anymore
+		void purge();
+		void clear();
+
+		VulkanU32 getAliveModuleCount() const;
+		const VulkanShaderModuleCacheStats& getStats() const;
+		void resetStats();
+		void printStats() const;
+
+	private:
+		VulkanDevice& mDevice;
+
+		mutable std::mutex mMutex;
+		std::unordered_map<VulkanU64, std::weak_ptr<VulkanShaderModule>> mModules; // By hash of the code
+		std::unordered_map<std::string, VulkanU64> mFiles; // Hash of the last code loaded from each file
+		VulkanShaderModuleCacheStats mStats;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
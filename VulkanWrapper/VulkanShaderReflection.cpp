@@ -0,0 +1,815 @@
+#include "VulkanShaderReflection.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanDescriptorSetLayout.hpp"
+#include "VulkanPipelineLayout.hpp"
+
+#include "../ThirdParty/vulkan/spirv.h"
+
+#include <algorithm>
+#include <cstring>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanShaderReflection::VulkanShaderReflection()
+	: mCode(nullptr)
+	, mWordCount(0)
+	, mAnnotationsBegin(0)
+	, mAnnotationsEnd(0)
+	, mIds()
+	, mStages(0)
+	, mEntryPoints()
+	, mDescriptorBindings()
+	, mPushConstantBlocks()
+	, mSpecializationConstants()
+	, mVertexInputs()
+{
+}
+
+bool VulkanShaderReflection::reflect(const std::vector<unsigned char>& spirvBlob)
+{
+	return reflect(reinterpret_cast<const VulkanU32*>(spirvBlob.data()), spirvBlob.size() / sizeof(VulkanU32));
+}
+
+bool VulkanShaderReflection::reflect(const VulkanU32* code, size_t wordCount)
+{
+	clear();
+
+	if (code == nullptr || wordCount < 5 || code[0] != SpvMagicNumber)
+	{
+		VULKAN_LOG_ERROR("Invalid SPIR-V module");
+		return false;
+	}
+
+	mCode = code;
+	mWordCount = wordCount;
+	mAnnotationsBegin = 0;
+	mAnnotationsEnd = 0;
+
+	IdInfo defaultInfo;
+	std::memset(&defaultInfo, 0, sizeof(IdInfo));
+	defaultInfo.set = VulkanInvalidU32;
+	defaultInfo.binding = VulkanInvalidU32;
+	defaultInfo.location = VulkanInvalidU32;
+	defaultInfo.specId = VulkanInvalidU32;
+	mIds.assign(code[3], defaultInfo); // The bound of the ids is in the header
+
+	bool result = parse();
+	if (result)
+	{
+		collectResults();
+	}
+
+	mCode = nullptr;
+	mWordCount = 0;
+	return result;
+}
+
+void VulkanShaderReflection::clear()
+{
+	mStages = 0;
+	mEntryPoints.clear();
+	mDescriptorBindings.clear();
+	mPushConstantBlocks.clear();
+	mSpecializationConstants.clear();
+	mVertexInputs.clear();
+}
+
+bool VulkanShaderReflection::merge(const VulkanShaderReflection& other)
+{
+	mStages |= other.mStages;
+
+	mEntryPoints.insert(mEntryPoints.end(), other.mEntryPoints.begin(), other.mEntryPoints.end());
+
+	for (const VulkanShaderDescriptorBinding& binding : other.mDescriptorBindings)
+	{
+		auto itr = std::find_if(mDescriptorBindings.begin(), mDescriptorBindings.end(), [&binding](const VulkanShaderDescriptorBinding& b) { return b.set == binding.set && b.binding == binding.binding; });
+		if (itr == mDescriptorBindings.end())
+		{
+			mDescriptorBindings.push_back(binding);
+		}
+		else if (itr->type != binding.type || itr->count != binding.count)
+		{
+			VULKAN_LOG_ERROR("Descriptor set %d binding %d is declared with different types", binding.set, binding.binding);
+			return false;
+		}
+		else
+		{
+			itr->stages |= binding.stages;
+		}
+	}
+	std::sort(mDescriptorBindings.begin(), mDescriptorBindings.end(), [](const VulkanShaderDescriptorBinding& a, const VulkanShaderDescriptorBinding& b) { return a.set < b.set || (a.set == b.set && a.binding < b.binding); });
+
+	for (const VulkanShaderPushConstantBlock& block : other.mPushConstantBlocks)
+	{
+		auto itr = std::find_if(mPushConstantBlocks.begin(), mPushConstantBlocks.end(), [&block](const VulkanShaderPushConstantBlock& b) { return b.offset == block.offset && b.size == block.size; });
+		if (itr == mPushConstantBlocks.end())
+		{
+			mPushConstantBlocks.push_back(block);
+		}
+		else
+		{
+			itr->stages |= block.stages;
+		}
+	}
+
+	for (const VulkanShaderSpecializationConstant& constant : other.mSpecializationConstants)
+	{
+		auto itr = std::find_if(mSpecializationConstants.begin(), mSpecializationConstants.end(), [&constant](const VulkanShaderSpecializationConstant& c) { return c.constantId == constant.constantId; });
+		if (itr == mSpecializationConstants.end())
+		{
+			mSpecializationConstants.push_back(constant);
+		}
+		else if (itr->type != constant.type || itr->size != constant.size)
+		{
+			VULKAN_LOG_ERROR("Specialization constant %d is declared with different types", constant.constantId);
+			return false;
+		}
+		else
+		{
+			itr->stages |= constant.stages;
+		}
+	}
+	std::sort(mSpecializationConstants.begin(), mSpecializationConstants.end(), [](const VulkanShaderSpecializationConstant& a, const VulkanShaderSpecializationConstant& b) { return a.constantId < b.constantId; });
+
+	// Only the vertex stage has vertex inputs
+	mVertexInputs.insert(mVertexInputs.end(), other.mVertexInputs.begin(), other.mVertexInputs.end());
+	std::sort(mVertexInputs.begin(), mVertexInputs.end(), [](const VulkanShaderVertexInput& a, const VulkanShaderVertexInput& b) { return a.location < b.location; });
+
+	return true;
+}
+
+VkShaderStageFlags VulkanShaderReflection::getStages() const
+{
+	return mStages;
+}
+
+const std::vector<VulkanShaderEntryPoint>& VulkanShaderReflection::getEntryPoints() const
+{
+	return mEntryPoints;
+}
+
+const std::vector<VulkanShaderDescriptorBinding>& VulkanShaderReflection::getDescriptorBindings() const
+{
+	return mDescriptorBindings;
+}
+
+const std::vector<VulkanShaderPushConstantBlock>& VulkanShaderReflection::getPushConstantBlocks() const
+{
+	return mPushConstantBlocks;
+}
+
+const std::vector<VulkanShaderSpecializationConstant>& VulkanShaderReflection::getSpecializationConstants() const
+{
+	return mSpecializationConstants;
+}
+
+const std::vector<VulkanShaderVertexInput>& VulkanShaderReflection::getVertexInputs() const
+{
+	return mVertexInputs;
+}
+
+const VulkanShaderDescriptorBinding* VulkanShaderReflection::findDescriptorBinding(VulkanU32 set, VulkanU32 binding) const
+{
+	for (const VulkanShaderDescriptorBinding& descriptorBinding : mDescriptorBindings)
+	{
+		if (descriptorBinding.set == set && descriptorBinding.binding == binding)
+		{
+			return &descriptorBinding;
+		}
+	}
+	return nullptr;
+}
+
+const VulkanShaderSpecializationConstant* VulkanShaderReflection::findSpecializationConstant(VulkanU32 constantId) const
+{
+	for (const VulkanShaderSpecializationConstant& constant : mSpecializationConstants)
+	{
+		if (constant.constantId == constantId)
+		{
+			return &constant;
+		}
+	}
+	return nullptr;
+}
+
+VulkanU32 VulkanShaderReflection::getDescriptorSetCount() const
+{
+	// Sorted by set
+	return (mDescriptorBindings.empty()) ? 0 : mDescriptorBindings.back().set + 1;
+}
+
+void VulkanShaderReflection::getDescriptorSetLayoutBindings(VulkanU32 set, std::vector<VkDescriptorSetLayoutBinding>& bindings) const
+{
+	bindings.clear();
+	for (const VulkanShaderDescriptorBinding& descriptorBinding : mDescriptorBindings)
+	{
+		if (descriptorBinding.set == set)
+		{
+			VkDescriptorSetLayoutBinding layoutBinding = {
+				descriptorBinding.binding,                  // uint32_t             binding
+				descriptorBinding.type,                     // VkDescriptorType     descriptorType
+				descriptorBinding.count,                    // uint32_t             descriptorCount
+				descriptorBinding.stages,                   // VkShaderStageFlags   stageFlags
+				nullptr                                     // const VkSampler    * pImmutableSamplers
+			};
+			bindings.push_back(layoutBinding);
+		}
+	}
+}
+
+void VulkanShaderReflection::getPushConstantRanges(std::vector<VkPushConstantRange>& ranges) const
+{
+	ranges.clear();
+	for (const VulkanShaderPushConstantBlock& block : mPushConstantBlocks)
+	{
+		VkPushConstantRange range = {
+			block.stages,                               // VkShaderStageFlags     stageFlags
+			block.offset,                               // uint32_t               offset
+			block.size                                  // uint32_t               size
+		};
+		ranges.push_back(range);
+	}
+}
+
+bool VulkanShaderReflection::createDescriptorSetLayouts(VulkanDevice& device, std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts) const
+{
+	descriptorSetLayouts.clear();
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	const VulkanU32 setCount = getDescriptorSetCount();
+	for (VulkanU32 set = 0; set < setCount; set++)
+	{
+		getDescriptorSetLayoutBindings(set, bindings);
+		VulkanDescriptorSetLayoutPtr descriptorSetLayout = device.createDescriptorSetLayout(bindings);
+		if (descriptorSetLayout == nullptr || !descriptorSetLayout->isInitialized())
+		{
+			descriptorSetLayouts.clear();
+			return false;
+		}
+		descriptorSetLayouts.push_back(std::move(descriptorSetLayout));
+	}
+	return true;
+}
+
+VulkanPipelineLayoutPtr VulkanShaderReflection::createPipelineLayout(VulkanDevice& device, const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts) const
+{
+	VULKAN_ASSERT(descriptorSetLayouts.size() >= getDescriptorSetCount());
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayoutHandles;
+	descriptorSetLayoutHandles.reserve(descriptorSetLayouts.size());
+	for (const VulkanDescriptorSetLayoutPtr& descriptorSetLayout : descriptorSetLayouts)
+	{
+		descriptorSetLayoutHandles.push_back(descriptorSetLayout->getHandle());
+	}
+
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	getPushConstantRanges(pushConstantRanges);
+
+	return device.createPipelineLayout(descriptorSetLayoutHandles, pushConstantRanges);
+}
+
+void VulkanShaderReflection::print() const
+{
+	for (const VulkanShaderEntryPoint& entryPoint : mEntryPoints)
+	{
+		VULKAN_LOG_INFO("ShaderReflection: entry point %s, stage 0x%x", entryPoint.name.c_str(), entryPoint.stage);
+	}
+	for (const VulkanShaderDescriptorBinding& binding : mDescriptorBindings)
+	{
+		VULKAN_LOG_INFO("ShaderReflection: set %d binding %d : %s, type %d, count %d, stages 0x%x", binding.set, binding.binding, binding.name.c_str(), binding.type, binding.count, binding.stages);
+	}
+	for (const VulkanShaderPushConstantBlock& block : mPushConstantBlocks)
+	{
+		VULKAN_LOG_INFO("ShaderReflection: push constants %s : offset %d, size %d, stages 0x%x", block.name.c_str(), block.offset, block.size, block.stages);
+	}
+	for (const VulkanShaderSpecializationConstant& constant : mSpecializationConstants)
+	{
+		VULKAN_LOG_INFO("ShaderReflection: specialization constant %d : %s, type %d, size %d, default 0x%llx", constant.constantId, constant.name.c_str(), static_cast<int>(constant.type), constant.size, static_cast<unsigned long long>(constant.defaultValue));
+	}
+	for (const VulkanShaderVertexInput& input : mVertexInputs)
+	{
+		VULKAN_LOG_INFO("ShaderReflection: vertex input %d : %s, format %d, size %d", input.location, input.name.c_str(), input.format, input.size);
+	}
+}
+
+bool VulkanShaderReflection::parse()
+{
+	const VulkanU32 bound = static_cast<VulkanU32>(mIds.size());
+
+	size_t offset = 5;
+	while (offset < mWordCount)
+	{
+		const VulkanU32 opcode = mCode[offset] & SpvOpCodeMask;
+		const VulkanU32 wordCount = mCode[offset] >> SpvWordCountShift;
+		if (wordCount == 0 || offset + wordCount > mWordCount)
+		{
+			VULKAN_LOG_ERROR("Invalid SPIR-V instruction at word %d", static_cast<VulkanU32>(offset));
+			return false;
+		}
+		const VulkanU32* words = mCode + offset;
+
+		// The declarations are before the functions, which don't change the interface
+		if (opcode == SpvOpFunction)
+		{
+			break;
+		}
+
+		// Id declared by the instruction, 0 if none
+		VulkanU32 resultId = 0;
+		switch (opcode)
+		{
+			case SpvOpEntryPoint:
+			{
+				VkShaderStageFlagBits stage;
+				switch (words[1])
+				{
+					case SpvExecutionModelVertex: stage = VK_SHADER_STAGE_VERTEX_BIT; break;
+					case SpvExecutionModelTessellationControl: stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; break;
+					case SpvExecutionModelTessellationEvaluation: stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; break;
+					case SpvExecutionModelGeometry: stage = VK_SHADER_STAGE_GEOMETRY_BIT; break;
+					case SpvExecutionModelFragment: stage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
+					case SpvExecutionModelGLCompute: stage = VK_SHADER_STAGE_COMPUTE_BIT; break;
+					default: VULKAN_LOG_WARNING("Unsupported execution model %d", words[1]); stage = static_cast<VkShaderStageFlagBits>(0); break;
+				}
+				if (stage == 0)
+				{
+					break;
+				}
+
+				const char* name = reinterpret_cast<const char*>(words + 3);
+				const size_t nameLength = strnlen(name, (wordCount - 3) * sizeof(VulkanU32));
+				mEntryPoints.push_back({ std::string(name, nameLength), stage });
+				mStages |= stage;
+
+				// Interface ids are after the name, which is padded to the next word
+				if (stage == VK_SHADER_STAGE_VERTEX_BIT)
+				{
+					for (VulkanU32 i = 3 + static_cast<VulkanU32>(nameLength / sizeof(VulkanU32)) + 1; i < wordCount; i++)
+					{
+						if (words[i] < bound)
+						{
+							mIds[words[i]].flags |= IdFlag_VertexInterface;
+						}
+					}
+				}
+				break;
+			}
+
+			case SpvOpName:
+				if (words[1] < bound)
+				{
+					mIds[words[1]].nameOffset = static_cast<VulkanU32>(offset + 2);
+				}
+				break;
+
+			case SpvOpDecorate:
+			{
+				if (mAnnotationsBegin == 0)
+				{
+					mAnnotationsBegin = offset;
+				}
+				mAnnotationsEnd = offset + wordCount;
+
+				if (words[1] >= bound || wordCount < 3)
+				{
+					break;
+				}
+				IdInfo& info = mIds[words[1]];
+				const VulkanU32 value = (wordCount > 3) ? words[3] : 0;
+				switch (words[2])
+				{
+					case SpvDecorationDescriptorSet: info.set = value; break;
+					case SpvDecorationBinding: info.binding = value; break;
+					case SpvDecorationLocation: info.location = value; break;
+					case SpvDecorationSpecId: info.specId = value; break;
+					case SpvDecorationArrayStride: info.arrayStride = value; break;
+					case SpvDecorationBlock: info.flags |= IdFlag_Block; break;
+					case SpvDecorationBufferBlock: info.flags |= IdFlag_BufferBlock; break;
+					case SpvDecorationBuiltIn: info.flags |= IdFlag_BuiltIn; break;
+					default: break;
+				}
+				break;
+			}
+
+			case SpvOpMemberDecorate:
+				if (mAnnotationsBegin == 0)
+				{
+					mAnnotationsBegin = offset;
+				}
+				mAnnotationsEnd = offset + wordCount;
+
+				// Blocks like gl_PerVertex are not user interfaces
+				if (wordCount > 3 && words[1] < bound && words[3] == SpvDecorationBuiltIn)
+				{
+					mIds[words[1]].flags |= IdFlag_BuiltIn;
+				}
+				break;
+
+			case SpvOpTypeBool:
+			case SpvOpTypeSampler:
+				resultId = words[1];
+				break;
+
+			case SpvOpTypeInt:
+			case SpvOpTypeFloat:
+				resultId = words[1];
+				if (resultId < bound)
+				{
+					mIds[resultId].literals[0] = words[2]; // Width
+					mIds[resultId].literals[1] = (opcode == SpvOpTypeInt) ? words[3] : 1; // Signedness
+				}
+				break;
+
+			case SpvOpTypeVector:
+			case SpvOpTypeMatrix:
+			case SpvOpTypeArray:
+				resultId = words[1];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[2];
+					mIds[resultId].literals[0] = words[3]; // Component count, column count or length id
+				}
+				break;
+
+			case SpvOpTypeRuntimeArray:
+			case SpvOpTypeSampledImage:
+				resultId = words[1];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[2];
+				}
+				break;
+
+			case SpvOpTypeImage:
+				resultId = words[1];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[2];
+					for (VulkanU32 i = 0; i < 5; i++)
+					{
+						mIds[resultId].literals[i] = words[3 + i]; // Dim, depth, arrayed, multisampled, sampled
+					}
+				}
+				break;
+
+			case SpvOpTypeStruct:
+				resultId = words[1];
+				break;
+
+			case SpvOpTypePointer:
+				resultId = words[1];
+				if (resultId < bound)
+				{
+					mIds[resultId].storageClass = words[2];
+					mIds[resultId].typeId = words[3];
+				}
+				break;
+
+			case SpvOpConstantTrue:
+			case SpvOpConstantFalse:
+			case SpvOpSpecConstantTrue:
+			case SpvOpSpecConstantFalse:
+				resultId = words[2];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[1];
+					mIds[resultId].literals[0] = (opcode == SpvOpConstantTrue || opcode == SpvOpSpecConstantTrue) ? 1 : 0;
+				}
+				break;
+
+			case SpvOpConstant:
+			case SpvOpSpecConstant:
+				resultId = words[2];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[1];
+					mIds[resultId].literals[0] = (wordCount > 3) ? words[3] : 0;
+					mIds[resultId].literals[1] = (wordCount > 4) ? words[4] : 0; // High word of 64 bits constants
+				}
+				break;
+
+			case SpvOpVariable:
+				resultId = words[2];
+				if (resultId < bound)
+				{
+					mIds[resultId].typeId = words[1];
+					mIds[resultId].storageClass = words[3];
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		if (resultId != 0)
+		{
+			if (resultId >= bound)
+			{
+				VULKAN_LOG_ERROR("SPIR-V id %d is out of bounds", resultId);
+				return false;
+			}
+			mIds[resultId].opcode = opcode;
+			mIds[resultId].instruction = static_cast<VulkanU32>(offset);
+		}
+
+		offset += wordCount;
+	}
+
+	return true;
+}
+
+void VulkanShaderReflection::collectResults()
+{
+	const VulkanU32 bound = static_cast<VulkanU32>(mIds.size());
+	for (VulkanU32 id = 1; id < bound; id++)
+	{
+		const IdInfo& info = mIds[id];
+		if (info.opcode == SpvOpVariable)
+		{
+			const VulkanU32 pointeeId = mIds[info.typeId].typeId;
+			switch (info.storageClass)
+			{
+				case SpvStorageClassUniformConstant:
+				case SpvStorageClassUniform:
+				case SpvStorageClassStorageBuffer:
+				{
+					if (info.binding == VulkanInvalidU32)
+					{
+						break;
+					}
+
+					// Arrays of descriptors
+					VulkanU32 typeId = pointeeId;
+					VulkanU32 count = 1;
+					while (mIds[typeId].opcode == SpvOpTypeArray || mIds[typeId].opcode == SpvOpTypeRuntimeArray)
+					{
+						count = (mIds[typeId].opcode == SpvOpTypeArray) ? count * getArrayLength(typeId) : 0;
+						typeId = mIds[typeId].typeId;
+					}
+
+					VkDescriptorType type = getDescriptorType(info, mIds[typeId]);
+					if (type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+					{
+						break;
+					}
+
+					// Blocks are often declared without instance name
+					const char* name = getName(id);
+					mDescriptorBindings.push_back({ (info.set != VulkanInvalidU32) ? info.set : 0, info.binding, type, count, mStages, std::string((name[0] != '\0') ? name : getName(typeId)) });
+					break;
+				}
+
+				case SpvStorageClassPushConstant:
+				{
+					VulkanU32 begin;
+					VulkanU32 end;
+					getStructRange(pointeeId, begin, end);
+					const char* name = getName(id);
+					mPushConstantBlocks.push_back({ begin, end - begin, mStages, std::string((name[0] != '\0') ? name : getName(pointeeId)) });
+					break;
+				}
+
+				case SpvStorageClassInput:
+				{
+					if (info.location == VulkanInvalidU32 || (info.flags & IdFlag_VertexInterface) == 0 || (info.flags & IdFlag_BuiltIn) != 0)
+					{
+						break;
+					}
+					mVertexInputs.push_back({ info.location, getVertexFormat(pointeeId), getTypeSize(pointeeId, 0), std::string(getName(id)) });
+					break;
+				}
+
+				default:
+					break;
+			}
+		}
+		else if (info.specId != VulkanInvalidU32 && (info.opcode == SpvOpSpecConstant || info.opcode == SpvOpSpecConstantTrue || info.opcode == SpvOpSpecConstantFalse))
+		{
+			const VulkanU32 size = getTypeSize(info.typeId, 0);
+			VulkanU64 defaultValue = info.literals[0];
+			if (size > sizeof(VulkanU32))
+			{
+				defaultValue |= static_cast<VulkanU64>(info.literals[1]) << 32;
+			}
+			mSpecializationConstants.push_back({ info.specId, getScalarType(info.typeId), size, defaultValue, mStages, std::string(getName(id)) });
+		}
+	}
+
+	std::sort(mDescriptorBindings.begin(), mDescriptorBindings.end(), [](const VulkanShaderDescriptorBinding& a, const VulkanShaderDescriptorBinding& b) { return a.set < b.set || (a.set == b.set && a.binding < b.binding); });
+	std::sort(mSpecializationConstants.begin(), mSpecializationConstants.end(), [](const VulkanShaderSpecializationConstant& a, const VulkanShaderSpecializationConstant& b) { return a.constantId < b.constantId; });
+	std::sort(mVertexInputs.begin(), mVertexInputs.end(), [](const VulkanShaderVertexInput& a, const VulkanShaderVertexInput& b) { return a.location < b.location; });
+}
+
+VkDescriptorType VulkanShaderReflection::getDescriptorType(const IdInfo& variable, const IdInfo& type) const
+{
+	switch (variable.storageClass)
+	{
+		case SpvStorageClassStorageBuffer:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+		case SpvStorageClassUniform:
+			// Before SPIR-V 1.3, storage buffers are uniform BufferBlocks
+			return ((type.flags & IdFlag_BufferBlock) != 0) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+		case SpvStorageClassUniformConstant:
+			switch (type.opcode)
+			{
+				case SpvOpTypeSampler:
+					return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+				case SpvOpTypeSampledImage:
+					return (mIds[type.typeId].literals[0] == SpvDimBuffer) ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+				case SpvOpTypeImage:
+				{
+					// Sampled is 1 for images used with a sampler, 2 for storage images
+					const bool storage = (type.literals[4] == 2);
+					if (type.literals[0] == SpvDimSubpassData)
+					{
+						return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+					}
+					if (type.literals[0] == SpvDimBuffer)
+					{
+						return (storage) ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+					}
+					return (storage) ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				}
+
+				default:
+					break;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+}
+
+VulkanShaderScalarType VulkanShaderReflection::getScalarType(VulkanU32 typeId) const
+{
+	switch (mIds[typeId].opcode)
+	{
+		case SpvOpTypeBool: return VulkanShaderScalarType::Bool;
+		case SpvOpTypeInt: return (mIds[typeId].literals[1] != 0) ? VulkanShaderScalarType::Int : VulkanShaderScalarType::UInt;
+		case SpvOpTypeFloat: return VulkanShaderScalarType::Float;
+		default: return VulkanShaderScalarType::Unknown;
+	}
+}
+
+VulkanU32 VulkanShaderReflection::getTypeSize(VulkanU32 typeId, VulkanU32 matrixStride) const
+{
+	const IdInfo& type = mIds[typeId];
+	switch (type.opcode)
+	{
+		case SpvOpTypeBool:
+			return sizeof(VkBool32);
+
+		case SpvOpTypeInt:
+		case SpvOpTypeFloat:
+			return type.literals[0] / 8;
+
+		case SpvOpTypeVector:
+			return type.literals[0] * getTypeSize(type.typeId, 0);
+
+		case SpvOpTypeMatrix:
+			// The stride is only known for the members of blocks
+			return type.literals[0] * ((matrixStride != 0) ? matrixStride : getTypeSize(type.typeId, 0));
+
+		case SpvOpTypeArray:
+			return getArrayLength(typeId) * ((type.arrayStride != 0) ? type.arrayStride : getTypeSize(type.typeId, matrixStride));
+
+		case SpvOpTypeStruct:
+		{
+			VulkanU32 begin;
+			VulkanU32 end;
+			getStructRange(typeId, begin, end);
+			return end;
+		}
+
+		default:
+			// Runtime arrays have no size
+			return 0;
+	}
+}
+
+VulkanU32 VulkanShaderReflection::getArrayLength(VulkanU32 typeId) const
+{
+	// The length is a constant, possibly a specialization constant in which case its default value is used
+	const IdInfo& length = mIds[mIds[typeId].literals[0]];
+	return length.literals[0];
+}
+
+void VulkanShaderReflection::getStructRange(VulkanU32 structId, VulkanU32& begin, VulkanU32& end) const
+{
+	begin = 0;
+	end = 0;
+
+	const IdInfo& type = mIds[structId];
+	if (type.opcode != SpvOpTypeStruct)
+	{
+		return;
+	}
+
+	// Scanning the annotations for each member is cheaper than storing the member decorations of all the structs
+	const VulkanU32 memberCount = (mCode[type.instruction] >> SpvWordCountShift) - 2;
+	begin = VulkanInvalidU32;
+	for (VulkanU32 member = 0; member < memberCount; member++)
+	{
+		VulkanU32 memberOffset = 0;
+		VulkanU32 matrixStride = 0;
+		bool rowMajor = false;
+		size_t offset = mAnnotationsBegin;
+		while (offset < mAnnotationsEnd)
+		{
+			const VulkanU32* words = mCode + offset;
+			const VulkanU32 wordCount = words[0] >> SpvWordCountShift;
+			if ((words[0] & SpvOpCodeMask) == SpvOpMemberDecorate && words[1] == structId && words[2] == member)
+			{
+				switch (words[3])
+				{
+					case SpvDecorationOffset: memberOffset = words[4]; break;
+					case SpvDecorationMatrixStride: matrixStride = words[4]; break;
+					case SpvDecorationRowMajor: rowMajor = true; break;
+					default: break;
+				}
+			}
+			offset += wordCount;
+		}
+
+		const VulkanU32 memberTypeId = mCode[type.instruction + 2 + member];
+		VulkanU32 memberSize;
+		if (rowMajor && mIds[memberTypeId].opcode == SpvOpTypeMatrix)
+		{
+			// The stride is between the rows, one per component of a column
+			memberSize = mIds[mIds[memberTypeId].typeId].literals[0] * matrixStride;
+		}
+		else
+		{
+			memberSize = getTypeSize(memberTypeId, matrixStride);
+		}
+
+		begin = std::min(begin, memberOffset);
+		end = std::max(end, memberOffset + memberSize);
+	}
+
+	if (begin == VulkanInvalidU32)
+	{
+		begin = 0;
+	}
+}
+
+VkFormat VulkanShaderReflection::getVertexFormat(VulkanU32 typeId) const
+{
+	VulkanU32 componentCount = 1;
+	VulkanU32 componentTypeId = typeId;
+	if (mIds[typeId].opcode == SpvOpTypeMatrix)
+	{
+		// Each column takes a location
+		componentTypeId = mIds[typeId].typeId;
+	}
+	if (mIds[componentTypeId].opcode == SpvOpTypeVector)
+	{
+		componentCount = mIds[componentTypeId].literals[0];
+		componentTypeId = mIds[componentTypeId].typeId;
+	}
+	if (componentCount < 1 || componentCount > 4)
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	static const VkFormat float16Formats[] = { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT };
+	static const VkFormat float32Formats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat float64Formats[] = { VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT };
+	static const VkFormat int32Formats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat uint32Formats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+	const IdInfo& componentType = mIds[componentTypeId];
+	const VulkanU32 width = componentType.literals[0];
+	switch (componentType.opcode)
+	{
+		case SpvOpTypeFloat:
+			if (width == 16) return float16Formats[componentCount - 1];
+			if (width == 32) return float32Formats[componentCount - 1];
+			if (width == 64) return float64Formats[componentCount - 1];
+			break;
+
+		case SpvOpTypeInt:
+			if (width == 32) return (componentType.literals[1] != 0) ? int32Formats[componentCount - 1] : uint32Formats[componentCount - 1];
+			break;
+
+		default:
+			break;
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+const char* VulkanShaderReflection::getName(VulkanU32 id) const
+{
+	return (mIds[id].nameOffset != 0) ? reinterpret_cast<const char*>(mCode + mIds[id].nameOffset) : "";
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+#include <string>
+
+// TODO : Storage image formats
+// TODO : Push constant blocks per entry point when a module has several of them
+// TODO : Dynamic uniform/storage buffers (not visible in SPIR-V, needs a hint from the application)
+
+VULKAN_NAMESPACE_BEGIN
+
+enum class VulkanShaderScalarType
+{
+	Bool,
+	Int,
+	UInt,
+	Float,
+	Unknown
+};
+
+struct VulkanShaderEntryPoint
+{
+	std::string name;
+	VkShaderStageFlagBits stage;
+};
+
+struct VulkanShaderDescriptorBinding
+{
+	VulkanU32 set;
+	VulkanU32 binding;
+	VkDescriptorType type;
+	VulkanU32 count; // 0 for runtime arrays
+	VkShaderStageFlags stages;
+	std::string name;
+};
+
+struct VulkanShaderPushConstantBlock
+{
+	VulkanU32 offset; // Offset of the first member
+	VulkanU32 size; // From the offset to the end of the last member
+	VkShaderStageFlags stages;
+	std::string name;
+};
+
+struct VulkanShaderSpecializationConstant
+{
+	VulkanU32 constantId;
+	VulkanShaderScalarType type;
+	VulkanU32 size; // In bytes, as expected in VkSpecializationMapEntry
+	VulkanU64 defaultValue; // Raw bits of the default value
+	VkShaderStageFlags stages;
+	std::string name;
+};
+
+struct VulkanShaderVertexInput
+{
+	VulkanU32 location;
+	VkFormat format;
+	VulkanU32 size; // In bytes
+	std::string name;
+};
+
+// Reads the interface of a SPIR-V module without any external library
+// The module is parsed in a single pass over the instructions, with one small record per id
+// The records are kept between the calls, so reflecting many modules with the same object doesn't allocate once warmed up
+// The stages of the results are the stages of the entry points of the module
+class VulkanShaderReflection
+{
+	public:
+		VulkanShaderReflection();
+
+		bool reflect(const std::vector<unsigned char>& spirvBlob);
+		bool reflect(const VulkanU32* code, size_t wordCount);
+		void clear();
+
+		// Combines the reflection of another module of the same pipeline
+		// The bindings and the specialization constants used by several stages are merged, and their types must match
+		bool merge(const VulkanShaderReflection& other);
+
+		VkShaderStageFlags getStages() const;
+		const std::vector<VulkanShaderEntryPoint>& getEntryPoints() const;
+		const std::vector<VulkanShaderDescriptorBinding>& getDescriptorBindings() const; // Sorted by set and binding
+		const std::vector<VulkanShaderPushConstantBlock>& getPushConstantBlocks() const;
+		const std::vector<VulkanShaderSpecializationConstant>& getSpecializationConstants() const; // Sorted by constant id
+		const std::vector<VulkanShaderVertexInput>& getVertexInputs() const; // Sorted by location
+
+		const VulkanShaderDescriptorBinding* findDescriptorBinding(VulkanU32 set, VulkanU32 binding) const;
+		const VulkanShaderSpecializationConstant* findSpecializationConstant(VulkanU32 constantId) const;
+
+		// The sets are numbered from 0 to getDescriptorSetCount() - 1, the sets not used by the shaders are empty
+		VulkanU32 getDescriptorSetCount() const;
+		void getDescriptorSetLayoutBindings(VulkanU32 set, std::vector<VkDescriptorSetLayoutBinding>& bindings) const;
+		void getPushConstantRanges(std::vector<VkPushConstantRange>& ranges) const;
+
+		// One layout per set, empty sets included so the set numbers match the shaders
+		bool createDescriptorSetLayouts(VulkanDevice& device, std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts) const;
+		VulkanPipelineLayoutPtr createPipelineLayout(VulkanDevice& device, const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts) const;
+
+		void print() const;
+
+	private:
+		enum IdFlags
+		{
+			IdFlag_Block = 1,
+			IdFlag_BufferBlock = 2,
+			IdFlag_BuiltIn = 4,
+			IdFlag_VertexInterface = 8
+		};
+
+		// Everything the reflection needs to know about an id, 64 bytes
+		struct IdInfo
+		{
+			VulkanU32 opcode; // Instruction that declares the id, 0 if not declared yet
+			VulkanU32 instruction; // Offset in words of the declaring instruction
+			VulkanU32 typeId; // Result type for variables and constants, pointee for pointers, element for arrays, vectors and matrices
+			VulkanU32 storageClass; // Variables and pointers
+			VulkanU32 set;
+			VulkanU32 binding;
+			VulkanU32 location;
+			VulkanU32 specId;
+			VulkanU32 arrayStride;
+			VulkanU32 flags;
+			VulkanU32 nameOffset; // Offset in words of the OpName string, 0 if unnamed
+			VulkanU32 literals[5]; // Width and signedness for scalars, count for vectors and matrices, length id for arrays, dim/depth/arrayed/ms/sampled for images, value for constants
+		};
+
+		bool parse();
+		void collectResults();
+
+		VkDescriptorType getDescriptorType(const IdInfo& variable, const IdInfo& type) const;
+		VulkanShaderScalarType getScalarType(VulkanU32 typeId) const;
+		VulkanU32 getTypeSize(VulkanU32 typeId, VulkanU32 matrixStride) const;
+		VulkanU32 getArrayLength(VulkanU32 typeId) const;
+		void getStructRange(VulkanU32 structId, VulkanU32& begin, VulkanU32& end) const;
+		VkFormat getVertexFormat(VulkanU32 typeId) const;
+		const char* getName(VulkanU32 id) const;
+
+		// Only valid during reflect()
+		const VulkanU32* mCode;
+		size_t mWordCount;
+		size_t mAnnotationsBegin;
+		size_t mAnnotationsEnd;
+
+		std::vector<IdInfo> mIds;
+
+		VkShaderStageFlags mStages;
+		std::vector<VulkanShaderEntryPoint> mEntryPoints;
+		std::vector<VulkanShaderDescriptorBinding> mDescriptorBindings;
+		std::vector<VulkanShaderPushConstantBlock> mPushConstantBlocks;
+		std::vector<VulkanShaderSpecializationConstant> mSpecializationConstants;
+		std::vector<VulkanShaderVertexInput> mVertexInputs;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
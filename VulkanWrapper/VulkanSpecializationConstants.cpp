@@ -0,0 +1,141 @@
+#include "VulkanSpecializationConstants.hpp"
+
+#include "VulkanShaderReflection.hpp"
+
+#include <cstring>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanSpecializationConstants::VulkanSpecializationConstants()
+	: mEntries()
+	, mData()
+	, mInfo()
+{
+}
+
+VulkanSpecializationConstants::VulkanSpecializationConstants(const VulkanSpecializationConstants& other)
+	: mEntries(other.mEntries)
+	, mData(other.mData)
+	, mInfo()
+{
+}
+
+VulkanSpecializationConstants& VulkanSpecializationConstants::operator=(const VulkanSpecializationConstants& other)
+{
+	// mInfo points to the vectors of its owner, it is rebuilt by getInfo()
+	mEntries = other.mEntries;
+	mData = other.mData;
+	return *this;
+}
+
+bool VulkanSpecializationConstants::remove(VulkanU32 constantId)
+{
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (mEntries[i].constantID == constantId)
+		{
+			const VulkanU32 offset = mEntries[i].offset;
+			const VulkanU32 size = static_cast<VulkanU32>(mEntries[i].size);
+			mData.erase(mData.begin() + offset, mData.begin() + offset + size);
+			mEntries.erase(mEntries.begin() + i);
+			for (VkSpecializationMapEntry& entry : mEntries)
+			{
+				if (entry.offset > offset)
+				{
+					entry.offset -= size;
+				}
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+void VulkanSpecializationConstants::clear()
+{
+	mEntries.clear();
+	mData.clear();
+}
+
+bool VulkanSpecializationConstants::isEmpty() const
+{
+	return mEntries.empty();
+}
+
+const std::vector<VkSpecializationMapEntry>& VulkanSpecializationConstants::getEntries() const
+{
+	return mEntries;
+}
+
+const std::vector<VulkanU8>& VulkanSpecializationConstants::getData() const
+{
+	return mData;
+}
+
+const VkSpecializationInfo* VulkanSpecializationConstants::getInfo() const
+{
+	if (mEntries.empty())
+	{
+		return nullptr;
+	}
+
+	mInfo = {
+		static_cast<VulkanU32>(mEntries.size()),    // uint32_t                           mapEntryCount
+		mEntries.data(),                            // const VkSpecializationMapEntry   * pMapEntries
+		mData.size(),                               // size_t                             dataSize
+		mData.data()                                // const void                       * pData
+	};
+	return &mInfo;
+}
+
+bool VulkanSpecializationConstants::validate(const VulkanShaderReflection& reflection, VkShaderStageFlagBits stage) const
+{
+	bool valid = true;
+	for (const VkSpecializationMapEntry& entry : mEntries)
+	{
+		const VulkanShaderSpecializationConstant* constant = reflection.findSpecializationConstant(entry.constantID);
+		if (constant == nullptr || (constant->stages & stage) == 0)
+		{
+			VULKAN_LOG_WARNING("Specialization constant %d is not declared in the shader", entry.constantID);
+			valid = false;
+		}
+		else if (constant->size != entry.size)
+		{
+			VULKAN_LOG_ERROR("Specialization constant %d (%s) has %d bytes instead of %d", entry.constantID, constant->name.c_str(), static_cast<VulkanU32>(entry.size), constant->size);
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+void VulkanSpecializationConstants::setData(VulkanU32 constantId, const void* data, VulkanU32 size)
+{
+	size_t index = 0;
+	while (index < mEntries.size() && mEntries[index].constantID < constantId)
+	{
+		index++;
+	}
+
+	if (index < mEntries.size() && mEntries[index].constantID == constantId)
+	{
+		if (mEntries[index].size == size)
+		{
+			std::memcpy(mData.data() + mEntries[index].offset, data, size);
+			return;
+		}
+		// The type changed
+		remove(constantId);
+	}
+
+	// The data follows the order of the entries
+	const VulkanU32 offset = (index < mEntries.size()) ? mEntries[index].offset : static_cast<VulkanU32>(mData.size());
+	const VulkanU8* bytes = static_cast<const VulkanU8*>(data);
+	mData.insert(mData.begin() + offset, bytes, bytes + size);
+	for (size_t i = index; i < mEntries.size(); i++)
+	{
+		mEntries[i].offset += size;
+	}
+	mEntries.insert(mEntries.begin() + index, { constantId, offset, size });
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+
+#include <type_traits>
+
+VULKAN_NAMESPACE_BEGIN
+
+// Values of the specialization constants of one shader stage
+// The entries are kept sorted by constant id, so the same values give the same data whatever the order they are set in
+class VulkanSpecializationConstants
+{
+	public:
+		VulkanSpecializationConstants();
+		VulkanSpecializationConstants(const VulkanSpecializationConstants& other);
+		VulkanSpecializationConstants& operator=(const VulkanSpecializationConstants& other);
+
+		// bool is stored as a VkBool32, as expected by the shaders
+		template <typename T>
+		void set(VulkanU32 constantId, T value)
+		{
+			static_assert(std::is_same<T, bool>::value || std::is_same<T, VulkanI32>::value || std::is_same<T, VulkanU32>::value || std::is_same<T, VulkanF32>::value
+				|| std::is_same<T, VulkanI64>::value || std::is_same<T, VulkanU64>::value || std::is_same<T, VulkanF64>::value, "Specialization constants are bool, 32 or 64 bits scalars");
+			if (std::is_same<T, bool>::value)
+			{
+				const VkBool32 boolValue = (value) ? VK_TRUE : VK_FALSE;
+				setData(constantId, &boolValue, sizeof(VkBool32));
+			}
+			else
+			{
+				setData(constantId, &value, sizeof(T));
+			}
+		}
+		bool remove(VulkanU32 constantId);
+		void clear();
+
+		bool isEmpty() const;
+		const std::vector<VkSpecializationMapEntry>& getEntries() const;
+		const std::vector<VulkanU8>& getData() const;
+
+		// nullptr when empty, valid until the next modification
+		const VkSpecializationInfo* getInfo() const;
+
+		// Each constant must be declared in the stage with the same size
+		bool validate(const VulkanShaderReflection& reflection, VkShaderStageFlagBits stage) const;
+
+	private:
+		void setData(VulkanU32 constantId, const void* data, VulkanU32 size);
+
+		std::vector<VkSpecializationMapEntry> mEntries;
+		std::vector<VulkanU8> mData;
+		mutable VkSpecializationInfo mInfo;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -57,6 +57,11 @@ bool VulkanSwapchain::acquireImageIndex(uint64_t timeout, VkSemaphore semaphore,
 	}
 }
 
+VulkanImage* VulkanSwapchain::getImage(uint32_t index)
+{
+	return (index < mSwapchainImages.size()) ? mSwapchainImages[index].get() : nullptr;
+}
+
 VkImage VulkanSwapchain::getImageHandle(uint32_t index) const
 {
 	uint32_t size = (uint32_t)mSwapchainImages.size();
@@ -21,6 +21,7 @@ class VulkanSwapchain : public VulkanObject<VulkanObjectType_Swapchain>
 		bool acquireImageIndex(uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t& imageIndex);
 		// TODO : Maybe acquireImage directly instead of index ?
 
+		VulkanImage* getImage(uint32_t index);
 		VkImage getImageHandle(uint32_t index) const;
 		VkImageView getImageViewHandle(uint32_t index) const;
 
@@ -0,0 +1,678 @@
+#include "VulkanUploadManager.hpp"
+
+#include "VulkanDevice.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanImage.hpp"
+#include "VulkanMemoryBlock.hpp"
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanCommandPool.hpp"
+#include "VulkanFence.hpp"
+#include "VulkanSemaphore.hpp"
+#include "VulkanQueue.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+VULKAN_NAMESPACE_BEGIN
+
+VulkanUploadManagerPtr VulkanUploadManager::createUploadManager(VulkanDevice& device, VulkanQueue* transferQueue, VulkanQueue* ownerQueue, VkDeviceSize chunkSize)
+{
+	VulkanUploadManagerPtr uploadManager(new VulkanUploadManager(device, transferQueue, ownerQueue, chunkSize));
+	if (uploadManager != nullptr)
+	{
+		if (!uploadManager->init())
+		{
+			uploadManager.reset();
+		}
+	}
+	return uploadManager;
+}
+
+VulkanUploadManager::~VulkanUploadManager()
+{
+	release();
+}
+
+bool VulkanUploadManager::uploadBuffer(VulkanBuffer* buffer, VkDeviceSize offset, VkDeviceSize dataSize, const void* data, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages)
+{
+	VULKAN_ASSERT(buffer != nullptr, "Invalid buffer");
+	VULKAN_ASSERT(offset + dataSize <= buffer->getSize(), "Upload outside of the buffer");
+
+	// Buffer copies don't have any alignment requirement
+	VulkanU32 chunk;
+	VkDeviceSize stagingOffset;
+	if (!allocateStaging(dataSize, 16, chunk, stagingOffset) || !writeStaging(chunk, stagingOffset, dataSize, data))
+	{
+		return false;
+	}
+
+	mRecordingBatch->bufferUploads.push_back({
+		buffer,                   // VulkanBuffer*          buffer
+		chunk,                    // VulkanU32              chunk
+		{                         // VkBufferCopy           region
+			stagingOffset,            // VkDeviceSize     srcOffset
+			offset,                   // VkDeviceSize     dstOffset
+			dataSize                  // VkDeviceSize     size
+		},
+		currentAccess,            // VkAccessFlags          currentAccess
+		newAccess,                // VkAccessFlags          newAccess
+		generatingStages,         // VkPipelineStageFlags   generatingStages
+		consumingStages           // VkPipelineStageFlags   consumingStages
+	});
+
+	return true;
+}
+
+bool VulkanUploadManager::uploadImage(VulkanImage* image, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D size, VkDeviceSize dataSize, const void* data, VkImageLayout currentLayout, VkImageLayout newLayout, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkImageAspectFlags aspect, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages)
+{
+	VULKAN_ASSERT(image != nullptr, "Invalid image");
+
+	// The buffer offset of an image copy must be a multiple of the texel block size and of 4, and should be one of optimalBufferCopyOffsetAlignment
+	const VkDeviceSize texelBlockSize = getTexelBlockSize(image->getFormat(), subresource.aspectMask);
+	const VkDeviceSize optimalAlignment = std::max<VkDeviceSize>(mDevice.getProperties().limits.optimalBufferCopyOffsetAlignment, 1);
+	const VkDeviceSize alignment = getLeastCommonMultiple(getLeastCommonMultiple(texelBlockSize, 4), optimalAlignment);
+
+	VulkanU32 chunk;
+	VkDeviceSize stagingOffset;
+	if (!allocateStaging(dataSize, alignment, chunk, stagingOffset) || !writeStaging(chunk, stagingOffset, dataSize, data))
+	{
+		return false;
+	}
+
+	mRecordingBatch->imageUploads.push_back({
+		image,                    // VulkanImage*           image
+		chunk,                    // VulkanU32              chunk
+		{                         // VkBufferImageCopy      region
+			stagingOffset,            // VkDeviceSize               bufferOffset
+			0,                        // uint32_t                   bufferRowLength
+			0,                        // uint32_t                   bufferImageHeight
+			subresource,              // VkImageSubresourceLayers   imageSubresource
+			offset,                   // VkOffset3D                 imageOffset
+			size                      // VkExtent3D                 imageExtent
+		},
+		currentLayout,            // VkImageLayout          currentLayout
+		newLayout,                // VkImageLayout          newLayout
+		currentAccess,            // VkAccessFlags          currentAccess
+		newAccess,                // VkAccessFlags          newAccess
+		aspect,                   // VkImageAspectFlags     aspect
+		generatingStages,         // VkPipelineStageFlags   generatingStages
+		consumingStages           // VkPipelineStageFlags   consumingStages
+	});
+
+	return true;
+}
+
+bool VulkanUploadManager::hasPendingUploads() const
+{
+	return mRecordingBatch != nullptr && (!mRecordingBatch->bufferUploads.empty() || !mRecordingBatch->imageUploads.empty());
+}
+
+bool VulkanUploadManager::submit(VulkanUploadTicket& ticket, VulkanArrayView<VkSemaphore> signalSemaphores)
+{
+	if (!hasPendingUploads() && signalSemaphores.empty())
+	{
+		ticket = mLastSubmittedTicket;
+		return true;
+	}
+
+	Batch* batch = getRecordingBatch();
+	if (batch == nullptr)
+	{
+		return false;
+	}
+
+	// The staging writes have been delayed to be flushed once per chunk
+	for (VulkanBufferPtr& chunk : batch->chunks)
+	{
+		if (!chunk->getMemoryBlock()->flush())
+		{
+			return false;
+		}
+	}
+
+	if (!recordBatch(*batch))
+	{
+		return false;
+	}
+
+	if (transfersOwnership())
+	{
+		if (!mTransferQueue->submitCommandBuffers({ batch->transferCommandBuffer.get() }, {}, { batch->ownershipSemaphore->getHandle() }, nullptr))
+		{
+			return false;
+		}
+		if (!mOwnerQueue->submitCommandBuffers({ batch->ownerCommandBuffer.get() }, { { batch->ownershipSemaphore->getHandle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT } }, signalSemaphores, batch->fence.get()))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (!mTransferQueue->submitCommandBuffers({ batch->transferCommandBuffer.get() }, {}, signalSemaphores, batch->fence.get()))
+		{
+			return false;
+		}
+	}
+
+	batch->ticket = ++mLastSubmittedTicket;
+	ticket = batch->ticket;
+	mSubmittedBatches.push_back(std::move(mRecordingBatch));
+
+	return true;
+}
+
+bool VulkanUploadManager::isCompleted(VulkanUploadTicket ticket)
+{
+	while (!mSubmittedBatches.empty() && mSubmittedBatches.front()->fence->isSignaled())
+	{
+		mLastCompletedTicket = mSubmittedBatches.front()->ticket;
+		recycleBatch(std::move(mSubmittedBatches.front()));
+		mSubmittedBatches.erase(mSubmittedBatches.begin());
+	}
+
+	return ticket <= mLastCompletedTicket;
+}
+
+bool VulkanUploadManager::wait(VulkanUploadTicket ticket, VulkanU64 timeout)
+{
+	if (ticket > mLastSubmittedTicket)
+	{
+		VULKAN_LOG_ERROR("Waiting on an upload ticket that has not been submitted");
+		return false;
+	}
+
+	for (BatchPtr& batch : mSubmittedBatches)
+	{
+		if (batch->ticket > ticket)
+		{
+			break;
+		}
+		if (!batch->fence->wait(timeout))
+		{
+			return false;
+		}
+	}
+
+	return isCompleted(ticket);
+}
+
+bool VulkanUploadManager::waitIdle(VulkanU64 timeout)
+{
+	return wait(mLastSubmittedTicket, timeout);
+}
+
+VulkanUploadTicket VulkanUploadManager::getLastSubmittedTicket() const
+{
+	return mLastSubmittedTicket;
+}
+
+VulkanUploadTicket VulkanUploadManager::getLastCompletedTicket() const
+{
+	return mLastCompletedTicket;
+}
+
+VulkanQueue* VulkanUploadManager::getTransferQueue() const
+{
+	return mTransferQueue;
+}
+
+VulkanQueue* VulkanUploadManager::getOwnerQueue() const
+{
+	return mOwnerQueue;
+}
+
+bool VulkanUploadManager::transfersOwnership() const
+{
+	return mTransferQueue->getFamilyIndex() != mOwnerQueue->getFamilyIndex();
+}
+
+VulkanUploadManager::VulkanUploadManager(VulkanDevice& device, VulkanQueue* transferQueue, VulkanQueue* ownerQueue, VkDeviceSize chunkSize)
+	: mDevice(device)
+	, mTransferQueue(transferQueue)
+	, mOwnerQueue((ownerQueue != nullptr) ? ownerQueue : transferQueue)
+	, mChunkSize(chunkSize)
+	, mTransferCommandPool(nullptr)
+	, mOwnerCommandPool(nullptr)
+	, mRecordingBatch(nullptr)
+	, mSubmittedBatches()
+	, mFreeBatches()
+	, mFreeChunks()
+	, mLastSubmittedTicket(0)
+	, mLastCompletedTicket(0)
+{
+}
+
+bool VulkanUploadManager::init()
+{
+	if (mTransferQueue == nullptr || (!mTransferQueue->hasTransferFlag() && !mTransferQueue->hasGraphicsFlag() && !mTransferQueue->hasComputeFlag()))
+	{
+		VULKAN_LOG_ERROR("The upload manager needs a queue supporting transfer operations");
+		return false;
+	}
+
+	mTransferCommandPool = mDevice.createCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, mTransferQueue->getFamilyIndex());
+	if (mTransferCommandPool == nullptr || !mTransferCommandPool->isInitialized())
+	{
+		return false;
+	}
+
+	if (transfersOwnership())
+	{
+		mOwnerCommandPool = mDevice.createCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, mOwnerQueue->getFamilyIndex());
+		if (mOwnerCommandPool == nullptr || !mOwnerCommandPool->isInitialized())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void VulkanUploadManager::release()
+{
+	// The staging chunks and the command buffers must not be destroyed while in use
+	for (BatchPtr& batch : mSubmittedBatches)
+	{
+		batch->fence->wait(VulkanInvalidU64);
+	}
+
+	mRecordingBatch.reset();
+	mSubmittedBatches.clear();
+	mFreeBatches.clear();
+	mFreeChunks.clear();
+	mTransferCommandPool.reset();
+	mOwnerCommandPool.reset();
+}
+
+VulkanUploadManager::Batch* VulkanUploadManager::getRecordingBatch()
+{
+	if (mRecordingBatch != nullptr)
+	{
+		return mRecordingBatch.get();
+	}
+
+	if (!mFreeBatches.empty())
+	{
+		mRecordingBatch = std::move(mFreeBatches.back());
+		mFreeBatches.pop_back();
+		return mRecordingBatch.get();
+	}
+
+	BatchPtr batch(new Batch());
+	batch->ticket = 0;
+	batch->lastChunkUsedSize = 0;
+	batch->transferCommandBuffer = mTransferCommandPool->allocatePrimaryCommandBuffer();
+	batch->fence = mDevice.createFence(false);
+	if (batch->transferCommandBuffer == nullptr || batch->fence == nullptr)
+	{
+		return nullptr;
+	}
+	if (transfersOwnership())
+	{
+		batch->ownerCommandBuffer = mOwnerCommandPool->allocatePrimaryCommandBuffer();
+		batch->ownershipSemaphore = mDevice.createSemaphore();
+		if (batch->ownerCommandBuffer == nullptr || batch->ownershipSemaphore == nullptr)
+		{
+			return nullptr;
+		}
+	}
+
+	mRecordingBatch = std::move(batch);
+	return mRecordingBatch.get();
+}
+
+bool VulkanUploadManager::allocateStaging(VkDeviceSize size, VkDeviceSize alignment, VulkanU32& chunk, VkDeviceSize& offset)
+{
+	Batch* batch = getRecordingBatch();
+	if (batch == nullptr)
+	{
+		return false;
+	}
+
+	if (!batch->chunks.empty())
+	{
+		const VkDeviceSize alignedOffset = (batch->lastChunkUsedSize + alignment - 1) / alignment * alignment;
+		if (alignedOffset + size <= batch->chunks.back()->getSize())
+		{
+			chunk = static_cast<VulkanU32>(batch->chunks.size() - 1);
+			offset = alignedOffset;
+			batch->lastChunkUsedSize = alignedOffset + size;
+			return true;
+		}
+	}
+
+	VulkanBufferPtr newChunk;
+	if (size <= mChunkSize && !mFreeChunks.empty())
+	{
+		newChunk = std::move(mFreeChunks.back());
+		mFreeChunks.pop_back();
+	}
+	else
+	{
+		// Bigger uploads get their own chunk, it will not be reused
+		newChunk = mDevice.createBuffer(std::max(size, mChunkSize), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+		if (newChunk == nullptr || newChunk->allocateMemoryBlock(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == nullptr)
+		{
+			return false;
+		}
+		if (!newChunk->getMemoryBlock()->isPersistentlyMapped() && !newChunk->getMemoryBlock()->mapPersistently())
+		{
+			return false;
+		}
+	}
+
+	batch->chunks.push_back(std::move(newChunk));
+	batch->lastChunkUsedSize = size;
+	chunk = static_cast<VulkanU32>(batch->chunks.size() - 1);
+	offset = 0;
+	return true;
+}
+
+bool VulkanUploadManager::writeStaging(VulkanU32 chunk, VkDeviceSize offset, VkDeviceSize dataSize, const void* data)
+{
+	VulkanBuffer* buffer = mRecordingBatch->chunks[chunk].get();
+	return buffer->getMemoryBlock()->writeRange(buffer->getOffsetInMemoryBlock() + offset, dataSize, data, false);
+}
+
+bool VulkanUploadManager::recordBatch(Batch& batch)
+{
+	const bool ownershipTransfer = transfersOwnership();
+	const VulkanU32 transferFamily = mTransferQueue->getFamilyIndex();
+	const VulkanU32 ownerFamily = mOwnerQueue->getFamilyIndex();
+	const VulkanU32 currentFamily = ownershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED;
+	const VulkanU32 newFamily = ownershipTransfer ? ownerFamily : VK_QUEUE_FAMILY_IGNORED;
+
+	// One transition per resource, even when several regions of it are uploaded
+	std::vector<VulkanBufferTransition> preBufferTransitions;
+	std::vector<VulkanBufferTransition> postBufferTransitions;
+	std::unordered_map<VulkanBuffer*, size_t> bufferTransitionIndices;
+	VkPipelineStageFlags generatingStages = 0;
+	VkPipelineStageFlags consumingStages = 0;
+	for (const BufferUpload& upload : batch.bufferUploads)
+	{
+		generatingStages |= upload.generatingStages;
+		consumingStages |= upload.consumingStages;
+
+		auto itr = bufferTransitionIndices.find(upload.buffer);
+		if (itr != bufferTransitionIndices.end())
+		{
+			preBufferTransitions[itr->second].currentAccess |= upload.currentAccess;
+			postBufferTransitions[itr->second].newAccess |= upload.newAccess;
+			continue;
+		}
+
+		bufferTransitionIndices[upload.buffer] = preBufferTransitions.size();
+		preBufferTransitions.push_back({
+			upload.buffer,                // Buffer*          buffer
+			upload.currentAccess,         // VkAccessFlags    currentAccess
+			VK_ACCESS_TRANSFER_WRITE_BIT, // VkAccessFlags    newAccess
+			VK_QUEUE_FAMILY_IGNORED,      // uint32_t         currentQueueFamily
+			VK_QUEUE_FAMILY_IGNORED       // uint32_t         newQueueFamily
+		});
+		postBufferTransitions.push_back({
+			upload.buffer,                // Buffer*          buffer
+			VK_ACCESS_TRANSFER_WRITE_BIT, // VkAccessFlags    currentAccess
+			upload.newAccess,             // VkAccessFlags    newAccess
+			currentFamily,                // uint32_t         currentQueueFamily
+			newFamily                     // uint32_t         newQueueFamily
+		});
+	}
+
+	std::vector<VulkanImageTransition> preImageTransitions;
+	std::vector<VulkanImageTransition> postImageTransitions;
+	std::unordered_map<VulkanImage*, size_t> imageTransitionIndices;
+	for (const ImageUpload& upload : batch.imageUploads)
+	{
+		generatingStages |= upload.generatingStages;
+		consumingStages |= upload.consumingStages;
+
+		auto itr = imageTransitionIndices.find(upload.image);
+		if (itr != imageTransitionIndices.end())
+		{
+			preImageTransitions[itr->second].currentAccess |= upload.currentAccess;
+			postImageTransitions[itr->second].newAccess |= upload.newAccess;
+			continue;
+		}
+
+		imageTransitionIndices[upload.image] = preImageTransitions.size();
+		preImageTransitions.push_back({
+			upload.image->getHandle(),                // VkImage            image
+			upload.currentAccess,                     // VkAccessFlags      currentAccess
+			VK_ACCESS_TRANSFER_WRITE_BIT,             // VkAccessFlags      newAccess
+			upload.currentLayout,                     // VkImageLayout      currentLayout
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // VkImageLayout      newLayout
+			VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           currentQueueFamily
+			VK_QUEUE_FAMILY_IGNORED,                  // uint32_t           newQueueFamily
+			upload.aspect                             // VkImageAspectFlags aspect
+		});
+		postImageTransitions.push_back({
+			upload.image->getHandle(),                // VkImage            image
+			VK_ACCESS_TRANSFER_WRITE_BIT,             // VkAccessFlags      currentAccess
+			upload.newAccess,                         // VkAccessFlags      newAccess
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,     // VkImageLayout      currentLayout
+			upload.newLayout,                         // VkImageLayout      newLayout
+			currentFamily,                            // uint32_t           currentQueueFamily
+			newFamily,                                // uint32_t           newQueueFamily
+			upload.aspect                             // VkImageAspectFlags aspect
+		});
+	}
+
+	if (ownershipTransfer)
+	{
+		// The stages and accesses of the owner queue may not be supported by the transfer queue
+		// The resources are expected to be new or already owned by the transfer queue family
+		generatingStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		for (VulkanBufferTransition& transition : preBufferTransitions)
+		{
+			transition.currentAccess = 0;
+		}
+		for (VulkanImageTransition& transition : preImageTransitions)
+		{
+			transition.currentAccess = 0;
+		}
+	}
+	if (generatingStages == 0)
+	{
+		generatingStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+	if (consumingStages == 0)
+	{
+		consumingStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+
+	VulkanCommandBuffer* commandBuffer = batch.transferCommandBuffer.get();
+	if (!commandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
+	{
+		return false;
+	}
+
+	commandBuffer->setBufferMemoryBarrier(generatingStages, VK_PIPELINE_STAGE_TRANSFER_BIT, preBufferTransitions);
+	commandBuffer->setImageMemoryBarrier(generatingStages, VK_PIPELINE_STAGE_TRANSFER_BIT, preImageTransitions);
+
+	// Consecutive uploads from the same chunk to the same resource share a copy command
+	std::vector<VkBufferCopy> bufferRegions;
+	for (size_t i = 0; i < batch.bufferUploads.size(); i++)
+	{
+		const BufferUpload& upload = batch.bufferUploads[i];
+		bufferRegions.push_back(upload.region);
+
+		const bool last = (i + 1 == batch.bufferUploads.size());
+		if (last || batch.bufferUploads[i + 1].buffer != upload.buffer || batch.bufferUploads[i + 1].chunk != upload.chunk)
+		{
+			commandBuffer->copyDataBetweenBuffers(batch.chunks[upload.chunk].get(), upload.buffer, bufferRegions);
+			bufferRegions.clear();
+		}
+	}
+
+	std::vector<VkBufferImageCopy> imageRegions;
+	for (size_t i = 0; i < batch.imageUploads.size(); i++)
+	{
+		const ImageUpload& upload = batch.imageUploads[i];
+		imageRegions.push_back(upload.region);
+
+		const bool last = (i + 1 == batch.imageUploads.size());
+		if (last || batch.imageUploads[i + 1].image != upload.image || batch.imageUploads[i + 1].chunk != upload.chunk)
+		{
+			commandBuffer->copyDataFromBufferToImage(batch.chunks[upload.chunk].get(), upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageRegions);
+			imageRegions.clear();
+		}
+	}
+
+	if (ownershipTransfer)
+	{
+		// Acquire : same transitions as the release, with the destination accesses
+		std::vector<VulkanBufferTransition> acquireBufferTransitions = postBufferTransitions;
+		std::vector<VulkanImageTransition> acquireImageTransitions = postImageTransitions;
+		for (VulkanBufferTransition& transition : acquireBufferTransitions)
+		{
+			transition.currentAccess = 0;
+		}
+		for (VulkanImageTransition& transition : acquireImageTransitions)
+		{
+			transition.currentAccess = 0;
+		}
+
+		// Release : the destination accesses are ignored
+		for (VulkanBufferTransition& transition : postBufferTransitions)
+		{
+			transition.newAccess = 0;
+		}
+		for (VulkanImageTransition& transition : postImageTransitions)
+		{
+			transition.newAccess = 0;
+		}
+		commandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, postBufferTransitions);
+		commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, postImageTransitions);
+
+		VulkanCommandBuffer* ownerCommandBuffer = batch.ownerCommandBuffer.get();
+		if (!ownerCommandBuffer->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr))
+		{
+			return false;
+		}
+		ownerCommandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, consumingStages, acquireBufferTransitions);
+		ownerCommandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, consumingStages, acquireImageTransitions);
+		if (!ownerCommandBuffer->endRecording())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		commandBuffer->setBufferMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, consumingStages, postBufferTransitions);
+		commandBuffer->setImageMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, consumingStages, postImageTransitions);
+	}
+
+	// The tracked state of the buffers is updated by their barriers, the images are only known by handle there
+	const VulkanU32 imageFamily = ownershipTransfer ? mOwnerQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+	for (const ImageUpload& upload : batch.imageUploads)
+	{
+		upload.image->setCurrentState(upload.newAccess, consumingStages, upload.newLayout, imageFamily);
+	}
+
+	return commandBuffer->endRecording();
+}
+
+void VulkanUploadManager::recycleBatch(BatchPtr batch)
+{
+	for (VulkanBufferPtr& chunk : batch->chunks)
+	{
+		if (chunk->getSize() == mChunkSize)
+		{
+			mFreeChunks.push_back(std::move(chunk));
+		}
+	}
+	batch->chunks.clear();
+	batch->lastChunkUsedSize = 0;
+	batch->bufferUploads.clear();
+	batch->imageUploads.clear();
+
+	if (!batch->fence->reset() || !batch->transferCommandBuffer->reset() || (batch->ownerCommandBuffer != nullptr && !batch->ownerCommandBuffer->reset()))
+	{
+		// The batch will be recreated when needed
+		return;
+	}
+
+	mFreeBatches.push_back(std::move(batch));
+}
+
+VkDeviceSize VulkanUploadManager::getTexelBlockSize(VkFormat format, VkImageAspectFlags aspect)
+{
+	// The depth and stencil aspects are copied separately, with their own texel size
+	if ((aspect & VK_IMAGE_ASPECT_STENCIL_BIT) != 0)
+	{
+		return 1;
+	}
+	if ((aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0)
+	{
+		return (format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D16_UNORM_S8_UINT) ? 2 : 4;
+	}
+
+	if (format == VK_FORMAT_R4G4_UNORM_PACK8 || (format >= VK_FORMAT_R8_UNORM && format <= VK_FORMAT_R8_SRGB))
+	{
+		return 1;
+	}
+	if ((format >= VK_FORMAT_R4G4B4A4_UNORM_PACK16 && format <= VK_FORMAT_A1R5G5B5_UNORM_PACK16) || (format >= VK_FORMAT_R8G8_UNORM && format <= VK_FORMAT_R8G8_SRGB) || (format >= VK_FORMAT_R16_UNORM && format <= VK_FORMAT_R16_SFLOAT))
+	{
+		return 2;
+	}
+	if (format >= VK_FORMAT_R8G8B8_UNORM && format <= VK_FORMAT_B8G8R8_SRGB)
+	{
+		return 3;
+	}
+	if ((format >= VK_FORMAT_R8G8B8A8_UNORM && format <= VK_FORMAT_A2B10G10R10_SINT_PACK32) || (format >= VK_FORMAT_R16G16_UNORM && format <= VK_FORMAT_R16G16_SFLOAT) || (format >= VK_FORMAT_R32_UINT && format <= VK_FORMAT_R32_SFLOAT) || format == VK_FORMAT_B10G11R11_UFLOAT_PACK32 || format == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32)
+	{
+		return 4;
+	}
+	if (format >= VK_FORMAT_R16G16B16_UNORM && format <= VK_FORMAT_R16G16B16_SFLOAT)
+	{
+		return 6;
+	}
+	if ((format >= VK_FORMAT_R16G16B16A16_UNORM && format <= VK_FORMAT_R16G16B16A16_SFLOAT) || (format >= VK_FORMAT_R32G32_UINT && format <= VK_FORMAT_R32G32_SFLOAT) || (format >= VK_FORMAT_R64_UINT && format <= VK_FORMAT_R64_SFLOAT))
+	{
+		return 8;
+	}
+	if (format >= VK_FORMAT_R32G32B32_UINT && format <= VK_FORMAT_R32G32B32_SFLOAT)
+	{
+		return 12;
+	}
+	if ((format >= VK_FORMAT_R32G32B32A32_UINT && format <= VK_FORMAT_R32G32B32A32_SFLOAT) || (format >= VK_FORMAT_R64G64_UINT && format <= VK_FORMAT_R64G64_SFLOAT))
+	{
+		return 16;
+	}
+	if (format >= VK_FORMAT_R64G64B64_UINT && format <= VK_FORMAT_R64G64B64_SFLOAT)
+	{
+		return 24;
+	}
+	if (format >= VK_FORMAT_R64G64B64A64_UINT && format <= VK_FORMAT_R64G64B64A64_SFLOAT)
+	{
+		return 32;
+	}
+
+	// Blocks of the compressed formats
+	if ((format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK) || (format >= VK_FORMAT_BC4_UNORM_BLOCK && format <= VK_FORMAT_BC4_SNORM_BLOCK) || (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK) || (format >= VK_FORMAT_EAC_R11_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11_SNORM_BLOCK))
+	{
+		return 8;
+	}
+	if (format >= VK_FORMAT_BC2_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+	{
+		return 16;
+	}
+
+	// Unknown formats (extensions) : 16 is a multiple of the usual texel sizes
+	return 16;
+}
+
+VkDeviceSize VulkanUploadManager::getLeastCommonMultiple(VkDeviceSize a, VkDeviceSize b)
+{
+	VkDeviceSize x = a;
+	VkDeviceSize y = b;
+	while (y != 0)
+	{
+		const VkDeviceSize remainder = x % y;
+		x = y;
+		y = remainder;
+	}
+	return a / x * b;
+}
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "VulkanFunctions.hpp"
+#include "VulkanContainers.hpp"
+
+// TODO : Mipmaps generation after an image upload
+// TODO : Ownership transfer of resources already used by the owner queue (release on the owner queue first)
+// TODO : Thread safety
+
+VULKAN_NAMESPACE_BEGIN
+
+// Increasing id of a submitted batch, a ticket is completed once all the uploads of its batch are done
+typedef VulkanU64 VulkanUploadTicket;
+
+// Records many buffer and image uploads and sends them all with one submission
+// The staging memory comes from persistently mapped chunks, recycled once the batch that used them has completed
+// When the transfer queue is not in the family of the owner queue, the resources are released by the transfer queue
+// and acquired by the owner queue, so they can be used on the owner queue as soon as the ticket is completed
+class VulkanUploadManager
+{
+	public:
+		static const VkDeviceSize DefaultChunkSize = 8 * 1024 * 1024;
+
+		// ownerQueue is the queue that will use the resources, nullptr if it is the transfer queue
+		static VulkanUploadManagerPtr createUploadManager(VulkanDevice& device, VulkanQueue* transferQueue, VulkanQueue* ownerQueue = nullptr, VkDeviceSize chunkSize = DefaultChunkSize);
+
+		~VulkanUploadManager();
+
+		bool uploadBuffer(VulkanBuffer* buffer, VkDeviceSize offset, VkDeviceSize dataSize, const void* data, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages);
+		bool uploadImage(VulkanImage* image, VkImageSubresourceLayers subresource, VkOffset3D offset, VkExtent3D size, VkDeviceSize dataSize, const void* data, VkImageLayout currentLayout, VkImageLayout newLayout, VkAccessFlags currentAccess, VkAccessFlags newAccess, VkImageAspectFlags aspect, VkPipelineStageFlags generatingStages, VkPipelineStageFlags consumingStages);
+		bool hasPendingUploads() const;
+
+		// Records and submits everything uploaded since the last submit
+		// When there is nothing to submit, the ticket of the last submission is returned
+		bool submit(VulkanUploadTicket& ticket, VulkanArrayView<VkSemaphore> signalSemaphores = {});
+
+		// Does not block, completed batches are recycled
+		bool isCompleted(VulkanUploadTicket ticket);
+		bool wait(VulkanUploadTicket ticket, VulkanU64 timeout);
+		bool waitIdle(VulkanU64 timeout);
+
+		VulkanUploadTicket getLastSubmittedTicket() const;
+		VulkanUploadTicket getLastCompletedTicket() const;
+
+		VulkanQueue* getTransferQueue() const;
+		VulkanQueue* getOwnerQueue() const;
+		bool transfersOwnership() const;
+
+	private:
+		VulkanUploadManager(VulkanDevice& device, VulkanQueue* transferQueue, VulkanQueue* ownerQueue, VkDeviceSize chunkSize);
+
+		bool init();
+		void release();
+
+		struct BufferUpload
+		{
+			VulkanBuffer* buffer;
+			VulkanU32 chunk;
+			VkBufferCopy region;
+			VkAccessFlags currentAccess;
+			VkAccessFlags newAccess;
+			VkPipelineStageFlags generatingStages;
+			VkPipelineStageFlags consumingStages;
+		};
+
+		struct ImageUpload
+		{
+			VulkanImage* image;
+			VulkanU32 chunk;
+			VkBufferImageCopy region;
+			VkImageLayout currentLayout;
+			VkImageLayout newLayout;
+			VkAccessFlags currentAccess;
+			VkAccessFlags newAccess;
+			VkImageAspectFlags aspect;
+			VkPipelineStageFlags generatingStages;
+			VkPipelineStageFlags consumingStages;
+		};
+
+		struct Batch
+		{
+			VulkanUploadTicket ticket;
+			VulkanCommandBufferPtr transferCommandBuffer;
+			VulkanCommandBufferPtr ownerCommandBuffer; // Only used with an ownership transfer
+			VulkanSemaphorePtr ownershipSemaphore; // Only used with an ownership transfer
+			VulkanFencePtr fence;
+			std::vector<VulkanBufferPtr> chunks;
+			VkDeviceSize lastChunkUsedSize;
+			std::vector<BufferUpload> bufferUploads;
+			std::vector<ImageUpload> imageUploads;
+		};
+		typedef std::unique_ptr<Batch> BatchPtr;
+
+		Batch* getRecordingBatch();
+		bool allocateStaging(VkDeviceSize size, VkDeviceSize alignment, VulkanU32& chunk, VkDeviceSize& offset);
+		bool writeStaging(VulkanU32 chunk, VkDeviceSize offset, VkDeviceSize dataSize, const void* data);
+		bool recordBatch(Batch& batch);
+		void recycleBatch(BatchPtr batch);
+
+		// Size of a texel, or of a block of texels for the compressed formats, in the buffer of a copy to the aspect of an image
+		static VkDeviceSize getTexelBlockSize(VkFormat format, VkImageAspectFlags aspect);
+		static VkDeviceSize getLeastCommonMultiple(VkDeviceSize a, VkDeviceSize b);
+
+	private:
+		VulkanDevice& mDevice;
+		VulkanQueue* mTransferQueue;
+		VulkanQueue* mOwnerQueue;
+		VkDeviceSize mChunkSize;
+
+		VulkanCommandPoolPtr mTransferCommandPool;
+		VulkanCommandPoolPtr mOwnerCommandPool;
+
+		BatchPtr mRecordingBatch;
+		std::vector<BatchPtr> mSubmittedBatches; // Ordered by ticket
+		std::vector<BatchPtr> mFreeBatches;
+		std::vector<VulkanBufferPtr> mFreeChunks;
+
+		VulkanUploadTicket mLastSubmittedTicket;
+		VulkanUploadTicket mLastCompletedTicket;
+};
+
+VULKAN_NAMESPACE_END
\ No newline at end of file
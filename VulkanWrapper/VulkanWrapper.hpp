@@ -2,30 +2,48 @@
 
 #include "VulkanCore.hpp"
 
+#include "VulkanBindlessTable.hpp"
 #include "VulkanBuffer.hpp"
 #include "VulkanBufferView.hpp"
 #include "VulkanCommandBuffer.hpp"
 #include "VulkanCommandPool.hpp"
 #include "VulkanComputePipeline.hpp"
+#include "VulkanContainers.hpp"
+#include "VulkanDescriptorAllocator.hpp"
 #include "VulkanDescriptorPool.hpp"
 #include "VulkanDescriptorSet.hpp"
+#include "VulkanDescriptorSetCache.hpp"
 #include "VulkanDescriptorSetLayout.hpp"
+#include "VulkanDescriptorUpdateTemplate.hpp"
 #include "VulkanDevice.hpp"
 #include "VulkanFence.hpp"
 #include "VulkanFramebuffer.hpp"
+#include "VulkanGpuProfiler.hpp"
 #include "VulkanGraphicsPipeline.hpp"
+#include "VulkanHash.hpp"
 #include "VulkanHelper.hpp"
 #include "VulkanImage.hpp"
 #include "VulkanImageView.hpp"
 #include "VulkanInstance.hpp"
+#include "VulkanMappedFile.hpp"
+#include "VulkanMemoryAllocator.hpp"
 #include "VulkanMemoryBlock.hpp"
+#include "VulkanParallelRecorder.hpp"
 #include "VulkanPhysicalDevice.hpp"
+#include "VulkanPipelineBatch.hpp"
 #include "VulkanPipelineCache.hpp"
 #include "VulkanPipelineLayout.hpp"
+#include "VulkanPipelineStateCache.hpp"
+#include "VulkanQueryPool.hpp"
 #include "VulkanQueue.hpp"
+#include "VulkanRenderGraph.hpp"
 #include "VulkanRenderPass.hpp"
 #include "VulkanSampler.hpp"
 #include "VulkanSemaphore.hpp"
 #include "VulkanShaderModule.hpp"
+#include "VulkanShaderModuleCache.hpp"
+#include "VulkanShaderReflection.hpp"
+#include "VulkanSpecializationConstants.hpp"
 #include "VulkanSurface.hpp"
 #include "VulkanSwapchain.hpp"
+#include "VulkanUploadManager.hpp"